@@ -0,0 +1,243 @@
+#include "admission.h"
+#include <string.h>
+#include <limits.h>
+
+/**
+ * SLO czekania z PIZZERIA_ADMISSION (ms; brak zmiennej lub "0" - bez SLO).
+ * @return 0 lub -1 (błędna wartość).
+ */
+
+int admissionConfigFromEnv(int* sloMs) {
+    *sloMs = 0;
+    const char* s = getenv("PIZZERIA_ADMISSION");
+    if (s == NULL || *s == '\0') {
+        return 0;
+    }
+    char* end;
+    long v = strtol(s, &end, 10);
+    if (end == s || *end != '\0' || v < 0 || v > ADMISSION_MAX_SLO_MS) {
+        fprintf(stderr, "[admission.c] PIZZERIA_ADMISSION: SLO czekania w ms (0..%d), jest: %s\n",
+                ADMISSION_MAX_SLO_MS, s);
+        return -1;
+    }
+    *sloMs = (int)v;
+    return 0;
+}
+
+static long long admissionNow(const Admission* a) {
+    return (a->clockNs != NULL) ? *a->clockNs : monotonicNs();
+}
+
+/**
+ * Przygotowuje szacowanie dla sali o podanym układzie.
+ *
+ * @param a Stan przyjmowania.
+ * @param perCapacity Liczba stolików każdej pojemności.
+ * @param queueLimit Twardy limit kolejki (tyle grup naraz ma zapamiętany szacunek).
+ * @param sloMs SLO czekania [ms] (> 0).
+ * @param enforce 1 - odmowa ponad SLO, 0 - tylko pomiar.
+ * @return 0 lub -1 (błąd malloc).
+ */
+
+int admissionInit(Admission* a, const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit, int sloMs, int enforce) {
+    memset(a, 0, sizeof(*a));
+    a->sloMs   = sloMs;
+    a->enforce = enforce;
+    int tables = 0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        tables += perCapacity[c];
+    }
+    for (int g = 1; g <= MAX_GROUP_SIZE; g++) {
+        for (int c = g; c <= MAX_TABLE_CAPACITY; c++) {
+            a->serversFor[g] += perCapacity[c - 1];
+        }
+    }
+    // Grupy s i g konkurują o stoliki, przy których zmieszczą się obie
+    for (int s = 1; s <= MAX_GROUP_SIZE; s++) {
+        for (int g = 1; g <= MAX_GROUP_SIZE; g++) {
+            int both = a->serversFor[s > g ? s : g];
+            a->share[s][g] = a->serversFor[s] ? (double)both / a->serversFor[s] : 0.0;
+        }
+    }
+    a->pendingCap = (queueLimit > 0) ? queueLimit : 1;
+    a->seatNs  = (long long*)calloc((size_t)(tables ? tables : 1) * TABLE_SLOTS, sizeof(long long));
+    a->pending = (AdmissionPending*)calloc(a->pendingCap, sizeof(AdmissionPending));
+    if (a->seatNs == NULL || a->pending == NULL) {
+        admissionDestroy(a);
+        return -1;
+    }
+    a->holdNs          = ADMISSION_HOLD_PRIOR_NS;
+    a->summary.sloMs   = sloMs;
+    a->summary.enforce = enforce;
+    return 0;
+}
+
+void admissionDestroy(Admission* a) {
+    free(a->seatNs);
+    free(a->pending);
+    a->seatNs  = NULL;
+    a->pending = NULL;
+}
+
+// Czas wirtualny (des.c, replay_app) zamiast CLOCK_MONOTONIC
+void admissionUseClock(Admission* a, const long long* clockNs) {
+    a->clockNs = clockNs;
+}
+
+/**
+ * Szacowany czas czekania grupy, dla której teraz nie ma stolika.
+ * Do pierwszego wyjścia czas przy stoliku to ADMISSION_HOLD_PRIOR_NS.
+ *
+ * @param a Stan przyjmowania.
+ * @param groupSize Wielkość grupy.
+ * @return Szacunek [ms]; INT_MAX, gdy w lokalu nie ma stolika dla tej grupy.
+ */
+
+int admissionEstimate(const Admission* a, int groupSize) {
+    if (a->serversFor[groupSize] == 0) {
+        return INT_MAX;
+    }
+    double ahead = 0;
+    for (int s = 1; s <= MAX_GROUP_SIZE; s++) {
+        ahead += a->queued[s] * a->share[s][groupSize];
+    }
+    int busy = 0;
+    for (int c = groupSize; c <= MAX_TABLE_CAPACITY; c++) {
+        busy += a->groupsAt[c];
+    }
+    double ms = (ahead + 1.0) * (double)a->holdNs / (busy > 0 ? busy : 1) / 1e6;
+    return (ms < INT_MAX) ? (int)ms : INT_MAX;
+}
+
+/**
+ * Czy szacunek przekracza SLO (i SLO jest egzekwowane) - wtedy liczy odmowę.
+ */
+
+int admissionOverSlo(Admission* a, int estimateMs) {
+    if (!a->enforce || estimateMs <= a->sloMs) {
+        return 0;
+    }
+    a->summary.sloRejects++;
+    return 1;
+}
+
+/**
+ * Grupa weszła do kolejki z szacunkiem estimateMs. Przy pełnej liście
+ * (grupy przekazane między kasjerami) najstarszy wpis ustępuje nowemu.
+ */
+
+void admissionQueued(Admission* a, const GroupOfClients* g, int estimateMs) {
+    a->summary.admitted++;
+    a->queued[g->size]++;
+    int slot = a->pendingCount;
+    if (slot == a->pendingCap) {
+        // Lista pełna - najstarszy wpis przestaje być śledzony, także w składzie kolejki
+        slot = 0;
+        for (int i = 1; i < a->pendingCount; i++) {
+            if (a->pending[i].sinceNs < a->pending[slot].sinceNs) {
+                slot = i;
+            }
+        }
+        if (a->queued[a->pending[slot].size] > 0) {
+            a->queued[a->pending[slot].size]--;
+        }
+    } else {
+        a->pendingCount++;
+    }
+    a->pending[slot].pid        = g->groupPID;
+    a->pending[slot].size       = g->size;
+    a->pending[slot].sinceNs    = admissionNow(a);
+    a->pending[slot].estimateMs = estimateMs;
+}
+
+// Zdejmuje grupę z listy czekających; zwraca jej wpis (pid 0 - nie było)
+static AdmissionPending takePending(Admission* a, const GroupOfClients* g) {
+    AdmissionPending p = { 0, 0, 0, 0 };
+    for (int i = 0; i < a->pendingCount; i++) {
+        if (a->pending[i].pid == g->groupPID) {
+            p = a->pending[i];
+            a->pending[i] = a->pending[--a->pendingCount];
+            if (a->queued[g->size] > 0) {
+                a->queued[g->size]--;
+            }
+            break;
+        }
+    }
+    return p;
+}
+
+static void countViolation(Admission* a, const AdmissionPending* p, long long now) {
+    if (p->pid != 0 && now - p->sinceNs > a->sloMs * 1000000LL) {
+        a->summary.violations++;
+    }
+}
+
+/**
+ * Grupa usiadła przy stoliku tableIdx (po occupyTable - jej PID jest już w slocie).
+ * Z kolejki: faktyczne czekanie porównujemy z szacunkiem i SLO.
+ */
+
+void admissionSeated(Admission* a, const DiningTable* t, int tableIdx, const GroupOfClients* g, int fromQueue) {
+    long long now = admissionNow(a);
+    if (fromQueue) {
+        AdmissionPending p = takePending(a, g);
+        if (p.pid != 0) {
+            long long waitedMs = (now - p.sinceNs) / 1000000LL;
+            a->summary.absErrorMs += llabs(waitedMs - p.estimateMs);
+            a->summary.estimates++;
+            countViolation(a, &p, now);
+        }
+    } else {
+        a->summary.admitted++;
+    }
+    a->groupsAt[t[tableIdx].capacity]++;
+    for (int j = 0; j < TABLE_SLOTS; j++) {
+        if (t[tableIdx].occupant_pids[j] == g->groupPID) {
+            a->seatNs[tableIdx * TABLE_SLOTS + j] = now;
+            break;
+        }
+    }
+}
+
+/**
+ * Grupa wychodzi (przed vacateTable - PID jeszcze w slocie): czas przy stoliku do średniej.
+ */
+
+void admissionLeft(Admission* a, const DiningTable* t, int tableIdx, const GroupOfClients* g) {
+    if (a->groupsAt[t[tableIdx].capacity] > 0) {
+        a->groupsAt[t[tableIdx].capacity]--;
+    }
+    for (int j = 0; j < TABLE_SLOTS; j++) {
+        if (t[tableIdx].occupant_pids[j] != g->groupPID) {
+            continue;
+        }
+        long long held = admissionNow(a) - a->seatNs[tableIdx * TABLE_SLOTS + j];
+        if (held > 0) {
+            a->holdNs = a->observed ? a->holdNs + (held - a->holdNs) / (1 << ADMISSION_HOLD_SHIFT) : held;
+            a->observed = 1;
+        }
+        break;
+    }
+}
+
+/**
+ * Grupa odprawiona z kolejki (zamykamy) - czekała już dłużej niż SLO?
+ */
+
+void admissionDismissed(Admission* a, const GroupOfClients* g) {
+    AdmissionPending p = takePending(a, g);
+    countViolation(a, &p, admissionNow(a));
+}
+
+// Grupa opuściła kolejkę bez stolika u tego kasjera (przekazana innemu)
+void admissionForget(Admission* a, const GroupOfClients* g) {
+    takePending(a, g);
+}
+
+/**
+ * Koniec zmiany: średni czas przy stoliku do podsumowania.
+ */
+
+void admissionFinish(Admission* a) {
+    a->summary.holdNs = a->holdNs;
+}
@@ -0,0 +1,64 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "pizzeria.h"
+#include "stats.h"
+
+// --------------------- Przyjmowanie grup wg szacowanego czekania ---------------------
+//
+// Zamiast samego limitu długości kolejki (QUEUE_LIMIT) kasjer szacuje, ile grupa danej
+// wielkości postoi w kolejce, i odmawia (NO_TABLE_FOUND), gdy szacunek przekracza SLO.
+// Szacunek jest utrzymywany przyrostowo przy każdym zdarzeniu sali:
+//   - średni czas zajmowania stolika (EWMA czasów od usadzenia do wyjścia),
+//   - grupy przy stolikach, przy których zmieści się nowa grupa (bieżąca zajętość),
+//   - skład kolejki: grupy każdej wielkości, ważone częścią stolików, o które konkurują.
+// czekanie(g) ~ (grupy przed nami + 1) x średni czas przy stoliku / grupy przy pasujących stolikach
+// Szacunek wraca do grupy w odpowiedzi (CommunicationMessage.waitMs; GROUP_QUEUED przy wejściu
+// do kolejki), a po usadzeniu jest porównywany z faktycznym czekaniem.
+//
+// Konfiguracja: PIZZERIA_ADMISSION=slo_ms (bez zmiennej albo "0" - tylko stały limit, jak dotąd).
+// Limit kolejki zostaje jako twarda granica pamięci (kolejka, statystyki, katalog shardów).
+
+#define ADMISSION_HOLD_SHIFT    4   // EWMA: nowy pomiar z wagą 1/16
+#define ADMISSION_HOLD_PRIOR_NS 8500000000LL  // do pierwszego wyjścia: średnie jedzenie klienta (6-11 s)
+#define ADMISSION_MAX_SLO_MS    3600000
+
+typedef struct {
+    pid_t     pid;
+    int       size;
+    long long sinceNs;
+    int       estimateMs;
+} AdmissionPending;
+
+typedef struct {
+    int       sloMs;
+    int       enforce;                              // 0 - tylko pomiar (porównanie ze stałym limitem)
+    int       serversFor[MAX_GROUP_SIZE + 1];       // stoliki, przy których zmieści się grupa g
+    double    share[MAX_GROUP_SIZE + 1][MAX_GROUP_SIZE + 1]; // [s][g]: część stolików grupy s dostępnych dla g
+    int       groupsAt[MAX_TABLE_CAPACITY + 1];     // grupy przy stolikach danej pojemności
+    int       queued[MAX_GROUP_SIZE + 1];           // skład kolejki
+    long long holdNs;                               // średni czas przy stoliku (EWMA)
+    int       observed;                             // 0 - holdNs to jeszcze założenie
+    long long* seatNs;                              // [stolik * TABLE_SLOTS + slot] - chwila usadzenia
+    AdmissionPending* pending;                      // grupy w kolejce: wejście i szacunek
+    int       pendingCap;
+    int       pendingCount;
+    const long long* clockNs;                       // NULL - CLOCK_MONOTONIC, inaczej czas wirtualny
+    AdmissionSummary summary;
+} Admission;
+
+int  admissionConfigFromEnv(int* sloMs);
+int  admissionInit(Admission* a, const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit, int sloMs, int enforce);
+void admissionDestroy(Admission* a);
+void admissionUseClock(Admission* a, const long long* clockNs);
+
+int  admissionEstimate(const Admission* a, int groupSize);
+int  admissionOverSlo(Admission* a, int estimateMs);
+void admissionQueued(Admission* a, const GroupOfClients* g, int estimateMs);
+void admissionSeated(Admission* a, const DiningTable* t, int tableIdx, const GroupOfClients* g, int fromQueue);
+void admissionLeft(Admission* a, const DiningTable* t, int tableIdx, const GroupOfClients* g);
+void admissionDismissed(Admission* a, const GroupOfClients* g);
+void admissionForget(Admission* a, const GroupOfClients* g);
+void admissionFinish(Admission* a);
+
+#endif // ADMISSION_H
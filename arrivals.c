@@ -0,0 +1,313 @@
+#include "arrivals.h"
+#include <string.h>
+#include <math.h>
+
+static unsigned long long arrivalsRandom(ArrivalModel* m) {
+    m->rng ^= m->rng >> 12;
+    m->rng ^= m->rng << 25;
+    m->rng ^= m->rng >> 27;
+    return m->rng * 0x2545F4914F6CDD1DULL;
+}
+
+// Liczba z przedziału (0, 1] - bez zera, bo idzie do log()
+static double arrivalsUnit(ArrivalModel* m) {
+    return ((arrivalsRandom(m) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static int drawGroupSize(ArrivalModel* m) {
+    double u = (arrivalsRandom(m) >> 11) * (1.0 / 9007199254740992.0);
+    int size = 1;
+    while (size < MAX_GROUP_SIZE && u >= m->sizeCdf[size - 1]) {
+        size++;
+    }
+    return size;
+}
+
+/**
+ * Wagi wielkości grup "w1,w2,..." (NULL - równe dla 1..GROUP_LIMIT). Brakujące wagi = 0.
+ */
+
+static int parseSizes(ArrivalModel* m, const char* sizes) {
+    double w[MAX_GROUP_SIZE];
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        w[i] = (sizes == NULL && i < GROUP_LIMIT) ? 1.0 : 0.0;
+    }
+    const char* p = sizes;
+    for (int i = 0; p != NULL && *p != '\0' && i < MAX_GROUP_SIZE; i++) {
+        char* end;
+        w[i] = strtod(p, &end);
+        if (end == p || w[i] < 0 || (w[i] > 0 && i >= GROUP_LIMIT)) {
+            fprintf(stderr, "[arrivals.c] Błędne wagi wielkości grup: %s\n", sizes);
+            return -1;
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    double total = 0;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        total += w[i];
+    }
+    if (total <= 0) {
+        fprintf(stderr, "[arrivals.c] Wagi wielkości grup sumują się do zera: %s\n", sizes);
+        return -1;
+    }
+    double acc = 0;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        acc += w[i];
+        m->sizeCdf[i] = acc / total;
+    }
+    m->sizeCdf[MAX_GROUP_SIZE - 1] = 1.0;
+    return 0;
+}
+
+/**
+ * "0=R0,T1=R1,..." - początki odcinków rosnąco, pierwszy od zera.
+ */
+
+static int parsePiecewise(ArrivalModel* m, const char* p) {
+    while (*p != '\0') {
+        if (m->segCount == ARRIVALS_MAX_SEGMENTS) {
+            fprintf(stderr, "[arrivals.c] Za dużo odcinków (najwyżej %d)\n", ARRIVALS_MAX_SEGMENTS);
+            return -1;
+        }
+        char* end;
+        ArrivalSegment* s = &m->seg[m->segCount];
+        s->start = strtod(p, &end);
+        if (end == p || *end != '=') {
+            return -1;
+        }
+        p = end + 1;
+        s->rate = strtod(p, &end);
+        if (end == p || s->rate < 0) {
+            return -1;
+        }
+        if ((m->segCount == 0 && s->start != 0) || (m->segCount > 0 && s->start <= m->seg[m->segCount - 1].start)) {
+            return -1;
+        }
+        m->segCount++;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return -1;
+        }
+    }
+    return (m->segCount > 0) ? 0 : -1;
+}
+
+/**
+ * Zapis przybyć: "czas_s [wielkość]" w wierszu, czasy niemalejące.
+ */
+
+static int loadTrace(ArrivalModel* m, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        perror("[arrivals.c] Błąd otwarcia pliku z zapisem przybyć");
+        return -1;
+    }
+    long capacity = 1024;
+    m->trace = (Arrival*)malloc(sizeof(Arrival) * capacity);
+    if (m->trace == NULL) {
+        perror("[arrivals.c] Błąd malloc() zapisu przybyć");
+        fclose(f);
+        return -1;
+    }
+    char line[256];
+    long lineNo = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineNo++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        char* end;
+        double at = strtod(p, &end);
+        int parsed = (end != p);
+        long size = strtol(end, &end, 10);
+        long long atUs = (long long)(at * 1e6 + 0.5);
+        if (!parsed || at < 0 || size < 0 || size > GROUP_LIMIT
+            || (m->traceCount > 0 && atUs < m->trace[m->traceCount - 1].atUs)) {
+            fprintf(stderr, "[arrivals.c] %s:%ld: błędny wiersz zapisu przybyć\n", path, lineNo);
+            fclose(f);
+            return -1;
+        }
+        if (m->traceCount == capacity) {
+            capacity *= 2;
+            Arrival* grown = (Arrival*)realloc(m->trace, sizeof(Arrival) * capacity);
+            if (grown == NULL) {
+                perror("[arrivals.c] Błąd realloc() zapisu przybyć");
+                fclose(f);
+                return -1;
+            }
+            m->trace = grown;
+        }
+        m->trace[m->traceCount].atUs = atUs;
+        m->trace[m->traceCount].size = (int)size;  // 0 - wielkość z wag
+        m->traceCount++;
+    }
+    fclose(f);
+    return 0;
+}
+
+/**
+ * Przygotowuje model przybyć.
+ *
+ * @param m Model.
+ * @param spec Opis modelu (NULL - uniform), składnia w arrivals.h.
+ * @param sizes Wagi wielkości grup (NULL - równe).
+ * @param seed Ziarno generatora.
+ * @return 0 lub -1 (komunikat wypisany na stderr).
+ */
+
+int arrivalsInit(ArrivalModel* m, const char* spec, const char* sizes, unsigned long long seed) {
+    memset(m, 0, sizeof(*m));
+    if (spec == NULL || *spec == '\0') {
+        spec = "uniform";
+    }
+    snprintf(m->spec, sizeof(m->spec), "%s", spec);
+    if (parseSizes(m, sizes) == -1) {
+        return -1;
+    }
+
+    int ok = 0;
+    if (strcmp(spec, "uniform") == 0) {
+        m->kind = ARRIVALS_UNIFORM;
+        ok = 1;
+    } else if (strncmp(spec, "poisson:", 8) == 0) {
+        m->kind     = ARRIVALS_POISSON;
+        m->segCount = 1;
+        m->seg[0].start = 0;
+        m->seg[0].rate  = atof(spec + 8);
+        ok = (m->seg[0].rate > 0);
+    } else if (strncmp(spec, "piecewise:", 10) == 0) {
+        m->kind = ARRIVALS_POISSON;
+        ok = (parsePiecewise(m, spec + 10) == 0);
+    } else if (strncmp(spec, "bursty:", 7) == 0) {
+        double base, peak, every, lasts;
+        m->kind = ARRIVALS_POISSON;
+        if (sscanf(spec + 7, "%lf,%lf,%lf,%lf", &base, &peak, &every, &lasts) == 4
+            && base >= 0 && peak > 0 && lasts > 0 && every > lasts) {
+            m->segCount = 2;
+            m->seg[0] = (ArrivalSegment){ 0, base };
+            m->seg[1] = (ArrivalSegment){ every - lasts, peak };
+            m->period = every;
+            ok = 1;
+        }
+    } else if (strncmp(spec, "trace:", 6) == 0) {
+        m->kind = ARRIVALS_TRACE;
+        if (loadTrace(m, spec + 6) == -1) {
+            arrivalsDestroy(m);
+            return -1;
+        }
+        ok = 1;
+    }
+    if (!ok) {
+        fprintf(stderr, "[arrivals.c] Nieznany lub błędny model przybyć: %s\n", spec);
+        return -1;
+    }
+    arrivalsReset(m, seed);
+    return 0;
+}
+
+/**
+ * Model z PIZZERIA_ARRIVALS i PIZZERIA_GROUP_SIZES.
+ */
+
+int arrivalsFromEnv(ArrivalModel* m, unsigned long long seed) {
+    return arrivalsInit(m, getenv("PIZZERIA_ARRIVALS"), getenv("PIZZERIA_GROUP_SIZES"), seed);
+}
+
+/**
+ * Zaczyna przebieg od nowa (czas 0) z nowym ziarnem; zapis przybyć od początku.
+ */
+
+void arrivalsReset(ArrivalModel* m, unsigned long long seed) {
+    m->rng        = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    m->now        = 0;
+    m->segIdx     = 0;
+    m->cycleStart = 0;
+    m->tracePos   = 0;
+    m->lastUs     = 0;
+    m->started    = 0;
+}
+
+/**
+ * Kolejne przybycie Poissona o intensywności odcinkami stałej: losujemy
+ * E ~ Exp(1) i przesuwamy się po odcinkach, aż skumulowana intensywność
+ * od bieżącej chwili osiągnie E.
+ *
+ * @return 0, gdy intensywność do końca jest zerowa (przybyć już nie będzie).
+ */
+
+static int nextPoisson(ArrivalModel* m) {
+    double e = -log(arrivalsUnit(m));
+    while (1) {
+        const ArrivalSegment* s = &m->seg[m->segIdx];
+        double end;
+        if (m->segIdx + 1 < m->segCount) {
+            end = m->cycleStart + m->seg[m->segIdx + 1].start;
+        } else if (m->period > 0) {
+            end = m->cycleStart + m->period;
+        } else {
+            end = INFINITY;
+        }
+        if (s->rate > 0 && m->now + e / s->rate <= end) {
+            m->now += e / s->rate;
+            return 1;
+        }
+        if (end == INFINITY) {
+            return 0;
+        }
+        e -= (end - m->now) * s->rate;
+        m->now = end;
+        if (++m->segIdx == m->segCount) {
+            m->segIdx      = 0;
+            m->cycleStart += m->period;
+        }
+    }
+}
+
+/**
+ * Następne przybycie (czasy niemalejące).
+ *
+ * @return 1 lub 0, gdy przybyć już nie będzie (koniec zapisu, zerowa intensywność).
+ */
+
+int arrivalsNext(ArrivalModel* m, Arrival* out) {
+    switch (m->kind) {
+    case ARRIVALS_UNIFORM:
+        // Jak dawniej w managerze: grupa od razu po otwarciu, potem odstęp 0.5-1.5 s (co 1 ms)
+        if (m->started) {
+            m->lastUs += (long long)(arrivalsRandom(m) % 1001 + 500) * 1000;
+        }
+        m->started = 1;
+        out->atUs = m->lastUs;
+        out->size = drawGroupSize(m);
+        return 1;
+
+    case ARRIVALS_POISSON:
+        if (!nextPoisson(m)) {
+            return 0;
+        }
+        out->atUs = (long long)(m->now * 1e6);
+        out->size = drawGroupSize(m);
+        return 1;
+
+    case ARRIVALS_TRACE:
+        if (m->tracePos == m->traceCount) {
+            return 0;
+        }
+        *out = m->trace[m->tracePos++];
+        if (out->size == 0) {
+            out->size = drawGroupSize(m);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+void arrivalsDestroy(ArrivalModel* m) {
+    free(m->trace);
+    m->trace      = NULL;
+    m->traceCount = 0;
+}
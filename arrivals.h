@@ -0,0 +1,60 @@
+#ifndef ARRIVALS_H
+#define ARRIVALS_H
+
+#include "pizzeria.h"
+
+// --------------------- Generator przybyć grup ---------------------
+//
+// Model wybiera PIZZERIA_ARRIVALS (czasy w sekundach od otwarcia, intensywność w grupach/s):
+//   uniform                  - jak dotąd: pierwsza grupa od razu, potem odstępy 0.5-1.5 s
+//   poisson:R                - proces Poissona o intensywności R
+//   piecewise:0=R0,T1=R1,... - Poisson o intensywności odcinkami stałej (krzywa dnia, np. szczyt obiadowy)
+//   bursty:R,P,T,D           - tło R, a co T sekund (na końcu okresu) D sekund szczytu o intensywności P
+//   trace:plik               - odtworzenie zapisu: w każdym wierszu "czas_s [wielkość]", '#' - komentarz
+// Wielkości grup: PIZZERIA_GROUP_SIZES = "w1,w2,..." (wagi grup 1..GROUP_LIMIT-osobowych, domyślnie równe);
+// w zapisie bez kolumny wielkości także z tych wag.
+// Odcinki Poissona są obsługiwane przez odwracanie skumulowanej intensywności (jedna liczba
+// losowa na przybycie, bez odrzucania), więc generator daje miliony przybyć na sekundę.
+
+#define ARRIVALS_UNIFORM       0
+#define ARRIVALS_POISSON       1  // poisson, piecewise i bursty - odcinki stałej intensywności
+#define ARRIVALS_TRACE         2
+#define ARRIVALS_MAX_SEGMENTS 64
+
+typedef struct {
+    double start;               // początek odcinka [s od otwarcia lub od początku okresu]
+    double rate;                // grup/s
+} ArrivalSegment;
+
+typedef struct {
+    long long atUs;             // czas przybycia [us od otwarcia]
+    int       size;
+} Arrival;
+
+typedef struct {
+    int                kind;
+    char               spec[64];                    // do wypisania w logach
+    ArrivalSegment     seg[ARRIVALS_MAX_SEGMENTS];
+    int                segCount;
+    double             period;                      // > 0: odcinki powtarzają się co period sekund
+    double             sizeCdf[MAX_GROUP_SIZE];     // skumulowane wagi wielkości grup (ostatnia = 1)
+    Arrival*           trace;
+    long               traceCount;
+
+    // Stan bieżącego przebiegu
+    unsigned long long rng;
+    double             now;                         // [s]
+    int                segIdx;
+    double             cycleStart;
+    long               tracePos;
+    long long          lastUs;
+    int                started;
+} ArrivalModel;
+
+int  arrivalsInit(ArrivalModel* m, const char* spec, const char* sizes, unsigned long long seed);
+int  arrivalsFromEnv(ArrivalModel* m, unsigned long long seed);
+void arrivalsReset(ArrivalModel* m, unsigned long long seed);
+int  arrivalsNext(ArrivalModel* m, Arrival* out);
+void arrivalsDestroy(ArrivalModel* m);
+
+#endif // ARRIVALS_H
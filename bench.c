@@ -0,0 +1,480 @@
+#include "pizzeria.h"
+#include "transport.h"
+#include <string.h>
+#include <getopt.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+
+// --------------------- Benchmark obciążeniowy kasjera ---------------------
+//
+// Uruchamia prawdziwy cashier_app i obciąża go przez prawdziwy transport
+// (kolejka komunikatów lub pierścień shm - PIZZERIA_TRANSPORT). Każdy wątek udaje kolejne grupy klientów (groupPID = TID wątku):
+// REQUEST_TABLE -> odpowiedź -> SEND_ORDER -> potwierdzenie -> LEAVE_TABLE, bez jedzenia.
+// Opóźnienie mierzymy od wysłania REQUEST_TABLE do odebrania numeru stolika.
+// Z -k zamiast obciążenia sprawdza rezygnację, która wyprzedza zapytanie (checkCancelOrder).
+
+typedef struct {
+    int        id;
+    pthread_t  thread;
+    long long* latency;     // [ns]
+    long       samples;
+    long       capacity;
+    long       requests;
+    long       seated;
+    long       rejected;
+    long       orders;
+    long       leaves;
+} BenchWorker;
+
+static int                 concurrency = 4;
+static double              rate        = 0;    // grup/s łącznie, 0 = bez odstępów (tryb nasycenia)
+static double              duration    = 5;
+static int                 sizeWeights[MAX_GROUP_SIZE];  // domyślnie równe dla 1..GROUP_LIMIT
+static int                 weightSum   = 0;
+static int                 readers     = 0;    // wątki czytające stoliki jak showCurrentTables/strażak
+static DiningTable*        tables;
+static int                 totalTables;
+static long long           startNs;
+static volatile int        stopBench   = 0;
+static int                 checkCancel = 0;    // -k: tylko sprawdzenie kolejności CANCEL_REQUEST
+
+static long long nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleepUntil(long long ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000LL), (long)(ns % 1000000000LL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+static void addSample(BenchWorker* w, long long ns) {
+    if (w->samples == w->capacity) {
+        w->capacity = w->capacity ? w->capacity * 2 : 65536;
+        w->latency = (long long*)realloc(w->latency, sizeof(long long) * w->capacity);
+        if (!w->latency) {
+            perror("[Bench] Błąd realloc()");
+            exit(1);
+        }
+    }
+    w->latency[w->samples++] = ns;
+}
+
+static void sendMessage(Transport* link, long type, const GroupOfClients* g, int tableIndex, const int* orders) {
+    CommunicationMessage* msg = transportAcquire(link);
+    if (msg == NULL) {
+        perror("[Bench] Błąd transportAcquire()");
+        exit(1);
+    }
+    msg->mtype      = type;
+    msg->group      = *g;
+    msg->tableIndex = tableIndex;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        msg->orderedItems[i] = (orders && i < g->size) ? orders[i] : -1;
+    }
+    if (transportCommit(link) == -1) {
+        perror("[Bench] Błąd wysyłania komunikatu");
+        exit(1);
+    }
+}
+
+/**
+ * Wątek obciążający: jedna grupa naraz. Przy zadanym tempie (-r) każdy wątek
+ * wysyła co concurrency/rate sekund, a opóźnienie liczymy od planowanej chwili
+ * wysłania - spóźnienie samego wątku też jest czasem oczekiwania klienta.
+ */
+
+static void* benchWorker(void* arg) {
+    BenchWorker* w = (BenchWorker*)arg;
+    GroupOfClients g;
+    g.groupPID = (pid_t)syscall(SYS_gettid);
+    unsigned int seed = (unsigned int)g.groupPID;
+    long long interval = (rate > 0) ? (long long)(1e9 * concurrency / rate) : 0;
+    long long planned  = startNs + (interval * w->id) / concurrency;
+    Transport link;
+    if (transportOpen(&link, g.groupPID, 0) == -1) {
+        perror("[Bench] Błąd transportOpen()");
+        exit(1);
+    }
+
+    while (!stopBench) {
+        int pick = rand_r(&seed) % weightSum;
+        g.size = 1;
+        while (pick >= sizeWeights[g.size - 1]) {
+            pick -= sizeWeights[g.size - 1];
+            g.size++;
+        }
+
+        long long sentAt;
+        if (interval > 0) {
+            sleepUntil(planned);
+            sentAt = planned;
+            planned += interval;
+        } else {
+            sentAt = nowNanos();
+        }
+        sendMessage(&link, REQUEST_TABLE, &g, -1, NULL);
+        w->requests++;
+
+        CommunicationMessage resp;
+        if (transportAwaitReply(&link, &resp) == -1) {
+            perror("[Bench] Błąd odbioru odpowiedzi");
+            exit(1);
+        }
+        addSample(w, nowNanos() - sentAt);
+        if (resp.tableIndex < 0) {
+            w->rejected++;
+            continue;
+        }
+        w->seated++;
+
+        int orders[MAX_GROUP_SIZE];
+        for (int i = 0; i < g.size; i++) {
+            orders[i] = rand_r(&seed) % MENU_SIZE;
+        }
+        sendMessage(&link, SEND_ORDER, &g, resp.tableIndex, orders);
+        w->orders++;
+        CommunicationMessage ack;
+        if (transportAwaitReply(&link, &ack) == -1) {  // ORDER_SERVED - kasjer jest bez kuchni
+            perror("[Bench] Błąd odbioru potwierdzenia zamówienia");
+            exit(1);
+        }
+        sendMessage(&link, LEAVE_TABLE, &g, resp.tableIndex, NULL);
+        w->leaves++;
+    }
+    transportClose(&link);
+    return NULL;
+}
+
+/**
+ * Sprawdzenie (-k, transport msg): przy zatrzymanym kasjerze wysyłamy REQUEST_TABLE
+ * i zaraz po nim CANCEL_REQUEST tej samej grupy. Kasjer odbiera z kolejki SysV najniższy
+ * typ, więc rezygnację dostaje pierwszą - mimo to grupa ma dostać GROUP_CANCELLED,
+ * a nie stolik czy miejsce w kolejce.
+ *
+ * @return 0 - odpowiedź zgodna z oczekiwaną, 1 - inna.
+ */
+
+static int checkCancelOrder(pid_t cashierPid) {
+    GroupOfClients g = { 1, getpid(), (int)(nowNanos() / 1000) };
+    Transport link;
+    while (transportOpen(&link, g.groupPID, 0) == -1) {
+        if (errno != ENOENT) {
+            perror("[Bench] Błąd transportOpen()");
+            exit(1);
+        }
+        sched_yield();
+    }
+    // Czekamy, aż kasjer faktycznie stanie - inaczej mógłby jeszcze odebrać zapytanie
+    kill(cashierPid, SIGSTOP);
+    while (waitpid(cashierPid, NULL, WUNTRACED) == -1 && errno == EINTR);
+    sendMessage(&link, REQUEST_TABLE, &g, -1, NULL);
+    sendMessage(&link, CANCEL_REQUEST, &g, -1, NULL);
+    kill(cashierPid, SIGCONT);
+
+    CommunicationMessage resp;
+    if (transportAwaitReply(&link, &resp) == -1) {
+        perror("[Bench] Błąd odbioru odpowiedzi");
+        exit(1);
+    }
+    transportClose(&link);
+    if (resp.tableIndex == GROUP_CANCELLED) {
+        printf("Rezygnacja przed zapytaniem: GROUP_CANCELLED - poprawnie.\n");
+        return 0;
+    }
+    printf("Rezygnacja przed zapytaniem: odpowiedź %d zamiast GROUP_CANCELLED (%d).\n", resp.tableIndex, GROUP_CANCELLED);
+    return 1;
+}
+
+/**
+ * Wątek czytelnika: w kółko robi spójną kopię wszystkich stolików
+ * (jak showCurrentTables czy skan strażaka) i liczy pełne przebiegi.
+ */
+
+static void* benchReader(void* arg) {
+    long* scans = (long*)arg;
+    long  occupied = 0;
+    while (!stopBench) {
+        for (int i = 0; i < totalTables; i++) {
+            DiningTable t;
+            tableSnapshot(&tables[i], &t);
+            occupied += t.total_seated;
+        }
+        (*scans)++;
+    }
+    return (void*)occupied;
+}
+
+/**
+ * Koniec dnia tak jak przy pożarze: kasjer przestaje przyjmować, a my (jak strażak)
+ * opróżniamy stoliki, żeby mógł zapisać raport; potem sprzątamy semafor i shm.
+ * PID-y czyścimy razem z liczbą miejsc - inaczej kasjer odzyskałby przy zamykaniu
+ * miejsca zakończonych wątków i zszedłby z total_seated poniżej zera.
+ */
+
+static void stopCashier(pid_t cashierPid, int shmId, int semId) {
+    kill(cashierPid, SIGUSR1);
+    for (int i = 0; i < totalTables; i++) {
+        tableLock(&tables[i]);
+        for (int j = 0; j < TABLE_SLOTS; j++) {
+            tables[i].occupant_pids[j] = 0;
+        }
+        tables[i].group_size   = 0;
+        tables[i].total_seated = 0;
+        tableUnlock(&tables[i]);
+    }
+    while (waitpid(cashierPid, NULL, 0) == -1 && errno == EINTR);
+    deleteSharedMemory(shmId, tables);
+    removeSemaphore(semId);
+}
+
+static int compareLatency(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentileUs(const long long* sorted, long n, double p) {
+    if (n == 0) {
+        return 0;
+    }
+    long idx = (long)(p / 100.0 * (n - 1) + 0.5);
+    return sorted[idx] / 1000.0;
+}
+
+// Wagi 1..GROUP_LIMIT-osobowych grup (albo same rozmiary, gdy sizes != 0) rozdzielone sep
+static void formatMix(char* buf, size_t len, const char* sep, int sizes) {
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < GROUP_LIMIT && used < len; i++) {
+        used += snprintf(buf + used, len - used, "%s%d", i ? sep : "", sizes ? i + 1 : sizeWeights[i]);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "Użycie: ./bench_app [-c wątki] [-r grup_na_s (0 = bez odstępów)] [-d sekundy] "
+                    "[-m w1:w2:...] [-R czytelnicy] [-o text|json|csv] [-k] x1 ... x%d\n"
+                    "Kasjer działa bez kuchni i przyjmowania po SLO (PIZZERIA_KITCHEN i PIZZERIA_ADMISSION są pomijane).\n"
+                    "-k: zamiast obciążenia sprawdza CANCEL_REQUEST wysłany tuż po REQUEST_TABLE (transport msg).\n",
+            MAX_TABLE_CAPACITY);
+    exit(1);
+}
+
+// Wagi "w1:w2:...", brakujące = 0
+static void parseMix(const char* s) {
+    weightSum = 0;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        char* end = (char*)s;
+        sizeWeights[i] = (*s != '\0') ? (int)strtol(s, &end, 10) : 0;
+        if (end == s && *s != '\0') {
+            usage();
+        }
+        if (sizeWeights[i] < 0) {
+            usage();
+        }
+        weightSum += sizeWeights[i];
+        s = (*end == ':') ? end + 1 : end;
+    }
+    if (weightSum == 0 || *s != '\0') {
+        usage();
+    }
+}
+
+/**
+ * 1) Uruchamia kasjera (jak manager) z podaną liczbą stolików i czeka na jego kolejkę.
+ * 2) Przez "-d" sekund obciąża go z "-c" wątków (i opcjonalnie "-R" czytelników stolików).
+ * 3) Kończy dzień jak strażak: SIGUSR1 do kasjera i wyzerowanie stolików,
+ *    po czym sprząta semafor i pamięć współdzieloną (kolejkę usuwa kasjer).
+ * 4) Wypisuje przepustowość i percentyle opóźnień (tekst, JSON lub CSV).
+ * Z -k zamiast kroków 2 i 4 robi checkCancelOrder; kod wyjścia 1 - sprawdzenie nie przeszło.
+ */
+
+int main(int argc, char* argv[]) {
+    const char* format = "text";
+    int opt;
+    while ((opt = getopt(argc, argv, "c:r:d:m:R:o:k")) != -1) {
+        switch (opt) {
+        case 'c': concurrency = atoi(optarg); break;
+        case 'r': rate        = atof(optarg); break;
+        case 'd': duration    = atof(optarg); break;
+        case 'm': parseMix(optarg); break;
+        case 'R': readers     = atoi(optarg); break;
+        case 'o': format      = optarg; break;
+        case 'k': checkCancel = 1; break;
+        default:  usage();
+        }
+    }
+    int perCapacity[MAX_TABLE_CAPACITY];
+    totalTables = parseTableCounts(argc - optind, &argv[optind], perCapacity);
+    if (totalTables == -1 || concurrency <= 0 || duration <= 0 || rate < 0 || readers < 0) {
+        usage();
+    }
+    if (weightSum == 0) {
+        for (int i = 0; i < GROUP_LIMIT; i++) {
+            sizeWeights[i] = 1;
+        }
+        weightSum = GROUP_LIMIT;
+    }
+    for (int i = GROUP_LIMIT; i < MAX_GROUP_SIZE; i++) {
+        if (sizeWeights[i] > 0) {
+            usage();
+        }
+    }
+
+    // Kasjer nie powinien zaśmiecać wyniku komunikatami o każdej grupie
+    setenv("PIZZERIA_LOG", "error", 0);
+    if (checkCancel) {
+        setenv("PIZZERIA_TRANSPORT", "msg", 1);  // kolejność wg typów jest tylko w kolejce SysV
+    }
+
+    pid_t cashierPid = fork();
+    if (cashierPid == -1) {
+        perror("[Bench] Błąd fork() podczas tworzenia kasjera");
+        exit(1);
+    }
+    if (cashierPid == 0) {
+        char  counts[MAX_TABLE_CAPACITY][12];
+        char* args[MAX_TABLE_CAPACITY + 2] = { "cashier_app" };
+        tableCountArgs(perCapacity, counts, &args[1]);
+        args[MAX_TABLE_CAPACITY + 1] = NULL;
+        // Wątek obciążenia oczekuje dokładnie jednej odpowiedzi na zapytanie i na zamówienie:
+        // bez PIZZA_READY z kuchni i bez GROUP_QUEUED przy przyjmowaniu po SLO
+        unsetenv("PIZZERIA_KITCHEN");
+        unsetenv("PIZZERIA_ADMISSION");
+        execv("./cashier_app", args);
+        perror("[Bench] Nie udało się uruchomić kasjera");
+        exit(1);
+    }
+
+    key_t kSem = ftok(".", SEMAPHORE_GEN_CHAR);
+    key_t kShm = ftok(".", SHM_GEN_CHAR);
+    if (kSem == -1 || kShm == -1) {
+        perror("[Bench] Błąd ftok()");
+        exit(1);
+    }
+    int semId, shmId;
+    while ((semId = semget(kSem, 0, 0)) == -1 || (shmId = shmget(kShm, 0, 0)) == -1) {
+        if (errno != ENOENT) {
+            perror("[Bench] Błąd podczas czekania na zasoby kasjera");
+            exit(1);
+        }
+        sched_yield();
+    }
+
+    tables = (DiningTable*)shmat(shmId, NULL, 0);
+    if (tables == (void*)-1) {
+        perror("[Bench] Błąd shmat()");
+        exit(1);
+    }
+
+    if (checkCancel) {
+        int failed = checkCancelOrder(cashierPid);
+        stopCashier(cashierPid, shmId, semId);
+        return failed;
+    }
+
+    BenchWorker* workers = (BenchWorker*)calloc(concurrency, sizeof(BenchWorker));
+    pthread_t*   readerThreads = (pthread_t*)calloc(readers ? readers : 1, sizeof(pthread_t));
+    long*        readerScans   = (long*)calloc(readers ? readers : 1, sizeof(long));
+    startNs = nowNanos();
+    for (int i = 0; i < readers; i++) {
+        if (pthread_create(&readerThreads[i], NULL, benchReader, &readerScans[i]) != 0) {
+            perror("[Bench] Błąd pthread_create()");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < concurrency; i++) {
+        workers[i].id = i;
+        if (pthread_create(&workers[i].thread, NULL, benchWorker, &workers[i]) != 0) {
+            perror("[Bench] Błąd pthread_create()");
+            exit(1);
+        }
+    }
+    sleepUntil(startNs + (long long)(duration * 1e9));
+    stopBench = 1;
+    for (int i = 0; i < concurrency; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    long scans = 0;
+    for (int i = 0; i < readers; i++) {
+        pthread_join(readerThreads[i], NULL);
+        scans += readerScans[i];
+    }
+    double elapsed = (nowNanos() - startNs) / 1e9;
+
+    stopCashier(cashierPid, shmId, semId);
+
+    // Zbieramy wyniki
+    long requests = 0, seated = 0, rejected = 0, orders = 0, leaves = 0, samples = 0;
+    for (int i = 0; i < concurrency; i++) {
+        requests += workers[i].requests;
+        seated   += workers[i].seated;
+        rejected += workers[i].rejected;
+        orders   += workers[i].orders;
+        leaves   += workers[i].leaves;
+        samples  += workers[i].samples;
+    }
+    long long* all = (long long*)malloc(sizeof(long long) * (samples ? samples : 1));
+    long pos = 0;
+    for (int i = 0; i < concurrency; i++) {
+        memcpy(all + pos, workers[i].latency, sizeof(long long) * workers[i].samples);
+        pos += workers[i].samples;
+        free(workers[i].latency);
+    }
+    qsort(all, samples, sizeof(long long), compareLatency);
+    double p50  = percentileUs(all, samples, 50);
+    double p99  = percentileUs(all, samples, 99);
+    double p999 = percentileUs(all, samples, 99.9);
+    double pmax = samples ? all[samples - 1] / 1000.0 : 0;
+
+    const char* transport = (transportKindFromEnv() == TRANSPORT_SHM) ? "shm" : "msg";
+    int batchMax = getenv("PIZZERIA_BATCH") ? atoi(getenv("PIZZERIA_BATCH")) : 1;
+    char mix[12 * MAX_GROUP_SIZE];
+    if (strcmp(format, "json") == 0) {
+        formatMix(mix, sizeof(mix), ", ", 0);
+        printf("{\"transport\": \"%s\", \"batch\": %d, \"concurrency\": %d, \"rate\": %.0f, \"mix\": [%s], \"seconds\": %.3f, "
+               "\"requests\": %ld, \"seated\": %ld, \"rejected\": %ld, \"orders\": %ld, \"leaves\": %ld, "
+               "\"requests_per_s\": %.0f, \"orders_per_s\": %.0f, \"leaves_per_s\": %.0f, "
+               "\"p50_us\": %.1f, \"p99_us\": %.1f, \"p999_us\": %.1f, \"max_us\": %.1f, "
+               "\"readers\": %d, \"reader_scans_per_s\": %.0f}\n",
+               transport, batchMax, concurrency, rate, mix, elapsed,
+               requests, seated, rejected, orders, leaves,
+               requests / elapsed, orders / elapsed, leaves / elapsed, p50, p99, p999, pmax,
+               readers, scans / elapsed);
+    } else if (strcmp(format, "csv") == 0) {
+        printf("transport,batch,concurrency,rate,mix,seconds,requests,seated,rejected,orders,leaves,"
+               "requests_per_s,orders_per_s,leaves_per_s,p50_us,p99_us,p999_us,max_us,readers,reader_scans_per_s\n");
+        formatMix(mix, sizeof(mix), ":", 0);
+        printf("%s,%d,%d,%.0f,%s,%.3f,%ld,%ld,%ld,%ld,%ld,%.0f,%.0f,%.0f,%.1f,%.1f,%.1f,%.1f,%d,%.0f\n",
+               transport, batchMax, concurrency, rate, mix, elapsed,
+               requests, seated, rejected, orders, leaves,
+               requests / elapsed, orders / elapsed, leaves / elapsed, p50, p99, p999, pmax,
+               readers, scans / elapsed);
+    } else {
+        printf("----- Benchmark kasjera (transport: %s, partia: %d) -----\n", transport, batchMax);
+        if (rate > 0) {
+            printf("Wątki: %d | tempo: %.0f grup/s", concurrency, rate);
+        } else {
+            printf("Wątki: %d | tempo: bez odstępów", concurrency);
+        }
+        char sizes[12 * MAX_GROUP_SIZE];
+        formatMix(sizes, sizeof(sizes), "/", 1);
+        formatMix(mix, sizeof(mix), ":", 0);
+        printf(" | mieszanka grup %s: %s | czas: %.3f s\n", sizes, mix, elapsed);
+        printf("Zapytania: %ld (%.0f/s) | usadzone: %ld | odprawione: %ld\n",
+               requests, requests / elapsed, seated, rejected);
+        printf("Zamówienia: %.0f/s | wyjścia: %.0f/s\n", orders / elapsed, leaves / elapsed);
+        printf("Opóźnienie REQUEST_TABLE -> stolik [us]: p50 %.1f | p99 %.1f | p99.9 %.1f | max %.1f\n",
+               p50, p99, p999, pmax);
+        if (readers > 0) {
+            printf("Czytelnicy: %d | pełne skany stolików: %.0f/s\n", readers, scans / elapsed);
+        }
+    }
+
+    free(all);
+    free(workers);
+    free(readerThreads);
+    free(readerScans);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "arrivals.h"
+#include <string.h>
+#include <time.h>
+
+// Benchmark generatora przybyć: ile przybyć na sekundę daje każdy model
+// i czy średnia intensywność zgadza się z opisem modelu (kontrola poprawności).
+
+#define BENCH_ARRIVALS  5000000L
+
+typedef struct {
+    const char* spec;
+    double      expectedRate;   // oczekiwana średnia liczba grup/s (0 - bez sprawdzania)
+} BenchModel;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    long count = (argc > 1) ? atol(argv[1]) : BENCH_ARRIVALS;
+    const BenchModel models[] = {
+        { "uniform",                    1.0 },
+        { "poisson:1000",               1000.0 },
+        { "piecewise:0=200,60=2000,90=200", 0 },  // 60 s po 200, 30 s po 2000, dalej 200
+        { "bursty:100,5000,10,1",       (9 * 100 + 1 * 5000) / 10.0 },
+    };
+
+    printf("%-32s %12s %14s %14s %14s %10s\n",
+           "model", "przybycia", "[mln/s]", "średnio [1/s]", "oczekiwane", "wielkość");
+    for (size_t i = 0; i < sizeof(models) / sizeof(models[0]); i++) {
+        ArrivalModel m;
+        if (arrivalsInit(&m, models[i].spec, NULL, 0x9E3779B97F4A7C15ULL) == -1) {
+            return 1;
+        }
+        Arrival a = { 0, 0 };
+        long n = 0, people = 0;
+        double start = nowSeconds();
+        while (n < count && arrivalsNext(&m, &a)) {
+            people += a.size;
+            n++;
+        }
+        double elapsed = nowSeconds() - start;
+        double rate = (a.atUs > 0) ? n / (a.atUs / 1e6) : 0;
+        if (models[i].expectedRate > 0) {
+            printf("%-32s %12ld %14.1f %14.2f %14.2f %10.3f\n",
+                   models[i].spec, n, n / elapsed / 1e6, rate, models[i].expectedRate, (double)people / n);
+        } else {
+            printf("%-32s %12ld %14.1f %14.2f %14s %10.3f\n",
+                   models[i].spec, n, n / elapsed / 1e6, rate, "-", (double)people / n);
+        }
+        arrivalsDestroy(&m);
+    }
+    return 0;
+}
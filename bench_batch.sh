@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# Krzywe przepustowość / opóźnienie dla różnych rozmiarów partii kasjera (PIZZERIA_BATCH).
+# Wynik w CSV na stdout, np. ./bench_batch.sh 10 10 10 10 > batch.csv
+# Zmienne: TRANSPORTS, BATCHES, CLIENTS, RUN_SECONDS (czas jednego pomiaru, domyślnie 2 s).
+
+TABLES=${@:-10 10 10 10}
+TRANSPORTS=${TRANSPORTS:-msg shm}
+BATCHES=${BATCHES:-1 4 16 64 256}
+CLIENTS=${CLIENTS:-1 4 16 64}
+RUN_SECONDS=${RUN_SECONDS:-2}
+
+header=1
+for transport in $TRANSPORTS; do
+    for batch in $BATCHES; do
+        for clients in $CLIENTS; do
+            out=$(PIZZERIA_TRANSPORT=$transport PIZZERIA_BATCH=$batch \
+                  ./bench_app -d "$RUN_SECONDS" -c "$clients" -o csv $TABLES) || exit 1
+            if [ $header -eq 1 ]; then
+                echo "$out" | head -1
+                header=0
+            fi
+            echo "$out" | tail -1
+        done
+    done
+done
@@ -0,0 +1,106 @@
+#include "order.h"
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+// Benchmark zamówień grupy: ile grup na sekundę zbiera zamówienie dawny klient
+// (wątek na osobę, wspólny mutex i rand()) i order.c - z wątkiem na osobę,
+// bez wątków i na puli wątków. Wielkości grup 1..GROUP_LIMIT po kolei; rozkład
+// karty z PIZZERIA_MENU_WEIGHTS. Na końcu udział każdej pizzy wobec wag.
+
+#define BENCH_GROUPS 20000L
+
+static pthread_mutex_t legacyMutex = PTHREAD_MUTEX_INITIALIZER;
+
+typedef struct {
+    int* selection;
+    int  count;
+} LegacyOrder;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Dawny singlePersonOrder z client.c: blokada, szukanie wolnego miejsca, rand()
+static void* legacyPersonOrder(void* arg) {
+    LegacyOrder* go = (LegacyOrder*)arg;
+    pthread_mutex_lock(&legacyMutex);
+    int idx = 0;
+    while (idx < go->count && go->selection[idx] != -1) {
+        idx++;
+    }
+    go->selection[idx] = rand() % MENU_SIZE;
+    pthread_mutex_unlock(&legacyMutex);
+    return NULL;
+}
+
+static int legacyGroup(int* selection, int count) {
+    LegacyOrder go = { selection, count };
+    pthread_t threads[MAX_GROUP_SIZE];
+    for (int i = 0; i < count; i++) {
+        selection[i] = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (pthread_create(&threads[i], NULL, legacyPersonOrder, &go) != 0) {
+            return -1;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    long groups = (argc > 1) ? atol(argv[1]) : BENCH_GROUPS;
+    const char* names[] = { "dawniej: wątki + mutex + rand()", "wątek na osobę (spawn)",
+                            "bez wątków (inline)", "pula wątków (pool)" };
+    const MenuPreference* menu = menuPreferenceFromEnv();
+    OrderPool* pool = orderPoolCreate(MAX_GROUP_SIZE);
+    if (pool == NULL) {
+        perror("[Bench] Błąd tworzenia puli wątków");
+        return 1;
+    }
+    long chosen[MENU_SIZE] = { 0 };
+    long people = 0;
+
+    printf("%-34s %10s %14s %12s\n", "sposób", "grupy", "grupy/s", "us/grupę");
+    for (int mode = -1; mode <= ORDER_POOL; mode++) {
+        int selection[MAX_GROUP_SIZE];
+        double start = nowSeconds();
+        for (long g = 0; g < groups; g++) {
+            int size = 1 + (int)(g % GROUP_LIMIT);
+            int rc;
+            if (mode == -1) {
+                rc = legacyGroup(selection, size);
+            } else {
+                GroupOrder go;
+                prepareGroupOrder(&go, selection, size, menu, 0x2545F4914F6CDD1DULL + (uint64_t)g);
+                rc = orderGroup(&go, mode, pool);
+            }
+            if (rc == -1) {
+                perror("[Bench] Błąd wątków zamówienia");
+                return 1;
+            }
+            if (mode == ORDER_INLINE) {
+                for (int i = 0; i < size; i++) {
+                    chosen[selection[i]]++;
+                }
+                people += size;
+            }
+        }
+        double elapsed = nowSeconds() - start;
+        printf("%-34s %10ld %14.0f %12.2f\n", names[mode + 1], groups, groups / elapsed, elapsed * 1e6 / groups);
+    }
+    orderPoolDestroy(pool);
+
+    printf("\nUdział pozycji karty (inline, %ld osób):\n", people);
+    for (int i = 0; i < MENU_SIZE; i++) {
+        uint64_t lo = (i == 0) ? 0 : menu->bound[i - 1];
+        double expected = menu->uniform ? 1.0 / MENU_SIZE : (menu->bound[i] - lo) / 4294967296.0;
+        printf("  %-22s %7.3f (wagi: %.3f)\n", pizzaMenu[i].name, (double)chosen[i] / people, expected);
+    }
+    return 0;
+}
@@ -0,0 +1,347 @@
+#include "pizzeria.h"
+#include "seating.h"
+#include <string.h>
+#include <time.h>
+
+// Benchmark skalowania obsługi stolików: pełny skan (dawne findFreeTable
+// + trySeatQueue po wszystkich stolikach) kontra katalog wolnych miejsc.
+// Oba warianty dostają ten sam strumień zdarzeń i muszą podjąć te same decyzje.
+// Druga część mierzy samo wyszukiwanie stolika: skan tablicy DiningTable, kubełki
+// katalogu i skan kolumn (wektorowy i skalarny) na sali zajętej w ok. 90%
+// i na pełnej sali z wolnymi stolikami tylko na końcu (najgorszy przypadek skanu).
+
+#define BENCH_MAX_OPS    200000
+#define REQUEST_PERCENT      55  // reszta to wyjścia klientów
+
+typedef struct {
+    int   idx;
+    pid_t pid;
+    int   size;
+} SeatedGroup;
+
+typedef struct {
+    DiningTable*  tables;
+    int           count;
+    int           useDirectory;
+    SeatDirectory dir;
+    ClientsQueue  queue;
+    SeatedGroup*  seated;
+    int           seatedCount;
+    pid_t         nextPid;
+    unsigned long checksum;
+    unsigned long rejected;
+} BenchFloor;
+
+static unsigned long long rngState;
+
+static unsigned int nextRandom(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (unsigned int)(rngState >> 11);
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// --------------------- Wariant z pełnym skanem ---------------------
+
+static int linearFind(const BenchFloor* f, int groupSize) {
+    for (int i = 0; i < f->count; i++) {
+        const DiningTable* t = &f->tables[i];
+        if ((t->group_size == 0 || t->group_size == groupSize) && (t->capacity - t->total_seated - groupSize >= 0)) {
+            return i;
+        }
+    }
+    return NO_TABLE_FOUND;
+}
+
+static int scanOrFind(BenchFloor* f, int search, int groupSize) {
+    f->dir.search = search;
+    return findTableForGroup(&f->dir, groupSize);
+}
+
+static void linearOccupy(DiningTable* t, const GroupOfClients* g) {
+    if (t->total_seated == 0) {
+        t->group_size = g->size;
+    }
+    t->total_seated += g->size;
+    int slot = 0;
+    while (slot < TABLE_SLOTS && t->occupant_pids[slot] != 0) {
+        slot++;
+    }
+    t->occupant_pids[slot] = g->groupPID;
+}
+
+static void linearVacate(DiningTable* t, pid_t pid, int size) {
+    for (int j = 0; j < TABLE_SLOTS; j++) {
+        if (t->occupant_pids[j] == pid) {
+            t->occupant_pids[j] = 0;
+            break;
+        }
+    }
+    t->total_seated -= size;
+    if (t->total_seated == 0) {
+        t->group_size = 0;
+    }
+}
+
+// --------------------- Wspólna logika kasjera ---------------------
+
+static void seat(BenchFloor* f, int idx, const GroupOfClients* g) {
+    if (f->useDirectory) {
+        occupyTable(f->tables, &f->dir, idx, g);
+    } else {
+        linearOccupy(&f->tables[idx], g);
+    }
+    f->seated[f->seatedCount].idx  = idx;
+    f->seated[f->seatedCount].pid  = g->groupPID;
+    f->seated[f->seatedCount].size = g->size;
+    f->seatedCount++;
+    f->checksum = f->checksum * 1000003UL + (unsigned long)idx * 31UL + (unsigned long)g->groupPID;
+}
+
+static void seatFromQueue(BenchFloor* f, int idx) {
+    while (queueSize(&f->queue) > 0) {
+        DiningTable* t = &f->tables[idx];
+        int freeSpace = t->capacity - t->total_seated;
+        if (freeSpace <= 0 || (freeSpace < t->group_size && t->group_size != 0)) {
+            return;
+        }
+        GroupOfClients g;
+        if (!dequeueSuitable(&f->queue, t->group_size, freeSpace, &g)) {
+            return;
+        }
+        seat(f, idx, &g);
+    }
+}
+
+static void linearSeatQueue(BenchFloor* f) {
+    int updated = 1;
+    while (updated) {
+        updated = 0;
+        for (int i = 0; i < f->count; i++) {
+            int freeSpace = f->tables[i].capacity - f->tables[i].total_seated;
+            if (freeSpace <= 0) {
+                continue;
+            }
+            int grpSize = f->tables[i].group_size;
+            if (freeSpace < grpSize && grpSize != 0) {
+                continue;
+            }
+            GroupOfClients g;
+            if (dequeueSuitable(&f->queue, grpSize, freeSpace, &g)) {
+                seat(f, i, &g);
+                updated = 1;
+            }
+        }
+    }
+}
+
+static void request(BenchFloor* f, int size) {
+    GroupOfClients g;
+    g.size     = size;
+    g.groupPID = f->nextPid++;
+
+    int idx;
+    if (f->useDirectory) {
+        idx = findTableForGroup(&f->dir, size);
+    } else {
+        if (queueSize(&f->queue) > 0) {
+            linearSeatQueue(f);
+        }
+        idx = linearFind(f, size);
+    }
+    if (idx != NO_TABLE_FOUND) {
+        seat(f, idx, &g);
+    } else if (queueSize(&f->queue) >= QUEUE_LIMIT) {
+        f->rejected++;
+    } else {
+        enqueueGroup(&f->queue, &g);
+    }
+}
+
+static void leave(BenchFloor* f, int which) {
+    SeatedGroup sg = f->seated[which];
+    f->seated[which] = f->seated[--f->seatedCount];
+    if (f->useDirectory) {
+        vacateTable(f->tables, &f->dir, sg.idx, sg.pid, sg.size);
+        seatFromQueue(f, sg.idx);
+    } else {
+        linearVacate(&f->tables[sg.idx], sg.pid, sg.size);
+        if (queueSize(&f->queue) > 0) {
+            linearSeatQueue(f);
+        }
+    }
+}
+
+// --------------------- Przebieg benchmarku ---------------------
+
+/**
+ * Przygotowuje salę: po równo stolików 1-4 osobowych, ok. 90% z nich zajętych.
+ */
+
+static void setupFloor(BenchFloor* f, int count, int useDirectory) {
+    memset(f, 0, sizeof(*f));
+    f->count        = count;
+    f->useDirectory = useDirectory;
+    f->tables       = (DiningTable*)calloc(count, sizeof(DiningTable));
+    f->seated       = (SeatedGroup*)malloc(sizeof(SeatedGroup) * (count * 4 + BENCH_MAX_OPS));
+    f->nextPid      = 1000;
+    initQueue(&f->queue, QUEUE_LIMIT);
+
+    rngState = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < count; i++) {
+        f->tables[i].capacity = 1 + (i * 4) / count;
+    }
+    for (int i = 0; i < count; i++) {
+        int size = 1 + nextRandom() % MAX_GROUP_SIZE;
+        if (nextRandom() % 10 != 0 && size <= f->tables[i].capacity) {
+            GroupOfClients g = { size, f->nextPid++, 0 };
+            linearOccupy(&f->tables[i], &g);
+            f->seated[f->seatedCount].idx  = i;
+            f->seated[f->seatedCount].pid  = g.groupPID;
+            f->seated[f->seatedCount].size = size;
+            f->seatedCount++;
+        }
+    }
+    if (useDirectory) {
+        initSeatDirectory(&f->dir, f->tables, count);
+    }
+}
+
+/**
+ * Pełna sala: wszystkie stoliki zajęte przez jednoosobowe grupy, poza ostatnim
+ * promilem (co najmniej jednym stolikiem).
+ */
+
+static void fillFloor(BenchFloor* f) {
+    int emptyFrom = f->count - (f->count / 1000 > 0 ? f->count / 1000 : 1);
+    for (int i = 0; i < f->count; i++) {
+        DiningTable* t = &f->tables[i];
+        memset(t->occupant_pids, 0, sizeof(t->occupant_pids));
+        t->group_size   = (i < emptyFrom) ? 1 : 0;
+        t->total_seated = (i < emptyFrom) ? t->capacity : 0;
+        for (int s = 0; s < t->total_seated; s++) {
+            t->occupant_pids[s] = f->nextPid++;
+        }
+        updateSeatDirectory(&f->dir, f->tables, i);
+    }
+}
+
+static void destroyFloor(BenchFloor* f) {
+    if (f->useDirectory) {
+        freeSeatDirectory(&f->dir);
+    }
+    destroyQueue(&f->queue);
+    free(f->tables);
+    free(f->seated);
+}
+
+/**
+ * Wykonuje operacje aż do maxOps lub przekroczenia budżetu czasu.
+ * @return Liczba wykonanych operacji; *elapsed - czas w sekundach.
+ */
+
+static int runOps(BenchFloor* f, int maxOps, double budget, double* elapsed) {
+    double start = nowSeconds();
+    int ops = 0;
+    while (ops < maxOps) {
+        if (f->seatedCount == 0 || nextRandom() % 100 < REQUEST_PERCENT) {
+            request(f, 1 + nextRandom() % MAX_GROUP_SIZE);
+        } else {
+            leave(f, nextRandom() % f->seatedCount);
+        }
+        ops++;
+        if ((ops & 63) == 0 && nowSeconds() - start > budget) {
+            break;
+        }
+    }
+    *elapsed = nowSeconds() - start;
+    return ops;
+}
+
+#define LOOKUP_SIZES 4096
+
+/**
+ * Mierzy samo wyszukiwanie (sala się nie zmienia) dla wariantu search
+ * (-1 - skan tablicy DiningTable). *checksum - suma znalezionych indeksów.
+ */
+
+static double lookupNs(BenchFloor* f, int search, const int* sizes, double budget, unsigned long* checksum) {
+    unsigned long sum = 0;
+    long lookups = 0;
+    double start = nowSeconds();
+    double elapsed;
+    do {
+        for (int i = 0; i < LOOKUP_SIZES; i++) {
+            int idx = (search == -1) ? linearFind(f, sizes[i]) : scanOrFind(f, search, sizes[i]);
+            sum += (unsigned long)(idx + 1);
+        }
+        lookups += LOOKUP_SIZES;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < budget);
+    *checksum = sum / (lookups / LOOKUP_SIZES);
+    return elapsed * 1e9 / lookups;
+}
+
+static void lookupTable(int maxTables, double budget) {
+    static const char* floors[] = { "90%", "pełna" };
+    int sizes[LOOKUP_SIZES];
+    for (int i = 0; i < LOOKUP_SIZES; i++) {
+        sizes[i] = 1 + nextRandom() % MAX_GROUP_SIZE;
+    }
+    printf("\nSamo wyszukiwanie stolika [ns/zapytanie] (kolumny: %s)\n", seatSearchKernel(SEAT_SEARCH_SIMD));
+    printf("%8s %6s %10s %10s %12s %12s %s\n",
+           "stoliki", "sala", "skan AoS", "kubełki", "kol. SIMD", "kol. skalar", "wyniki");
+    for (int count = 100; count <= maxTables; count *= 10) {
+        for (int full = 0; full <= 1; full++) {
+            BenchFloor f;
+            setupFloor(&f, count, 1);
+            if (full) {
+                fillFloor(&f);
+            }
+            unsigned long sums[4];
+            double ns[4];
+            ns[0] = lookupNs(&f, -1, sizes, budget / 8, &sums[0]);
+            ns[1] = lookupNs(&f, SEAT_SEARCH_INDEX, sizes, budget / 8, &sums[1]);
+            ns[2] = lookupNs(&f, SEAT_SEARCH_SIMD, sizes, budget / 8, &sums[2]);
+            ns[3] = lookupNs(&f, SEAT_SEARCH_SCALAR, sizes, budget / 8, &sums[3]);
+            printf("%8d %6s %10.1f %10.1f %12.1f %12.1f %s\n", count, floors[full], ns[0], ns[1], ns[2], ns[3],
+                   (sums[0] == sums[1] && sums[1] == sums[2] && sums[2] == sums[3]) ? "zgodne" : "RÓŻNE");
+            destroyFloor(&f);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int maxTables = (argc > 1) ? atoi(argv[1]) : 100000;
+    double budget = (argc > 2) ? atof(argv[2]) : 1.0;
+
+    printf("%8s %8s %14s %15s %11s %9s %s\n",
+           "stoliki", "operacje", "skan [ns/op]", "katalog [ns/op]", "przyspiesz.", "odmowy", "decyzje");
+    for (int count = 100; count <= maxTables; count *= 10) {
+        BenchFloor linear, indexed;
+        double tLinear, tIndexed;
+
+        setupFloor(&linear, count, 0);
+        int ops = runOps(&linear, BENCH_MAX_OPS, budget, &tLinear);
+
+        setupFloor(&indexed, count, 1);
+        runOps(&indexed, ops, 1e9, &tIndexed);
+
+        double nsLinear  = tLinear * 1e9 / ops;
+        double nsIndexed = tIndexed * 1e9 / ops;
+        printf("%8d %8d %14.1f %15.1f %10.1fx %9lu %s\n",
+               count, ops, nsLinear, nsIndexed, nsLinear / nsIndexed, indexed.rejected,
+               (linear.checksum == indexed.checksum && linear.rejected == indexed.rejected) ? "zgodne" : "RÓŻNE");
+
+        destroyFloor(&linear);
+        destroyFloor(&indexed);
+    }
+    lookupTable(maxTables, budget);
+    return 0;
+}
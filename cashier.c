@@ -1,270 +1,381 @@
 #include "pizzeria.h"
+#include "restaurant.h"
+#include "transport.h"
+#include "cashier_shard.h"
+#include "report.h"
+#include "metrics.h"
+#include "kitchen.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <poll.h>
 
 // Zmienne globalne sterowane sygnałami
 static volatile sig_atomic_t fireSignal = 0;
 static volatile sig_atomic_t closeIsNear = 0;
 static volatile unsigned long forcedFinish = ULONG_MAX;
 
+// Kasjer prowadzący przekazuje SIGUSR1 / SIGUSR2 pozostałym kasjerom
+static pid_t peerPids[MAX_SHARDS];
+static int   peerCount = 0;
+
+// Kuchnia (PIZZERIA_KITCHEN); NULL - grupy jedzą zaraz po zamówieniu
+static Kitchen* kitchen = NULL;
+
+#define MAX_BATCH       256                  // górna granica PIZZERIA_BATCH
+#define RECLAIM_INTERVAL_S 1                 // co tyle sekund sprawdzamy, czy procesy grup żyją
+#define MAX_REPLIES     (MAX_BATCH * (TABLE_SLOTS + 1))  // zapytanie -> 1 odpowiedź, wyjście -> do TABLE_SLOTS usadzonych z kolejki
+
+// Odpowiedzi odkładane do końca partii (tryb PIZZERIA_BATCH > 1)
+typedef struct {
+    CashierShard*  shard;
+    int            deferred;
+    int            count;
+    GroupOfClients groups[MAX_REPLIES];
+    int            tables[MAX_REPLIES];
+    int            waits[MAX_REPLIES];
+    int            origins[MAX_REPLIES];
+} ReplyBatch;
+
+// Adaptacyjny rozmiar partii: rośnie x2, gdy partia się zapełnia, maleje /2, gdy jest prawie pusta
+typedef struct {
+    int  limit;
+    int  max;
+    long batches;
+    long messages;
+} BatchControl;
+
 /**
  * Handler sygnałów:
  * - SIGUSR1 -> ustawia fireSignal = 1 (pożar, kończymy pętlę).
- * - SIGUSR2 -> ustawia closeIsNear = 1 i oblicza forcedFinish
- *   (za ile sekund faktycznie się zamkniemy).
+ * - SIGUSR2 -> ustawia closeIsNear = 1, oblicza forcedFinish
+ *   (za ile sekund faktycznie się zamkniemy) i nastawia alarm na ten moment.
+ * - SIGALRM -> nic nie robi, służy tylko do przerwania blokującego odbioru.
+ * Handler jest instalowany bez SA_RESTART, więc każdy z tych sygnałów
+ * wybudza kasjera czekającego w msgrcv() lub na futeksie transportu shm (EINTR).
+ * Kasjer prowadzący (PIZZERIA_SHARDS > 1) przekazuje SIGUSR1 i SIGUSR2 pozostałym.
  *
- * @param sig Numer sygnału (SIGUSR1 lub SIGUSR2).
+ * @param sig Numer sygnału (SIGUSR1, SIGUSR2 lub SIGALRM).
  */
 
 // -------------------------------------
 static void handleSignals(int sig) {
+    if (sig == SIGUSR1 || sig == SIGUSR2) {
+        for (int i = 0; i < peerCount; i++) {
+            kill(peerPids[i], sig);
+        }
+    }
     if (sig == SIGUSR1) {
         fireSignal = 1;
-        printf(CLR_CASHIER "[Kasjer] POŻAR! Sprawdzam, czy klienci opuścili lokal...\n" CLR_RESET);
     } else if (sig == SIGUSR2) {
         closeIsNear   = 1;
         forcedFinish  = (unsigned long)time(NULL) + TIME_BEFORE_CLOSE;
+        alarm(TIME_BEFORE_CLOSE);
     }
 }
 
-/**
- * Inicjuje fragment tablicy stolików w zakresie [start..end-1].
- * Ustawia capacity = cap, group_size = 0, total_seated = 0,
- * occupant_pids[j] = 0.
- *
- * @param t Tablica DiningTable.
- * @param start Indeks początkowy.
- * @param end Indeks końcowy (niewłączny).
- * @param cap Pojemność (1,2,3,4).
- */
+static void sendReply(Transport* link, const GroupOfClients* grp, int tableIndex, int waitMs) {
+    if (transportReply(link, grp, tableIndex, waitMs) == -1 && tableIndex >= 0 && errno != ESRCH && errno != ENOBUFS) {
+        perror(CLR_CASHIER "[Kasjer] Błąd przy wysyłaniu nr stolika" CLR_RESET);
+        exit(1);
+    }
+}
 
-// -------------------------------------
-static void setupTables(DiningTable* t, int start, int end, int cap) {
-    for (int i = start; i < end; i++) {
-        for (int j = 0; j < 4; j++) {
-            t[i].occupant_pids[j] = 0;
-        }
-        t[i].capacity = cap;
-        t[i].group_size = 0;
-        t[i].total_seated = 0;
+static void replyThrough(ReplyBatch* rb, int origin, const GroupOfClients* grp, int tableIndex, int waitMs) {
+    Transport* link = shardLink(rb->shard, origin);
+    if (link == NULL) {
+        return; // kasjera tej grupy już nie ma, ona sama dostała EIDRM
+    }
+    sendReply(link, grp, tableIndex, waitMs);
+}
+
+static void flushReplies(ReplyBatch* rb) {
+    for (int i = 0; i < rb->count; i++) {
+        replyThrough(rb, rb->origins[i], &rb->groups[i], rb->tables[i], rb->waits[i]);
     }
+    rb->count = 0;
 }
 
 /**
- * Szuka wolnego stolika (lub pasującego do danej wielkości grupy)
- * w tablicy t. Jeśli closeIsNear == 1, zwraca NEAR_CLOSING.
- * W przeciwnym razie przechodzi przez wszystkie stoliki i sprawdza:
- *   - czy stolik jest pusty lub ma group_size równy rozmiarowi grupy,
- *   - czy jest w nim dość miejsca (capacity - total_seated >= groupSize).
- * Gdy znajdzie, zwraca indeks stolika; w przeciwnym razie NO_TABLE_FOUND.
+ * Funkcja zwrotna logiki sali: wysyła odpowiedź do grupy przez transport
+ * (kolejka komunikatów z mtype = PID grupy albo slot odpowiedzi w shm).
+ * W trakcie partii odpowiedź jest tylko zapamiętywana i wychodzi w flushReplies().
+ * Przy kilku kasjerach numer stolika staje się globalny, a odpowiedź idzie przez
+ * transport kasjera, u którego grupa czeka (shardReplyOrigin).
+ * Błąd przy wysyłaniu numeru stolika kończy kasjera - chyba że grupy już nie ma (ESRCH)
+ * albo nie odbiera odpowiedzi (ENOBUFS - jej miejsce odzyska potem reclaimIfDue).
  *
- * @param t Tablica DiningTable.
- * @param groupSize Wielkość grupy.
- * @param count Liczba stolików w tablicy.
- * @return Indeks stolika >= 0, NEAR_CLOSING lub NO_TABLE_FOUND.
+ * @param ctx Wskaźnik na ReplyBatch kasjera.
+ * @param grp Grupa, do której odpowiadamy.
+ * @param tableIndex Numer stolika, NO_TABLE_FOUND, NEAR_CLOSING, GROUP_QUEUED lub GROUP_CANCELLED.
+ * @param waitMs Szacowane czekanie na stolik [ms] (-1 - brak szacunku).
  */
 
-// -------------------------------------
-static int findFreeTable(DiningTable* arr, int groupSize, int count) {
-    if (closeIsNear) {
-        return NEAR_CLOSING;
+static void replyViaTransport(void* ctx, const GroupOfClients* grp, int tableIndex, int waitMs) {
+    ReplyBatch* rb = (ReplyBatch*)ctx;
+    int origin = shardReplyOrigin(rb->shard, grp, &tableIndex);
+    if (!rb->deferred) {
+        replyThrough(rb, origin, grp, tableIndex, waitMs);
+        return;
     }
-    for (int i = 0; i < count; i++) {
-        if ((arr[i].group_size == 0 || arr[i].group_size == groupSize) && (arr[i].capacity - arr[i].total_seated - groupSize >= 0)) {
-            return i;
-        }
+    if (rb->count == MAX_REPLIES) {
+        flushReplies(rb);
     }
-    return NO_TABLE_FOUND;
+    rb->groups[rb->count]  = *grp;
+    rb->tables[rb->count]  = tableIndex;
+    rb->waits[rb->count]   = waitMs;
+    rb->origins[rb->count] = origin;
+    rb->count++;
 }
 
 /**
- * Usadza daną grupę (groupPID, size) przy stoliku o indeksie tableIdx:
- * 1) Ustawia, jeśli total_seated == 0, group_size = group->size.
- * 2) Zwiększa total_seated o group->size.
- * 3) Szuka pustego slotu occupant_pids[] i wpisuje tam PID grupy.
- * 4) Wysyła do klienta komunikat z jego PIDem i tableIndex.
+ * Funkcja zwrotna kuchni (jej wątek): komplet pizz grupy gotowy - PIZZA_READY
+ * przez transport, którym przyszło zamówienie (ten sam, na którym grupa czeka).
  *
- * @param t Tablica DiningTable.
- * @param tableIdx Indeks stolika w tablicy.
- * @param grp Informacje o grupie (pid, size).
- * @param msg_id Id kolejki, by wysłać odpowiedź do klienta.
+ * @param ctx Transport tego kasjera.
+ * @param grp Grupa, której zamówienie jest gotowe.
+ * @param tableIndex Stolik grupy (do logu).
  */
 
-static void seatGroupAtTable(DiningTable* arr, int tableIdx, const GroupOfClients* grp, int queueId) {
-    if (arr[tableIdx].total_seated == 0) {
-        arr[tableIdx].group_size = grp->size;
-    }
-    arr[tableIdx].total_seated += grp->size;
-
-    int slot = 0;
-    while (slot < 4 && arr[tableIdx].occupant_pids[slot] != 0) {
-        slot++;
-    }
-    arr[tableIdx].occupant_pids[slot] = grp->groupPID;
-
-    CommunicationMessage msg;
-    msg.mtype       = grp->groupPID;
-    msg.group       = *grp;
-    msg.tableIndex  = tableIdx;
+static void pizzaReady(void* ctx, const GroupOfClients* grp, int tableIndex) {
+    (void)tableIndex;  // tylko do logu, którego może nie być (PIZZERIA_HEADLESS)
+    LOG_HOT(LVL_INFO, CLR_CASHIER "[Kuchnia] Zamówienie grupy PID(%d) gotowe, podajemy do stolika nr %d.\n" CLR_RESET,
+            (int)grp->groupPID, tableIndex);
+    sendReply((Transport*)ctx, grp, PIZZA_READY, -1);
+}
 
-    printf(CLR_CASHIER "[Kasjer] Przydzielam stolik %d grupie PID(%d), liczba osób: %d\n" CLR_RESET,
-           tableIdx, (int)grp->groupPID, grp->size);
+/**
+ * Czy proces grupy żyje. pidfd jest gotowy do odczytu, gdy proces się zakończył -
+ * także jako zombie, którego manager jeszcze nie pogrzebał (kill(pid, 0) by go nie odróżnił).
+ * Bez pidfd_open (starsze jądro) zostaje kill(pid, 0).
+ */
 
-    if (msgsnd(queueId, &msg, sizeof(msg) - sizeof(long), 0) == -1) {
-        perror(CLR_CASHIER "[Kasjer] Błąd msgsnd() przy wysyłaniu nr stolika" CLR_RESET);
-        exit(1);
+static int groupAlive(pid_t pid) {
+#ifdef SYS_pidfd_open
+    int fd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (fd >= 0) {
+        struct pollfd p = { fd, POLLIN, 0 };
+        int exited = (poll(&p, 1, 0) == 1);
+        close(fd);
+        return !exited;
     }
+    if (errno == ESRCH) {
+        return 0;
+    }
+#endif
+    return !(kill(pid, 0) == -1 && errno == ESRCH);
 }
 
 /**
- * Usuwa grupę (gPID, size) ze stolika o indeksie idx:
- * 1) W occupant_pids[] szuka PID == gPID i ustawia 0.
- * 2) Zmniejsza total_seated o size.
- * 3) Jeśli total_seated == 0, ustawia group_size = 0.
- *
- * @param t Tablica stolików.
- * @param idx Numer stolika.
- * @param gPID PID grupy.
- * @param size Rozmiar grupy.
+ * Co RECLAIM_INTERVAL_S zwalnia miejsca grup, których procesy już nie żyją
+ * (w kolejce i przy stolikach), i porządkuje listę cudzych grup kasjera-sharda.
  */
 
-static void removeGroupFromTable(DiningTable* arr, int idx, pid_t gPID, int size) {
-    for (int j = 0; j < 4; j++) {
-        if (arr[idx].occupant_pids[j] == gPID) {
-            arr[idx].occupant_pids[j] = 0;
-            break;
-        }
+static void reclaimIfDue(Restaurant* hall, CashierShard* shard, long long* nextNs) {
+    long long now = monotonicNs();
+    if (now < *nextNs) {
+        return;
     }
-    arr[idx].total_seated -= size;
-    if (arr[idx].total_seated == 0) {
-        arr[idx].group_size = 0;
+    *nextNs = now + RECLAIM_INTERVAL_S * 1000000000LL;
+    int reclaimed = reclaimDeadGroups(hall, groupAlive);
+    if (reclaimed > 0) {
+        shardPrune(shard, hall);
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Zwolniono miejsca %d grup, których procesy już nie żyją.\n" CLR_RESET,
+            reclaimed);
     }
 }
 
 /**
- * Próbujemy usadzić grupy z kolejki "q" na dostępnych stolikach "t".
- * Iterujemy po wszystkich stolikach. Dla każdego:
- *   - obliczamy wolne miejsce (freeSpace),
- *   - jeśli wolne miejsce > 0,
- *     - sprawdzamy, czy jest już group_size (grpSize). Jeśli freeSpace < grpSize i grpSize != 0, pomijamy.
- *     - wywołujemy dequeueSuitable(q, grpSize, freeSpace).
- *       Jeśli znajdzie grupę (newG != NULL), przydzielamy ją seatGroupAtTable(...) i zaznaczamy updated=1.
- *   - Dopóki updated=1, powtarzamy całą procedurę (while).
+ * Obsługuje jeden komunikat od klienta. Stoliki w shm zmieniamy pod blokadą
+ * pojedynczego stolika (occupyTable/vacateTable), więc semafor nie jest potrzebny.
+ * Przy kilku kasjerach zapytanie lub wyjście może pójść do innego kasjera.
  *
- * @param t Tablica stolików.
- * @param q Kolejka oczekujących.
- * @param tcount Liczba stolików.
- * @param msg_id Id kolejki (do seatGroupAtTable).
+ * @param hall Stan sali.
+ * @param shard Stan kasjera-sharda.
+ * @param msg REQUEST_TABLE, CANCEL_REQUEST, SEND_ORDER, LEAVE_TABLE lub SEAT_AVAILABLE.
  */
 
-static void trySeatQueue(DiningTable* t, ClientsQueue* q, int tcount, int qid) {  //Staramy się rozładować kolejkę w razie możliwości
-    int updated = 1;
-    while (updated) {
-        updated = 0;
-        for (int i = 0; i < tcount; i++) {
-            int freeSpace = t[i].capacity - t[i].total_seated;
-            if (freeSpace <= 0) {  //stolik jest pełny i nie ma możliwości nikogo wpuścić
-                continue;
-            }
-            int grpSize = t[i].group_size;
+static void dispatchMessage(Restaurant* hall, CashierShard* shard, CommunicationMessage* msg) {
+    switch (msg->mtype) {
+    // --- Odbiór rezerwacji stolika ---
+    case REQUEST_TABLE:
+        shardTableRequest(shard, hall, msg);
+        break;
+
+    // --- Rezygnacja z czekania w kolejce ---
+    case CANCEL_REQUEST:
+        shardCancel(shard, hall, msg);
+        break;
+
+    // --- Odbiór zamówień ---
+    case SEND_ORDER:
+        handleOrder(hall, msg);
+        // Grupa dowiaduje się od nas, czy czekać na PIZZA_READY - potwierdzenie
+        // wychodzi przed przekazaniem do kuchni, więc zawsze je wyprzedza
+        sendReply(shard->own, &msg->group, (kitchen != NULL) ? ORDER_COOKING : ORDER_SERVED, -1);
+        if (kitchen != NULL) {
+            kitchenOrder(kitchen, msg);
+        }
+        if (LOG_HOT_ENABLED(LVL_DEBUG)) {
+            showCurrentTables(hall);
+        }
+        break;
 
-            if (freeSpace < grpSize && grpSize != 0) {  //stolik jest już zajęty przez grupy o konkretnym rozmiarze
-                continue;
-            }
-            GroupOfClients* newG = dequeueSuitable(q, grpSize, freeSpace);  //wyszukuje pierwszą pasującą grupę
-            if (newG) { //newG != 0 -> to znaczy, że w kolejce była jakaś grupa, którą możemy posadzić przy itym stoliku
-                seatGroupAtTable(t, i, newG, qid);
-                free(newG);
-                updated = 1;
-            }
+    // --- Odbiór wyjścia klientów ---
+    case LEAVE_TABLE:
+        if (shardLocalLeave(shard, msg)) {
+            handleLeave(hall, msg->tableIndex, &msg->group);
         }
+        break;
+
+    // --- Inny kasjer ma wolne miejsce: kolejkę sprawdza shardRebalance po komunikacie ---
+    case SEAT_AVAILABLE:
+        break;
     }
 }
 
 /**
- * Informuje wszystkie grupy w kolejce, że pizzeria
- * "zaraz się zamyka" (NEAR_CLOSING). Wysyła do każdej
- * w kolejce komunikat z tableIndex = NEAR_CLOSING.
- * Następnie ustawia current_size = 0, aby nikt nie czekał.
+ * Tryb partii: zaczynając od już odebranego komunikatu, zabiera bez czekania
+ * do ctl->limit kolejnych, po czym:
+ *   1) zwalnia stoliki wszystkich LEAVE_TABLE i jednym przejściem sadza kolejkę,
+ *   2) obsługuje zamówienia i zapytania w kolejności nadejścia,
+ *   3) wysyła wszystkie odpowiedzi razem.
  *
- * @param q Kolejka oczekujących.
- * @param msg_id Id kolejki.
+ * @param hall Stan sali.
+ * @param rb Bufor odpowiedzi (funkcja zwrotna sali).
+ * @param first Pierwszy komunikat partii (z transportReceive).
+ * @param ctl Rozmiar partii i statystyki.
  */
 
-static void sendClosingSoon(ClientsQueue* q, int queueId) {
-    QueueNode* iter = q->head;
-    while (iter) {
-        GroupOfClients* g = &iter->data;
-        CommunicationMessage msg;
-        msg.mtype = g->groupPID;
-        msg.group = *g;
-        msg.tableIndex = NEAR_CLOSING;
-
-        printf(CLR_CASHIER "[Kasjer] Informuję grupę PID(%d), że zaraz zamykamy.\n" CLR_RESET,
-               (int)g->groupPID);
+static void processBatch(Restaurant* hall, ReplyBatch* rb, CommunicationMessage* first, BatchControl* ctl) {
+    static CommunicationMessage leaves[MAX_BATCH];
+    static CommunicationMessage others[MAX_BATCH];
+    int nLeaves = 0, nOthers = 0, n = 0;
+
+    Transport* link = rb->shard->own;
+    CommunicationMessage* msg = first;
+    while (msg != NULL) {
+        if (msg->mtype != LEAVE_TABLE) {
+            others[nOthers++] = *msg;
+        } else if (shardLocalLeave(rb->shard, msg)) {
+            leaves[nLeaves++] = *msg;
+        }
+        transportRelease(link);
+        if (++n >= ctl->limit) {
+            break;
+        }
+        msg = transportPoll(link);
+    }
 
-        msgsnd(queueId, &msg, sizeof(msg) - sizeof(long), 0);
-        iter = iter->next;
+    rb->deferred = 1;
+    handleLeaveBatch(hall, leaves, nLeaves);
+    for (int i = 0; i < nOthers; i++) {
+        dispatchMessage(hall, rb->shard, &others[i]);
+    }
+    rb->deferred = 0;
+    flushReplies(rb);
+
+    ctl->batches++;
+    ctl->messages += n;
+    if (n >= ctl->limit && ctl->limit < ctl->max) {
+        ctl->limit = (ctl->limit * 2 < ctl->max) ? ctl->limit * 2 : ctl->max;
+    } else if (n <= ctl->limit / 4 && ctl->limit > 1) {
+        ctl->limit /= 2;
     }
-    q->currentSize = 0;
 }
 
 /**
- * Wyświetla status wszystkich stolików (capacity, total_seated,
- * group_size, occupant_pids).
- *
- * @param t Tablica DiningTable.
- * @param count Liczba stolików.
+ * Kasjer prowadzący: czeka, aż pozostali kasjerowie wpiszą statystyki
+ * (albo zginą), i zapisuje raporty z sumami i analityką wszystkich.
  */
 
-static void showCurrentTables(DiningTable* arr, int count) {
-    printf(CLR_CASHIER "\n--- Stoliki w lokalu ---\n" CLR_RESET);
-    for (int i = 0; i < count; i++) {
-        printf(CLR_CASHIER "[Stol %2d] Kap: %d | Zaj: %d | GrupaSz: %d | PIDy: (" CLR_RESET, i, arr[i].capacity, arr[i].total_seated, arr[i].group_size);
-        for (int j = 0; j < 4; j++) {
-            if (arr[i].occupant_pids[j] != 0) {
-                printf(CLR_CASHIER " %d " CLR_RESET, (int)arr[i].occupant_pids[j]);
+static void writeMergedReport(ShardDirectory* dir) {
+    static DayReport day;
+    memset(&day, 0, sizeof(day));
+    int merged = 0;
+    for (int s = 0; s < dir->shards; s++) {
+        ShardInfo* info = &dir->shard[s];
+        while (!atomic_load_explicit(&info->done, memory_order_acquire)) {
+            pid_t pid = atomic_load(&info->pid);
+            if (pid > 0 && kill(pid, 0) == -1 && errno == ESRCH) {
+                break;
             }
+            usleep(10000);
+        }
+        for (int i = 0; i < MENU_SIZE; i++) {
+            day.soldItems[i] += info->soldItems[i];
+        }
+        day.revenue += info->totalRevenue;
+        day.clients += info->totalClients;
+        if (!atomic_load_explicit(&info->done, memory_order_acquire)) {
+            continue;   // kasjer zginął przed końcem dnia - bez jego analityki
+        }
+        if (merged++ == 0) {
+            day.stats = info->stats;
+        } else {
+            summaryMerge(&day.stats, &info->stats);
         }
-        printf(CLR_CASHIER ")\n" CLR_RESET);
     }
-    printf(CLR_CASHIER "************************\n\n" CLR_RESET);
+    writeDailyReports(&day, dir);
 }
 
 /**
  * Główny proces kasjera:
- * 1) Pobiera argumenty (x1, x2, x3, x4) = liczby stolików 1,2,3,4-osobowych.
- * 2) Tworzy zasoby IPC: semafor, shm (tablica DiningTable) i msgQueue.
- * 3) Inicjuje stoliki (setupTables(...) w czterech kawałkach).
- * 4) W pętli odbiera:
- *    - REQUEST_TABLE: sprawdza kolejkę, findFreeTable; jeśli brak miejsca -> do kolejki,
- *      jeśli zaraz zamykamy -> NEAR_CLOSING, itp.
- *    - SEND_ORDER: zlicza sprzedane pizze i przychód.
- *    - LEAVE_TABLE: zwalnia stolik, znów próbuje wpuścić kogoś z kolejki.
+ * 1) Pobiera argumenty (x1 ... xMAX_TABLE_CAPACITY) = liczby stolików 1..MAX_TABLE_CAPACITY-osobowych
+ *    i opcjonalnie <nr_kasjera> <liczba_kasjerów> (tryb PIZZERIA_SHARDS).
+ * 2) Tworzy zasoby IPC: semafor, shm (tablica DiningTable) i msgQueue, po czym melduje
+ *    gotowość managerowi przez potok z PIZZERIA_READY_FD (readyNotify).
+ *    Przy kilku kasjerach prowadzący (nr 0) tworzy też katalog kasjerów (meldunek READY_DIRECTORY),
+ *    a semafor i READY_SERVING dopiero wtedy, gdy wszyscy są gotowi; pozostali dołączają do jego shm.
+ * 3) Inicjuje salę (initRestaurant: stoliki, katalog wolnych miejsc, kolejka) - na swoim zakresie stolików.
+ * 4) W pętli czeka (blokujący transportReceive na typy 1..5) i odbiera:
+ *    - REQUEST_TABLE: findFreeTable (katalog wolnych miejsc); jeśli brak miejsca -> do kolejki
+ *      (albo do innego kasjera, który ma miejsce), jeśli zaraz zamykamy -> NEAR_CLOSING, itp.
+ *    - SEND_ORDER: zlicza sprzedane pizze i przychód, potwierdza zamówienie (ORDER_SERVED),
+ *      a przy PIZZERIA_KITCHEN potwierdza ORDER_COOKING i przekazuje je do kuchni
+ *      (wątek kuchni odsyła PIZZA_READY, gdy pizze się upieką).
+ *    - LEAVE_TABLE: zwalnia stolik, próbuje wpuścić przy nim kogoś z kolejki.
+ *    - CANCEL_REQUEST: zdejmuje z kolejki grupę, której skończyła się cierpliwość.
+ *    Co RECLAIM_INTERVAL_S zwalnia też miejsca grup, których procesy już nie żyją.
  *    - Reaguje też na sygnały pożaru (SIGUSR1) i zamknięcia (SIGUSR2).
- * 5) Po wyjściu z pętli czeka, aż stoliki się opróżnią.
- * 6) Tworzy raport "daily_report.txt" z sumą sprzedanych pizz i przychodem.
- * 7) Usuwa kolejkę (deleteMessageQueue), odłącza pamięć (shmdt).
+ *    Przy PIZZERIA_BATCH > 1 obsługuje oczekujące komunikaty partiami (processBatch).
+ * 5) Po wyjściu z pętli obsługuje dalej komunikaty (nowe grupy dostają NEAR_CLOSING),
+ *    aż stoliki (wszystkich kasjerów) się opróżnią.
+ * 6) Tworzy raport "daily_report.txt" z sumą sprzedanych pizz, przychodem i analityką zmiany
+ *    (czas w kolejce, odmowy, zajętość, kuchnia) oraz jego wersje .csv i .json (report.c);
+ *    przy kilku kasjerach robi to prowadzący, scalając statystyki wszystkich.
+ * 7) Zamyka dziennik zdarzeń (PIZZERIA_JOURNAL), usuwa transport (transportDestroy), odłącza pamięć (shmdt).
  *
- * @param argc Liczba argumentów (powinno być 5).
- * @param argv x1, x2, x3, x4 -> stoliki 1,2,3,4-osobowe.
+ * @param argc Liczba argumentów (MAX_TABLE_CAPACITY + 1 lub + 3).
+ * @param argv x1 .. xN -> stoliki 1..N-osobowe (N = MAX_TABLE_CAPACITY), [nr_kasjera liczba_kasjerów].
  * @return Kod wyjścia (0).
  */
 
 // -------------------------------------
 int main(int argc, char* argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, CLR_CASHIER "[Kasjer] Użycie: ./cashier_app x1 x2 x3 x4\n" CLR_RESET);
+    long long startedNs = monotonicNs();  // do meldunków gotowości (fazy startu u managera)
+    int withShard = (argc == MAX_TABLE_CAPACITY + 3);
+    int perCapacity[MAX_TABLE_CAPACITY];
+    if ((argc != MAX_TABLE_CAPACITY + 1 && !withShard)
+        || parseTableCounts(MAX_TABLE_CAPACITY, &argv[1], perCapacity) == -1) {
+        fprintf(stderr, CLR_CASHIER "[Kasjer] Użycie: ./cashier_app x1 ... x%d [nr_kasjera liczba_kasjerów]\n" CLR_RESET,
+                MAX_TABLE_CAPACITY);
+        exit(1);
+    }
+    int total = tableCountFor(perCapacity);
+    int self   = withShard ? atoi(argv[MAX_TABLE_CAPACITY + 1]) : 0;
+    int shards = withShard ? atoi(argv[MAX_TABLE_CAPACITY + 2]) : 1;
+    if (shards < 1 || shards > MAX_SHARDS || self < 0 || self >= shards) {
+        fprintf(stderr, CLR_CASHIER "[Kasjer] Błędny numer kasjera %d / %d\n" CLR_RESET, self, shards);
         exit(1);
     }
 
-    int st1 = atoi(argv[1]);
-    int st2 = atoi(argv[2]);
-    int st3 = atoi(argv[3]);
-    int st4 = atoi(argv[4]);
-    int total = st1 + st2 + st3 + st4;
+    // Logi kasjera idą przez pierścień opróżniany w tle
+    logInit(1);
 
     // Obsługa sygnałów
     struct sigaction sa;
@@ -273,6 +384,7 @@ int main(int argc, char* argv[]) {
     sa.sa_flags   = 0;
     sigaction(SIGUSR1, &sa, NULL);
     sigaction(SIGUSR2, &sa, NULL);
+    sigaction(SIGALRM, &sa, NULL);
 
     // Generujemy klucze
     key_t kSem = ftok(".", SEMAPHORE_GEN_CHAR);
@@ -285,16 +397,38 @@ int main(int argc, char* argv[]) {
         perror(CLR_CASHIER "[Kasjer] ftok() shm" CLR_RESET);
         exit(1);
     }
-    key_t kMsg = ftok(".", MSG_GEN_CHAR);
-    if (kMsg == -1) {
-        perror(CLR_CASHIER "[Kasjer] ftok() msg" CLR_RESET);
-        exit(1);
-    }
 
-    // Tworzymy zasoby
-    int semId = createSemaphore(kSem);
-    int shmId = createSharedMemory(kShm, sizeof(DiningTable) * total);
-    int msgId = createMessageQueue(kMsg);
+    // Tworzymy zasoby. Transport (PIZZERIA_TRANSPORT) powstaje przed meldunkiem
+    // gotowości, na który czeka manager, więc klienci zawsze go zastaną.
+    Transport link;
+    transportCreate(&link, self);
+    ShardDirectory* dir = NULL;
+    int dirShmId = -1;
+    PizzeriaMetrics* metrics = NULL;
+    int metricsShmId = -1;
+    int shmId;
+    if (shards == 1) {
+        createSemaphore(kSem);  // stoliki chronią ich własne seqlocki; semafor zostaje dla zgodności (manager go usuwa)
+        shmId   = createSharedMemory(kShm, sizeof(DiningTable) * total);
+        metrics = metricsCreate(shards, &metricsShmId);
+    } else if (self == 0) {
+        shmId   = createSharedMemory(kShm, sizeof(DiningTable) * total);
+        metrics = metricsCreate(shards, &metricsShmId);
+        dir     = shardCreateDirectory(perCapacity, shards, &dirShmId);
+        readyNotify(READY_DIRECTORY, startedNs);  // manager może uruchomić pozostałych kasjerów
+    } else {
+        // Manager uruchamia nas dopiero, gdy katalog prowadzącego jest gotowy
+        dir = shardAttachDirectory(&dirShmId);
+        if (dir == NULL) {
+            perror(CLR_CASHIER "[Kasjer] Brak katalogu kasjerów" CLR_RESET);
+            exit(1);
+        }
+        shmId   = accessSharedMemory(kShm);
+        metrics = metricsAttach(0, &metricsShmId);
+        if (metrics == NULL) {
+            LOG(LVL_ERROR, CLR_CASHIER "[Kasjer %d] Brak segmentu metryk - pracuję bez nich.\n" CLR_RESET, self);
+        }
+    }
 
     // Inicjalizujemy stoliki
     DiningTable* allTables = (DiningTable*)shmat(shmId, NULL, 0);
@@ -302,107 +436,175 @@ int main(int argc, char* argv[]) {
         perror(CLR_CASHIER "[Kasjer] błąd shmat()" CLR_RESET);
         exit(1);
     }
-    setupTables(allTables, 0, st1, 1);
-    setupTables(allTables, st1, st1+st2, 2);
-    setupTables(allTables, st1+st2, st1+st2+st3, 3);
-    setupTables(allTables, st1+st2+st3, st1+st2+st3+st4, 4); 
 
-    // Kolejka oczekujących
-    ClientsQueue waitingLine;
-    initQueue(&waitingLine, QUEUE_LIMIT);
+    // Sala: stoliki, katalog wolnych miejsc (prywatny dla kasjera), kolejka i statystyki.
+    // Przy kilku kasjerach - tylko nasz zakres stolików.
+    static CashierShard shard;
+    static ReplyBatch replies;
+    replies.shard = &shard;
+    Restaurant hall;
+    if (dir == NULL) {
+        initRestaurant(&hall, allTables, perCapacity, QUEUE_LIMIT, replyViaTransport, &replies);
+    } else {
+        const ShardInfo* mine = &dir->shard[self];
+        initRestaurant(&hall, allTables + mine->base, mine->perCapacity, QUEUE_LIMIT, replyViaTransport, &replies);
+        total = dir->totalTables;  // na koniec dnia czekamy na opróżnienie całego lokalu
+    }
+    shardJoin(&shard, dir, self, &link);
+    shardPublish(&shard, &hall);
+
+    // Dziennik zdarzeń (PIZZERIA_JOURNAL) - do odtworzenia zmiany w replay_app
+    static Journal journal;
+    if (journalOpenFromEnv(&journal, (dir == NULL) ? perCapacity : dir->shard[self].perCapacity,
+                           QUEUE_LIMIT, self, shards) == 0) {
+        hall.journal = &journal;
+    }
 
-    // Statystyki dzienne
-    int soldItems[10] = {0};
-    double totalRevenue  = 0.0;
-    int totalClients  = 0;
+    // Analityka zmiany do raportu dziennego (czas w kolejce, odmowy, zajętość)
+    static ShiftStats stats;
+    if (statsInit(&stats, (dir == NULL) ? perCapacity : dir->shard[self].perCapacity, QUEUE_LIMIT,
+                  self, (dir == NULL) ? 0 : dir->shard[self].base) == 0) {
+        hall.stats = &stats;
+        // Bieżące metryki dla pizzeria_top - te same zdarzenia co analityka
+        if (metrics != NULL) {
+            metricsJoin(&metrics->shard[self], (dir == NULL) ? perCapacity : dir->shard[self].perCapacity);
+            statsAttachLive(&stats, &metrics->shard[self]);
+        }
+    }
+    ShardMetrics* live = (hall.stats != NULL) ? hall.stats->live : NULL;
+
+    // Przyjmowanie grup wg szacowanego czekania (PIZZERIA_ADMISSION=slo_ms)
+    static Admission admission;
+    int sloMs;
+    if (admissionConfigFromEnv(&sloMs) == 0 && sloMs > 0) {
+        if (admissionInit(&admission, (dir == NULL) ? perCapacity : dir->shard[self].perCapacity,
+                          QUEUE_LIMIT, sloMs, 1) == -1) {
+            perror(CLR_CASHIER "[Kasjer] Błąd przygotowania szacowania czekania" CLR_RESET);
+            exit(1);
+        }
+        hall.admission = &admission;
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Przyjmowanie grup: SLO czekania %d ms (kolejka do %d grup).\n" CLR_RESET,
+            sloMs, QUEUE_LIMIT);
+    }
 
-    printf(CLR_CASHIER "[Kasjer] Startuję z obsługą!\n" CLR_RESET);
-    while (!fireSignal && (unsigned long)time(NULL) < forcedFinish) {
-        if (!fireSignal && closeIsNear == 1 && queueSize(&waitingLine) > 0) {
-            sendClosingSoon(&waitingLine, msgId);
+    // Kuchnia: kolejka przygotowania i piece we własnym wątku (PIZZERIA_KITCHEN)
+    static Kitchen kitchenState;
+    KitchenConfig kitchenCfg;
+    if (kitchenConfigFromEnv(&kitchenCfg) == 0 && kitchenCfg.ovens > 0) {
+        if (kitchenInit(&kitchenState, &kitchenCfg, pizzaReady, &link, monotonicNs()) == -1
+            || kitchenStart(&kitchenState) == -1) {
+            perror(CLR_CASHIER "[Kasjer] Błąd uruchomienia kuchni" CLR_RESET);
+            exit(1);
         }
+        kitchen = &kitchenState;
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Kuchnia: %d piec(e) po %d pizze, kolejka %d pizz.\n" CLR_RESET,
+            kitchenCfg.ovens, kitchenCfg.load, kitchenCfg.queueLimit);
+    }
 
-        CommunicationMessage msg;
-        // --- Odbiór rezerwacji stolika ---
-        int rc = msgrcv(msgId, &msg, sizeof(msg) - sizeof(long), REQUEST_TABLE, IPC_NOWAIT);
-        if (rc != -1 && !fireSignal) {
-            semaphoreP(semId, MUTEX_INDEX);
-            if (queueSize(&waitingLine) > 0) {
-                trySeatQueue(allTables, &waitingLine, total, msgId);
-            }
-            int tIdx = findFreeTable(allTables, msg.group.size, total);
-            if (tIdx == NEAR_CLOSING) {
-                msg.mtype = msg.group.groupPID;
-                msg.tableIndex = NEAR_CLOSING;
-                printf(CLR_CASHIER "[Kasjer] Grupa PID(%d), zamykamy wkrótce, nie wpuszczam.\n" CLR_RESET,
-                       (int)msg.group.groupPID);
-                msgsnd(msgId, &msg, sizeof(msg) - sizeof(long), 0);
-            } else if (tIdx == NO_TABLE_FOUND) {
-                if (queueSize(&waitingLine) >= QUEUE_LIMIT) {
-                    msg.mtype = msg.group.groupPID;
-                    msg.tableIndex = NO_TABLE_FOUND;
-                    printf(CLR_CASHIER "[Kasjer] Grupa PID(%d), kolejka jest przepełniona.\n" CLR_RESET,
-                           (int)msg.group.groupPID);
-                    msgsnd(msgId, &msg, sizeof(msg) - sizeof(long), 0);
-                } else {
-                    enqueueGroup(&waitingLine, &msg.group);
-                    printQueue(&waitingLine);
-                }
-            } else {
-                seatGroupAtTable(allTables, tIdx, &msg.group, msgId);
-            }
-            semaphoreV(semId, MUTEX_INDEX);
-        } else if (rc == -1) {
-            if (errno != ENOMSG && errno != EINTR) {
-                perror(CLR_CASHIER "[Kasjer] Błąd msgrcv() rezerwacja" CLR_RESET);
-                exit(1);
-            }
+    if (dir != NULL && self == 0) {
+        // Semafor i meldunek dla managera dopiero, gdy wszyscy kasjerowie przyjmują komunikaty
+        for (int s = 1; s < shards; s++) {
+            shardAwaitReady(dir, s);
+            peerPids[peerCount++] = atomic_load(&dir->shard[s].pid);
         }
+        createSemaphore(kSem);
+    }
+    readyNotify(READY_SERVING, startedNs);
+    int firstSeatNoted = 0;
+
+    // PIZZERIA_BATCH = maksymalny rozmiar partii (1 = po jednym komunikacie, jak dotąd)
+    BatchControl batch = { 1, 1, 0, 0 };
+    const char* batchEnv = getenv("PIZZERIA_BATCH");
+    if (batchEnv != NULL) {
+        int max = atoi(batchEnv);
+        batch.max = (max < 1) ? 1 : (max > MAX_BATCH ? MAX_BATCH : max);
+    }
+
+    long long nextReclaimNs = monotonicNs() + RECLAIM_INTERVAL_S * 1000000000LL;
 
-        // --- Odbiór zamówień ---
-        rc = msgrcv(msgId, &msg, sizeof(msg) - sizeof(long), SEND_ORDER, IPC_NOWAIT);
-        if (rc != -1 && !fireSignal) {
-            for (int i = 0; i < msg.group.size; i++) {
-                soldItems[msg.orderedItems[i]]++;
-                totalRevenue += pizzaMenu[msg.orderedItems[i]].cost;
+    LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Startuję z obsługą!\n" CLR_RESET);
+    while (!fireSignal && (unsigned long)time(NULL) < forcedFinish) {
+        if (closeIsNear && !hall.closing) {
+            if (hall.journal != NULL) {
+                journalAppend(hall.journal, JOURNAL_CLOSE_WARNING, NULL, -1, 0, 0);
             }
-            totalClients += msg.group.size;
-            semaphoreP(semId, MUTEX_INDEX);
-            showCurrentTables(allTables, total);
-            semaphoreV(semId, MUTEX_INDEX);
-        } else if (rc == -1) {
-            if (errno != ENOMSG && errno != EINTR) {
-                perror(CLR_CASHIER "[Kasjer] Błąd msgrcv() zamówienie" CLR_RESET);
-                exit(1);
+            if (live != NULL) {
+                metricsSet(&live->state, METRICS_CLOSING);
             }
         }
+        hall.closing = closeIsNear;
+        if (!fireSignal && closeIsNear == 1 && queueSize(&hall.waitingLine) > 0) {
+            announceClosing(&hall);
+        }
 
-        // --- Odbiór wyjścia klientów ---
-        rc = msgrcv(msgId, &msg, sizeof(msg) - sizeof(long), LEAVE_TABLE, IPC_NOWAIT);
-        if (rc != -1 && !fireSignal) {
-            semaphoreP(semId, MUTEX_INDEX);
-            removeGroupFromTable(allTables, msg.tableIndex, msg.group.groupPID, msg.group.size);
-            if (queueSize(&waitingLine) > 0) {
-                trySeatQueue(allTables, &waitingLine, total, msgId);
+        // Jedno blokujące czekanie na wszystkie typy zapytań (msgrcv z ujemnym mtype
+        // albo futex pierścienia w shm); sygnał przerywa je z EINTR. Gdy w outbox czekają
+        // komunikaty do innego kasjera, tylko zaglądamy do kolejki i ponawiamy je co 1 ms.
+        CommunicationMessage* msg = (shard.outboxCount > 0) ? transportPoll(&link) : transportReceive(&link);
+        if (msg == NULL) {
+            if (errno == ENOMSG) {
+                shardFlush(&shard);
+                usleep(1000);
+                continue;
             }
-            semaphoreV(semId, MUTEX_INDEX);
-        } else if (rc == -1) {
-            if (errno != ENOMSG && errno != EINTR) {
-                perror(CLR_CASHIER "[Kasjer] Błąd msgrcv() wyjście klienta" CLR_RESET);
+            if (errno != EINTR) {
+                perror(CLR_CASHIER "[Kasjer] Błąd odbioru komunikatu" CLR_RESET);
                 exit(1);
             }
+            continue; // sygnał - wracamy do sprawdzenia flag
         }
+        if (fireSignal) {
+            break;
+        }
+        if (batch.max > 1) {
+            processBatch(&hall, &replies, msg, &batch);
+        } else {
+            dispatchMessage(&hall, &shard, msg);
+            transportRelease(&link);
+        }
+        reclaimIfDue(&hall, &shard, &nextReclaimNs);
+        shardFlush(&shard);
+        shardRebalance(&shard, &hall);
+        shardPublish(&shard, &hall);
+        if (live != NULL) {
+            metricsSet(&live->queueDepth, queueSize(&hall.waitingLine));
+        }
+        if (!firstSeatNoted && hall.seated > 0) {
+            firstSeatNoted = 1;
+            readyNotify(READY_FIRST_SEAT, startedNs);
+        }
+    }
+    if (fireSignal && hall.journal != NULL) {
+        journalAppend(hall.journal, JOURNAL_FIRE, NULL, -1, 0, 0);
+    }
+    if (fireSignal) {
+        // Kolejka ewakuuje się razem z lokalem - nikogo już z niej nie sadzamy
+        clearQueue(&hall.waitingLine);
+    }
+    hall.closing = 1;
+    shardPublish(&shard, &hall);
+    if (live != NULL) {
+        metricsSet(&live->queueDepth, queueSize(&hall.waitingLine));
+        metricsSet(&live->state, METRICS_CLOSING);
+    }
+    if (batch.batches > 0) {
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Partie: %ld, średnio %.1f komunikatu na partię (limit %d)\n" CLR_RESET,
+            batch.batches, (double)batch.messages / batch.batches, batch.max);
     }
 
-    if (!fireSignal) {
-        printf(CLR_CASHIER "[Kasjer] Pozwalam dokończyć jedzenie tym, co jeszcze siedzą.\n" CLR_RESET);
+    if (fireSignal) {
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] POŻAR! Sprawdzam, czy klienci opuścili lokal...\n" CLR_RESET);
+    } else {
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Pozwalam dokończyć jedzenie tym, co jeszcze siedzą.\n" CLR_RESET);
     }
 
     // Oczekiwanie aż wszystkie stoliki będą puste
     while (1) {
         int allFree = 1;
         for (int i = 0; i < total; i++) {
-            if (allTables[i].total_seated != 0) {
+            DiningTable t;
+            tableSnapshot(&allTables[i], &t);
+            if (t.total_seated != 0) {
                 allFree = 0;
                 break;
             }
@@ -410,53 +612,119 @@ int main(int argc, char* argv[]) {
         if (allFree) {
             break;
         }
-        if (!fireSignal) {
-            CommunicationMessage exitMsg;
-            if (msgrcv(msgId, &exitMsg, sizeof(exitMsg) - sizeof(long), LEAVE_TABLE, IPC_NOWAIT) == -1) {
-                if (errno == ENOMSG || errno == EINTR) {
-                    continue;
-                } else {
-                    perror(CLR_CASHIER "[Kasjer] Błąd msgrcv() w fazie końcowej" CLR_RESET);
-                    exit(1);
-                }
-            } else {
-                semaphoreP(semId, MUTEX_INDEX);
-                removeGroupFromTable(allTables, exitMsg.tableIndex, exitMsg.group.groupPID, exitMsg.group.size);
-                semaphoreV(semId, MUTEX_INDEX);
+        if (fireSignal) {
+            // Stoliki czyści strażak - sprawdzamy ponownie po krótkiej przerwie. Grupę usadzoną
+            // w partii już po jego przejściu zwalniamy sami, gdy jej proces się zakończy.
+            reclaimIfDue(&hall, &shard, &nextReclaimNs);
+            usleep(10000);
+            continue;
+        }
+        // Grupa, która zginęła przy stoliku, nie wyśle LEAVE_TABLE - jej miejsca zwalniamy sami
+        reclaimIfDue(&hall, &shard, &nextReclaimNs);
+        shardFlush(&shard);
+        // Spóźnione zapytania dostają NEAR_CLOSING (hall.closing), zamówienia i wyjścia obsługujemy.
+        // Przy kilku kasjerach ostatnie wyjście może trafić do innego kasjera,
+        // więc nie czekamy w nieskończoność - sprawdzamy co 1 ms. Jeden kasjer czeka
+        // najwyżej RECLAIM_INTERVAL_S (SIGALRM przerywa odbiór).
+        if (dir == NULL) {
+            alarm(RECLAIM_INTERVAL_S);
+        }
+        CommunicationMessage* exitMsg = (dir == NULL) ? transportReceive(&link) : transportPoll(&link);
+        if (exitMsg == NULL) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOMSG) {
+                usleep(1000);
+                continue;
             }
+            perror(CLR_CASHIER "[Kasjer] Błąd odbioru w fazie końcowej" CLR_RESET);
+            exit(1);
         }
+        dispatchMessage(&hall, &shard, exitMsg);
+        transportRelease(&link);
     }
+    alarm(0);
 
-    // Generowanie raportu
-    int fd = open("daily_report.txt", O_WRONLY | O_CREAT | O_TRUNC, 0600);
-    if (fd == -1) {
-        perror(CLR_CASHIER "[Kasjer] Błąd przy otwarciu pliku raportu" CLR_RESET);
-        exit(1);
+    // Kuchnia kończy razem z salą - jej podsumowanie idzie do raportu
+    if (kitchen != NULL) {
+        kitchenStop(kitchen);
+        if (hall.stats != NULL) {
+            hall.stats->summary.kitchen = kitchen->summary;
+        }
+    }
+    if (hall.admission != NULL) {
+        admissionFinish(hall.admission);
+        if (hall.stats != NULL) {
+            hall.stats->summary.admission = hall.admission->summary;
+        }
     }
-    char line[256];
-    snprintf(line, sizeof(line), "----- Dzienny raport pizzerii -----\n");
-    write(fd, line, strlen(line));
-
-    snprintf(line, sizeof(line), "Liczba obsłużonych osób: %d\n", totalClients);
-    write(fd, line, strlen(line));
-
-    snprintf(line, sizeof(line), "Całkowity utarg: %.2lf zł\n", totalRevenue);
-    write(fd, line, strlen(line));
-
-    snprintf(line, sizeof(line), "Sprzedane produkty:\n");
-    write(fd, line, strlen(line));
 
-    for (int i = 0; i < 10; i++) {
-        snprintf(line, sizeof(line), "  %s: %d\n", pizzaMenu[i].name, soldItems[i]);
-        write(fd, line, strlen(line));
+    // Generowanie raportu (przy kilku kasjerach - sumy od prowadzącego)
+    if (hall.stats != NULL) {
+        statsFinish(hall.stats);
+    }
+    shardFinish(&shard, &hall);
+    if (dir == NULL) {
+        static DayReport day;
+        memcpy(day.soldItems, hall.soldItems, sizeof(day.soldItems));
+        day.revenue = hall.totalRevenue;
+        day.clients = hall.totalClients;
+        if (hall.stats != NULL) {
+            day.stats = hall.stats->summary;
+        }
+        writeDailyReports(&day, NULL);
+    } else if (self == 0) {
+        writeMergedReport(dir);
+    }
+    if (live != NULL) {
+        metricsSet(&live->state, METRICS_DONE);
+    }
+    // Metryki usuwa prowadzący - raport już czekał, aż pozostali skończą
+    if (metrics != NULL) {
+        if (dir == NULL || self == 0) {
+            atomic_store_explicit(&metrics->finished, 1, memory_order_release);
+            deleteSharedMemory(metricsShmId, metrics);
+        } else {
+            metricsDetach(metrics);
+        }
     }
-    close(fd);
 
     sleep(1);
-    printf(CLR_CASHIER "[Kasjer] Kończę pracę.\n" CLR_RESET);
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Czas CPU: user %ld.%03ld s, sys %ld.%03ld s\n" CLR_RESET,
+            (long)usage.ru_utime.tv_sec, (long)usage.ru_utime.tv_usec / 1000,
+            (long)usage.ru_stime.tv_sec, (long)usage.ru_stime.tv_usec / 1000);
+    }
+    LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Kończę pracę.\n" CLR_RESET);
 
-    // Usuwamy kolejkę
-    deleteMessageQueue(msgId);
+    if (hall.journal != NULL) {
+        LOG(LVL_INFO, CLR_CASHIER "[Kasjer] Dziennik zdarzeń: %llu rekordów\n" CLR_RESET,
+            (unsigned long long)journal.count);
+        journalClose(&journal);
+    }
+    if (hall.stats != NULL) {
+        statsDestroy(hall.stats);
+    }
+    if (kitchen != NULL) {
+        kitchenDestroy(kitchen);
+    }
+    if (hall.admission != NULL) {
+        admissionDestroy(hall.admission);
+    }
+    destroyRestaurant(&hall);
+    shardLeave(&shard);
+    // Usuwamy kolejkę / pierścień
+    transportDestroy(&link);
+    // Katalog kasjerów usuwa prowadzący, pozostali tylko się odłączają
+    if (dir != NULL) {
+        if (self == 0) {
+            deleteSharedMemory(dirShmId, dir);
+        } else {
+            shardDetachDirectory(dir);
+        }
+    }
     // Odłączamy shm
     if (shmdt(allTables) == -1) {
         perror(CLR_CASHIER "[Kasjer] Błąd shmdt()" CLR_RESET);
@@ -0,0 +1,449 @@
+#include "cashier_shard.h"
+#include "logger.h"
+#include <string.h>
+#include <limits.h>
+
+/**
+ * Dołącza kasjera do katalogu: zapisuje PID i zgłasza gotowość
+ * (sala i transport muszą już być przygotowane).
+ *
+ * @param cs Stan kasjera-sharda.
+ * @param dir Katalog kasjerów lub NULL (jeden kasjer).
+ * @param self Numer tego kasjera.
+ * @param own Transport tego kasjera.
+ */
+
+void shardJoin(CashierShard* cs, ShardDirectory* dir, int self, Transport* own) {
+    memset(cs, 0, sizeof(*cs));
+    cs->dir  = dir;
+    cs->self = self;
+    cs->own  = own;
+    if (dir == NULL) {
+        return;
+    }
+    cs->info = &dir->shard[self];
+    cs->base = cs->info->base;
+    atomic_store(&cs->info->pid, getpid());
+    shardMarkReady(cs->info);
+}
+
+void shardLeave(CashierShard* cs) {
+    for (int s = 0; s < MAX_SHARDS; s++) {
+        if (cs->peerOpen[s]) {
+            transportClose(&cs->peers[s]);
+            cs->peerOpen[s] = 0;
+        }
+    }
+}
+
+/**
+ * Transport kasjera nr shard: własny albo (przy pierwszym użyciu) dołączony
+ * transport innego kasjera - bez slotu odpowiedzi, tylko do wysyłania.
+ * @return Transport lub NULL, gdy tamtego kasjera już nie ma.
+ */
+
+Transport* shardLink(CashierShard* cs, int shard) {
+    if (shard == cs->self || cs->dir == NULL) {
+        return cs->own;
+    }
+    if (!cs->peerOpen[shard]) {
+        if (transportOpen(&cs->peers[shard], 0, shard) == -1) {
+            return NULL;
+        }
+        cs->peerOpen[shard] = 1;
+    }
+    return &cs->peers[shard];
+}
+
+/**
+ * Wysyła komunikat innemu kasjerowi bez czekania na miejsce w jego kolejce -
+ * dwaj kasjerzy z pełnymi kolejkami, czekający na siebie nawzajem, staliby na zawsze.
+ * @return 0 lub -1 (errno = EAGAIN - kolejka pełna; inny błąd - kasjera już nie ma).
+ */
+
+static int forward(CashierShard* cs, int shard, const CommunicationMessage* msg) {
+    Transport* link = shardLink(cs, shard);
+    if (link == NULL) {
+        return -1;
+    }
+    CommunicationMessage* out = transportTryAcquire(link);
+    if (out == NULL) {
+        return -1;
+    }
+    *out = *msg;
+    return transportTryCommit(link);
+}
+
+/**
+ * Jak forward, ale komunikatu, który nie zmieścił się w pełnej kolejce, nie gubimy -
+ * czeka w outbox na shardFlush.
+ * @return 0 (wysłany lub odłożony) albo -1 (kasjera już nie ma, outbox pełny).
+ */
+
+static int forwardOrKeep(CashierShard* cs, int shard, const CommunicationMessage* msg) {
+    if (forward(cs, shard, msg) == 0) {
+        return 0;
+    }
+    if (errno != EAGAIN || cs->outboxCount == SHARD_OUTBOX) {
+        return -1;
+    }
+    cs->outbox[cs->outboxCount].target = shard;
+    cs->outbox[cs->outboxCount].msg    = *msg;
+    cs->outboxCount++;
+    return 0;
+}
+
+/**
+ * Ponawia komunikaty z outbox (w kolejności odłożenia); te, dla których
+ * kolejka odbiorcy nadal jest pełna, zostają na następny raz.
+ */
+
+void shardFlush(CashierShard* cs) {
+    int kept = 0;
+    for (int i = 0; i < cs->outboxCount; i++) {
+        ShardOutgoing* out = &cs->outbox[i];
+        if (forward(cs, out->target, &out->msg) == 0) {
+            continue;
+        }
+        if (errno == EAGAIN) {
+            cs->outbox[kept++] = *out;
+        } else {
+            LOG(LVL_ERROR, CLR_CASHIER "[Kasjer %d] Nie mogę przekazać komunikatu (typ %ld) kasjerowi %d\n" CLR_RESET,
+                cs->self, out->msg.mtype, out->target);
+        }
+    }
+    cs->outboxCount = kept;
+}
+
+/**
+ * Inny kasjer z wolnym stolikiem dla grupy groupSize - najmniej obciążony.
+ * @return Numer kasjera lub -1.
+ */
+
+static int pickTarget(const CashierShard* cs, int groupSize) {
+    int best = -1, bestLoad = INT_MAX;
+    for (int s = 0; s < cs->dir->shards; s++) {
+        const ShardInfo* info = &cs->dir->shard[s];
+        if (s == cs->self || !((atomic_load_explicit(&info->fitMask, memory_order_relaxed) >> groupSize) & 1u)) {
+            continue;
+        }
+        int load = shardLoad(info);
+        if (load < bestLoad) {
+            best     = s;
+            bestLoad = load;
+        }
+    }
+    return best;
+}
+
+static int findForeign(const CashierShard* cs, pid_t pid) {
+    for (int i = 0; i < cs->foreignCount; i++) {
+        if (cs->foreign[i].pid == pid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void rememberForeign(CashierShard* cs, pid_t pid, int origin, int hops) {
+    if (cs->foreignCount == QUEUE_LIMIT) {
+        return; // nie powinno się zdarzyć - wpisów jest najwyżej tyle, ile grup w kolejce
+    }
+    cs->foreign[cs->foreignCount].pid    = pid;
+    cs->foreign[cs->foreignCount].origin = origin;
+    cs->foreign[cs->foreignCount].hops   = hops;
+    cs->foreignCount++;
+}
+
+static int takeForeign(CashierShard* cs, pid_t pid, int* origin, int* hops) {
+    int i = findForeign(cs, pid);
+    if (i == -1) {
+        return 0;
+    }
+    *origin = cs->foreign[i].origin;
+    *hops   = cs->foreign[i].hops;
+    cs->foreign[i] = cs->foreign[--cs->foreignCount];
+    return 1;
+}
+
+/**
+ * Przy przybyciu: jeśli u nas nie ma stolika dla grupy, a u innego kasjera jest,
+ * przekazujemy mu zapytanie (hops + 1) zamiast wstawiać grupę do naszej kolejki.
+ * Gdy jego kolejka jest pełna, grupę obsługujemy u siebie.
+ * @return 1, gdy zapytanie poszło dalej.
+ */
+
+static int handOffRequest(CashierShard* cs, Restaurant* r, const CommunicationMessage* msg) {
+    if (cs->dir == NULL || r->closing || msg->hops >= SHARD_MAX_HOPS
+        || findTableForGroup(&r->dir, msg->group.size) != NO_TABLE_FOUND || cancelNoted(r, &msg->group)) {
+        return 0;
+    }
+    int target = pickTarget(cs, msg->group.size);
+    if (target == -1) {
+        return 0;
+    }
+    CommunicationMessage fwd = *msg;
+    fwd.hops++;
+    if (forward(cs, target, &fwd) == -1) {
+        return 0;
+    }
+    cs->handedOff++;
+    if (r->journal != NULL) {
+        journalAppend(r->journal, JOURNAL_HANDOFF, &msg->group, target, 0, 0);
+    }
+    LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer %d] Grupa PID(%d) - u nas brak miejsca, przekazuję kasjerowi %d.\n" CLR_RESET,
+            cs->self, (int)msg->group.groupPID, target);
+    return 1;
+}
+
+/**
+ * REQUEST_TABLE w trybie shardów: przekazanie dalej albo handleTableRequest.
+ * Cudza grupa, która trafia do naszej kolejki, jest zapamiętywana razem
+ * z kasjerem, przez którego trzeba jej odpowiedzieć.
+ */
+
+void shardTableRequest(CashierShard* cs, Restaurant* r, const CommunicationMessage* msg) {
+    if (handOffRequest(cs, r, msg)) {
+        return;
+    }
+    cs->current = msg;
+    int rc = handleTableRequest(r, &msg->group);
+    cs->current = NULL;
+    if (rc == GROUP_QUEUED && cs->dir != NULL && (msg->originShard != cs->self || msg->hops > 0)) {
+        rememberForeign(cs, msg->group.groupPID, msg->originShard, msg->hops);
+    }
+}
+
+/**
+ * CANCEL_REQUEST: grupa czeka w naszej kolejce - zdejmuje ją handleCancel (odpowiedź
+ * przez kasjera, u którego grupa czeka). Jeśli jej u nas nie ma, a mogła przejść
+ * do innego kasjera, rezygnacja idzie do wszystkich pozostałych (hops = 1, dalej już nie);
+ * przy pełnej kolejce odbiorcy czeka w outbox.
+ * Rezygnacja, która wyprzedzi (przekazane) zapytanie, zostaje zapamiętana u każdego
+ * kasjera (handleCancel) - zapytanie dostanie GROUP_CANCELLED tam, dokąd dotrze.
+ */
+
+void shardCancel(CashierShard* cs, Restaurant* r, const CommunicationMessage* msg) {
+    cs->current = msg;
+    int removed = handleCancel(r, &msg->group);
+    cs->current = NULL;
+    if (removed) {
+        int origin, hops;
+        takeForeign(cs, msg->group.groupPID, &origin, &hops);
+        return;
+    }
+    if (cs->dir == NULL || msg->hops > 0) {
+        return;
+    }
+    CommunicationMessage fwd = *msg;
+    fwd.hops = 1;
+    for (int s = 0; s < cs->dir->shards; s++) {
+        if (s != cs->self && forwardOrKeep(cs, s, &fwd) == -1) {
+            LOG(LVL_ERROR, CLR_CASHIER "[Kasjer %d] Nie mogę przekazać rezygnacji grupy PID(%d) kasjerowi %d\n" CLR_RESET,
+                cs->self, (int)msg->group.groupPID, s);
+        }
+    }
+}
+
+/**
+ * Wpisy cudzych grup, których nie ma już w naszej kolejce (zdjętych przez
+ * reclaimDeadGroups - nikt im nie odpowiadał), są usuwane.
+ */
+
+void shardPrune(CashierShard* cs, const Restaurant* r) {
+    for (int i = 0; i < cs->foreignCount; ) {
+        if (isQueued(&r->waitingLine, cs->foreign[i].pid)) {
+            i++;
+        } else {
+            cs->foreign[i] = cs->foreign[--cs->foreignCount];
+        }
+    }
+}
+
+/**
+ * LEAVE_TABLE: stolik innego kasjera (grupa przekazana dalej) - wyjście idzie
+ * do właściciela stolika (przy pełnej kolejce - przez outbox). Nasz stolik - indeks
+ * zamieniany na lokalny.
+ * @return 1, gdy wyjście trzeba obsłużyć u nas.
+ */
+
+int shardLocalLeave(CashierShard* cs, CommunicationMessage* msg) {
+    if (cs->dir == NULL) {
+        return 1;
+    }
+    int owner = shardOwner(cs->dir, msg->tableIndex);
+    if (owner == cs->self || owner == -1) {
+        msg->tableIndex -= cs->base;
+        return 1;
+    }
+    if (forwardOrKeep(cs, owner, msg) == -1) {
+        LOG(LVL_ERROR, CLR_CASHIER "[Kasjer %d] Nie mogę przekazać wyjścia ze stolika %d kasjerowi %d\n" CLR_RESET,
+            cs->self, msg->tableIndex, owner);
+        return 0;
+    }
+    cs->forwardedLeaves++;
+    return 0;
+}
+
+/**
+ * Dla odpowiedzi z sali: zamienia lokalny numer stolika na globalny i zwraca
+ * kasjera, przez którego transport grupa czeka na odpowiedź.
+ */
+
+int shardReplyOrigin(CashierShard* cs, const GroupOfClients* g, int* tableIndex) {
+    if (cs->dir == NULL) {
+        return cs->self;
+    }
+    if (*tableIndex >= 0) {
+        *tableIndex += cs->base;
+    }
+    if (cs->current != NULL && cs->current->group.groupPID == g->groupPID) {
+        return cs->current->originShard;
+    }
+    int origin, hops;
+    if (cs->foreignCount > 0 && takeForeign(cs, g->groupPID, &origin, &hops)) {
+        return origin;
+    }
+    return cs->self;
+}
+
+/**
+ * Grupy czekające w naszej kolejce, dla których inny kasjer ma teraz wolny
+ * stolik, przechodzą do niego - najdłużej czekająca grupa każdej wielkości,
+ * po jednej na wywołanie (wolne miejsce u celu mogło być tylko jedno).
+ * Grupa przekazana już SHARD_MAX_HOPS razy zostaje u nas, tak samo jak grupa,
+ * której nie udało się wysłać (pełna kolejka celu albo celu już nie ma).
+ */
+
+void shardRebalance(CashierShard* cs, Restaurant* r) {
+    if (cs->dir == NULL || r->closing || queueSize(&r->waitingLine) == 0) {
+        return;
+    }
+    for (int g = 1; g <= MAX_GROUP_SIZE; g++) {
+        QueueNode* oldest = r->waitingLine.sizeHead[g];
+        if (oldest == NULL) {
+            continue;
+        }
+        int i = findForeign(cs, oldest->data.groupPID);
+        if (i >= 0 && cs->foreign[i].hops >= SHARD_MAX_HOPS) {
+            continue;
+        }
+        int target = pickTarget(cs, g);
+        if (target == -1) {
+            continue;
+        }
+
+        CommunicationMessage fwd;
+        memset(&fwd, 0, sizeof(fwd));
+        dequeueSuitable(&r->waitingLine, g, g, &fwd.group);
+        fwd.mtype       = REQUEST_TABLE;
+        fwd.tableIndex  = -1;
+        fwd.originShard = cs->self;
+        fwd.hops        = 0;
+        for (int j = 0; j < MAX_GROUP_SIZE; j++) {
+            fwd.orderedItems[j] = -1;
+        }
+        takeForeign(cs, fwd.group.groupPID, &fwd.originShard, &fwd.hops);
+        fwd.hops++;
+
+        if (forward(cs, target, &fwd) == -1) {
+            // Kolejka tamtego kasjera jest pełna albo jego już nie ma - grupa wraca na koniec naszej
+            if (r->journal != NULL) {
+                journalAppend(r->journal, JOURNAL_HANDOFF_QUEUED, &fwd.group, -1, 0, 0);
+            }
+            enqueueGroup(&r->waitingLine, &fwd.group);
+            if (fwd.originShard != cs->self || fwd.hops > 1) {
+                rememberForeign(cs, fwd.group.groupPID, fwd.originShard, fwd.hops - 1);
+            }
+            continue;
+        }
+        cs->handedOff++;
+        if (r->journal != NULL) {
+            journalAppend(r->journal, JOURNAL_HANDOFF_QUEUED, &fwd.group, target, 0, 0);
+        }
+        if (r->stats != NULL) {
+            statsForget(r->stats, fwd.group.groupPID);
+        }
+        if (r->admission != NULL) {
+            admissionForget(r->admission, &fwd.group);
+        }
+        LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer %d] Grupa PID(%d) z kolejki przechodzi do kasjera %d.\n" CLR_RESET,
+                cs->self, (int)fwd.group.groupPID, target);
+    }
+}
+
+/**
+ * Kasjerzy, u których czekają grupy, dostają SEAT_AVAILABLE - inaczej
+ * sprawdziliby nasze wolne miejsca dopiero przy swoim następnym komunikacie.
+ * Przy pełnej kolejce odbiorcy szturchnięcie przepada: ma już co odbierać.
+ */
+
+static void announceSeats(CashierShard* cs) {
+    CommunicationMessage nudge;
+    memset(&nudge, 0, sizeof(nudge));
+    nudge.mtype       = SEAT_AVAILABLE;
+    nudge.tableIndex  = -1;
+    nudge.originShard = cs->self;
+    for (int s = 0; s < cs->dir->shards; s++) {
+        if (s != cs->self && atomic_load_explicit(&cs->dir->shard[s].queued, memory_order_relaxed) > 0) {
+            forward(cs, s, &nudge);
+        }
+    }
+}
+
+/**
+ * Publikuje w katalogu stan kasjera dla routera i pozostałych kasjerów:
+ * dla jakich wielkości grup ma wolny stolik, ile osób siedzi i ile grup czeka.
+ * Zapis tylko przy zmianie, żeby nie unieważniać bez potrzeby linii pamięci czytelników.
+ * Nowe wolne miejsce ogłaszamy kasjerom z kolejką (announceSeats).
+ */
+
+void shardPublish(CashierShard* cs, const Restaurant* r) {
+    if (cs->dir == NULL) {
+        return;
+    }
+    unsigned int mask = 0;
+    if (!r->closing) {
+        for (int g = 1; g <= MAX_GROUP_SIZE; g++) {
+            if (findTableForGroup(&r->dir, g) != NO_TABLE_FOUND) {
+                mask |= 1u << g;
+            }
+        }
+    }
+    ShardInfo* info = cs->info;
+    unsigned int old = atomic_load_explicit(&info->fitMask, memory_order_relaxed);
+    if (old != mask) {
+        atomic_store_explicit(&info->fitMask, mask, memory_order_relaxed);
+        if (mask & ~old) {
+            announceSeats(cs);
+        }
+    }
+    if (atomic_load_explicit(&info->seated, memory_order_relaxed) != r->seated) {
+        atomic_store_explicit(&info->seated, r->seated, memory_order_relaxed);
+    }
+    int queued = queueSize(&r->waitingLine);
+    if (atomic_load_explicit(&info->queued, memory_order_relaxed) != queued) {
+        atomic_store_explicit(&info->queued, queued, memory_order_relaxed);
+    }
+}
+
+/**
+ * Koniec dnia: wpisuje statystyki kasjera do katalogu (dla raportu
+ * kasjera prowadzącego) i ustawia done.
+ */
+
+void shardFinish(CashierShard* cs, const Restaurant* r) {
+    if (cs->dir == NULL) {
+        return;
+    }
+    ShardInfo* info = cs->info;
+    memcpy(info->soldItems, r->soldItems, sizeof(info->soldItems));
+    info->totalRevenue    = r->totalRevenue;
+    info->totalClients    = r->totalClients;
+    info->handedOff       = cs->handedOff;
+    info->forwardedLeaves = cs->forwardedLeaves;
+    if (r->stats != NULL) {
+        info->stats = r->stats->summary;
+    }
+    atomic_store_explicit(&info->done, 1, memory_order_release);
+}
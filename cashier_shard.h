@@ -0,0 +1,66 @@
+#ifndef CASHIER_SHARD_H
+#define CASHIER_SHARD_H
+
+#include "pizzeria.h"
+#include "restaurant.h"
+#include "transport.h"
+#include "shard.h"
+
+// --------------------- Kasjer jako jeden z shardów ---------------------
+//
+// Sala kasjera (Restaurant) pracuje na lokalnych indeksach swojego zakresu
+// stolików; klienci znają indeksy globalne (base + lokalny). Grupę, dla której
+// kasjer nie ma miejsca, a inny kasjer ma (fitMask w katalogu), przekazuje się
+// dalej jako REQUEST_TABLE z hops + 1 - od razu przy przybyciu albo później
+// z kolejki (shardRebalance). Odpowiedź zawsze idzie przez transport kasjera,
+// u którego grupa czeka (originShard). Przy jednym kasjerze (dir == NULL)
+// wszystkie funkcje są przezroczyste.
+
+#define SHARD_MAX_HOPS  2   // grupa przekazana tyle razy zostaje u bieżącego kasjera
+#define SHARD_OUTBOX    64  // wyjścia i rezygnacje czekające na miejsce w kolejce innego kasjera
+
+// Cudza (przekazana) grupa czekająca w naszej kolejce - dokąd odpowiedzieć
+typedef struct {
+    pid_t pid;
+    int   origin;
+    int   hops;
+} ForeignGroup;
+
+// Komunikat do innego kasjera, którego kolejka była pełna - ponawiany w shardFlush
+typedef struct {
+    int                  target;
+    CommunicationMessage msg;
+} ShardOutgoing;
+
+typedef struct {
+    ShardDirectory*             dir;            // NULL - jeden kasjer
+    ShardInfo*                  info;           // nasz wpis w katalogu
+    int                         self;
+    int                         base;
+    Transport*                  own;
+    Transport                   peers[MAX_SHARDS];
+    int                         peerOpen[MAX_SHARDS];
+    const CommunicationMessage* current;        // obsługiwane właśnie zapytanie
+    ForeignGroup                foreign[QUEUE_LIMIT];  // kolejka ma najwyżej QUEUE_LIMIT grup
+    int                         foreignCount;
+    ShardOutgoing               outbox[SHARD_OUTBOX];
+    int                         outboxCount;
+    long                        handedOff;
+    long                        forwardedLeaves;
+} CashierShard;
+
+void shardJoin(CashierShard* cs, ShardDirectory* dir, int self, Transport* own);
+void shardLeave(CashierShard* cs);
+Transport* shardLink(CashierShard* cs, int shard);
+
+void shardTableRequest(CashierShard* cs, Restaurant* r, const CommunicationMessage* msg);
+void shardCancel(CashierShard* cs, Restaurant* r, const CommunicationMessage* msg);
+void shardPrune(CashierShard* cs, const Restaurant* r);
+int  shardLocalLeave(CashierShard* cs, CommunicationMessage* msg);
+int  shardReplyOrigin(CashierShard* cs, const GroupOfClients* g, int* tableIndex);
+void shardRebalance(CashierShard* cs, Restaurant* r);
+void shardFlush(CashierShard* cs);
+void shardPublish(CashierShard* cs, const Restaurant* r);
+void shardFinish(CashierShard* cs, const Restaurant* r);
+
+#endif // CASHIER_SHARD_H
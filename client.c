@@ -1,10 +1,22 @@
 #include "pizzeria.h"
+#include "logger.h"
+#include "transport.h"
+#include "shard.h"
+#include "order.h"
+#include "launch.h"
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
-#include <pthread.h>
+#include <sys/time.h>
 
-static pthread_mutex_t localMutex;
+#define PATIENCE_MAX_MS     3600000
+#define PATIENCE_RETRY_MS   100     // SIGALRM powtarzany, gdyby pierwszy przyszedł tuż przed msgrcv()
+
+// Koniec cierpliwości w kolejce (SIGALRM z zegara ITIMER_REAL)
+static volatile sig_atomic_t patienceOut = 0;
+
+// Pula wątków zamówień (PIZZERIA_CLIENT_THREADS=pool) - jedna na proces, także dla kolejnych grup pracownika
+static OrderPool* orderPool = NULL;
 
 /**
  * Handler sygnału SIGUSR1 (pożar).
@@ -17,220 +29,415 @@ static pthread_mutex_t localMutex;
 // Sygnał pożaru
 static void handleFireSignal(int sig) {
     if (sig == SIGUSR1) {
-        printf(CLR_CLIENT "[Grupa PID(%d)] W lokalu wybuchł pożar! Uciekamy!\n" CLR_RESET, getpid());
+        LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] W lokalu wybuchł pożar! Uciekamy!\n" CLR_RESET, getpid());
         exit(0);
     }
 }
 
 /**
- * Wątek reprezentujący jedną osobę w grupie.
- * - Blokuje mutex localMutex,
- * - Szuka wolnego miejsca w tablicy go->selection,
- * - Wpisuje losowy indeks pizzy (rand()%10),
- * - Wypisuje informację o wybranej pizzy,
- * - Zwalnia mutex i kończy.
- *
- * @param arg Wskaźnik na strukturę GroupOrder (zawiera tablicę orders i liczbę osób).
- * @return Zwraca NULL (kończący wątek).
+ * Handler SIGALRM: grupie skończyła się cierpliwość. Instalowany bez SA_RESTART,
+ * więc przerywa czekanie na odpowiedź (EINTR) - grupa wysyła wtedy CANCEL_REQUEST.
  */
 
-// Wątek reprezentujący jedną osobę w grupie
-void* singlePersonOrder(void* arg) {
-    GroupOrder* go = (GroupOrder*)arg;
-    pthread_mutex_lock(&localMutex);
+static void handlePatience(int sig) {
+    (void)sig;
+    patienceOut = 1;
+}
+
+/**
+ * Pula wątków zamówień procesu, tworzona przy pierwszej grupie (GROUP_LIMIT wątków).
+ * Wątki puli blokują SIGALRM, żeby zegar cierpliwości przerywał czekanie wątku głównego.
+ * @return Pula lub NULL (nie udało się jej utworzyć - zamawiamy wtedy wątkiem na osobę).
+ */
 
-    int idx = 0;
-    while (idx < go->count && go->selection[idx] != -1) {
-        idx++;
+static OrderPool* processOrderPool(void) {
+    if (orderPool == NULL) {
+        sigset_t alarmOnly, previous;
+        sigemptyset(&alarmOnly);
+        sigaddset(&alarmOnly, SIGALRM);
+        pthread_sigmask(SIG_BLOCK, &alarmOnly, &previous);
+        orderPool = orderPoolCreate(GROUP_LIMIT);
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
     }
-    // Losujemy pizzę
-    go->selection[idx] = rand() % 10;
-    printf(CLR_CLIENT "[Grupa PID(%d), wątek %lu] ", getpid(), (unsigned long)pthread_self());
-    showChosenPizza(go->selection[idx]);
+    return orderPool;
+}
+
+/**
+ * Cierpliwość grupy z PIZZERIA_PATIENCE: "ms" albo "min,max" (losowo z przedziału).
+ * Brak zmiennej lub 0 - grupa czeka, aż kasjer odpowie (jak dotąd).
+ * @return Cierpliwość [ms] lub 0.
+ */
 
-    pthread_mutex_unlock(&localMutex);
-    pthread_exit(NULL);
+static int patienceFromEnv(void) {
+    const char* s = getenv("PIZZERIA_PATIENCE");
+    if (s == NULL || *s == '\0') {
+        return 0;
+    }
+    char* end;
+    long lo = strtol(s, &end, 10);
+    long hi = lo;
+    int valid = (end != s);
+    if (valid && *end == ',') {
+        const char* p = end + 1;
+        hi = strtol(p, &end, 10);
+        valid = (end != p);
+    }
+    if (!valid || *end != '\0' || lo < 0 || hi < lo || hi > PATIENCE_MAX_MS) {
+        fprintf(stderr, CLR_CLIENT "[Klient] PIZZERIA_PATIENCE: ms albo min,max (0..%d), jest: %s\n" CLR_RESET,
+                PATIENCE_MAX_MS, s);
+        return 0;
+    }
+    return (int)(lo + ((hi > lo) ? rand() % (hi - lo + 1) : 0));
+}
+
+// Nastawia zegar cierpliwości (0 - wyłącza)
+static void armPatience(int ms) {
+    struct itimerval it;
+    it.it_value.tv_sec     = ms / 1000;
+    it.it_value.tv_usec    = (ms % 1000) * 1000;
+    it.it_interval.tv_sec  = 0;
+    it.it_interval.tv_usec = (ms > 0) ? PATIENCE_RETRY_MS * 1000 : 0;
+    setitimer(ITIMER_REAL, &it, NULL);
+}
+
+// Rezygnacja z czekania w kolejce (z numerem zapytania, którego dotyczy)
+static int sendCancel(Transport* link, const GroupOfClients* me) {
+    CommunicationMessage* msg = transportAcquire(link);
+    if (msg == NULL) {
+        return -1;
+    }
+    msg->mtype          = CANCEL_REQUEST;
+    msg->group          = *me;
+    msg->tableIndex     = -1;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        msg->orderedItems[i] = -1;
+    }
+    return transportCommit(link);
+}
+
+/**
+ * Czeka na odpowiedź kasjera z kodem first albo second; inne (spóźnione) odpowiedzi pomija.
+ * @return Otrzymany kod lub 0, gdy kasjer zamknął już transport (EIDRM).
+ */
+
+static int awaitCode(Transport* link, int first, int second) {
+    CommunicationMessage reply;
+    reply.tableIndex = NO_TABLE_FOUND;
+    do {
+        if (transportAwaitReply(link, &reply) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EIDRM) {
+                return 0;
+            }
+            perror(CLR_CLIENT "[Klient] Błąd odbioru odpowiedzi na zamówienie" CLR_RESET);
+            exit(1);
+        }
+    } while (reply.tableIndex != first && reply.tableIndex != second);
+    return reply.tableIndex;
 }
 
 /**
- * Sprawdza czy program klienta ma 1 argument:
- * <liczba_osób_w_grupie> (1..3).
- * Jeśli błędnie, wypisuje komunikat i exit(1).
+ * Sprawdza argumenty klienta: <liczba_osób_w_grupie> (1..GROUP_LIMIT) [chwila_uruchomienia_ns]
+ * albo, w puli klientów (PIZZERIA_LAUNCH=pool), -w <fd_przydziałów> <nr_pracownika>.
+ * Jeśli błędne, wypisuje komunikat i exit(1).
  *
  * @param argc liczba argumentów,
  * @param argv tablica argumentów.
  */
 
 static void usageCheck(int argc, char* argv[]) {
-    if (argc != 2) {
-        fprintf(stderr, CLR_CLIENT "Użycie: ./client_app <liczba_osób_w_grupie>\n" CLR_RESET);
+    if (argc == 4 && strcmp(argv[1], "-w") == 0) {
+        return;
+    }
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, CLR_CLIENT "Użycie: ./client_app <liczba_osób_w_grupie> [chwila_uruchomienia_ns]\n"
+                "       ./client_app -w <fd_przydziałów> <nr_pracownika>\n" CLR_RESET);
         exit(1);
     }
     int n = atoi(argv[1]);
-    if (n < 1 || n > 3) {
-        fprintf(stderr, CLR_CLIENT "Grupa może liczyć 1-3 osoby.\n" CLR_RESET);
+    if (n < 1 || n > GROUP_LIMIT) {
+        fprintf(stderr, CLR_CLIENT "Grupa może liczyć 1-%d osoby.\n" CLR_RESET, GROUP_LIMIT);
         exit(1);
     }
 }
 
 /**
- * Główna funkcja klienta (grupy 1-3 osób):
- * 1) Sprawdza argument (usageCheck).
- * 2) Ustawia handler SIGUSR1 (pożar).
- * 3) Dołącza do kolejki msgQueue utworzonej przez kasjera.
- * 4) Wysyła REQUEST_TABLE, czeka na odpowiedź:
- *    - NO_TABLE_FOUND => wychodzi,
+ * Obsługa jednej grupy od zapytania o stolik do wyjścia:
+ * 1) Dołącza do transportu kasjera (kolejka msgQueue lub pierścień w shm, PIZZERIA_TRANSPORT);
+ *    przy PIZZERIA_SHARDS > 1 kasjera wybiera shardForClient().
+ * 2) Wysyła REQUEST_TABLE, czeka na odpowiedź:
+ *    - NO_TABLE_FOUND => wychodzi (z SLO czekania - z szacunkiem, ile by czekała),
  *    - NEAR_CLOSING   => wychodzi,
+ *    - GROUP_QUEUED   => czeka dalej (szacowane czekanie w waitMs),
  *    - w przeciwnym razie otrzymuje tableIndex (>=0).
- * 5) Tworzy wątki (po 1 na osobę w grupie), każdy losuje pizzę.
- * 6) Wysyła SEND_ORDER z informacjami o zamówionych pizzach.
- * 7) Symuluje czas jedzenia (sleep).
- * 8) Wysyła LEAVE_TABLE, by zwolnić stolik.
- * 9) Kończy proces.
+ *    Z PIZZERIA_PATIENCE grupa czeka najwyżej tyle (albo krócej, gdy szacunek kasjera
+ *    jest dłuższy), wysyła CANCEL_REQUEST i odchodzi po GROUP_CANCELLED. Stolik
+ *    przydzielony, zanim kasjer przyjął rezygnację, grupa jednak zajmuje.
+ * 3) Każda osoba losuje pizzę do swojego miejsca w zamówieniu (order.h) - w osobnym
+ *    wątku, po kolei albo na puli wątków (PIZZERIA_CLIENT_THREADS).
+ * 4) Wysyła SEND_ORDER z informacjami o zamówionych pizzach i czeka na potwierdzenie:
+ *    ORDER_SERVED - je od razu, ORDER_COOKING (kuchnia kasjera) - czeka jeszcze na PIZZA_READY.
+ * 5) Symuluje czas jedzenia (sleep).
+ * 6) Wysyła LEAVE_TABLE, by zwolnić stolik.
  *
- * @param argc Liczba argumentów (powinno być 2).
- * @param argv [1] -> liczba osób w grupie (1..3).
- * @return 0 przy pomyślnym zakończeniu.
+ * @param groupSize Liczba osób w grupie.
+ * @return 0 lub -1 (kasjera już nie ma - nie ma po co czekać na kolejne grupy).
  */
 
-int main(int argc, char* argv[]) {
-    usageCheck(argc, argv);
-    srand(time(NULL));
-
-    // Obsługa sygnału pożaru
-    struct sigaction sa;
-    sa.sa_handler = handleFireSignal;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
-        perror(CLR_CLIENT "[Klient] Błąd sigaction() sygnału pożaru" CLR_RESET);
-        exit(1);
-    }
+static int serveGroup(int groupSize) {
+    pid_t myPid = getpid();
 
-    // Dołączenie do kolejki komunikatów
-    key_t msgKey = ftok(".", MSG_GEN_CHAR);
-    if (msgKey == -1) {
-        perror(CLR_CLIENT "[Klient] Błąd ftok() dla kolejki" CLR_RESET);
+    // Dołączenie do transportu kasjera (kolejka komunikatów lub pierścień w shm).
+    // Przy kilku kasjerach router wybiera tego, który ma miejsce i najmniej pracy.
+    Transport link;
+    if (transportOpen(&link, myPid, shardForClient(groupSize, myPid)) == -1) {
+        if (errno == ENOENT) {
+            return -1; // kasjer już usunął transport
+        }
+        perror(CLR_CLIENT "[Klient] Błąd dołączenia do transportu kasjera" CLR_RESET);
         exit(1);
     }
-    int msgId = accessMessageQueue(msgKey);
-
-    int groupSize = atoi(argv[1]);
-    pid_t myPid   = getpid();
 
-    // Wysyłamy zapytanie o stolik
-    CommunicationMessage req;
-    req.mtype = REQUEST_TABLE;
-    req.group.size = groupSize;
-    req.group.groupPID = myPid;
-    req.tableIndex = -1;
-    for (int i = 0; i < 3; i++) {
-        req.orderedItems[i] = -1;
+    // Wysyłamy zapytanie o stolik (budowane od razu w slocie transportu). Numer zapytania
+    // z zegara odróżnia je od wcześniejszych zapytań tego samego PID-u (pracownik puli,
+    // PID użyty ponownie przez system) - rezygnacja dotyczy tylko tego jednego.
+    LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Mamy %d osób i chcemy stolik.\n" CLR_RESET, (int)myPid, groupSize);
+    long long askedNs = monotonicNs();
+    GroupOfClients me = { groupSize, myPid, (int)(askedNs / 1000) };
+    CommunicationMessage* req = transportAcquire(&link);
+    if (req != NULL) {
+        req->mtype = REQUEST_TABLE;
+        req->group = me;
+        req->tableIndex = -1;
+        for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+            req->orderedItems[i] = -1;
+        }
     }
-
-    printf(CLR_CLIENT "[Grupa PID(%d)] Mamy %d osób i chcemy stolik.\n" CLR_RESET, (int)myPid, groupSize);
-    if (msgsnd(msgId, &req, sizeof(req) - sizeof(long), 0) == -1) {
+    if (req == NULL || transportCommit(&link) == -1) {
         if (errno == EIDRM || errno == EINVAL) {
-            exit(0); // kolejka usunięta
+            transportClose(&link);
+            return -1; // kolejka usunięta
         }
-        perror(CLR_CLIENT "[Klient] Błąd msgsnd() rezerwacji stolika" CLR_RESET);
+        perror(CLR_CLIENT "[Klient] Błąd wysłania rezerwacji stolika" CLR_RESET);
         exit(1);
     }
 
-    // Odbiór odpowiedzi
+    // Odbiór odpowiedzi (z SLO czekania najpierw GROUP_QUEUED z szacunkiem, potem stolik).
+    // Po CANCEL_REQUEST czekamy już tylko na ostateczną odpowiedź: GROUP_CANCELLED
+    // albo stolik / odmowę, które kasjer wysłał wcześniej.
+    int patienceMs = patienceFromEnv();
+    int cancelSent = 0;
+    patienceOut = 0;
+    armPatience(patienceMs);
     CommunicationMessage resp;
-    if (msgrcv(msgId, &resp, sizeof(resp) - sizeof(long), myPid, 0) == -1) {
-        if (errno == EIDRM) {
-            exit(0);
+    resp.tableIndex = GROUP_QUEUED;
+    do {
+        if (patienceOut && !cancelSent) {
+            armPatience(0);
+            cancelSent = 1;
+            LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Czekamy już %.1f s, rezygnujemy z kolejki.\n" CLR_RESET,
+                (int)myPid, (monotonicNs() - askedNs) / 1e9);
+            if (sendCancel(&link, &me) == -1) {
+                if (errno == EIDRM || errno == EINVAL) {
+                    transportClose(&link);
+                    return -1;
+                }
+                perror(CLR_CLIENT "[Klient] Błąd wysłania rezygnacji" CLR_RESET);
+                exit(1);
+            }
         }
-        perror(CLR_CLIENT "[Klient] Błąd msgrcv() stolik" CLR_RESET);
-        exit(1);
+        if (transportAwaitReply(&link, &resp) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            armPatience(0);
+            if (errno == EIDRM) {
+                transportClose(&link);
+                return -1;
+            }
+            perror(CLR_CLIENT "[Klient] Błąd odbioru odpowiedzi (stolik)" CLR_RESET);
+            exit(1);
+        }
+        if (resp.tableIndex == GROUP_QUEUED) {
+            LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Czekamy w kolejce, kasjer szacuje %.1f s.\n" CLR_RESET,
+                (int)myPid, resp.waitMs / 1000.0);
+            if (patienceMs > 0 && resp.waitMs > patienceMs) {
+                patienceOut = 1;  // nie wytrzymamy tyle - rezygnujemy od razu
+            }
+        }
+    } while (resp.tableIndex == GROUP_QUEUED);
+    armPatience(0);
+
+    if (resp.tableIndex == GROUP_CANCELLED) {
+        LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Odeszliśmy z kolejki po %.1f s czekania.\n" CLR_RESET,
+            (int)myPid, (monotonicNs() - askedNs) / 1e9);
+        transportClose(&link);
+        return 0;
+    } else if (cancelSent && resp.tableIndex >= 0) {
+        LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Stolik przyszedł przed rezygnacją - zostajemy.\n" CLR_RESET,
+            (int)myPid);
     }
 
-    if (resp.tableIndex == NO_TABLE_FOUND) {
-        printf(CLR_CLIENT "[Grupa PID(%d)] Zrezygnowaliśmy, kolejka za długa.\n" CLR_RESET, (int)myPid);
-        exit(0);
+    if (resp.tableIndex == NO_TABLE_FOUND && resp.waitMs > 0) {
+        LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Zrezygnowaliśmy, czekalibyśmy ok. %.1f s.\n" CLR_RESET,
+            (int)myPid, resp.waitMs / 1000.0);
+        transportClose(&link);
+        return 0;
+    } else if (resp.tableIndex == NO_TABLE_FOUND) {
+        LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Zrezygnowaliśmy, kolejka za długa.\n" CLR_RESET, (int)myPid);
+        transportClose(&link);
+        return 0;
     } else if (resp.tableIndex == NEAR_CLOSING) {
-        printf(CLR_CLIENT "[Grupa PID(%d)] Lokal się zamyka, odchodzimy.\n" CLR_RESET, (int)myPid);
-        exit(0);
-    }
-
-    // Ustawiamy wątki dla każdej osoby w grupie
-    if (pthread_mutex_init(&localMutex, NULL) != 0) {
-        perror(CLR_CLIENT "[Klient] Błąd pthread_mutex_init()" CLR_RESET);
-        exit(1);
-    }
-
-    int* myOrders = (int*)malloc(sizeof(int) * groupSize);
-    for (int i = 0; i < groupSize; i++) {
-        myOrders[i] = -1;
+        LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Lokal się zamyka, odchodzimy.\n" CLR_RESET, (int)myPid);
+        transportClose(&link);
+        return 0;
     }
 
+    // Każda osoba wybiera do własnego miejsca w zamówieniu, z własnym generatorem
+    int myOrders[MAX_GROUP_SIZE];
     GroupOrder go;
-    go.selection = myOrders;
-    go.count = groupSize;
-
-    pthread_t* threads = (pthread_t*)calloc(groupSize, sizeof(pthread_t));
-    for (int i = 0; i < groupSize; i++) {
-        if (pthread_create(&threads[i], NULL, singlePersonOrder, &go) != 0) { // tworzę wątki które wykonują funkcję singlePersonOrder()
-            perror(CLR_CLIENT "[Klient] Błąd pthread_create()" CLR_RESET);
-            exit(1);
-        }
-    }
-    for (int i = 0; i < groupSize; i++) {
-        if (pthread_join(threads[i], NULL) != 0) {
-            perror(CLR_CLIENT "[Klient] Błąd pthread_join()" CLR_RESET);
-            exit(1);
-        }
+    prepareGroupOrder(&go, myOrders, groupSize, menuPreferenceFromEnv(),
+                      (uint64_t)monotonicNs() ^ ((uint64_t)myPid << 32));
+    int mode = orderModeFromEnv();
+    OrderPool* pool = (mode == ORDER_POOL) ? processOrderPool() : NULL;
+    if (orderGroup(&go, (mode == ORDER_POOL && pool == NULL) ? ORDER_SPAWN : mode, pool) == -1) {
+        perror(CLR_CLIENT "[Klient] Błąd wątków zamówienia" CLR_RESET);
+        exit(1);
     }
 
     // Wysyłamy zamówienie do kasjera
-    CommunicationMessage orderMsg;
-    orderMsg.mtype = SEND_ORDER;
-    orderMsg.group.size = groupSize;
-    orderMsg.group.groupPID = myPid;
-    orderMsg.tableIndex = resp.tableIndex;
-
     double sumCost = 0.0;
+    CommunicationMessage* orderMsg = transportAcquire(&link);
+    if (orderMsg != NULL) {
+        orderMsg->mtype = SEND_ORDER;
+        orderMsg->group = me;
+        orderMsg->tableIndex = resp.tableIndex;
+        for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+            orderMsg->orderedItems[i] = (i < groupSize) ? myOrders[i] : -1;
+        }
+    }
     for (int i = 0; i < groupSize; i++) {
-        orderMsg.orderedItems[i] = myOrders[i];
         sumCost += pizzaMenu[myOrders[i]].cost;
     }
 
-    if (msgsnd(msgId, &orderMsg, sizeof(orderMsg) - sizeof(long), 0) == -1) {
-        perror(CLR_CLIENT "[Klient] Błąd msgsnd() zamówienie" CLR_RESET);
+    if (orderMsg == NULL || transportCommit(&link) == -1) {
+        perror(CLR_CLIENT "[Klient] Błąd wysłania zamówienia" CLR_RESET);
         exit(1);
     }
 
-    printf(CLR_CLIENT "[Grupa PID(%d)] Złożyliśmy zamówienie (%.2f zł) i zajmujemy stolik nr %d.\n" CLR_RESET,
-           (int)myPid, sumCost, resp.tableIndex);
+    LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Złożyliśmy zamówienie (%.2f zł) i zajmujemy stolik nr %d.\n" CLR_RESET,
+        (int)myPid, sumCost, resp.tableIndex);
+
+    // Kasjer mówi, czy zamówienie poszło do kuchni - wtedy jemy dopiero po PIZZA_READY
+    int served = awaitCode(&link, ORDER_SERVED, ORDER_COOKING);
+    if (served == ORDER_COOKING) {
+        served = awaitCode(&link, PIZZA_READY, PIZZA_READY);
+        if (served != 0) {
+            LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Pizza gotowa, zaczynamy jeść.\n" CLR_RESET, (int)myPid);
+        }
+    }
+    if (served == 0) {
+        transportClose(&link);
+        return -1;
+    }
 
     // Symulacja jedzenia
     int eatingDuration = rand() % 6 + 6;
     sleep(eatingDuration);
 
     // Zwalniamy stolik
-    CommunicationMessage leaveMsg;
-    leaveMsg.mtype = LEAVE_TABLE;
-    leaveMsg.group.size = groupSize;
-    leaveMsg.group.groupPID = myPid;
-    leaveMsg.tableIndex = resp.tableIndex;
-    for (int i = 0; i < 3; i++) {
-        leaveMsg.orderedItems[i] = -1;
+    CommunicationMessage* leaveMsg = transportAcquire(&link);
+    if (leaveMsg != NULL) {
+        leaveMsg->mtype = LEAVE_TABLE;
+        leaveMsg->group = me;
+        leaveMsg->tableIndex = resp.tableIndex;
+        for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+            leaveMsg->orderedItems[i] = -1;
+        }
     }
 
-    if (msgsnd(msgId, &leaveMsg, sizeof(leaveMsg) - sizeof(long), 0) == -1) {
+    if (leaveMsg == NULL || transportCommit(&link) == -1) {
         if (errno != EIDRM && errno != EINVAL) {
-            perror(CLR_CLIENT "[Klient] Błąd msgsnd() przy wychodzeniu" CLR_RESET);
+            perror(CLR_CLIENT "[Klient] Błąd wysłania wyjścia" CLR_RESET);
         }
     }
 
-    printf(CLR_CLIENT "[Grupa PID(%d)] Kończymy posiłek i zwalniamy stolik nr %d.\n" CLR_RESET,
-           (int)myPid, resp.tableIndex);
+    LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d)] Kończymy posiłek i zwalniamy stolik nr %d.\n" CLR_RESET,
+        (int)myPid, resp.tableIndex);
 
-    pthread_mutex_destroy(&localMutex);
-    free(myOrders);
-    free(threads);
+    transportClose(&link);
+    return 0;
+}
+
+/**
+ * Pracownik puli klientów: czeka na przydział (wielkość grupy) w potoku od managera,
+ * obsługuje grupę i melduje jej koniec; kolejne grupy mają ten sam PID. Koniec potoku
+ * (zamknięcie lokalu) albo brak kasjera kończą pracownika.
+ *
+ * @param fd Koniec potoku przydziałów do odczytu.
+ * @param slot Numer pracownika (w meldunkach).
+ */
 
+static void poolWorker(int fd, int slot) {
+    LaunchAssignment a;
+    ssize_t got;
+    while ((got = read(fd, &a, sizeof(a))) == (ssize_t)sizeof(a) || (got == -1 && errno == EINTR)) {
+        if (got == -1) {
+            continue;
+        }
+        launchNotify(LAUNCH_NOTE_READY, slot, a.launchNs);
+        int rc = serveGroup(a.size);
+        launchNotify(LAUNCH_NOTE_DONE, slot, 0);
+        if (rc == -1) {
+            break;
+        }
+    }
+    close(fd);
+}
+
+/**
+ * Główna funkcja klienta (grupy 1..GROUP_LIMIT osób):
+ * 1) Sprawdza argumenty (usageCheck).
+ * 2) Ustawia handler SIGUSR1 (pożar) i SIGALRM (cierpliwość w kolejce).
+ * 3) Melduje managerowi opóźnienie startu (launch.h) i obsługuje grupę (serveGroup)
+ *    albo, z -w, jako pracownik puli obsługuje kolejne przydzielone grupy.
+ *
+ * @param argc Liczba argumentów.
+ * @param argv [1] -> liczba osób w grupie (1..GROUP_LIMIT), [2] -> chwila uruchomienia [ns]
+ *             albo -w <fd_przydziałów> <nr_pracownika>.
+ * @return 0 przy pomyślnym zakończeniu.
+ */
+
+int main(int argc, char* argv[]) {
+    usageCheck(argc, argv);
+    srand(time(NULL) ^ getpid());
+
+    // Obsługa sygnału pożaru
+    struct sigaction sa;
+    sa.sa_handler = handleFireSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;
+    if (sigaction(SIGUSR1, &sa, NULL) == -1) {
+        perror(CLR_CLIENT "[Klient] Błąd sigaction() sygnału pożaru" CLR_RESET);
+        exit(1);
+    }
+    // Zegar cierpliwości w kolejce (PIZZERIA_PATIENCE)
+    sa.sa_handler = handlePatience;
+    if (sigaction(SIGALRM, &sa, NULL) == -1) {
+        perror(CLR_CLIENT "[Klient] Błąd sigaction() zegara cierpliwości" CLR_RESET);
+        exit(1);
+    }
+
+    if (argc == 4) {
+        poolWorker(atoi(argv[2]), atoi(argv[3]));
+    } else {
+        launchNotify(LAUNCH_NOTE_READY, -1, (argc == 3) ? atoll(argv[2]) : 0);
+        serveGroup(atoi(argv[1]));
+    }
+    if (orderPool != NULL) {
+        orderPoolDestroy(orderPool);
+    }
     return 0;
 }
@@ -0,0 +1,393 @@
+#include "des.h"
+#include "order.h"
+#include <string.h>
+
+#define EV_ARRIVAL        0  // przychodzi nowa grupa (manager)
+#define EV_REPLY          1  // grupa dostaje odpowiedź kasjera
+#define EV_LEAVE          2  // grupa skończyła jeść
+#define EV_CLOSE_WARNING  3  // SIGUSR2 od managera
+#define EV_CLOSE          4  // koniec przyjmowania (forcedFinish kasjera)
+#define EV_FIRE           5  // SIGUSR1 od strażaka
+#define EV_KITCHEN        6  // koniec pieczenia wsadu (kitchen.c)
+
+typedef struct {
+    long long      time;
+    unsigned long  seq;        // rozstrzyga remisy - kolejność planowania
+    int            type;
+    int            tableIndex;
+    GroupOfClients group;
+} DesEvent;
+
+// Zamówienie czekające przy kasie na miejsce w kolejce przygotowania
+typedef struct {
+    CommunicationMessage order;
+    long long            orderedNs;
+} ParkedOrder;
+
+typedef struct {
+    DesEvent*          heap;
+    int                count;
+    int                capacity;
+    unsigned long      nextSeq;
+    long long          now;
+    long long          nowNs;      // now w ns - zegar statystyk zmiany
+    unsigned long long rng;
+    Restaurant         hall;
+    int                activeGroups;
+    int                closed;
+    DesResult*         out;
+    ArrivalModel*      arrivals;
+    Arrival            pending;    // grupa, której przybycie jest zaplanowane (model przybyć)
+    const MenuPreference* menu;    // wybór pizzy jak u klienta (PIZZERIA_MENU_WEIGHTS)
+    Kitchen*           kitchen;    // NULL - bez kuchni
+    Kitchen            kitchenState;
+    Admission          admission;
+    long long          kitchenAt;  // zaplanowane EV_KITCHEN [us] albo -1
+    ParkedOrder*       parked;     // zamówienia czekające na miejsce w kolejce przygotowania
+    int                parkedCount;
+    int                parkedCap;
+} DesState;
+
+static unsigned int desRandom(DesState* s) {
+    s->rng ^= s->rng >> 12;
+    s->rng ^= s->rng << 25;
+    s->rng ^= s->rng >> 27;
+    return (unsigned int)((s->rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static int eventBefore(const DesEvent* a, const DesEvent* b) {
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+static void schedule(DesState* s, long long at, int type, const GroupOfClients* g, int tableIndex) {
+    if (s->count == s->capacity) {
+        s->capacity = s->capacity ? s->capacity * 2 : 256;
+        s->heap = (DesEvent*)realloc(s->heap, sizeof(DesEvent) * s->capacity);
+        if (!s->heap) {
+            perror("[des.c] Błąd realloc() kolejki zdarzeń");
+            exit(1);
+        }
+    }
+    DesEvent ev;
+    ev.time       = at;
+    ev.seq        = s->nextSeq++;
+    ev.type       = type;
+    ev.tableIndex = tableIndex;
+    if (g) {
+        ev.group = *g;
+    } else {
+        ev.group.size     = 0;
+        ev.group.groupPID = 0;
+    }
+    int i = s->count++;
+    while (i > 0 && eventBefore(&ev, &s->heap[(i - 1) / 2])) {
+        s->heap[i] = s->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    s->heap[i] = ev;
+}
+
+static DesEvent popEvent(DesState* s) {
+    DesEvent top  = s->heap[0];
+    DesEvent last = s->heap[--s->count];
+    int i = 0;
+    while (2 * i + 1 < s->count) {
+        int c = 2 * i + 1;
+        if (c + 1 < s->count && eventBefore(&s->heap[c + 1], &s->heap[c])) {
+            c++;
+        }
+        if (!eventBefore(&s->heap[c], &last)) {
+            break;
+        }
+        s->heap[i] = s->heap[c];
+        i = c;
+    }
+    s->heap[i] = last;
+    return top;
+}
+
+/**
+ * Funkcja zwrotna logiki sali: odpowiedź kasjera dociera do grupy natychmiast
+ * (w tej samej chwili wirtualnej, po zdarzeniach już zaplanowanych).
+ */
+
+static void replyAsEvent(void* ctx, const GroupOfClients* g, int tableIndex, int waitMs) {
+    (void)waitMs;
+    if (tableIndex == GROUP_QUEUED) {
+        return; // grupa i tak czeka na stolik
+    }
+    DesState* s = (DesState*)ctx;
+    schedule(s, s->now, EV_REPLY, g, tableIndex);
+}
+
+static void mixChecksum(DesResult* r, const DesEvent* ev) {
+    unsigned long long parts[4] = { (unsigned long long)ev->time, (unsigned long long)ev->type,
+                                    (unsigned long long)ev->group.groupPID, (unsigned long long)(ev->tableIndex + 3) };
+    for (int i = 0; i < 4; i++) {
+        r->checksum = (r->checksum ^ parts[i]) * 1099511628211UL;
+    }
+}
+
+// Grupa zaczyna jeść: wyjście po 6-11 s
+static void startEating(DesState* s, const GroupOfClients* g, int tableIndex) {
+    long long eating = (desRandom(s) % 6 + 6) * DES_USEC;
+    schedule(s, s->now + eating, EV_LEAVE, g, tableIndex);
+}
+
+/**
+ * Funkcja zwrotna kuchni: PIZZA_READY - grupa zaczyna jeść w tej samej chwili wirtualnej.
+ */
+
+static void servedAsEvent(void* ctx, const GroupOfClients* g, int tableIndex) {
+    startEating((DesState*)ctx, g, tableIndex);
+}
+
+/**
+ * Planuje EV_KITCHEN na koniec najbliższego wsadu (o ile nie jest już zaplanowane wcześniej).
+ */
+
+static void wakeKitchen(DesState* s, long long nextNs) {
+    if (nextNs < 0) {
+        return;
+    }
+    long long at = nextNs / 1000;
+    if (s->kitchenAt < 0 || at < s->kitchenAt) {
+        s->kitchenAt = at;
+        schedule(s, at, EV_KITCHEN, NULL, 0);
+    }
+}
+
+/**
+ * Zamówienie do kuchni; gdy kolejka przygotowania jest pełna (albo czekają już
+ * wcześniejsze), czeka przy kasie - w kolejności zamówień.
+ */
+
+static void orderToKitchen(DesState* s, const CommunicationMessage* order) {
+    if (s->parkedCount == 0 && kitchenSubmit(s->kitchen, order, s->nowNs, s->nowNs) == 0) {
+        wakeKitchen(s, kitchenAdvance(s->kitchen, s->nowNs));
+        return;
+    }
+    if (s->parkedCount == s->parkedCap) {
+        s->parkedCap = s->parkedCap ? s->parkedCap * 2 : 64;
+        s->parked = (ParkedOrder*)realloc(s->parked, sizeof(ParkedOrder) * s->parkedCap);
+        if (!s->parked) {
+            perror("[des.c] Błąd realloc() zamówień czekających na kuchnię");
+            exit(1);
+        }
+    }
+    s->parked[s->parkedCount].order     = *order;
+    s->parked[s->parkedCount].orderedNs = s->nowNs;
+    s->parkedCount++;
+}
+
+/**
+ * EV_KITCHEN: wyjmuje upieczone wsady, wpuszcza czekające zamówienia
+ * do zwolnionej kolejki i planuje kolejne zdarzenie kuchni.
+ */
+
+static void onKitchen(DesState* s, const DesEvent* ev) {
+    if (ev->time == s->kitchenAt) {
+        s->kitchenAt = -1;
+    }
+    kitchenAdvance(s->kitchen, s->nowNs);
+    int taken = 0;
+    while (taken < s->parkedCount) {
+        const ParkedOrder* p = &s->parked[taken];
+        if (kitchenSubmit(s->kitchen, &p->order, p->orderedNs, s->nowNs) == -1) {
+            break;
+        }
+        kitchenStalled(s->kitchen, s->nowNs - p->orderedNs);
+        taken++;
+    }
+    if (taken > 0) {
+        memmove(s->parked, s->parked + taken, sizeof(ParkedOrder) * (s->parkedCount - taken));
+        s->parkedCount -= taken;
+    }
+    wakeKitchen(s, kitchenAdvance(s->kitchen, s->nowNs));
+}
+
+/**
+ * Grupa z odpowiedzią: przy stoliku zamawia (każda osoba losuje pizzę)
+ * i planuje wyjście po 6-11 s jedzenia - z kuchnią dopiero po upieczeniu pizz;
+ * odprawiona po prostu wychodzi.
+ */
+
+static void onReply(DesState* s, const DesEvent* ev) {
+    if (ev->tableIndex < 0) {
+        s->out->groupsTurnedAway++;
+        s->activeGroups--;
+        return;
+    }
+    s->out->groupsSeated++;
+    CommunicationMessage order;
+    order.mtype      = SEND_ORDER;
+    order.group      = ev->group;
+    order.tableIndex = ev->tableIndex;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        order.orderedItems[i] = (i < ev->group.size) ? menuPick(s->menu, desRandom(s)) : -1;
+    }
+    handleOrder(&s->hall, &order);
+    if (s->kitchen != NULL) {
+        orderToKitchen(s, &order);
+        return;
+    }
+    startEating(s, &ev->group, ev->tableIndex);
+}
+
+/**
+ * Przyjście grupy 1..GROUP_LIMIT osobowej (o ile aktywnych jest mniej niż MAX_CUSTOMERS)
+ * i zaplanowanie kolejnej za 0.5-1.5 s (albo z modelu przybyć), dopóki lokal nie jest zamknięty.
+ */
+
+static void onArrival(DesState* s, int* nextPid) {
+    if (s->activeGroups < MAX_CUSTOMERS) {
+        GroupOfClients g;
+        g.size     = s->arrivals ? s->pending.size : (int)(desRandom(s) % GROUP_LIMIT) + 1;
+        g.groupPID = (pid_t)(*nextPid)++;
+        s->activeGroups++;
+        s->out->groupsArrived++;
+        handleTableRequest(&s->hall, &g);
+    }
+    if (s->arrivals) {
+        if (arrivalsNext(s->arrivals, &s->pending) && s->pending.atUs < RUNTIME_LIMIT * DES_USEC) {
+            schedule(s, s->pending.atUs, EV_ARRIVAL, NULL, 0);
+        }
+        return;
+    }
+    long long pause = (long long)(desRandom(s) % 1001 + 500) * 1000;
+    if (s->now + pause < RUNTIME_LIMIT * DES_USEC) {
+        schedule(s, s->now + pause, EV_ARRIVAL, NULL, 0);
+    }
+}
+
+/**
+ * Symuluje jeden dzień pizzerii w czasie wirtualnym.
+ * Dzień kończy się, gdy po zamknięciu wyjdzie ostatnia grupa albo wybuchnie pożar.
+ *
+ * @param cfg Konfiguracja sali i ziarno generatora.
+ * @param out Wyniki dnia (statystyki jak w daily_report.txt i skrót przebiegu).
+ */
+
+void runDesDay(const DesConfig* cfg, DesResult* out) {
+    DesState s;
+    memset(&s, 0, sizeof(s));
+    memset(out, 0, sizeof(*out));
+    out->fireTime = -1;
+    out->checksum = 14695981039346656037UL;
+    s.out = out;
+    s.rng = cfg->seed ? cfg->seed : 0x9E3779B97F4A7C15ULL;
+    s.menu = menuPreferenceFromEnv();
+
+    DiningTable* tables = (DiningTable*)calloc(tableCountFor(cfg->perCapacity), sizeof(DiningTable));
+    if (!tables) {
+        perror("[des.c] Błąd calloc() stolików");
+        exit(1);
+    }
+    initRestaurant(&s.hall, tables, cfg->perCapacity, cfg->queueLimit, replyAsEvent, &s);
+    if (cfg->policy != NULL) {
+        s.hall.policy = cfg->policy;
+    }
+    if (cfg->stats != NULL) {
+        statsUseClock(cfg->stats, &s.nowNs);
+        s.hall.stats = cfg->stats;
+    }
+    if (cfg->sloMs > 0) {
+        if (admissionInit(&s.admission, cfg->perCapacity, cfg->queueLimit, cfg->sloMs, cfg->sloEnforce) == -1) {
+            perror("[des.c] Błąd przygotowania szacowania czekania");
+            exit(1);
+        }
+        admissionUseClock(&s.admission, &s.nowNs);
+        s.hall.admission = &s.admission;
+    }
+    s.kitchenAt = -1;
+    if (cfg->kitchen != NULL && cfg->kitchen->ovens > 0) {
+        if (kitchenInit(&s.kitchenState, cfg->kitchen, servedAsEvent, &s, 0) == -1) {
+            perror("[des.c] Błąd przygotowania kuchni");
+            exit(1);
+        }
+        s.kitchen = &s.kitchenState;
+    }
+
+    long long warnAt = (RUNTIME_LIMIT - TIME_BEFORE_CLOSE) * DES_USEC;
+    if (cfg->arrivals) {
+        // Model przybyć ma własny generator, ziarno dnia przechodzi i na niego
+        s.arrivals = cfg->arrivals;
+        arrivalsReset(s.arrivals, s.rng ^ 0xA5A5A5A5A5A5A5A5ULL);
+        if (arrivalsNext(s.arrivals, &s.pending) && s.pending.atUs < RUNTIME_LIMIT * DES_USEC) {
+            schedule(&s, s.pending.atUs, EV_ARRIVAL, NULL, 0);
+        }
+    } else {
+        schedule(&s, 0, EV_ARRIVAL, NULL, 0);
+    }
+    schedule(&s, warnAt, EV_CLOSE_WARNING, NULL, 0);
+    schedule(&s, warnAt + TIME_BEFORE_CLOSE * DES_USEC, EV_CLOSE, NULL, 0);
+    if (cfg->withFire) {
+        schedule(&s, (long long)(desRandom(&s) % 35 + 10) * DES_USEC, EV_FIRE, NULL, 0);
+    }
+
+    int nextPid = 1;
+    while (s.count > 0 && !(s.closed && s.activeGroups == 0)) {
+        DesEvent ev = popEvent(&s);
+        s.now   = ev.time;
+        s.nowNs = ev.time * 1000;
+        out->events++;
+        mixChecksum(out, &ev);
+
+        switch (ev.type) {
+        case EV_ARRIVAL:
+            onArrival(&s, &nextPid);
+            break;
+        case EV_REPLY:
+            onReply(&s, &ev);
+            break;
+        case EV_LEAVE:
+            handleLeave(&s.hall, ev.tableIndex, &ev.group);
+            s.activeGroups--;
+            break;
+        case EV_CLOSE_WARNING:
+            s.hall.closing = 1;
+            announceClosing(&s.hall);
+            break;
+        case EV_CLOSE:
+            s.closed = 1;
+            break;
+        case EV_KITCHEN:
+            onKitchen(&s, &ev);
+            break;
+        case EV_FIRE:
+            // Klienci uciekają, niczego więcej już nie obsługujemy
+            out->fireTime = s.now;
+            s.count = 0;
+            break;
+        }
+    }
+
+    if (s.kitchen != NULL) {
+        kitchenFinish(s.kitchen, s.nowNs);
+        out->kitchen = s.kitchen->summary;
+        if (cfg->stats != NULL) {
+            cfg->stats->summary.kitchen = s.kitchen->summary;
+        }
+        kitchenDestroy(s.kitchen);
+    }
+    if (s.hall.admission != NULL) {
+        admissionFinish(&s.admission);
+        out->admission = s.admission.summary;
+        if (cfg->stats != NULL) {
+            cfg->stats->summary.admission = s.admission.summary;
+        }
+        admissionDestroy(&s.admission);
+    }
+    if (cfg->stats != NULL) {
+        statsFinish(cfg->stats);
+    }
+    out->endTime      = s.now;
+    out->totalRevenue = s.hall.totalRevenue;
+    out->totalClients = s.hall.totalClients;
+    memcpy(out->soldItems, s.hall.soldItems, sizeof(out->soldItems));
+
+    destroyRestaurant(&s.hall);
+    free(tables);
+    free(s.heap);
+    free(s.parked);
+}
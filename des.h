@@ -0,0 +1,52 @@
+#ifndef DES_H
+#define DES_H
+
+#include "restaurant.h"
+#include "arrivals.h"
+#include "kitchen.h"
+
+// --------------------- Symulacja zdarzeń dyskretnych ---------------------
+//
+// Cały dzień pizzerii w czasie wirtualnym: przyjście grupy, odpowiedź kasjera,
+// koniec jedzenia, ostrzeżenie o zamknięciu, zamknięcie i pożar są zdarzeniami
+// w kolejce priorytetowej (czas, numer kolejny). Losowość pochodzi z jednego
+// generatora o podanym ziarnie, więc ten sam seed daje identyczny przebieg.
+// Czasy losowane są z tych samych rozkładów co w manager.c, client.c i fireman.c;
+// przybycia - z modelu arrivals.c, jeśli podano go w konfiguracji (inaczej jak "uniform").
+// Z kuchnią (kitchen.c) grupa zaczyna jeść dopiero po upieczeniu jej pizz; zamówienie,
+// które nie mieści się w kolejce przygotowania, czeka przy kasie na kolejny wsad.
+// Z SLO czekania (admission.c) sala szacuje czekanie w czasie wirtualnym.
+
+#define DES_USEC 1000000LL  // jednostka czasu wirtualnego: mikrosekunda
+
+typedef struct {
+    int                perCapacity[MAX_TABLE_CAPACITY];
+    int                queueLimit;
+    unsigned long long seed;
+    int                withFire;        // 0 - dzień bez strażaka
+    ArrivalModel*      arrivals;        // NULL - wbudowany rozkład managera (przebiegi jak dotąd)
+    const SeatPolicy*  policy;          // NULL - z PIZZERIA_SEATING
+    ShiftStats*        stats;           // NULL - bez statystyk; inaczej po statsInit, liczone w czasie wirtualnym
+    const KitchenConfig* kitchen;       // NULL lub 0 pieców - bez kuchni (jedzenie zaraz po zamówieniu)
+    int                sloMs;           // 0 - tylko limit kolejki; inaczej szacowanie czekania (admission.c)
+    int                sloEnforce;      // 1 - odmowa ponad SLO, 0 - SLO tylko mierzone
+} DesConfig;
+
+typedef struct {
+    long long      endTime;             // czas wirtualny ostatniego zdarzenia [us]
+    long long      fireTime;            // -1, jeśli pożaru nie było
+    long           events;
+    int            groupsArrived;
+    int            groupsSeated;
+    int            groupsTurnedAway;
+    int            soldItems[MENU_SIZE];
+    double         totalRevenue;
+    int            totalClients;
+    unsigned long  checksum;            // skrót przebiegu (kolejność i treść zdarzeń)
+    KitchenSummary kitchen;             // ovens == 0 - dzień bez kuchni
+    AdmissionSummary admission;         // sloMs == 0 - dzień bez szacowania czekania
+} DesResult;
+
+void runDesDay(const DesConfig* cfg, DesResult* out);
+
+#endif // DES_H
@@ -0,0 +1,838 @@
+#include "pizzeria.h"
+#include "restaurant.h"
+#include "des.h"
+#include "logger.h"
+#include <string.h>
+#include <getopt.h>
+
+// --------------------- Silnik symulacji w jednym procesie ---------------------
+//
+// Grupy klientów są lekkimi zadaniami (GroupTask) wykonywanymi przez stałą pulę
+// wątków. Zamiast kolejki komunikatów SysV zadania wysyłają CommunicationMessage
+// do skrzynki kasjera w pamięci, a wątek kasjera obsługuje je tą samą logiką
+// sali (restaurant.c) co cashier_app. Odpowiedź kasjera wznawia zadanie.
+
+#define TASK_NEW        0  // grupa właśnie przyszła
+#define TASK_WAITING    1  // czeka na odpowiedź kasjera (stolik lub kolejka)
+#define TASK_SEATED     2  // dostała stolik - zamawia
+#define TASK_EATING     3  // je (czeka w timerze)
+#define TASK_REJECTED   4  // odprawiona (kolejka pełna / zamykamy)
+
+typedef struct GroupTask {
+    GroupOfClients      group;
+    int                 state;
+    int                 tableIndex;
+    unsigned long long  rng;
+    long long           wakeAt;     // koniec jedzenia [ns, CLOCK_MONOTONIC]
+    struct GroupTask*   next;
+} GroupTask;
+
+typedef struct {
+    GroupTask*      head;
+    GroupTask*      tail;
+    pthread_mutex_t lock;
+    pthread_cond_t  ready;
+} TaskQueue;
+
+typedef struct {
+    CommunicationMessage* slots;
+    int                   capacity;
+    int                   head;
+    int                   count;
+    pthread_mutex_t       lock;
+    pthread_cond_t        ready;
+} CashierInbox;
+
+typedef struct {
+    GroupTask**     heap;       // kopiec minimalny po wakeAt
+    int             count;
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+} EatingTimer;
+
+typedef struct {
+    // Konfiguracja
+    long            groups;
+    int             workers;
+    int             maxInFlight;
+    long            eatMicros;
+    unsigned long long seed;
+
+    // Zadania
+    GroupTask*      tasks;      // groupPID = indeks + 1
+    GroupTask*      freeTasks;
+    pthread_mutex_t poolLock;
+    pthread_cond_t  poolChanged;
+    long            finished;
+    long            seated;
+    long            rejected;
+
+    TaskQueue       runQueue;
+    CashierInbox    inbox;
+    EatingTimer     timer;
+    Restaurant      hall;
+    int             stop;
+} Engine;
+
+static long long nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static unsigned int taskRandom(GroupTask* t) {
+    t->rng ^= t->rng << 13;
+    t->rng ^= t->rng >> 7;
+    t->rng ^= t->rng << 17;
+    return (unsigned int)(t->rng >> 11);
+}
+
+// --------------------- Kolejka zadań gotowych ---------------------
+
+static void pushTask(TaskQueue* q, GroupTask* t) {
+    t->next = NULL;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail) {
+        q->tail->next = t;
+    } else {
+        q->head = t;
+    }
+    q->tail = t;
+    pthread_cond_signal(&q->ready);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * Pobiera zadanie do wykonania; zwraca NULL, gdy silnik się zatrzymuje.
+ */
+
+static GroupTask* popTask(Engine* e) {
+    TaskQueue* q = &e->runQueue;
+    pthread_mutex_lock(&q->lock);
+    while (q->head == NULL && !e->stop) {
+        pthread_cond_wait(&q->ready, &q->lock);
+    }
+    GroupTask* t = q->head;
+    if (t) {
+        q->head = t->next;
+        if (q->head == NULL) {
+            q->tail = NULL;
+        }
+    }
+    pthread_mutex_unlock(&q->lock);
+    return t;
+}
+
+// --------------------- Skrzynka kasjera ---------------------
+
+static void sendToCashier(Engine* e, long type, const GroupTask* t, const int* orders) {
+    CashierInbox* in = &e->inbox;
+    pthread_mutex_lock(&in->lock);
+    CommunicationMessage* msg = &in->slots[(in->head + in->count) % in->capacity];
+    msg->mtype      = type;
+    msg->group      = t->group;
+    msg->tableIndex = t->tableIndex;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        msg->orderedItems[i] = (orders && i < t->group.size) ? orders[i] : -1;
+    }
+    in->count++;
+    pthread_cond_signal(&in->ready);
+    pthread_mutex_unlock(&in->lock);
+}
+
+/**
+ * Funkcja zwrotna logiki sali - wznawia zadanie grupy, do której odpowiedział kasjer.
+ */
+
+static void replyToTask(void* ctx, const GroupOfClients* g, int tableIndex, int waitMs) {
+    (void)waitMs;
+    if (tableIndex == GROUP_QUEUED) {
+        return;
+    }
+    Engine* e = (Engine*)ctx;
+    GroupTask* t = &e->tasks[g->groupPID - 1];
+    t->tableIndex = tableIndex;
+    t->state      = (tableIndex >= 0) ? TASK_SEATED : TASK_REJECTED;
+    pushTask(&e->runQueue, t);
+}
+
+/**
+ * Wątek kasjera: zabiera ze skrzynki wszystkie czekające komunikaty naraz
+ * i obsługuje je po kolei. Tylko ten wątek dotyka stanu sali.
+ */
+
+static void* cashierThread(void* arg) {
+    Engine* e = (Engine*)arg;
+    CashierInbox* in = &e->inbox;
+    CommunicationMessage* batch = (CommunicationMessage*)malloc(sizeof(CommunicationMessage) * in->capacity);
+
+    while (1) {
+        pthread_mutex_lock(&in->lock);
+        while (in->count == 0 && !e->stop) {
+            pthread_cond_wait(&in->ready, &in->lock);
+        }
+        if (in->count == 0) {
+            pthread_mutex_unlock(&in->lock);
+            break;
+        }
+        int n = in->count;
+        for (int i = 0; i < n; i++) {
+            batch[i] = in->slots[(in->head + i) % in->capacity];
+        }
+        in->head  = (in->head + n) % in->capacity;
+        in->count = 0;
+        pthread_mutex_unlock(&in->lock);
+
+        for (int i = 0; i < n; i++) {
+            switch (batch[i].mtype) {
+            case REQUEST_TABLE:
+                handleTableRequest(&e->hall, &batch[i].group);
+                break;
+            case SEND_ORDER:
+                handleOrder(&e->hall, &batch[i]);
+                break;
+            case LEAVE_TABLE:
+                handleLeave(&e->hall, batch[i].tableIndex, &batch[i].group);
+                break;
+            }
+        }
+    }
+    free(batch);
+    return NULL;
+}
+
+// --------------------- Timer jedzenia ---------------------
+
+static void timerAdd(EatingTimer* tm, GroupTask* t) {
+    pthread_mutex_lock(&tm->lock);
+    int i = tm->count++;
+    while (i > 0 && tm->heap[(i - 1) / 2]->wakeAt > t->wakeAt) {
+        tm->heap[i] = tm->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    tm->heap[i] = t;
+    if (i == 0) {
+        pthread_cond_signal(&tm->changed);
+    }
+    pthread_mutex_unlock(&tm->lock);
+}
+
+static GroupTask* timerPopLocked(EatingTimer* tm) {
+    GroupTask* top  = tm->heap[0];
+    GroupTask* last = tm->heap[--tm->count];
+    int i = 0;
+    while (2 * i + 1 < tm->count) {
+        int c = 2 * i + 1;
+        if (c + 1 < tm->count && tm->heap[c + 1]->wakeAt < tm->heap[c]->wakeAt) {
+            c++;
+        }
+        if (last->wakeAt <= tm->heap[c]->wakeAt) {
+            break;
+        }
+        tm->heap[i] = tm->heap[c];
+        i = c;
+    }
+    tm->heap[i] = last;
+    return top;
+}
+
+/**
+ * Wątek timera: przenosi grupy, które skończyły jeść, z powrotem do kolejki zadań.
+ */
+
+static void* timerThread(void* arg) {
+    Engine* e = (Engine*)arg;
+    EatingTimer* tm = &e->timer;
+    pthread_mutex_lock(&tm->lock);
+    while (!e->stop) {
+        if (tm->count == 0) {
+            pthread_cond_wait(&tm->changed, &tm->lock);
+            continue;
+        }
+        long long now = nowNanos();
+        if (tm->heap[0]->wakeAt <= now) {
+            GroupTask* t = timerPopLocked(tm);
+            pushTask(&e->runQueue, t);
+            continue;
+        }
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        long long wait = tm->heap[0]->wakeAt - now + until.tv_nsec;
+        until.tv_sec  += wait / 1000000000LL;
+        until.tv_nsec  = wait % 1000000000LL;
+        pthread_cond_timedwait(&tm->changed, &tm->lock, &until);
+    }
+    pthread_mutex_unlock(&tm->lock);
+    return NULL;
+}
+
+// --------------------- Wątki grup ---------------------
+
+static void finishTask(Engine* e, GroupTask* t, int wasSeated) {
+    pthread_mutex_lock(&e->poolLock);
+    if (wasSeated) {
+        e->seated++;
+    } else {
+        e->rejected++;
+    }
+    e->finished++;
+    t->next      = e->freeTasks;
+    e->freeTasks = t;
+    pthread_cond_broadcast(&e->poolChanged);
+    pthread_mutex_unlock(&e->poolLock);
+}
+
+/**
+ * Wątek roboczy: wykonuje kolejny krok zadania grupy, aż zadanie musi
+ * poczekać na kasjera lub timer.
+ */
+
+static void* workerThread(void* arg) {
+    Engine* e = (Engine*)arg;
+    GroupTask* t;
+    while ((t = popTask(e)) != NULL) {
+        switch (t->state) {
+        case TASK_NEW:
+            t->state = TASK_WAITING;
+            sendToCashier(e, REQUEST_TABLE, t, NULL);
+            break;
+
+        case TASK_SEATED: {
+            int orders[MAX_GROUP_SIZE];
+            for (int i = 0; i < t->group.size; i++) {
+                orders[i] = taskRandom(t) % MENU_SIZE;
+            }
+            sendToCashier(e, SEND_ORDER, t, orders);
+            if (e->eatMicros > 0) {
+                t->state  = TASK_EATING;
+                t->wakeAt = nowNanos() + (long long)(taskRandom(t) % (e->eatMicros + 1) + e->eatMicros / 2) * 1000;
+                timerAdd(&e->timer, t);
+                break;
+            }
+            sendToCashier(e, LEAVE_TABLE, t, NULL);
+            finishTask(e, t, 1);
+            break;
+        }
+
+        case TASK_EATING:
+            sendToCashier(e, LEAVE_TABLE, t, NULL);
+            finishTask(e, t, 1);
+            break;
+
+        case TASK_REJECTED:
+            finishTask(e, t, 0);
+            break;
+        }
+    }
+    return NULL;
+}
+
+// --------------------- Uruchomienie ---------------------
+
+static void usage(void) {
+    fprintf(stderr, "Użycie: ./engine_app [-n grupy] [-w wątki] [-f grup_naraz] [-e jedzenie_us] "
+                    "[-q limit_kolejki] [-s ziarno] [-p polityka] x1 ... x%d\n"
+                    "        ./engine_app -d dni [-F] [-P] [-K piece] [-A slo_ms] [-q limit_kolejki] [-s ziarno] [-p polityka]\n"
+                    "                     [-k kuchnia] [-a slo_ms] x1 ... x%d\n"
+                    "        (polityka sadzania: first, best, match, lookahead; -P - porównanie wszystkich;\n"
+                    "         kuchnia: piece[,wsad[,kolejka]] jak PIZZERIA_KITCHEN, tylko z -d; -K - kuchnie 1..piece;\n"
+                    "         -a - SLO czekania jak PIZZERIA_ADMISSION; -A - SLO a stały limit kolejki)\n",
+            MAX_TABLE_CAPACITY, MAX_TABLE_CAPACITY);
+    exit(1);
+}
+
+/**
+ * Tryb zdarzeń dyskretnych: "days" kolejnych dni w czasie wirtualnym
+ * (dzień i ma ziarno seed + i). Dla jednego dnia wypisuje pełny raport,
+ * dla wielu - sumy i liczbę dni na sekundę.
+ */
+
+static void runDesMode(const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit,
+                       unsigned long long seed, long days, int withFire) {
+    DesConfig cfg;
+    memcpy(cfg.perCapacity, perCapacity, sizeof(cfg.perCapacity));
+    cfg.queueLimit = queueLimit;
+    cfg.withFire   = withFire;
+    cfg.arrivals   = NULL;
+    cfg.policy     = NULL;
+    cfg.stats      = NULL;
+    cfg.kitchen    = NULL;
+
+    // Kuchnia jak u kasjera (PIZZERIA_KITCHEN); bez niej przebiegi jak dotąd
+    KitchenConfig kitchen;
+    if (kitchenConfigFromEnv(&kitchen) == -1) {
+        exit(1);
+    }
+    if (kitchen.ovens > 0) {
+        cfg.kitchen = &kitchen;
+    }
+    // Przyjmowanie grup wg szacowanego czekania (PIZZERIA_ADMISSION)
+    if (admissionConfigFromEnv(&cfg.sloMs) == -1) {
+        exit(1);
+    }
+    cfg.sloEnforce = 1;
+
+    // Model przybyć jak w managerze (PIZZERIA_ARRIVALS); bez niego przebiegi jak dotąd
+    ArrivalModel arrivals;
+    if (getenv("PIZZERIA_ARRIVALS") != NULL || getenv("PIZZERIA_GROUP_SIZES") != NULL) {
+        if (arrivalsFromEnv(&arrivals, seed) == -1) {
+            exit(1);
+        }
+        cfg.arrivals = &arrivals;
+        printf("Model przybyć: %s\n", arrivals.spec);
+    }
+
+    DesResult day;
+    long   events = 0, fires = 0;
+    double revenue = 0;
+    unsigned long checksum = 0;
+    long long start = nowNanos();
+    for (long i = 0; i < days; i++) {
+        cfg.seed = seed + (unsigned long long)i;
+        runDesDay(&cfg, &day);
+        events   += day.events;
+        fires    += (day.fireTime >= 0);
+        revenue  += day.totalRevenue;
+        checksum  = (checksum ^ day.checksum) * 1099511628211UL;
+    }
+    double elapsed = (nowNanos() - start) / 1e9;
+    if (cfg.arrivals != NULL) {
+        arrivalsDestroy(cfg.arrivals);
+    }
+
+    printf("----- Symulacja zdarzeń dyskretnych -----\n");
+    printf("Dni: %ld | ziarno: %llu | zdarzeń: %ld | czas: %.3f s (%.0f dni/s, %.0f zdarzeń/s)\n",
+           days, seed, events, elapsed, days / elapsed, events / elapsed);
+    printf("Skrót przebiegu: %016lx\n", checksum);
+    if (days > 1) {
+        printf("Dni z pożarem: %ld | średni utarg: %.2lf zł\n", fires, revenue / days);
+        return;
+    }
+    printf("Koniec dnia: %.3f s czasu wirtualnego", day.endTime / (double)DES_USEC);
+    if (day.fireTime >= 0) {
+        printf(" (POŻAR w %.3f s)", day.fireTime / (double)DES_USEC);
+    }
+    printf("\nGrupy: %d (usadzone: %d, odprawione: %d)\n",
+           day.groupsArrived, day.groupsSeated, day.groupsTurnedAway);
+    printf("Liczba obsłużonych osób: %d\n", day.totalClients);
+    printf("Całkowity utarg: %.2lf zł\n", day.totalRevenue);
+    printf("Sprzedane produkty:\n");
+    for (int i = 0; i < MENU_SIZE; i++) {
+        printf("  %s: %d\n", pizzaMenu[i].name, day.soldItems[i]);
+    }
+    const KitchenSummary* k = &day.kitchen;
+    if (k->ovens > 0) {
+        printf("Kuchnia: %d piec(e) po %d pizze, kolejka %d | pizze: %ld we wsadach: %ld | zajętość pieców: %.1f%%\n",
+               k->ovens, k->ovenLoad, k->queueLimit, k->pizzas, k->loads,
+               k->ovenTimeNs ? 100.0 * k->ovenBusyNs / k->ovenTimeNs : 0.0);
+        printf("Od zamówienia do podania: średnio %.1f ms, p50 %.1f ms, p99 %.1f ms | pełna kolejka: %ld razy\n",
+               histMean(&k->latency) / 1000.0, histPercentile(&k->latency, 50.0) / 1000.0,
+               histPercentile(&k->latency, 99.0) / 1000.0, k->stalls);
+    }
+    const AdmissionSummary* a = &day.admission;
+    if (a->sloMs > 0) {
+        printf("SLO czekania %d ms: przyjęte %ld, odmowy ponad SLO %ld, przekroczenia %ld | średni błąd szacunku %.0f ms\n",
+               a->sloMs, a->admitted, a->sloRejects, a->violations,
+               a->estimates ? (double)a->absErrorMs / a->estimates : 0.0);
+    }
+}
+
+/**
+ * Porównanie polityk sadzania: każda dostaje te same dni (ziarna seed + i)
+ * i ten sam zapis przybyć - z PIZZERIA_ARRIVALS albo "uniform", bo wbudowany
+ * rozkład managera dzieli generator z czasem jedzenia i rozjechałby się między
+ * politykami. Statystyki zmiany liczone są w czasie wirtualnym.
+ */
+
+static void runPolicyComparison(const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit,
+                                unsigned long long seed, long days, int withFire) {
+    ArrivalModel arrivals;
+    const char* spec = getenv("PIZZERIA_ARRIVALS");
+    if (arrivalsInit(&arrivals, spec ? spec : "uniform", getenv("PIZZERIA_GROUP_SIZES"), seed) == -1) {
+        exit(1);
+    }
+    DesConfig cfg;
+    memcpy(cfg.perCapacity, perCapacity, sizeof(cfg.perCapacity));
+    cfg.queueLimit = queueLimit;
+    cfg.withFire   = withFire;
+    cfg.arrivals   = &arrivals;
+    KitchenConfig kitchen;
+    if (kitchenConfigFromEnv(&kitchen) == -1) {
+        exit(1);
+    }
+    cfg.kitchen = (kitchen.ovens > 0) ? &kitchen : NULL;
+    cfg.sloMs   = 0;
+
+    printf("----- Porównanie polityk sadzania -----\n");
+    printf("Dni: %ld | ziarno: %llu | model przybyć: %s | stolików: %d\n",
+           days, seed, arrivals.spec, tableCountFor(perCapacity));
+    printf("%-10s %9s %9s %12s %13s %12s %11s %11s %12s\n", "polityka", "usadzone", "odprawione",
+           "osoby/h", "zajęte miejsca", "zajętość[%]", "czek.[ms]", "p90[ms]", "utarg/dzień");
+    for (int p = 0; p < SEAT_POLICIES; p++) {
+        cfg.policy = &seatPolicies[p];
+        Histogram wait;
+        histInit(&wait);
+        long   seated = 0, turnedAway = 0, clients = 0;
+        double revenue = 0, seatNs = 0, shiftNs = 0;
+        int    seats = 0;
+        for (long i = 0; i < days; i++) {
+            ShiftStats stats;
+            if (statsInit(&stats, perCapacity, queueLimit, 0, 0) == -1) {
+                exit(1);
+            }
+            DesResult day;
+            cfg.seed  = seed + (unsigned long long)i;
+            cfg.stats = &stats;
+            runDesDay(&cfg, &day);
+
+            const ShiftSummary* sum = &stats.summary;
+            histMerge(&wait, &sum->wait[0]);
+            for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+                seatNs += sum->capacitySeatNs[c];
+            }
+            shiftNs    += (double)sum->shiftNs;
+            seats       = sum->seats;
+            seated     += day.groupsSeated;
+            turnedAway += day.groupsTurnedAway;
+            clients    += day.totalClients;
+            revenue    += day.totalRevenue;
+            statsDestroy(&stats);
+        }
+        double hours    = shiftNs / 3.6e12;
+        double occupied = shiftNs > 0 ? seatNs / shiftNs : 0.0;   // średnio zajęte miejsca = miejscogodziny na godzinę
+        printf("%-10s %9ld %9ld %12.0f %13.2f %12.1f %11.1f %11.1f %12.2f\n", seatPolicies[p].name,
+               seated, turnedAway, hours > 0 ? clients / hours : 0.0, occupied,
+               seats ? 100.0 * occupied / seats : 0.0, histMean(&wait) / 1000.0,
+               histPercentile(&wait, 90.0) / 1000.0, revenue / days);
+    }
+    arrivalsDestroy(&arrivals);
+}
+
+/**
+ * SLO czekania a stały limit kolejki: te same dni i przybycia (jak w porównaniu polityk)
+ * raz z samym limitem kolejki (SLO tylko mierzone), raz z odmową ponad szacowane SLO
+ * (kolejka do MAX_CUSTOMERS grup - limit przestaje decydować). Dla każdego wariantu:
+ * przyjęte i usadzone grupy, odmowy, czekanie, przekroczenia SLO i błąd szacunku.
+ */
+
+static void runAdmissionComparison(const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit,
+                                   unsigned long long seed, long days, int withFire, int sloMs) {
+    ArrivalModel arrivals;
+    const char* spec = getenv("PIZZERIA_ARRIVALS");
+    if (arrivalsInit(&arrivals, spec ? spec : "uniform", getenv("PIZZERIA_GROUP_SIZES"), seed) == -1) {
+        exit(1);
+    }
+    KitchenConfig kitchen;
+    if (kitchenConfigFromEnv(&kitchen) == -1) {
+        exit(1);
+    }
+    DesConfig cfg;
+    memcpy(cfg.perCapacity, perCapacity, sizeof(cfg.perCapacity));
+    cfg.withFire = withFire;
+    cfg.arrivals = &arrivals;
+    cfg.policy   = NULL;
+    cfg.kitchen  = (kitchen.ovens > 0) ? &kitchen : NULL;
+    cfg.sloMs    = sloMs;
+
+    printf("----- SLO czekania a stały limit kolejki -----\n");
+    printf("Dni: %ld | ziarno: %llu | model przybyć: %s | stolików: %d | SLO: %d ms\n",
+           days, seed, arrivals.spec, tableCountFor(perCapacity), sloMs);
+    printf("%-16s %9s %9s %9s %9s %11s %11s %11s %12s %11s\n", "wariant", "przyjęte", "usadzone", "odmowy",
+           "osoby/h", "czek.[ms]", "p99[ms]", "ponad SLO", "ponad SLO[%]", "błąd[ms]");
+    for (int enforce = 0; enforce <= 1; enforce++) {
+        cfg.sloEnforce = enforce;
+        cfg.queueLimit = enforce ? MAX_CUSTOMERS : queueLimit;
+        Histogram wait;
+        histInit(&wait);
+        AdmissionSummary sum;
+        memset(&sum, 0, sizeof(sum));
+        long   seated = 0, rejected = 0, queued = 0, clients = 0;
+        double shiftNs = 0;
+        for (long i = 0; i < days; i++) {
+            ShiftStats stats;
+            if (statsInit(&stats, perCapacity, cfg.queueLimit, 0, 0) == -1) {
+                exit(1);
+            }
+            DesResult day;
+            cfg.seed  = seed + (unsigned long long)i;
+            cfg.stats = &stats;
+            runDesDay(&cfg, &day);
+            histMerge(&wait, &stats.summary.wait[0]);
+            admissionSummaryMerge(&sum, &day.admission);
+            shiftNs  += (double)stats.summary.shiftNs;
+            rejected += stats.summary.rejects[STATS_REJECT_NO_TABLE] + stats.summary.rejects[STATS_REJECT_SLO];
+            queued   += stats.summary.queued;
+            seated   += day.groupsSeated;
+            clients  += day.totalClients;
+            statsDestroy(&stats);
+        }
+        char label[32];
+        if (enforce) {
+            snprintf(label, sizeof(label), "SLO %d ms", sloMs);
+        } else {
+            snprintf(label, sizeof(label), "limit %d grup", queueLimit);
+        }
+        double hours = shiftNs / 3.6e12;
+        printf("%-16s %9ld %9ld %9ld %9.0f %11.1f %11.1f %11ld %12.1f %11.0f\n", label, sum.admitted, seated,
+               rejected, hours > 0 ? clients / hours : 0.0, histMean(&wait) / 1000.0,
+               histPercentile(&wait, 99.0) / 1000.0, sum.violations, queued ? 100.0 * sum.violations / queued : 0.0,
+               sum.estimates ? (double)sum.absErrorMs / sum.estimates : 0.0);
+    }
+    arrivalsDestroy(&arrivals);
+}
+
+/**
+ * Dobór pieców do sali: te same dni i przybycia (jak w porównaniu polityk) dla kuchni
+ * z 1..maxOvens piecami (wsad i kolejka z PIZZERIA_KITCHEN albo domyślne).
+ * Dla każdej liczby pieców - usadzone grupy, czekanie na stolik, przepustowość kuchni,
+ * zajętość pieców i czas od zamówienia do podania.
+ */
+
+static void runKitchenSweep(const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit,
+                            unsigned long long seed, long days, int withFire, int maxOvens) {
+    ArrivalModel arrivals;
+    const char* spec = getenv("PIZZERIA_ARRIVALS");
+    if (arrivalsInit(&arrivals, spec ? spec : "uniform", getenv("PIZZERIA_GROUP_SIZES"), seed) == -1) {
+        exit(1);
+    }
+    KitchenConfig kitchen;
+    if (kitchenConfigFromEnv(&kitchen) == -1) {
+        exit(1);
+    }
+    DesConfig cfg;
+    memcpy(cfg.perCapacity, perCapacity, sizeof(cfg.perCapacity));
+    cfg.queueLimit = queueLimit;
+    cfg.withFire   = withFire;
+    cfg.arrivals   = &arrivals;
+    cfg.policy     = NULL;
+    cfg.kitchen    = &kitchen;
+    cfg.sloMs      = 0;
+
+    printf("----- Dobór pieców -----\n");
+    printf("Dni: %ld | ziarno: %llu | model przybyć: %s | stolików: %d | wsad: %d | kolejka kuchni: %d\n",
+           days, seed, arrivals.spec, tableCountFor(perCapacity), kitchen.load, kitchen.queueLimit);
+    printf("%5s %9s %9s %11s %10s %13s %12s %12s %12s %12s\n", "piece", "usadzone", "osoby/h", "czek.[ms]",
+           "pizze/h", "zajętość[%]", "podanie[ms]", "p50[ms]", "p99[ms]", "pełna kol.");
+    for (int ovens = 1; ovens <= maxOvens; ovens++) {
+        kitchen.ovens = ovens;
+        Histogram wait;
+        histInit(&wait);
+        KitchenSummary sum;
+        memset(&sum, 0, sizeof(sum));
+        long   seated = 0, clients = 0;
+        double shiftNs = 0;
+        for (long i = 0; i < days; i++) {
+            ShiftStats stats;
+            if (statsInit(&stats, perCapacity, queueLimit, 0, 0) == -1) {
+                exit(1);
+            }
+            DesResult day;
+            cfg.seed  = seed + (unsigned long long)i;
+            cfg.stats = &stats;
+            runDesDay(&cfg, &day);
+            histMerge(&wait, &stats.summary.wait[0]);
+            kitchenSummaryMerge(&sum, &day.kitchen);
+            shiftNs += (double)stats.summary.shiftNs;
+            seated  += day.groupsSeated;
+            clients += day.totalClients;
+            statsDestroy(&stats);
+        }
+        double hours = shiftNs / 3.6e12;
+        printf("%5d %9ld %9.0f %11.1f %10.0f %13.1f %12.1f %12.1f %12.1f %12ld\n", ovens, seated,
+               hours > 0 ? clients / hours : 0.0, histMean(&wait) / 1000.0, hours > 0 ? sum.pizzas / hours : 0.0,
+               sum.ovenTimeNs ? 100.0 * sum.ovenBusyNs / sum.ovenTimeNs : 0.0, histMean(&sum.latency) / 1000.0,
+               histPercentile(&sum.latency, 50.0) / 1000.0, histPercentile(&sum.latency, 99.0) / 1000.0, sum.stalls);
+    }
+    arrivalsDestroy(&arrivals);
+}
+
+/**
+ * Symulacja całego dnia w jednym procesie:
+ * 1) Tworzy salę (x1..xMAX_TABLE_CAPACITY stolików 1..MAX_TABLE_CAPACITY-osobowych) i wątki: kasjera, timera i pulę roboczą.
+ * 2) Generuje "grupy" zadań, utrzymując co najwyżej "grup_naraz" aktywnych.
+ * 3) Po obsłużeniu wszystkich grup wypisuje przepustowość i podsumowanie dnia.
+ * Z opcją -d zamiast wątków uruchamia symulację zdarzeń dyskretnych (des.c).
+ */
+
+int main(int argc, char* argv[]) {
+    Engine e;
+    memset(&e, 0, sizeof(e));
+    e.groups      = 1000000;
+    e.workers     = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    e.maxInFlight = 4096;
+    e.seed        = 0x2545F4914F6CDD1DULL;
+    int queueLimit = QUEUE_LIMIT;
+    long desDays   = 0;
+    int  withFire  = 1;
+    int  comparePolicies = 0;
+    int  sweepOvens = 0;
+    int  compareSlo = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:w:f:e:q:s:d:Fp:Pk:K:a:A:")) != -1) {
+        switch (opt) {
+        case 'n': e.groups      = atol(optarg); break;
+        case 'w': e.workers     = atoi(optarg); break;
+        case 'f': e.maxInFlight = atoi(optarg); break;
+        case 'e': e.eatMicros   = atol(optarg); break;
+        case 'q': queueLimit    = atoi(optarg); break;
+        case 's': e.seed        = strtoull(optarg, NULL, 0); break;
+        case 'd': desDays       = atol(optarg); break;
+        case 'F': withFire      = 0; break;
+        case 'P': comparePolicies = 1; break;
+        case 'K': sweepOvens      = atoi(optarg); break;
+        case 'A': compareSlo      = atoi(optarg); break;
+        case 'k':
+            setenv("PIZZERIA_KITCHEN", optarg, 1);
+            break;
+        case 'a':
+            setenv("PIZZERIA_ADMISSION", optarg, 1);
+            break;
+        case 'p':
+            if (seatPolicyByName(optarg) == NULL) {
+                usage();
+            }
+            setenv("PIZZERIA_SEATING", optarg, 1);
+            break;
+        default:  usage();
+        }
+    }
+    int perCapacity[MAX_TABLE_CAPACITY];
+    if (parseTableCounts(argc - optind, &argv[optind], perCapacity) == -1
+        || e.groups <= 0 || e.workers <= 0 || e.maxInFlight <= 0) {
+        usage();
+    }
+    // Bez zamykania lokalu grupa większa niż największy stolik czekałaby w kolejce w nieskończoność
+    int largestGroup = 0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        if (perCapacity[c] > 0) {
+            largestGroup = (c + 1 < GROUP_LIMIT) ? c + 1 : GROUP_LIMIT;
+        }
+    }
+    if (largestGroup == 0) {
+        usage();
+    }
+
+    if (sweepOvens > 0) {
+        setenv("PIZZERIA_LOG", "error", 0);
+        runKitchenSweep(perCapacity, queueLimit, e.seed, desDays > 0 ? desDays : 1, withFire,
+                        sweepOvens < KITCHEN_MAX_OVENS ? sweepOvens : KITCHEN_MAX_OVENS);
+        return 0;
+    }
+    if (compareSlo > 0) {
+        setenv("PIZZERIA_LOG", "error", 0);
+        runAdmissionComparison(perCapacity, queueLimit, e.seed, desDays > 0 ? desDays : 1, withFire, compareSlo);
+        return 0;
+    }
+    if (comparePolicies) {
+        setenv("PIZZERIA_LOG", "error", 0);
+        runPolicyComparison(perCapacity, queueLimit, e.seed, desDays > 0 ? desDays : 1, withFire);
+        return 0;
+    }
+    if (desDays > 0) {
+        setenv("PIZZERIA_LOG", "error", 0);
+        runDesMode(perCapacity, queueLimit, e.seed, desDays, withFire);
+        return 0;
+    }
+
+    // Komunikaty o każdej grupie tylko na wyraźne życzenie (PIZZERIA_LOG)
+    setenv("PIZZERIA_LOG", "error", 0);
+    logInit(1);
+
+    DiningTable* tables = (DiningTable*)calloc(tableCountFor(perCapacity), sizeof(DiningTable));
+    initRestaurant(&e.hall, tables, perCapacity, queueLimit, replyToTask, &e);
+
+    e.tasks = (GroupTask*)calloc(e.maxInFlight, sizeof(GroupTask));
+    for (int i = e.maxInFlight - 1; i >= 0; i--) {
+        e.tasks[i].next = e.freeTasks;
+        e.freeTasks     = &e.tasks[i];
+    }
+    pthread_mutex_init(&e.poolLock, NULL);
+    pthread_cond_init(&e.poolChanged, NULL);
+    pthread_mutex_init(&e.runQueue.lock, NULL);
+    pthread_cond_init(&e.runQueue.ready, NULL);
+    e.inbox.capacity = e.maxInFlight * 3;
+    e.inbox.slots    = (CommunicationMessage*)calloc(e.inbox.capacity, sizeof(CommunicationMessage));
+    pthread_mutex_init(&e.inbox.lock, NULL);
+    pthread_cond_init(&e.inbox.ready, NULL);
+    e.timer.heap = (GroupTask**)calloc(e.maxInFlight, sizeof(GroupTask*));
+    pthread_mutex_init(&e.timer.lock, NULL);
+    pthread_cond_init(&e.timer.changed, NULL);
+
+    pthread_t cashier, timer;
+    pthread_t* workers = (pthread_t*)calloc(e.workers, sizeof(pthread_t));
+    if (pthread_create(&cashier, NULL, cashierThread, &e) != 0
+        || pthread_create(&timer, NULL, timerThread, &e) != 0) {
+        perror("[Silnik] Błąd pthread_create()");
+        exit(1);
+    }
+    for (int i = 0; i < e.workers; i++) {
+        if (pthread_create(&workers[i], NULL, workerThread, &e) != 0) {
+            perror("[Silnik] Błąd pthread_create()");
+            exit(1);
+        }
+    }
+
+    // Generator przybyć: nowa grupa, gdy zwolni się zadanie w puli
+    long long start = nowNanos();
+    unsigned long long rng = e.seed;
+    for (long n = 0; n < e.groups; n++) {
+        pthread_mutex_lock(&e.poolLock);
+        while (e.freeTasks == NULL) {
+            pthread_cond_wait(&e.poolChanged, &e.poolLock);
+        }
+        GroupTask* t = e.freeTasks;
+        e.freeTasks  = t->next;
+        pthread_mutex_unlock(&e.poolLock);
+
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        t->group.size     = 1 + (int)((rng >> 11) % largestGroup);
+        t->group.groupPID = (pid_t)(t - e.tasks) + 1;
+        t->tableIndex     = -1;
+        t->rng            = rng | 1;
+        t->state          = TASK_NEW;
+        pushTask(&e.runQueue, t);
+    }
+
+    pthread_mutex_lock(&e.poolLock);
+    while (e.finished < e.groups) {
+        pthread_cond_wait(&e.poolChanged, &e.poolLock);
+    }
+    pthread_mutex_unlock(&e.poolLock);
+    double elapsed = (nowNanos() - start) / 1e9;
+
+    // Zatrzymanie wątków
+    pthread_mutex_lock(&e.runQueue.lock);
+    pthread_mutex_lock(&e.inbox.lock);
+    pthread_mutex_lock(&e.timer.lock);
+    e.stop = 1;
+    pthread_cond_broadcast(&e.runQueue.ready);
+    pthread_cond_broadcast(&e.inbox.ready);
+    pthread_cond_broadcast(&e.timer.changed);
+    pthread_mutex_unlock(&e.timer.lock);
+    pthread_mutex_unlock(&e.inbox.lock);
+    pthread_mutex_unlock(&e.runQueue.lock);
+    for (int i = 0; i < e.workers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_join(cashier, NULL);
+    pthread_join(timer, NULL);
+
+    printf("----- Symulacja w jednym procesie -----\n");
+    printf("Stoliki: %d | wątki: %d | grup naraz: %d | jedzenie: %ld us\n",
+           e.hall.count, e.workers, e.maxInFlight, e.eatMicros);
+    printf("Grupy: %ld (usadzone: %ld, odprawione: %ld)\n", e.groups, e.seated, e.rejected);
+    printf("Czas: %.3f s | %.0f grup/s\n", elapsed, e.groups / elapsed);
+    printf("Liczba obsłużonych osób: %d\n", e.hall.totalClients);
+    printf("Całkowity utarg: %.2lf zł\n", e.hall.totalRevenue);
+
+    destroyRestaurant(&e.hall);
+    free(tables);
+    free(e.tasks);
+    free(e.inbox.slots);
+    free(e.timer.heap);
+    free(workers);
+    return 0;
+}
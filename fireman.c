@@ -1,4 +1,5 @@
 #include "pizzeria.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -12,37 +13,40 @@
 
 static void onTermSignal(int sig) {
     if (sig == SIGTERM) {
-        printf(CLR_FIREMAN "[Strażak] Otrzymałem SIGTERM – wychodzę, bo nie jestem już potrzebny.\n" CLR_RESET);
+        LOG(LVL_INFO, CLR_FIREMAN "[Strażak] Otrzymałem SIGTERM – wychodzę, bo nie jestem już potrzebny.\n" CLR_RESET);
         exit(0);
     }
 }
 
 /**
  * Proces strażaka:
- * 1) Odbiera parametry: <pid_kasjera>, <pid_managera>, <liczba_stolików>.
+ * 1) Odbiera parametry: <pid_kasjera>, <pid_managera>, <liczba_stolików>, <grupa_klientów>.
  * 2) Ustawia handler SIGTERM (manager może go zabić, gdy nie ma pożaru).
- * 3) Dołącza do semafora i pamięci współdzielonej (klucze ftok()).
+ * 3) Dołącza do pamięci współdzielonej (klucz ftok()).
  * 4) Czeka losowy czas (0-600s).
  * 5) Ogłasza pożar:
+ *    - kill(managerPid, SIGUSR1) (manager notuje czas pożaru do raportu ewakuacji),
+ *    - kill(-clientGroup, SIGUSR1) - jeden sygnał do całej grupy procesów klientów,
+ *      także tych, które czekają w kolejce i nie siedzą przy żadnym stoliku,
  *    - kill(cashierPid, SIGUSR1) (kasjer -> fireSignal=1),
- *    - blokuje semafor i każdemu occupant_pids w tablicy stolików wysyła SIGUSR1,
- *      ustawia total_seated=0,
- *    - kill(managerPid, SIGUSR1).
+ *    - dla każdego stolika (pod blokadą tableLock) ustawia total_seated=0,
+ *      żeby kasjer nie czekał na wyjścia, które już nie nadejdą.
  * 6) Odłącza pamięć (shmdt) i kończy.
  *
- * @param argc liczba argumentów (powinno być 4).
- * @param argv pid_kasjera, pid_managera, liczba_stolików.
+ * @param argc liczba argumentów (powinno być 5).
+ * @param argv pid_kasjera, pid_managera, liczba_stolików, grupa_klientów (PGID).
  * @return Kod wyjścia (0).
  */
 
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        fprintf(stderr, CLR_FIREMAN "[Strażak] Użycie: ./fireman_app <pid_kasjera> <pid_menadżera> <liczba_stolików>\n" CLR_RESET);
+    if (argc != 5) {
+        fprintf(stderr, CLR_FIREMAN "[Strażak] Użycie: ./fireman_app <pid_kasjera> <pid_menadżera> <liczba_stolików> <grupa_klientów>\n" CLR_RESET);
         exit(1);
     }
-    pid_t cashierPid = (pid_t)atoi(argv[1]);
-    pid_t managerPid = (pid_t)atoi(argv[2]);
-    int   tableCount = atoi(argv[3]);
+    pid_t cashierPid  = (pid_t)atoi(argv[1]);
+    pid_t managerPid  = (pid_t)atoi(argv[2]);
+    int   tableCount  = atoi(argv[3]);
+    pid_t clientGroup = (pid_t)atoi(argv[4]);
 
     srand(time(NULL));
     // Obsługa SIGTERM
@@ -61,13 +65,7 @@ int main(int argc, char* argv[]) {
         perror(CLR_FIREMAN "[Strażak] ftok() shm" CLR_RESET);
         exit(1);
     }
-    key_t kSem = ftok(".", SEMAPHORE_GEN_CHAR);
-    if (kSem == -1) {
-        perror(CLR_FIREMAN "[Strażak] ftok() sem" CLR_RESET);
-        exit(1);
-    }
 
-    int semId = accessSemaphore(kSem);
     int shmId = accessSharedMemory(kShm);
 
     DiningTable* tabPtr = (DiningTable*)shmat(shmId, NULL, 0);
@@ -81,27 +79,26 @@ int main(int argc, char* argv[]) {
     //int randomDelay = rand() % 1000 + 80;
     sleep(randomDelay);
 
-    printf(CLR_FIREMAN "[Strażak] POŻAR wybucha!\n" CLR_RESET);
-    // Informujemy kasjera i klientów
+    LOG(LVL_INFO, CLR_FIREMAN "[Strażak] POŻAR wybucha!\n" CLR_RESET);
+    // Najpierw menadżer (od jego odbioru liczy się czas ewakuacji), potem
+    // wszyscy klienci naraz - koszt nie zależy od liczby stolików ani grup
+    kill(managerPid, SIGUSR1);
+    if (kill(-clientGroup, SIGUSR1) == -1 && errno != ESRCH) {
+        perror(CLR_FIREMAN "[Strażak] Błąd kill() do grupy klientów" CLR_RESET);
+    }
     kill(cashierPid, SIGUSR1);
 
-    semaphoreP(semId, MUTEX_INDEX);
+    // Stoliki zwalniamy pod ich własnymi blokadami - kasjer czeka na pusty lokal.
+    // Czyścimy też PID-y grup, żeby kasjer nie odejmował później ich miejsc drugi raz.
     for (int i = 0; i < tableCount; i++) {
-        for (int j = 0; j < 4; j++) {
-            if (tabPtr[i].occupant_pids[j] != 0) {
-                if (kill(tabPtr[i].occupant_pids[j], SIGUSR1) == -1) {
-                    if (errno != ESRCH) {
-                        perror(CLR_FIREMAN "[Strażak] Błąd kill() do klienta" CLR_RESET);
-                    }
-                }
-            }
+        tableLock(&tabPtr[i]);
+        for (int j = 0; j < TABLE_SLOTS; j++) {
+            tabPtr[i].occupant_pids[j] = 0;
         }
+        tabPtr[i].group_size   = 0;
         tabPtr[i].total_seated = 0;
+        tableUnlock(&tabPtr[i]);
     }
-    semaphoreV(semId, MUTEX_INDEX);
-
-    // Informujemy menadżera
-    kill(managerPid, SIGUSR1);
 
     if (shmdt(tabPtr) == -1) {
         perror(CLR_FIREMAN "[Strażak] Błąd shmdt()" CLR_RESET);
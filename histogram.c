@@ -0,0 +1,85 @@
+#include "histogram.h"
+#include <string.h>
+
+static int bucketOf(uint64_t v) {
+    if (v < HIST_SUB) {
+        return (int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    int k   = msb - HIST_SUB_BITS + 1;            // szerokość kubełka = 2^k
+    int idx = HIST_SUB + (k - 1) * HIST_HALF + (int)(v >> k) - HIST_HALF;
+    return (idx < HIST_BUCKETS) ? idx : HIST_BUCKETS - 1;
+}
+
+// Największa wartość, która trafia do kubełka idx
+static uint64_t bucketHigh(int idx) {
+    if (idx < HIST_SUB) {
+        return (uint64_t)idx;
+    }
+    int j   = idx - HIST_SUB;
+    int k   = j / HIST_HALF + 1;
+    uint64_t sub = (uint64_t)(j % HIST_HALF + HIST_HALF);
+    return ((sub + 1) << k) - 1;
+}
+
+void histInit(Histogram* h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void histRecord(Histogram* h, uint64_t value) {
+    h->buckets[bucketOf(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value < h->min) {
+        h->min = value;
+    }
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+void histMerge(Histogram* into, const Histogram* from) {
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        into->buckets[i] += from->buckets[i];
+    }
+    into->count += from->count;
+    into->sum   += from->sum;
+    if (from->min < into->min) {
+        into->min = from->min;
+    }
+    if (from->max > into->max) {
+        into->max = from->max;
+    }
+}
+
+/**
+ * Wartość, poniżej której (włącznie) leży percentile % zapisów - górna granica
+ * kubełka, ale nie więcej niż największa zapisana wartość.
+ *
+ * @param percentile 0..100.
+ * @return Wartość lub 0 dla pustego histogramu.
+ */
+
+uint64_t histPercentile(const Histogram* h, double percentile) {
+    if (h->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(percentile / 100.0 * h->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t high = bucketHigh(i);
+            return (high < h->max) ? high : h->max;
+        }
+    }
+    return h->max;
+}
+
+double histMean(const Histogram* h) {
+    return h->count ? (double)h->sum / h->count : 0.0;
+}
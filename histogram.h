@@ -0,0 +1,34 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// --------------------- Histogram o stałych kubełkach (w stylu HDR) ---------------------
+//
+// Wartości 0..HIST_SUB-1 mają własne kubełki, wyżej każda oktawa [2^k, 2^(k+1))
+// dzieli się na HIST_SUB/2 równych kubełków, więc błąd względny odczytu jest
+// poniżej 2 / HIST_SUB (~3%). Tablica kubełków ma stały rozmiar - zapis to
+// kilka instrukcji bez alokacji; wartości powyżej zakresu trafiają do ostatniego kubełka.
+// Histogramy o tym samym układzie można sumować (histMerge), np. z kilku kasjerów.
+
+#define HIST_SUB_BITS   6
+#define HIST_SUB        (1 << HIST_SUB_BITS)
+#define HIST_HALF       (HIST_SUB / 2)
+#define HIST_MAX_BITS   40                                  // do ~1.1e12 (np. 12 dni w us)
+#define HIST_BUCKETS    (HIST_SUB + (HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_HALF)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint32_t buckets[HIST_BUCKETS];
+} Histogram;
+
+void     histInit(Histogram* h);
+void     histRecord(Histogram* h, uint64_t value);
+void     histMerge(Histogram* into, const Histogram* from);
+uint64_t histPercentile(const Histogram* h, double percentile);
+double   histMean(const Histogram* h);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,175 @@
+#include "journal.h"
+#include "seating.h"
+#include "admission.h"
+#include <string.h>
+#include <sys/mman.h>
+
+#define JOURNAL_INITIAL_RECORDS  32768      // 1 MiB
+#define JOURNAL_MAX_GROWTH       2097152    // najwyżej 64 MiB na jedno powiększenie
+
+/**
+ * Odwzorowuje plik na nowo z pojemnością records rekordów.
+ * MAP_POPULATE wczytuje strony od razu, więc zapisy nie trafiają na błędy stron.
+ */
+
+static int journalMap(Journal* j, uint64_t records) {
+    size_t bytes = sizeof(JournalHeader) + records * sizeof(JournalRecord);
+    if (j->map != NULL && munmap(j->map, j->mapped) == -1) {
+        perror("[journal.c] Błąd munmap() dziennika");
+    }
+    j->map = NULL;
+    if (ftruncate(j->fd, (off_t)bytes) == -1) {
+        perror("[journal.c] Błąd ftruncate() dziennika");
+        return -1;
+    }
+    void* map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, j->fd, 0);
+    if (map == MAP_FAILED) {
+        perror("[journal.c] Błąd mmap() dziennika");
+        return -1;
+    }
+    j->map      = (char*)map;
+    j->mapped   = bytes;
+    j->capacity = records;
+    j->records  = (JournalRecord*)(j->map + sizeof(JournalHeader));
+    return 0;
+}
+
+/**
+ * Tworzy dziennik (istniejący plik jest nadpisywany) i zapisuje nagłówek.
+ *
+ * @param j Dziennik.
+ * @param path Ścieżka pliku.
+ * @param perCapacity Stoliki każdej pojemności (sala tego kasjera).
+ * @param queueLimit Limit kolejki oczekujących.
+ * @param shard Numer kasjera.
+ * @param shards Liczba kasjerów.
+ * @return 0 lub -1 (dziennik wyłączony).
+ */
+
+int journalOpen(Journal* j, const char* path, const int perCapacity[MAX_TABLE_CAPACITY],
+                int queueLimit, int shard, int shards) {
+    memset(j, 0, sizeof(*j));
+    j->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (j->fd == -1) {
+        perror("[journal.c] Błąd open() dziennika");
+        return -1;
+    }
+    if (journalMap(j, JOURNAL_INITIAL_RECORDS) == -1) {
+        close(j->fd);
+        j->fd = -1;
+        return -1;
+    }
+    JournalHeader* h = (JournalHeader*)j->map;
+    memcpy(h->magic, JOURNAL_MAGIC, sizeof(h->magic));
+    h->version    = JOURNAL_VERSION;
+    h->recordSize = sizeof(JournalRecord);
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        h->perCapacity[c] = perCapacity[c];
+    }
+    h->queueLimit = queueLimit;
+    h->shard      = shard;
+    h->shards     = shards;
+    h->maxCapacity = MAX_TABLE_CAPACITY;
+    h->maxGroup    = MAX_GROUP_SIZE;
+    h->menuSize    = MENU_SIZE;
+    h->seatPolicy  = seatPolicyFromEnv()->id;
+    int sloMs;
+    h->sloMs       = (admissionConfigFromEnv(&sloMs) == 0) ? sloMs : 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    h->startedRealtimeNs = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    j->startNs = monotonicNs();
+    return 0;
+}
+
+/**
+ * Dziennik z PIZZERIA_JOURNAL (przy kilku kasjerach do ścieżki dochodzi ".<nr>").
+ * @return 0 - dziennik otwarty, -1 - brak zmiennej lub błąd (dziennik wyłączony).
+ */
+
+int journalOpenFromEnv(Journal* j, const int perCapacity[MAX_TABLE_CAPACITY],
+                       int queueLimit, int shard, int shards) {
+    const char* path = getenv("PIZZERIA_JOURNAL");
+    if (path == NULL || *path == '\0') {
+        return -1;
+    }
+    char shardPath[512];
+    if (shards > 1) {
+        snprintf(shardPath, sizeof(shardPath), "%s.%d", path, shard);
+        path = shardPath;
+    }
+    return journalOpen(j, path, perCapacity, queueLimit, shard, shards);
+}
+
+/**
+ * Dopisuje rekord. Powiększenie pliku (rzadkie, pojemność rośnie dwukrotnie)
+ * to jedyna chwila z wywołaniami systemowymi; gdy się nie uda, dziennik
+ * przestaje przyjmować rekordy, a obsługa klientów idzie dalej.
+ */
+
+void journalAppend(Journal* j, int type, const GroupOfClients* g, int table, uint64_t items, int batch) {
+    if (j->map == NULL) {
+        return;
+    }
+    if (j->count == j->capacity) {
+        uint64_t grow = (j->capacity < JOURNAL_MAX_GROWTH) ? j->capacity : JOURNAL_MAX_GROWTH;
+        if (journalMap(j, j->capacity + grow) == -1) {
+            return;
+        }
+    }
+    JournalRecord* rec = &j->records[j->count];
+    rec->atNs     = monotonicNs() - j->startNs;
+    rec->seq      = (uint32_t)j->count;
+    rec->size     = g ? (uint8_t)g->size : 0;
+    rec->batch    = (uint16_t)batch;
+    rec->pid      = g ? (int32_t)g->groupPID : 0;
+    rec->table    = table;
+    rec->items    = items;
+    rec->type     = (uint8_t)type;
+    j->count++;
+}
+
+/**
+ * Wpisuje liczbę rekordów, przycina plik do zapisanej części i zamyka go.
+ */
+
+void journalClose(Journal* j) {
+    if (j->map == NULL) {
+        return;
+    }
+    ((JournalHeader*)j->map)->count = j->count;
+    if (munmap(j->map, j->mapped) == -1) {
+        perror("[journal.c] Błąd munmap() dziennika");
+    }
+    j->map = NULL;
+    if (ftruncate(j->fd, (off_t)(sizeof(JournalHeader) + j->count * sizeof(JournalRecord))) == -1) {
+        perror("[journal.c] Błąd ftruncate() dziennika");
+    }
+    close(j->fd);
+    j->fd = -1;
+}
+
+uint64_t journalPackItems(const int orderedItems[MAX_GROUP_SIZE]) {
+    uint64_t items = ~0ULL;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        uint64_t v = (orderedItems[i] < 0) ? 0xF : (uint64_t)orderedItems[i];
+        items = (items & ~(0xFULL << (4 * i))) | (v << (4 * i));
+    }
+    return items;
+}
+
+void journalUnpackItems(uint64_t items, int orderedItems[MAX_GROUP_SIZE]) {
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        uint64_t v = (items >> (4 * i)) & 0xF;
+        orderedItems[i] = (v == 0xF) ? -1 : (int)v;
+    }
+}
+
+const char* journalTypeName(int type) {
+    static const char* names[JOURNAL_TYPES] = {
+        "?", "przybycie", "kolejka", "stolik", "odmowa", "zamówienie",
+        "wyjście", "ostrzeżenie", "pożar", "przekazanie", "przekazanie z kolejki",
+        "rezygnacja", "martwa grupa"
+    };
+    return (type > 0 && type < JOURNAL_TYPES) ? names[type] : names[0];
+}
@@ -0,0 +1,90 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "pizzeria.h"
+#include <stdint.h>
+
+// --------------------- Dziennik zdarzeń zmiany ---------------------
+//
+// Binarny dziennik kasjera (PIZZERIA_JOURNAL=plik, przy kilku kasjerach plik.<nr>):
+// nagłówek z konfiguracją sali, a po nim rekordy stałej długości w kolejności obsługi.
+// Zapis to zwykłe przypisanie do pliku odwzorowanego w pamięci (mmap, strony
+// wstępnie wczytane przy każdym powiększeniu) - bez wywołań systemowych w gorącej
+// ścieżce; plik dostaje dokładny rozmiar przy journalClose(). Po awarii rekordy
+// kończą się na pierwszym zerowym typie.
+//
+// Rekordy wejściowe (ARRIVAL, ORDER, LEAVE, CLOSE_WARNING, FIRE, HANDOFF_QUEUED, CANCEL, RECLAIM)
+// wystarczą, by odtworzyć stan sali; rekordy decyzji (SEAT, QUEUE, REJECT) replay_app
+// porównuje z decyzjami logiki sali (restaurant.c) przy ponownym przebiegu.
+
+#define JOURNAL_MAGIC          "PIZJRNL1"
+#define JOURNAL_VERSION         3  // 2: układ lokalu w nagłówku, 16 pozycji zamówienia; 3: numer zapytania
+#define JOURNAL_MAX_CAPACITY   16  // pojemności w nagłówku (niezależnie od MAX_TABLE_CAPACITY)
+
+#define JOURNAL_ARRIVAL         1  // zapytanie o stolik dotarło do sali (items = numer zapytania)
+#define JOURNAL_QUEUE           2  // grupa wstawiona do kolejki
+#define JOURNAL_SEAT            3  // przydział stolika (table = lokalny indeks)
+#define JOURNAL_REJECT          4  // odmowa (table = NO_TABLE_FOUND / NEAR_CLOSING)
+#define JOURNAL_ORDER           5  // zamówienie (items: MAX_GROUP_SIZE x 4 bity, 0xF - brak)
+#define JOURNAL_LEAVE           6  // wyjście (batch = liczba wyjść obsłużonych razem)
+#define JOURNAL_CLOSE_WARNING   7  // SIGUSR2: nowe grupy odprawiane, kolejka rozwiązana
+#define JOURNAL_FIRE            8  // SIGUSR1: koniec przyjmowania
+#define JOURNAL_HANDOFF         9  // przy przybyciu przekazana innemu kasjerowi (table = kasjer)
+#define JOURNAL_HANDOFF_QUEUED 10  // z kolejki do innego kasjera (table = kasjer; -1 - wróciła na koniec kolejki)
+#define JOURNAL_CANCEL         11  // CANCEL_REQUEST (grupa zdjęta z kolejki, jeśli jeszcze w niej czekała; items jak ARRIVAL)
+#define JOURNAL_RECLAIM        12  // proces grupy nie żyje (table = lokalny stolik; -1 - grupa z kolejki)
+#define JOURNAL_TYPES          13
+
+typedef struct {
+    int64_t  atNs;          // od otwarcia dziennika (CLOCK_MONOTONIC)
+    uint32_t seq;
+    uint8_t  type;
+    uint8_t  size;
+    uint16_t batch;
+    int32_t  pid;
+    int32_t  table;
+    uint64_t items;
+} JournalRecord;            // 32 bajty
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    int32_t  perCapacity[JOURNAL_MAX_CAPACITY];
+    int32_t  queueLimit;
+    int32_t  shard;
+    int32_t  shards;
+    int32_t  maxCapacity;   // układ, z którym skompilowano kasjera (replay_app musi mieć ten sam)
+    int32_t  maxGroup;
+    int32_t  menuSize;
+    int32_t  seatPolicy;    // SEAT_POLICY_* (replay_app sadza tak samo)
+    int32_t  sloMs;         // SLO czekania (PIZZERIA_ADMISSION), 0 - tylko limit kolejki
+    int64_t  startedRealtimeNs;
+    uint64_t count;         // liczba rekordów (wpisywana przy zamknięciu)
+} JournalHeader;            // 128 bajtów
+
+_Static_assert(sizeof(JournalRecord) == 32 && sizeof(JournalHeader) == 128, "Zmieniony format dziennika");
+_Static_assert(MAX_TABLE_CAPACITY <= JOURNAL_MAX_CAPACITY && MAX_GROUP_SIZE <= 16, "Układ nie mieści się w dzienniku");
+
+typedef struct {
+    int            fd;
+    char*          map;
+    size_t         mapped;      // bajty odwzorowane (nagłówek + pojemność)
+    uint64_t       capacity;    // rekordów w odwzorowaniu
+    uint64_t       count;
+    long long      startNs;
+    JournalRecord* records;
+} Journal;
+
+int  journalOpen(Journal* j, const char* path, const int perCapacity[MAX_TABLE_CAPACITY],
+                 int queueLimit, int shard, int shards);
+int  journalOpenFromEnv(Journal* j, const int perCapacity[MAX_TABLE_CAPACITY],
+                        int queueLimit, int shard, int shards);
+void journalAppend(Journal* j, int type, const GroupOfClients* g, int table, uint64_t items, int batch);
+void journalClose(Journal* j);
+
+uint64_t journalPackItems(const int orderedItems[MAX_GROUP_SIZE]);
+void     journalUnpackItems(uint64_t items, int orderedItems[MAX_GROUP_SIZE]);
+const char* journalTypeName(int type);
+
+#endif // JOURNAL_H
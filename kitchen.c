@@ -0,0 +1,316 @@
+#include "kitchen.h"
+#include "logger.h"
+#include <string.h>
+
+/**
+ * "piece[,wsad[,kolejka]]" (NULL, pusty napis lub "0" - bez kuchni).
+ * @return 0 lub -1 (błędna konfiguracja).
+ */
+
+int kitchenConfigParse(KitchenConfig* cfg, const char* spec) {
+    cfg->ovens      = 0;
+    cfg->load       = KITCHEN_DEFAULT_LOAD;
+    cfg->queueLimit = KITCHEN_DEFAULT_QUEUE;
+    if (spec == NULL || *spec == '\0') {
+        return 0;
+    }
+    int* fields[3] = { &cfg->ovens, &cfg->load, &cfg->queueLimit };
+    const char* p = spec;
+    for (int i = 0; i < 3 && *p != '\0'; i++) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p || (*end != ',' && *end != '\0')) {
+            fprintf(stderr, "[kitchen.c] Błędna konfiguracja kuchni: %s (piece[,wsad[,kolejka]])\n", spec);
+            return -1;
+        }
+        *fields[i] = (int)v;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    if (cfg->ovens < 0 || cfg->ovens > KITCHEN_MAX_OVENS || cfg->load < 1 || cfg->load > KITCHEN_MAX_LOAD
+        || cfg->queueLimit < MAX_GROUP_SIZE || cfg->queueLimit > KITCHEN_MAX_QUEUE) {
+        fprintf(stderr, "[kitchen.c] Kuchnia: 0..%d pieców, wsad 1..%d, kolejka %d..%d pizz (%s)\n",
+                KITCHEN_MAX_OVENS, KITCHEN_MAX_LOAD, MAX_GROUP_SIZE, KITCHEN_MAX_QUEUE, spec);
+        return -1;
+    }
+    return 0;
+}
+
+int kitchenConfigFromEnv(KitchenConfig* cfg) {
+    return kitchenConfigParse(cfg, getenv("PIZZERIA_KITCHEN"));
+}
+
+/**
+ * Przygotowuje kuchnię. Zamówienie ma pizze w kolejce albo w piecu,
+ * więc biletów wystarczy tyle, ile pizz mieści kolejka i wszystkie piece.
+ *
+ * @param k Kuchnia.
+ * @param cfg Piece, wsad i długość kolejki (ovens > 0).
+ * @param ready Odpowiedź PIZZA_READY do grupy.
+ * @param ctx Kontekst funkcji ready.
+ * @param nowNs Początek pracy kuchni.
+ * @return 0 lub -1 (błąd malloc).
+ */
+
+int kitchenInit(Kitchen* k, const KitchenConfig* cfg, KitchenReadyFn ready, void* ctx, long long nowNs) {
+    memset(k, 0, sizeof(*k));
+    k->cfg      = *cfg;
+    k->ready    = ready;
+    k->readyCtx = ctx;
+    k->startNs  = nowNs;
+    int tickets = cfg->queueLimit + cfg->ovens * cfg->load;
+    k->tickets     = (KitchenTicket*)calloc(tickets, sizeof(KitchenTicket));
+    k->freeTickets = (int*)calloc(tickets, sizeof(int));
+    if (k->tickets == NULL || k->freeTickets == NULL) {
+        kitchenDestroy(k);
+        return -1;
+    }
+    for (int i = 0; i < tickets; i++) {
+        k->freeTickets[k->freeCount++] = tickets - 1 - i;
+    }
+    k->summary.ovens      = cfg->ovens;
+    k->summary.ovenLoad   = cfg->load;
+    k->summary.queueLimit = cfg->queueLimit;
+    histInit(&k->summary.latency);
+    return 0;
+}
+
+void kitchenDestroy(Kitchen* k) {
+    free(k->tickets);
+    free(k->freeTickets);
+    k->tickets     = NULL;
+    k->freeTickets = NULL;
+}
+
+/**
+ * Ładuje wolne piece: czoło kolejki wyznacza czas pieczenia wsadu,
+ * a do wsadu idą kolejne pizze o tym samym czasie (w kolejności zamówień).
+ */
+
+static void startLoads(Kitchen* k, long long nowNs) {
+    for (int o = 0; o < k->cfg.ovens && k->queued > 0; o++) {
+        KitchenOven* oven = &k->ovens[o];
+        if (oven->count > 0) {
+            continue;
+        }
+        int bakeMs = k->queue[0].bakeMs;
+        int kept = 0;
+        for (int i = 0; i < k->queued; i++) {
+            if (oven->count < k->cfg.load && k->queue[i].bakeMs == bakeMs) {
+                oven->ticket[oven->count++] = k->queue[i].ticket;
+            } else {
+                k->queue[kept++] = k->queue[i];
+            }
+        }
+        k->queued      = kept;
+        oven->startNs  = nowNs;
+        oven->endNs    = nowNs + bakeMs * 1000000LL;
+    }
+}
+
+/**
+ * Przyjmuje zamówienie grupy (pizze do kolejki przygotowania) i ładuje wolne piece.
+ *
+ * @param k Kuchnia.
+ * @param order SEND_ORDER (group, tableIndex, orderedItems).
+ * @param orderedNs Chwila zamówienia (od niej liczy się czas do PIZZA_READY).
+ * @param nowNs Bieżąca chwila (później niż orderedNs, jeśli zamówienie czekało na miejsce).
+ * @return 0 lub -1 (kolejka nie zmieści zamówienia - trzeba poczekać na piec).
+ */
+
+int kitchenSubmit(Kitchen* k, const CommunicationMessage* order, long long orderedNs, long long nowNs) {
+    int pizzas = order->group.size;
+    if (k->queued + pizzas > k->cfg.queueLimit || k->freeCount == 0) {
+        return -1;
+    }
+    int t = k->freeTickets[--k->freeCount];
+    k->tickets[t].group      = order->group;
+    k->tickets[t].tableIndex = order->tableIndex;
+    k->tickets[t].remaining  = pizzas;
+    k->tickets[t].orderedNs  = orderedNs;
+    for (int i = 0; i < pizzas; i++) {
+        k->queue[k->queued].ticket = t;
+        k->queue[k->queued].bakeMs = pizzaMenu[order->orderedItems[i]].bakeMs;
+        k->queued++;
+    }
+    k->summary.orders++;
+    if (k->queued > k->summary.peakQueue) {
+        k->summary.peakQueue = k->queued;
+    }
+    startLoads(k, nowNs);
+    return 0;
+}
+
+/**
+ * Wyjmuje wsady upieczone do chwili nowNs i ładuje zwolnione piece. Grupy z kompletem
+ * pizz trafiają do k->done - PIZZA_READY wysyła dopiero deliverReady(), już bez blokady kuchni.
+ *
+ * @return Chwila najbliższego końca pieczenia [ns] albo -1 (piece stoją).
+ */
+
+static long long collectReady(Kitchen* k, long long nowNs) {
+    for (int o = 0; o < k->cfg.ovens; o++) {
+        KitchenOven* oven = &k->ovens[o];
+        if (oven->count == 0 || oven->endNs > nowNs) {
+            continue;
+        }
+        k->summary.loads++;
+        k->summary.pizzas     += oven->count;
+        k->summary.ovenBusyNs += oven->endNs - oven->startNs;
+        for (int i = 0; i < oven->count; i++) {
+            KitchenTicket* t = &k->tickets[oven->ticket[i]];
+            if (--t->remaining > 0) {
+                continue;
+            }
+            histRecord(&k->summary.latency, (uint64_t)(nowNs - t->orderedNs) / 1000);
+            k->freeTickets[k->freeCount++] = oven->ticket[i];
+            k->done[k->doneCount++] = *t;
+        }
+        oven->count = 0;
+    }
+    startLoads(k, nowNs);
+
+    long long next = -1;
+    for (int o = 0; o < k->cfg.ovens; o++) {
+        if (k->ovens[o].count > 0 && (next == -1 || k->ovens[o].endNs < next)) {
+            next = k->ovens[o].endNs;
+        }
+    }
+    return next;
+}
+
+// PIZZA_READY do grup zebranych przez collectReady()
+static void deliverReady(Kitchen* k) {
+    for (int i = 0; i < k->doneCount; i++) {
+        k->ready(k->readyCtx, &k->done[i].group, k->done[i].tableIndex);
+    }
+    k->doneCount = 0;
+}
+
+/**
+ * Wyjmuje wsady upieczone do chwili nowNs (grupom z kompletem pizz idzie PIZZA_READY)
+ * i ładuje zwolnione piece.
+ *
+ * @return Chwila najbliższego końca pieczenia [ns] albo -1 (piece stoją).
+ */
+
+long long kitchenAdvance(Kitchen* k, long long nowNs) {
+    long long next = collectReady(k, nowNs);
+    deliverReady(k);
+    return next;
+}
+
+// Zamówienie czekało waitedNs na miejsce w kolejce przygotowania
+void kitchenStalled(Kitchen* k, long long waitedNs) {
+    k->summary.stalls++;
+    k->summary.stallNs += waitedNs;
+}
+
+/**
+ * Koniec pracy kuchni: czas pracy do zajętości pieców
+ * (wsady przerwane np. pożarem liczą się do chwili nowNs).
+ */
+
+void kitchenFinish(Kitchen* k, long long nowNs) {
+    for (int o = 0; o < k->cfg.ovens; o++) {
+        if (k->ovens[o].count > 0) {
+            long long end = (k->ovens[o].endNs < nowNs) ? k->ovens[o].endNs : nowNs;
+            k->summary.ovenBusyNs += end - k->ovens[o].startNs;
+        }
+    }
+    k->summary.spanNs     = nowNs - k->startNs;
+    k->summary.ovenTimeNs = k->summary.spanNs * k->cfg.ovens;
+}
+
+// --------------------- Wątek kuchni (cashier_app) ---------------------
+
+static void* kitchenThread(void* arg) {
+    Kitchen* k = (Kitchen*)arg;
+    pthread_mutex_lock(&k->lock);
+    while (!k->stop) {
+        long long next = collectReady(k, monotonicNs());
+        pthread_cond_broadcast(&k->room);
+        if (k->doneCount > 0) {
+            // Wysłanie PIZZA_READY może czekać na miejsce w kolejce komunikatów,
+            // a kasjer przekazujący zamówienie nie może wtedy stać na blokadzie kuchni.
+            // Tylko ten wątek zbiera i wysyła k->done, więc bufor jest bezpieczny bez blokady.
+            pthread_mutex_unlock(&k->lock);
+            deliverReady(k);
+            pthread_mutex_lock(&k->lock);
+            continue;
+        }
+        if (next == -1) {
+            pthread_cond_wait(&k->wake, &k->lock);
+        } else {
+            struct timespec at;
+            at.tv_sec  = next / 1000000000LL;
+            at.tv_nsec = next % 1000000000LL;
+            pthread_cond_timedwait(&k->wake, &k->lock, &at);
+        }
+    }
+    pthread_mutex_unlock(&k->lock);
+    return NULL;
+}
+
+/**
+ * Uruchamia wątek kuchni: piecze w czasie rzeczywistym (CLOCK_MONOTONIC)
+ * i wysyła PIZZA_READY z tego wątku.
+ * @return 0 lub -1 (errno z pthread_create).
+ */
+
+int kitchenStart(Kitchen* k) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&k->lock, NULL);
+    pthread_cond_init(&k->wake, &attr);
+    pthread_cond_init(&k->room, NULL);
+    pthread_condattr_destroy(&attr);
+    int rc = pthread_create(&k->thread, NULL, kitchenThread, k);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    k->running = 1;
+    return 0;
+}
+
+/**
+ * Kasjer: przekazuje zamówienie do kuchni. Przy pełnej kolejce przygotowania
+ * czeka, aż piec zabierze pizze.
+ */
+
+void kitchenOrder(Kitchen* k, const CommunicationMessage* order) {
+    pthread_mutex_lock(&k->lock);
+    long long nowNs = monotonicNs();
+    if (kitchenSubmit(k, order, nowNs, nowNs) == -1) {
+        LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Kuchnia pełna, zamówienie grupy PID(%d) czeka.\n" CLR_RESET,
+                (int)order->group.groupPID);
+        while (!k->stop && kitchenSubmit(k, order, nowNs, monotonicNs()) == -1) {
+            pthread_cond_wait(&k->room, &k->lock);
+        }
+        kitchenStalled(k, monotonicNs() - nowNs);
+    }
+    pthread_cond_signal(&k->wake);
+    pthread_mutex_unlock(&k->lock);
+}
+
+/**
+ * Zatrzymuje wątek kuchni i zamyka jej statystyki (kitchenFinish).
+ */
+
+void kitchenStop(Kitchen* k) {
+    if (!k->running) {
+        return;
+    }
+    pthread_mutex_lock(&k->lock);
+    k->stop = 1;
+    pthread_cond_signal(&k->wake);
+    pthread_cond_broadcast(&k->room);
+    pthread_mutex_unlock(&k->lock);
+    pthread_join(k->thread, NULL);
+    k->running = 0;
+    kitchenFinish(k, monotonicNs());
+    pthread_mutex_destroy(&k->lock);
+    pthread_cond_destroy(&k->wake);
+    pthread_cond_destroy(&k->room);
+}
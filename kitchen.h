@@ -0,0 +1,96 @@
+#ifndef KITCHEN_H
+#define KITCHEN_H
+
+#include "pizzeria.h"
+#include "stats.h"
+
+// --------------------- Kuchnia: kolejka przygotowania i piece ---------------------
+//
+// Zamówienie grupy (SEND_ORDER) trafia do ograniczonej kolejki przygotowania
+// (po jednej pozycji na pizzę). Wolny piec bierze pizzę z czoła kolejki i dokłada
+// do wsadu kolejne pizze o tym samym czasie pieczenia (MenuItem.bakeMs), do pojemności
+// pieca. Gdy upieką się wszystkie pizze grupy, idzie do niej odpowiedź PIZZA_READY -
+// dopiero wtedy grupa zaczyna jeść.
+//
+// Logika nie zna IPC ani zegara: czas (ns) podaje wywołujący, więc tę samą kuchnię
+// prowadzi wątek kasjera (kitchenStart / kitchenOrder, CLOCK_MONOTONIC) i symulacja
+// zdarzeń (des.c, czas wirtualny).
+//
+// Konfiguracja: PIZZERIA_KITCHEN="piece[,wsad[,kolejka]]" (domyślnie wsad 4, kolejka 32 pizze);
+// bez zmiennej (albo "0") kuchni nie ma - grupa je zaraz po zamówieniu, jak dotąd.
+// Kolejka pełna: kasjer czeka, aż piec zabierze pizze (przeciwciśnienie), co liczy się jako przestój.
+
+#define KITCHEN_MAX_OVENS     16
+#define KITCHEN_MAX_LOAD      16
+#define KITCHEN_MAX_QUEUE    256
+#define KITCHEN_DEFAULT_LOAD   4
+#define KITCHEN_DEFAULT_QUEUE 32
+
+typedef struct {
+    int ovens;                  // 0 - bez kuchni
+    int load;                   // pizz w jednym wsadzie
+    int queueLimit;             // pizz w kolejce przygotowania (>= MAX_GROUP_SIZE)
+} KitchenConfig;
+
+// PIZZA_READY do grupy (kasjer - przez transport, des.c - zdarzenie początku jedzenia)
+typedef void (*KitchenReadyFn)(void* ctx, const GroupOfClients* g, int tableIndex);
+
+typedef struct {
+    GroupOfClients group;
+    int            tableIndex;
+    int            remaining;   // pizze jeszcze nieupieczone
+    long long      orderedNs;
+} KitchenTicket;
+
+typedef struct {
+    int ticket;
+    int bakeMs;
+} KitchenPizza;
+
+typedef struct {
+    long long startNs;
+    long long endNs;
+    int       count;            // 0 - piec wolny
+    int       ticket[KITCHEN_MAX_LOAD];
+} KitchenOven;
+
+typedef struct {
+    KitchenConfig  cfg;
+    KitchenReadyFn ready;
+    void*          readyCtx;
+    KitchenTicket* tickets;
+    int*           freeTickets;
+    int            freeCount;
+    KitchenPizza   queue[KITCHEN_MAX_QUEUE];
+    int            queued;
+    KitchenOven    ovens[KITCHEN_MAX_OVENS];
+    KitchenTicket  done[KITCHEN_MAX_OVENS * KITCHEN_MAX_LOAD];  // gotowe, jeszcze bez PIZZA_READY
+    int            doneCount;
+    long long      startNs;
+    KitchenSummary summary;
+
+    // Wątek kuchni (cashier_app)
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;       // nowe zamówienie albo koniec pracy
+    pthread_cond_t  room;       // miejsce w kolejce przygotowania
+    pthread_t       thread;
+    int             running;
+    int             stop;
+} Kitchen;
+
+int  kitchenConfigParse(KitchenConfig* cfg, const char* spec);
+int  kitchenConfigFromEnv(KitchenConfig* cfg);
+
+int  kitchenInit(Kitchen* k, const KitchenConfig* cfg, KitchenReadyFn ready, void* ctx, long long nowNs);
+void kitchenDestroy(Kitchen* k);
+int  kitchenSubmit(Kitchen* k, const CommunicationMessage* order, long long orderedNs, long long nowNs);
+long long kitchenAdvance(Kitchen* k, long long nowNs);
+void kitchenStalled(Kitchen* k, long long waitedNs);
+void kitchenFinish(Kitchen* k, long long nowNs);
+
+// Wątek kuchni
+int  kitchenStart(Kitchen* k);
+void kitchenOrder(Kitchen* k, const CommunicationMessage* order);
+void kitchenStop(Kitchen* k);
+
+#endif // KITCHEN_H
@@ -1,6 +1,18 @@
 #!/bin/bash
 
-gcc manager.c pizzeria.c -o manager_app
-gcc cashier.c pizzeria.c -o cashier_app
-gcc client.c pizzeria.c -lpthread -o client_app
-gcc fireman.c pizzeria.c -o fireman_app
+# Dodatkowe flagi, np. CFLAGS=-DPIZZERIA_HEADLESS ./kompilacja.sh (bez formatowania logów w kasjerze)
+# Układ lokalu (pizzeria.h): CFLAGS="-DMAX_TABLE_CAPACITY=12 -DMAX_GROUP_SIZE=10" - stoły bankietowe,
+# CFLAGS=-DPIZZERIA_LAYOUT_GENERIC - jedna wersja dla układów znanych dopiero przy starcie
+CFLAGS=${CFLAGS:-}
+
+gcc $CFLAGS -O2 manager.c launch.c histogram.c shard.c arrivals.c pizzeria.c logger.c -lpthread -lm -o manager_app
+gcc $CFLAGS -O2 cashier.c cashier_shard.c kitchen.c admission.c report.c metrics.c shard.c transport.c restaurant.c seating.c journal.c stats.c histogram.c pizzeria.c logger.c -lpthread -o cashier_app
+gcc $CFLAGS -O2 client.c order.c launch.c histogram.c shard.c transport.c pizzeria.c logger.c -lpthread -o client_app
+gcc $CFLAGS -O2 fireman.c pizzeria.c logger.c -lpthread -o fireman_app
+gcc $CFLAGS -O2 pizzeria_top.c metrics.c pizzeria.c logger.c -lpthread -o pizzeria_top
+gcc $CFLAGS -O2 engine.c des.c kitchen.c admission.c order.c arrivals.c restaurant.c seating.c journal.c stats.c histogram.c pizzeria.c logger.c -lpthread -lm -o engine_app
+gcc $CFLAGS -O2 bench_seating.c seating.c pizzeria.c logger.c -lpthread -o bench_seating_app
+gcc $CFLAGS -O2 bench.c transport.c pizzeria.c logger.c -lpthread -o bench_app
+gcc $CFLAGS -O2 bench_arrivals.c arrivals.c pizzeria.c logger.c -lpthread -lm -o bench_arrivals_app
+gcc $CFLAGS -O2 replay.c admission.c restaurant.c seating.c journal.c stats.c histogram.c pizzeria.c logger.c -lpthread -o replay_app
+gcc $CFLAGS -O2 bench_orders.c order.c pizzeria.c logger.c -lpthread -o bench_orders_app
@@ -0,0 +1,358 @@
+#include "launch.h"
+#include "logger.h"
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <spawn.h>
+#include <poll.h>
+
+extern char** environ;
+
+/**
+ * PIZZERIA_LAUNCH = fork | spawn | pool[:N] (NULL lub pusty napis - fork).
+ * @return 0 lub -1 (błędna wartość).
+ */
+
+static int parseStrategy(ClientLauncher* l, const char* spec, int* poolSize) {
+    *poolSize = LAUNCH_POOL_DEFAULT;
+    if (spec == NULL || *spec == '\0' || strcasecmp(spec, "fork") == 0) {
+        l->strategy = LAUNCH_FORK;
+        snprintf(l->spec, sizeof(l->spec), "fork");
+        return 0;
+    }
+    if (strcasecmp(spec, "spawn") == 0) {
+        l->strategy = LAUNCH_SPAWN;
+        snprintf(l->spec, sizeof(l->spec), "spawn");
+        return 0;
+    }
+    if (strncasecmp(spec, "pool", 4) == 0 && (spec[4] == '\0' || spec[4] == ':')) {
+        if (spec[4] == ':') {
+            char* end;
+            long n = strtol(spec + 5, &end, 10);
+            if (end == spec + 5 || *end != '\0' || n < 1 || n > MAX_CUSTOMERS) {
+                fprintf(stderr, "[launch.c] Pula klientów: 1..%d procesów (%s)\n", MAX_CUSTOMERS, spec);
+                return -1;
+            }
+            *poolSize = (int)n;
+        }
+        l->strategy = LAUNCH_POOL;
+        snprintf(l->spec, sizeof(l->spec), "pool:%d", *poolSize);
+        return 0;
+    }
+    fprintf(stderr, "[launch.c] Nieznany sposób uruchamiania klientów: %s (fork, spawn, pool[:N])\n", spec);
+    return -1;
+}
+
+/**
+ * Uruchamia (fork + exec) pracownika puli nr slot: client_app -w <fd_przydziałów> <slot>.
+ * Koniec potoku do zapisu ma FD_CLOEXEC, więc nie trafia do innych klientów.
+ *
+ * @return 0 lub -1 (errno z pipe / fork).
+ */
+
+static int startWorker(ClientLauncher* l, int slot) {
+    int fds[2];
+    if (pipe(fds) == -1) {
+        return -1;
+    }
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        setpgid(0, l->clientGroup);
+        char bufFd[12], bufSlot[12];
+        snprintf(bufFd,   sizeof(bufFd), "%d", fds[0]);
+        snprintf(bufSlot, sizeof(bufSlot), "%d", slot);
+        execl("./client_app", "client_app", "-w", bufFd, bufSlot, NULL);
+        perror(CLR_MGR "[Manager] Nie udało się uruchomić pracownika puli klientów" CLR_RESET);
+        exit(1);
+    }
+    setpgid(pid, l->clientGroup);
+    close(fds[0]);
+    l->workers[slot].pid  = pid;
+    l->workers[slot].fd   = fds[1];
+    l->workers[slot].busy = 0;
+    if (slot == l->workerCount) {
+        l->workerCount++;
+    }
+    l->idle++;
+    return 0;
+}
+
+/**
+ * Przygotowuje uruchamianie klientów w grupie procesów clientGroup: potok meldunków
+ * (PIZZERIA_LAUNCH_FD dla wszystkich uruchamianych później klientów), a przy puli -
+ * jej pracowników.
+ *
+ * @return 0 lub -1 (błędny PIZZERIA_LAUNCH albo błąd pipe / fork).
+ */
+
+int launcherInit(ClientLauncher* l, pid_t clientGroup) {
+    memset(l, 0, sizeof(*l));
+    l->clientGroup = clientGroup;
+    histInit(&l->callNs);
+    histInit(&l->readyNs);
+    int poolSize;
+    if (parseStrategy(l, getenv("PIZZERIA_LAUNCH"), &poolSize) == -1) {
+        return -1;
+    }
+
+    int fds[2];
+    if (pipe(fds) == -1) {
+        return -1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);  // pełny potok - READY przepada, klient nie czeka (DONE czeka, launchNotify)
+    l->notesFd      = fds[0];
+    l->notesWriteFd = fds[1];
+    char bufFd[12];
+    snprintf(bufFd, sizeof(bufFd), "%d", fds[1]);
+    if (setenv(LAUNCH_FD_ENV, bufFd, 1) == -1) {
+        return -1;
+    }
+
+    if (l->strategy == LAUNCH_POOL) {
+        l->workers = (LaunchWorker*)calloc(MAX_CUSTOMERS, sizeof(LaunchWorker));
+        if (l->workers == NULL) {
+            return -1;
+        }
+        for (int i = 0; i < poolSize; i++) {
+            if (startWorker(l, i) == -1) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int assignWorker(ClientLauncher* l, int groupSize, long long launchNs) {
+    int slot = -1;
+    for (int i = 0; i < l->workerCount && slot == -1; i++) {
+        if (l->workers[i].pid != 0 && !l->workers[i].busy) {
+            slot = i;
+        }
+    }
+    if (slot == -1) {
+        // Wszyscy zajęci - pula rośnie (wolne miejsce po zakończonym pracowniku albo nowe)
+        for (int i = 0; i < l->workerCount && slot == -1; i++) {
+            if (l->workers[i].pid == 0) {
+                slot = i;
+            }
+        }
+        if (slot == -1) {
+            slot = l->workerCount;
+        }
+        if (slot == MAX_CUSTOMERS) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (startWorker(l, slot) == -1) {
+            return -1;
+        }
+    }
+    LaunchAssignment a = { groupSize, launchNs };
+    while (write(l->workers[slot].fd, &a, sizeof(a)) == -1) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    l->workers[slot].busy = 1;
+    l->idle--;
+    return 0;
+}
+
+/**
+ * Uruchamia klienta (grupę groupSize osób) wybranym sposobem
+ * i zapisuje czas wywołania w histogramie callNs.
+ *
+ * @return 0 lub -1 (errno).
+ */
+
+int launchClient(ClientLauncher* l, int groupSize) {
+    long long launchNs = monotonicNs();
+    char sizeBuf[12], launchBuf[24];
+    snprintf(sizeBuf,   sizeof(sizeBuf), "%d", groupSize);
+    snprintf(launchBuf, sizeof(launchBuf), "%lld", launchNs);
+
+    if (l->strategy == LAUNCH_POOL) {
+        if (assignWorker(l, groupSize, launchNs) == -1) {
+            return -1;
+        }
+    } else if (l->strategy == LAUNCH_SPAWN) {
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        short flags = POSIX_SPAWN_SETPGROUP;
+#ifdef POSIX_SPAWN_USEVFORK
+        flags |= POSIX_SPAWN_USEVFORK;
+#endif
+        posix_spawnattr_setflags(&attr, flags);
+        posix_spawnattr_setpgroup(&attr, l->clientGroup);
+        char* args[] = { "client_app", sizeBuf, launchBuf, NULL };
+        pid_t pid;
+        int rc = posix_spawn(&pid, "./client_app", NULL, &attr, args, environ);
+        posix_spawnattr_destroy(&attr);
+        if (rc != 0) {
+            errno = rc;
+            return -1;
+        }
+    } else {
+        pid_t pid = fork();
+        if (pid == -1) {
+            return -1;
+        }
+        if (pid == 0) {
+            // Proces klienta (w grupie klientów - setpgid po obu stronach fork(), bez wyścigu)
+            setpgid(0, l->clientGroup);
+            execl("./client_app", "client_app", sizeBuf, launchBuf, NULL);
+            perror(CLR_MGR "[Manager] Nie udało się uruchomić klienta" CLR_RESET);
+            exit(1);
+        }
+        setpgid(pid, l->clientGroup);
+    }
+    l->launched++;
+    histRecord(&l->callNs, (uint64_t)(monotonicNs() - launchNs));
+    return 0;
+}
+
+/**
+ * Odczytuje (bez czekania) meldunki klientów: opóźnienia startu trafiają do readyNs,
+ * zwolnieni pracownicy puli wracają do wolnych.
+ *
+ * @return Liczba grup, które skończyły się u pracowników puli.
+ */
+
+int launcherPoll(ClientLauncher* l) {
+    LaunchNote notes[64];
+    int finished = 0;
+    ssize_t got;
+    while ((got = read(l->notesFd, notes, sizeof(notes))) > 0) {
+        for (int i = 0; i < got / (ssize_t)sizeof(LaunchNote); i++) {
+            if (notes[i].kind == LAUNCH_NOTE_READY) {
+                histRecord(&l->readyNs, (uint64_t)(notes[i].ns > 0 ? notes[i].ns : 0));
+                continue;
+            }
+            int s = notes[i].slot;
+            if (l->workers != NULL && s >= 0 && s < l->workerCount && l->workers[s].busy) {
+                l->workers[s].busy = 0;
+                l->idle++;
+                finished++;
+            }
+        }
+    }
+    return finished;
+}
+
+/**
+ * Zebrany proces z grupy klientów. Pracownik puli zwalnia swoje miejsce.
+ *
+ * @return 1, jeśli z procesem skończyła się grupa (klient albo zajęty pracownik), inaczej 0.
+ */
+
+int launcherReaped(ClientLauncher* l, pid_t pid) {
+    if (pid == l->clientGroup) {
+        return 0;
+    }
+    if (l->workers == NULL) {
+        return 1;
+    }
+    for (int i = 0; i < l->workerCount; i++) {
+        if (l->workers[i].pid == pid) {
+            int busy = l->workers[i].busy;
+            close(l->workers[i].fd);
+            l->workers[i].pid  = 0;
+            l->workers[i].busy = 0;
+            if (!busy) {
+                l->idle--;
+            }
+            return busy;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Koniec przyjmowania grup: pracownicy puli dostają koniec potoku
+ * (wolni kończą od razu, zajęci po swojej grupie). Potok meldunków zostaje otwarty.
+ */
+
+void launcherClose(ClientLauncher* l) {
+    for (int i = 0; l->workers != NULL && i < l->workerCount; i++) {
+        if (l->workers[i].pid != 0) {
+            close(l->workers[i].fd);
+            l->workers[i].pid = 0;
+        }
+    }
+    l->idle = 0;
+}
+
+void launcherDestroy(ClientLauncher* l) {
+    launcherClose(l);
+    close(l->notesFd);
+    close(l->notesWriteFd);
+    free(l->workers);
+    l->workers = NULL;
+}
+
+/**
+ * Dopisuje do pliku fd podsumowanie uruchamiania klientów: sposób, czas wywołania
+ * w managerze (i wynikającą z niego największą intensywność przybyć) oraz czas
+ * od decyzji managera do startu obsługi grupy.
+ */
+
+void launcherReport(const ClientLauncher* l, int fd) {
+    char line[256];
+    snprintf(line, sizeof(line), "----- Uruchamianie klientów (%s) -----\n", l->spec);
+    write(fd, line, strlen(line));
+    snprintf(line, sizeof(line), "Uruchomione grupy: %ld\n", l->launched);
+    write(fd, line, strlen(line));
+    if (l->callNs.count == 0) {
+        return;
+    }
+    double meanCall = histMean(&l->callNs);
+    snprintf(line, sizeof(line), "Wywołanie w managerze: średnio %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us"
+             " (do %.0f grup/s)\n",
+             meanCall / 1e3, histPercentile(&l->callNs, 50) / 1e3, histPercentile(&l->callNs, 99) / 1e3,
+             l->callNs.max / 1e3, meanCall > 0 ? 1e9 / meanCall : 0.0);
+    write(fd, line, strlen(line));
+    if (l->readyNs.count > 0) {
+        snprintf(line, sizeof(line), "Gotowość klienta (%lu): średnio %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                 (unsigned long)l->readyNs.count, histMean(&l->readyNs) / 1e3, histPercentile(&l->readyNs, 50) / 1e3,
+                 histPercentile(&l->readyNs, 99) / 1e3, l->readyNs.max / 1e3);
+        write(fd, line, strlen(line));
+    }
+}
+
+// --------------------- Strona klienta ---------------------
+
+/**
+ * Klient: melduje managerowi start obsługi grupy (opóźnienie od launchNs)
+ * albo - pracownik puli - jej koniec. Bez PIZZERIA_LAUNCH_FD nic nie robi.
+ * Przy pełnym potoku READY (tylko statystyka) przepada, a DONE czeka na miejsce -
+ * bez niego manager uważałby pracownika za zajętego do końca dnia. Po launcherClose
+ * meldunków DONE jest najwyżej tyle, ilu pracowników (MAX_CUSTOMERS), więc zmieszczą się w potoku.
+ */
+
+void launchNotify(int kind, int slot, long long launchNs) {
+    static int fd = -2;  // -2: jeszcze nie sprawdzono zmiennej, -1: brak potoku
+    if (fd == -2) {
+        const char* s = getenv(LAUNCH_FD_ENV);
+        fd = (s != NULL) ? atoi(s) : -1;
+    }
+    if (fd < 0 || (kind == LAUNCH_NOTE_READY && launchNs <= 0)) {
+        return;
+    }
+    LaunchNote note = { kind, slot, (kind == LAUNCH_NOTE_READY) ? monotonicNs() - launchNs : 0 };
+    while (write(fd, &note, sizeof(note)) == -1) {
+        if (errno == EAGAIN && kind == LAUNCH_NOTE_DONE) {
+            struct pollfd p = { fd, POLLOUT, 0 };
+            poll(&p, 1, -1);
+        } else if (errno != EINTR) {
+            break;
+        }
+    }
+}
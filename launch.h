@@ -0,0 +1,73 @@
+#ifndef LAUNCH_H
+#define LAUNCH_H
+
+#include "pizzeria.h"
+#include "histogram.h"
+
+// --------------------- Uruchamianie procesów klientów ---------------------
+//
+// Sposób uruchamiania grup wybiera PIZZERIA_LAUNCH:
+//   fork (domyślnie) - jak dotąd: fork() managera i execl("./client_app")
+//   spawn            - posix_spawn() (w glibc clone(CLONE_VM | CLONE_VFORK) - bez kopiowania
+//                      przestrzeni adresowej managera), grupa procesów ustawiana atrybutem
+//   pool[:N]         - N (domyślnie LAUNCH_POOL_DEFAULT) gotowych procesów client_app -w,
+//                      uruchomionych przed otwarciem; każdy czyta przydziały (wielkość grupy)
+//                      z własnego potoku i obsługuje kolejne grupy. Gdy wszyscy są zajęci,
+//                      pula rośnie (do MAX_CUSTOMERS). Pracownik kończy się na końcu potoku.
+// Klient odsyła potokiem meldunków (PIZZERIA_LAUNCH_FD, nieblokujący) czas od decyzji managera
+// do startu obsługi grupy, a pracownik puli - także zwolnienie. Manager zbiera dwa histogramy:
+// czas wywołania (ile blokuje pętlę przybyć) i czas do gotowości klienta.
+
+#define LAUNCH_FORK           0
+#define LAUNCH_SPAWN          1
+#define LAUNCH_POOL           2
+#define LAUNCH_POOL_DEFAULT  32
+#define LAUNCH_FD_ENV        "PIZZERIA_LAUNCH_FD"
+
+#define LAUNCH_NOTE_READY     0   // klient zaczyna obsługę grupy (ns = opóźnienie startu)
+#define LAUNCH_NOTE_DONE      1   // pracownik puli skończył grupę
+
+typedef struct {
+    int       kind;               // LAUNCH_NOTE_*
+    int       slot;               // nr pracownika puli (-1 poza pulą)
+    long long ns;
+} LaunchNote;
+
+typedef struct {
+    int       size;               // wielkość grupy
+    long long launchNs;           // chwila decyzji managera [CLOCK_MONOTONIC]
+} LaunchAssignment;
+
+typedef struct {
+    pid_t pid;                    // 0 - pracownik zakończony
+    int   fd;                     // koniec potoku przydziałów do zapisu
+    int   busy;
+} LaunchWorker;
+
+typedef struct {
+    int           strategy;
+    char          spec[16];       // do wypisania w logach
+    pid_t         clientGroup;
+    int           notesFd;        // potok meldunków - koniec do odczytu (nieblokujący)
+    int           notesWriteFd;   // koniec do zapisu, dziedziczony przez klientów
+    LaunchWorker* workers;        // pula
+    int           workerCount;
+    int           idle;           // wolni pracownicy puli
+    long          launched;
+    Histogram     callNs;         // czas wywołania w managerze
+    Histogram     readyNs;        // od decyzji do startu obsługi grupy w kliencie
+} ClientLauncher;
+
+// Manager
+int   launcherInit(ClientLauncher* l, pid_t clientGroup);
+int   launchClient(ClientLauncher* l, int groupSize);
+int   launcherPoll(ClientLauncher* l);
+int   launcherReaped(ClientLauncher* l, pid_t pid);
+void  launcherClose(ClientLauncher* l);
+void  launcherDestroy(ClientLauncher* l);
+void  launcherReport(const ClientLauncher* l, int fd);
+
+// Klient
+void  launchNotify(int kind, int slot, long long launchNs);
+
+#endif // LAUNCH_H
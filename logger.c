@@ -0,0 +1,234 @@
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// Jeden slot pierścienia = jedna gotowa linia tekstu.
+// Producenci rezerwują slot przez CAS na tail (bez blokad), piszą tekst
+// i publikują go ustawiając seq; jedyny konsument (wątek piszący) czyta po kolei.
+typedef struct {
+    atomic_ulong seq;
+    int          len;
+    char         text[LOG_LINE_MAX];
+} LogSlot;
+
+// Stan wątku piszącego widziany przez producentów
+#define WRITER_RUNNING  0
+#define WRITER_NAPPING  1  // śpi z limitem czasu, budzimy go dopiero przy połowie pierścienia
+#define WRITER_IDLE     2  // śpi bez limitu, budzi go pierwsza nowa linia
+
+#define WRITER_NAP_NS   20000000L  // maksymalne opóźnienie linii w trakcie ruchu (20 ms)
+
+static int            currentLevel = -1;
+static int            asyncMode    = 0;
+static LogSlot        ring[LOG_RING_SLOTS];
+static atomic_ulong   ringTail;
+static atomic_ulong   ringHead;
+static atomic_ulong   droppedLines;
+static atomic_int     writerState;
+static atomic_int     writerWakeups;  // słowo futexa
+static atomic_int     stopWriter;
+static pthread_t      writerThread;
+
+static int parseLevel(const char* s) {
+    if (s == NULL)                      return LVL_DEBUG;
+    if (strcasecmp(s, "quiet") == 0)    return LVL_QUIET;
+    if (strcasecmp(s, "error") == 0)    return LVL_ERROR;
+    if (strcasecmp(s, "info") == 0)     return LVL_INFO;
+    if (strcasecmp(s, "debug") == 0)    return LVL_DEBUG;
+    int lvl = atoi(s);
+    return (lvl < LVL_QUIET) ? LVL_QUIET : (lvl > LVL_DEBUG ? LVL_DEBUG : lvl);
+}
+
+int logLevel(void) {
+    if (currentLevel < 0) {
+        currentLevel = parseLevel(getenv("PIZZERIA_LOG"));
+    }
+    return currentLevel;
+}
+
+unsigned long logDropped(void) {
+    return atomic_load(&droppedLines);
+}
+
+static void writeAll(const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, buf, len);
+        if (n <= 0) {
+            return;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static int ringHasLine(void) {
+    unsigned long head = atomic_load_explicit(&ringHead, memory_order_relaxed);
+    LogSlot* slot = &ring[head & (LOG_RING_SLOTS - 1)];
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) == head + 1;
+}
+
+/**
+ * Przepisuje wszystkie opublikowane linie do bufora i wypisuje je jednym write().
+ * @return Liczba przepisanych linii.
+ */
+
+static int drainRing(void) {
+    static char batch[LOG_RING_SLOTS / 4 * LOG_LINE_MAX];
+    size_t used = 0;
+    int lines = 0;
+    unsigned long head = atomic_load_explicit(&ringHead, memory_order_relaxed);
+    while (1) {
+        LogSlot* slot = &ring[head & (LOG_RING_SLOTS - 1)];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != head + 1) {
+            break;
+        }
+        if (used + (size_t)slot->len > sizeof(batch)) {
+            writeAll(batch, used);
+            used = 0;
+        }
+        memcpy(batch + used, slot->text, (size_t)slot->len);
+        used += (size_t)slot->len;
+        atomic_store_explicit(&slot->seq, head + LOG_RING_SLOTS, memory_order_release);
+        head++;
+        atomic_store_explicit(&ringHead, head, memory_order_release);
+        lines++;
+    }
+    if (used > 0) {
+        writeAll(batch, used);
+    }
+    return lines;
+}
+
+/**
+ * Wątek piszący: opróżnia pierścień partiami. W trakcie ruchu drzemie do 20 ms
+ * (producenci budzą go tylko, gdy pierścień zapełni się do połowy), a gdy
+ * dwie drzemki z rzędu nic nie przyniosły - śpi na futeksie bez limitu czasu.
+ */
+
+static void* writerMain(void* arg) {
+    (void)arg;
+    int idleRounds = 0;
+    struct timespec nap = { 0, WRITER_NAP_NS };
+    while (1) {
+        int lines = drainRing();
+        if (atomic_load(&stopWriter)) {
+            drainRing();
+            return NULL;
+        }
+        idleRounds = (lines > 0) ? 0 : idleRounds + 1;
+        int deep = (idleRounds >= 2);
+
+        int seen = atomic_load(&writerWakeups);
+        atomic_store(&writerState, deep ? WRITER_IDLE : WRITER_NAPPING);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!ringHasLine() && !atomic_load(&stopWriter)) {
+            syscall(SYS_futex, &writerWakeups, FUTEX_WAIT_PRIVATE, seen, deep ? NULL : &nap, NULL, 0);
+        }
+        atomic_store(&writerState, WRITER_RUNNING);
+    }
+}
+
+static void wakeWriter(unsigned long pos) {
+    atomic_thread_fence(memory_order_seq_cst);
+    int state = atomic_load(&writerState);
+    if (state == WRITER_IDLE
+        || (state == WRITER_NAPPING && pos + 1 - atomic_load(&ringHead) >= LOG_RING_SLOTS / 2)) {
+        atomic_fetch_add(&writerWakeups, 1);
+        syscall(SYS_futex, &writerWakeups, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+/**
+ * Inicjuje logowanie w procesie.
+ * @param async 1 - linie trafiają do pierścienia opróżnianego przez wątek w tle,
+ *              0 - wypisujemy od razu (procesy krótko żyjące).
+ */
+
+void logInit(int async) {
+    logLevel();
+    if (!async || asyncMode || currentLevel == LVL_QUIET) {
+        return;
+    }
+    for (unsigned long i = 0; i < LOG_RING_SLOTS; i++) {
+        atomic_store(&ring[i].seq, i);
+    }
+    atomic_store(&ringTail, 0);
+    atomic_store(&ringHead, 0);
+    fflush(stdout);
+    if (pthread_create(&writerThread, NULL, writerMain, NULL) != 0) {
+        perror("[logger.c] Błąd pthread_create() wątku logowania");
+        return; // zostajemy przy wypisywaniu synchronicznym
+    }
+    asyncMode = 1;
+    atexit(logShutdown);
+}
+
+/**
+ * Zatrzymuje wątek piszący po wypisaniu wszystkiego, co zostało w pierścieniu.
+ */
+
+void logShutdown(void) {
+    if (!asyncMode) {
+        return;
+    }
+    atomic_store(&stopWriter, 1);
+    atomic_fetch_add(&writerWakeups, 1);
+    syscall(SYS_futex, &writerWakeups, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    pthread_join(writerThread, NULL);
+    asyncMode = 0;
+    if (atomic_load(&droppedLines) > 0) {
+        fprintf(stderr, "[logger.c] Pominięto %lu linii (pełny bufor logów)\n", atomic_load(&droppedLines));
+    }
+}
+
+/**
+ * Formatuje linię logu. W trybie asynchronicznym rezerwuje slot w pierścieniu
+ * (gdy pierścień jest pełny, linia jest pomijana i liczona w droppedLines,
+ * żeby nie blokować kasjera), w synchronicznym - wypisuje przez stdout.
+ */
+
+void logWrite(int level, const char* fmt, ...) {
+    va_list ap;
+    if (!logEnabled(level)) {
+        return;
+    }
+    va_start(ap, fmt);
+    if (!asyncMode) {
+        vprintf(fmt, ap);
+        va_end(ap);
+        return;
+    }
+
+    unsigned long pos = atomic_load_explicit(&ringTail, memory_order_relaxed);
+    LogSlot* slot;
+    while (1) {
+        slot = &ring[pos & (LOG_RING_SLOTS - 1)];
+        unsigned long seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        long diff = (long)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ringTail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add(&droppedLines, 1);
+            va_end(ap);
+            return;
+        } else {
+            pos = atomic_load_explicit(&ringTail, memory_order_relaxed);
+        }
+    }
+    int len = vsnprintf(slot->text, LOG_LINE_MAX, fmt, ap);
+    va_end(ap);
+    slot->len = (len < 0) ? 0 : (len >= LOG_LINE_MAX ? LOG_LINE_MAX - 1 : len);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    wakeWriter(pos);
+}
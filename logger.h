@@ -0,0 +1,37 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// --------------------- Poziomy logowania ---------------------
+// Poziom wybiera zmienna środowiskowa PIZZERIA_LOG (quiet|error|info|debug,
+// domyślnie debug - tak jak dotąd wypisujemy wszystko).
+#define LVL_QUIET   0
+#define LVL_ERROR   1
+#define LVL_INFO    2
+#define LVL_DEBUG   3
+
+#define LOG_RING_SLOTS  1024  // potęga dwójki
+#define LOG_LINE_MAX     256
+
+void logInit(int async);
+void logShutdown(void);
+int  logLevel(void);
+void logWrite(int level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+unsigned long logDropped(void);
+
+#define logEnabled(level) ((level) <= logLevel())
+
+// LOG - komunikaty poza gorącą ścieżką.
+#define LOG(level, ...) \
+    do { if (logEnabled(level)) logWrite((level), __VA_ARGS__); } while (0)
+
+// LOG_HOT - komunikaty z sekcji krytycznych kasjera. W trybie bez terminala
+// (-DPIZZERIA_HEADLESS) formatowanie znika z kodu całkowicie.
+#ifdef PIZZERIA_HEADLESS
+#define LOG_HOT(level, ...) do { } while (0)
+#define LOG_HOT_ENABLED(level) 0
+#else
+#define LOG_HOT(level, ...) LOG(level, __VA_ARGS__)
+#define LOG_HOT_ENABLED(level) logEnabled(level)
+#endif
+
+#endif // LOGGER_H
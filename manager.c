@@ -1,16 +1,24 @@
 #include "pizzeria.h"
+#include "logger.h"
+#include "shard.h"
+#include "arrivals.h"
+#include "launch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/wait.h>
 #include <errno.h>
-#include <sched.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <poll.h>
 
 static volatile sig_atomic_t fireEvent = 0;
+static struct timespec fireTime;  // chwila odebrania sygnału pożaru (CLOCK_MONOTONIC)
 
 /**
  * Handler sygnału SIGUSR1 (pożar).
  * Ustawia flagę fireEvent = 1, co pozwala managerowi
- * wiedzieć, że musi zakończyć pętlę generowania klientów.
+ * wiedzieć, że musi zakończyć pętlę generowania klientów,
+ * i zapamiętuje czas pożaru (clock_gettime jest bezpieczne w handlerze).
  *
  * @param sig Numer sygnału (oczekiwany SIGUSR1).
  */
@@ -20,36 +28,37 @@ static void signalFire(int sig);
 // Obsługa sygnału pożaru
 static void signalFire(int sig) {
     if (sig == SIGUSR1) {
+        clock_gettime(CLOCK_MONOTONIC, &fireTime);
         fireEvent = 1;
     }
 }
 
 /**
- * Sprawdza poprawność 4 argumentów przekazanych do managera.
- * Każdy argument oznacza liczbę stolików (1-os, 2-os, 3-os, 4-os).
+ * Sprawdza argumenty managera: liczby stolików 1-, 2-, ..., MAX_TABLE_CAPACITY-osobowych
+ * (w wersji ogólnej PIZZERIA_LAYOUT_GENERIC wystarczą pierwsze pojemności).
  * Wymaga, aby >= 0 i przynajmniej jeden z nich był > 0.
  * Jeśli niepoprawne, wypisuje błąd i kończy program.
  *
  * @param argc Liczba argumentów w main.
  * @param argv Tablica argumentów.
- * @return Suma (x1 + x2 + x3 + x4).
+ * @param perCapacity Liczby stolików każdej pojemności.
+ * @return Łączna liczba stolików.
  */
 
-// Walidacja argumentów: X1, X2, X3, X4
-static int validateArgs(int argc, char* argv[]) {
-    if (argc != 5) {
-        fprintf(stderr, CLR_MGR "Użycie: ./manager_app X1 X2 X3 X4\n" CLR_RESET);
+// Walidacja argumentów: X1 .. X(MAX_TABLE_CAPACITY)
+static int validateArgs(int argc, char* argv[], int perCapacity[MAX_TABLE_CAPACITY]) {
+    if (argc < 2) {
+        fprintf(stderr, CLR_MGR "Użycie: ./manager_app X1 ... X%d (liczby stolików 1..%d-osobowych)\n" CLR_RESET,
+                MAX_TABLE_CAPACITY, MAX_TABLE_CAPACITY);
         exit(1);
     }
-    int x1 = atoi(argv[1]);
-    int x2 = atoi(argv[2]);
-    int x3 = atoi(argv[3]);
-    int x4 = atoi(argv[4]);
-    if ((x1 < 0 || x2 < 0 || x3 < 0 || x4 < 0) || (x1 + x2 + x3 + x4) == 0) {
-        fprintf(stderr, CLR_MGR "Błędne argumenty (≥0 i co najmniej jedna wartość > 0)\n" CLR_RESET);
+    int total = parseTableCounts(argc - 1, &argv[1], perCapacity);
+    if (total == -1) {
+        fprintf(stderr, CLR_MGR "Błędne argumenty (%d liczb ≥0 i co najmniej jedna wartość > 0)\n" CLR_RESET,
+                MAX_TABLE_CAPACITY);
         exit(1);
     }
-    return x1 + x2 + x3 + x4;
+    return total;
 }
 
 /**
@@ -74,28 +83,238 @@ static void displayReport() {
     close(fd);
 }
 
+/**
+ * Tworzy grupę procesów dla klientów. Jej liderem jest proces, który tylko
+ * czeka (pause) - grupa istnieje więc przez cały dzień, niezależnie od tego,
+ * którzy klienci już wyszli. Strażak ewakuuje wszystkich jednym kill(-pgid).
+ * SIGUSR1 ma u lidera domyślną obsługę, więc znika razem z klientami.
+ *
+ * @return PGID grupy klientów (= PID lidera).
+ */
+
+static pid_t startClientGroup(void) {
+    pid_t leader = fork();
+    if (leader == -1) {
+        perror(CLR_MGR "[Manager] Błąd fork() przy tworzeniu grupy klientów" CLR_RESET);
+        exit(1);
+    }
+    if (leader == 0) {
+        setpgid(0, 0);
+        signal(SIGUSR1, SIG_DFL);
+        prctl(PR_SET_PDEATHSIG, SIGTERM);  // nie zostajemy po managerze
+        while (1) {
+            pause();
+        }
+    }
+    setpgid(leader, leader);  // także w rodzicu - grupa istnieje, zanim fork() klienta do niej dołączy
+    return leader;
+}
+
+/**
+ * Śpi do chwili atNs [CLOCK_MONOTONIC]; sygnał (pożar) przerywa sen wcześniej.
+ */
+
+static void sleepUntil(long long atNs) {
+    struct timespec ts;
+    ts.tv_sec  = atNs / 1000000000LL;
+    ts.tv_nsec = atNs % 1000000000LL;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static double msBetween(const struct timespec* from, const struct timespec* to) {
+    return (to->tv_sec - from->tv_sec) * 1e3 + (to->tv_nsec - from->tv_nsec) / 1e6;
+}
+
+/**
+ * Dopisuje do "daily_report.txt" raport ewakuacji: czas od pożaru do wyjścia
+ * ostatniego klienta, do zakończenia kasjera i do zakończenia managera.
+ *
+ * @param evacuated Liczba procesów klientów zebranych po pożarze.
+ * @param lastClient Chwila zebrania ostatniego klienta.
+ * @param cashierDone Chwila zakończenia kasjera.
+ * @param managerDone Chwila sprzątnięcia zasobów przez managera.
+ */
+
+static void appendEvacuationReport(int evacuated, const struct timespec* lastClient,
+                                   const struct timespec* cashierDone, const struct timespec* managerDone) {
+    int fd = open("daily_report.txt", O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd == -1) {
+        perror(CLR_MGR "[Manager] Błąd przy otwarciu pliku raportu" CLR_RESET);
+        return;
+    }
+    char line[256];
+    snprintf(line, sizeof(line), "----- Ewakuacja -----\n");
+    write(fd, line, strlen(line));
+
+    snprintf(line, sizeof(line), "Ewakuowane grupy: %d\n", evacuated);
+    write(fd, line, strlen(line));
+
+    snprintf(line, sizeof(line), "Ostatni klient wyszedł po: %.1f ms\n", msBetween(&fireTime, lastClient));
+    write(fd, line, strlen(line));
+
+    snprintf(line, sizeof(line), "Kasjer zakończył pracę po: %.1f ms\n", msBetween(&fireTime, cashierDone));
+    write(fd, line, strlen(line));
+
+    snprintf(line, sizeof(line), "Manager zakończył pracę po: %.1f ms\n", msBetween(&fireTime, managerDone));
+    write(fd, line, strlen(line));
+    close(fd);
+}
+
+/**
+ * Uruchamia kasjera (cashier_app). Przy jednym kasjerze argumenty są takie
+ * jak dotąd, przy kilku dochodzą <nr_kasjera> <liczba_kasjerów>.
+ * Kasjer dziedziczy koniec potoku do zapisu (PIZZERIA_READY_FD), którym melduje
+ * etapy startu. Koniec do odczytu ma FD_CLOEXEC, więc nie trafia do klientów,
+ * a koniec do zapisu manager zamyka zaraz po fork().
+ *
+ * @param perCapacity Liczby stolików każdej pojemności.
+ * @param shard Numer kasjera.
+ * @param shards Liczba kasjerów.
+ * @param readyFd Koniec potoku meldunków do odczytu.
+ * @return PID kasjera.
+ */
+
+static pid_t startCashier(const int perCapacity[MAX_TABLE_CAPACITY], int shard, int shards, int* readyFd) {
+    int fds[2];
+    if (pipe(fds) == -1 || fcntl(fds[0], F_SETFD, FD_CLOEXEC) == -1) {
+        perror(CLR_MGR "[Manager] Błąd pipe() dla meldunków kasjera" CLR_RESET);
+        exit(1);
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror(CLR_MGR "[Manager] Błąd fork() podczas tworzenia kasjera" CLR_RESET);
+        exit(1);
+    }
+    if (pid == 0) {
+        // Proces potomny – kasjer; koniec do zapisu przechodzi przez exec
+        char bufFd[12];
+        snprintf(bufFd, sizeof(bufFd), "%d", fds[1]);
+        if (setenv(READY_FD_ENV, bufFd, 1) == -1) {
+            perror(CLR_MGR "[Manager] Błąd przekazania potoku kasjerowi" CLR_RESET);
+            exit(1);
+        }
+        char  counts[MAX_TABLE_CAPACITY][12];
+        char  bufShard[12], bufShards[12];
+        char* args[MAX_TABLE_CAPACITY + 4];
+        args[0] = "cashier_app";
+        tableCountArgs(perCapacity, counts, &args[1]);
+        int n = MAX_TABLE_CAPACITY + 1;
+        if (shards > 1) {
+            snprintf(bufShard,  sizeof(bufShard), "%d", shard);
+            snprintf(bufShards, sizeof(bufShards), "%d", shards);
+            args[n++] = bufShard;
+            args[n++] = bufShards;
+        }
+        args[n] = NULL;
+        execv("./cashier_app", args);
+        perror(CLR_MGR "[Manager] Nie udało się uruchomić kasjera" CLR_RESET);
+        exit(1);
+    }
+    close(fds[1]);
+    *readyFd = fds[0];
+    return pid;
+}
+
+/**
+ * Śpi w poll(), aż kasjer prowadzący (readyFds[0]) zamelduje etap stage.
+ * Meldunki pozostałych kasjerów są po drodze odczytywane; zamknięty potok
+ * bez meldunku oznacza, że kasjer zginął przy starcie - wtedy kończymy dzień.
+ *
+ * @param readyFds Potoki meldunków kasjerów (prowadzący pierwszy).
+ * @param count Liczba potoków.
+ * @param stage Oczekiwany etap prowadzącego.
+ * @param note Meldunek prowadzącego.
+ */
+
+static void awaitCashiers(const int readyFds[], int count, int stage, ReadyNote* note) {
+    struct pollfd pfd[MAX_SHARDS];
+    for (int s = 0; s < count; s++) {
+        pfd[s].fd     = readyFds[s];
+        pfd[s].events = POLLIN;
+    }
+    while (1) {
+        if (poll(pfd, count, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror(CLR_MGR "[Manager] Błąd poll() podczas czekania na kasjera" CLR_RESET);
+            exit(1);
+        }
+        for (int s = 0; s < count; s++) {
+            if (pfd[s].revents == 0) {
+                continue;
+            }
+            ReadyNote got;
+            int rc = readyAwait(pfd[s].fd, &got);
+            if (rc <= 0) {
+                if (rc == 0) {
+                    fprintf(stderr, CLR_MGR "[Manager] Kasjer nr %d zakończył się przed zgłoszeniem gotowości\n" CLR_RESET, s);
+                } else {
+                    perror(CLR_MGR "[Manager] Błąd odczytu meldunku kasjera" CLR_RESET);
+                }
+                exit(1);
+            }
+            if (s == 0 && got.stage == stage) {
+                *note = got;
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * Sprawdza (bez czekania), czy któryś kasjer zameldował pierwszą grupę przy stoliku.
+ *
+ * @return Chwila meldunku [ns, CLOCK_MONOTONIC] lub 0.
+ */
+
+static long long pollFirstSeat(const int readyFds[], int count) {
+    for (int s = 0; s < count; s++) {
+        ReadyNote got;
+        if (readyAwait(readyFds[s], &got) == 1 && got.stage == READY_FIRST_SEAT) {
+            return got.atNs;
+        }
+    }
+    return 0;
+}
+
 /**
  * Główny proces menedżera pizzerii:
  * 1) Waliduje argumenty (liczba stolików).
- * 2) Uruchamia kasjera (cashier_app).
- * 3) Czeka, aż kasjer utworzy zasoby (semafor, shm).
- * 4) Uruchamia strażaka (fireman_app).
- * 5) Generuje procesy klienta w pętli, ograniczając liczbę aktywnych.
+ * 2) Uruchamia kasjera (cashier_app). Przy PIZZERIA_SHARDS = N > 1 - N kasjerów:
+ *    najpierw prowadzącego, a po jego meldunku o katalogu pozostałych.
+ * 3) Czeka (poll na potokach meldunków, bez aktywnego czekania), aż kasjer utworzy
+ *    zasoby, i wypisuje czasy faz startu: fork, exec, zasoby IPC, pierwsza grupa przy stoliku.
+ * 4) Tworzy grupę procesów klientów i uruchamia strażaka (fireman_app).
+ * 5) Uruchamia klientów (każdy w grupie klientów) w chwilach z modelu przybyć
+ *    (arrivals.c: PIZZERIA_ARRIVALS, PIZZERIA_GROUP_SIZES), ograniczając liczbę aktywnych.
+ *    Sposób (launch.c: PIZZERIA_LAUNCH) - fork + exec, posix_spawn albo pula gotowych klientów.
  * 6) Po upływie czasu lub sygnale pożaru przestaje generować klientów.
+ *    Po pożarze czeka na ostatniego klienta z grupy (czas ewakuacji).
  * 7) Czeka, aż kasjer się zakończy, usuwa semafor i shm.
- * 8) Wyświetla końcowy raport z pliku "daily_report.txt".
+ * 8) Wyświetla końcowy raport z pliku "daily_report.txt" (po pożarze z raportem ewakuacji)
+ *    z czasami uruchamiania klientów.
  *
  * @param argc Liczba argumentów.
- * @param argv [1]..[4] zawierają ilości stolików 1-os, 2-os, 3-os, 4-os.
+ * @param argv [1]..[MAX_TABLE_CAPACITY] zawierają ilości stolików 1-os, 2-os, ... (domyślnie do 4-os.).
  * @return Kod zakończenia (0 przy sukcesie).
  */
 
 // --------------------------------------------------------
 int main(int argc, char* argv[]) {
     // Sprawdzamy poprawność argumentów i wyliczamy liczbę stolików
-    int totalTables = validateArgs(argc, argv);
+    int perCapacity[MAX_TABLE_CAPACITY];
+    int totalTables = validateArgs(argc, argv, perCapacity);
     pid_t managerPid = getpid();
-    srand(time(NULL));
+
+    // Model przybyć (PIZZERIA_ARRIVALS, PIZZERIA_GROUP_SIZES); PIZZERIA_SEED powtarza przebieg
+    const char* seedEnv = getenv("PIZZERIA_SEED");
+    unsigned long long seed = seedEnv ? strtoull(seedEnv, NULL, 0)
+                                      : ((unsigned long long)time(NULL) << 20) ^ (unsigned long long)managerPid;
+    ArrivalModel arrivals;
+    if (arrivalsFromEnv(&arrivals, seed) == -1) {
+        exit(1);
+    }
 
     // Ustawienie obsługi sygnału pożaru (SIGUSR1)
     struct sigaction sa;
@@ -107,20 +326,36 @@ int main(int argc, char* argv[]) {
         exit(1);
     }
 
-    // Uruchomienie kasjera (cashier_app)
-    pid_t cashierPid = fork();
-    if (cashierPid == -1) {
-        perror(CLR_MGR "[Manager] Błąd fork() podczas tworzenia kasjera" CLR_RESET);
-        exit(1);
+    // Uruchomienie kasjera (cashier_app); przy kilku kasjerach to kasjer prowadzący (nr 0)
+    int shards = shardCountFromEnv();
+    if (shards > totalTables) {
+        shards = totalTables;  // kasjer bez stolików nie miałby czego obsługiwać
     }
-    if (cashierPid == 0) {
-        // Proces potomny – kasjer
-        execl("./cashier_app", "cashier_app", argv[1], argv[2], argv[3], argv[4], NULL);
-        perror(CLR_MGR "[Manager] Nie udało się uruchomić kasjera" CLR_RESET);
-        exit(1);
+    int readyFds[MAX_SHARDS];
+    ReadyNote note;
+    long long startNs = monotonicNs();
+    pid_t cashierPid = startCashier(perCapacity, 0, shards, &readyFds[0]);
+    long long forkNs = monotonicNs();
+    if (shards > 1) {
+        awaitCashiers(readyFds, 1, READY_DIRECTORY, &note);
+        for (int s = 1; s < shards; s++) {
+            startCashier(perCapacity, s, shards, &readyFds[s]);
+        }
+        LOG(LVL_INFO, CLR_MGR "[Manager] Uruchomiłem %d kasjerów.\n" CLR_RESET, shards);
+    }
+
+    // Czekamy na meldunek gotowości (zasoby IPC utworzone, kasjerzy przyjmują komunikaty)
+    awaitCashiers(readyFds, shards, READY_SERVING, &note);
+    long long readyNs = monotonicNs();
+    LOG(LVL_INFO, CLR_MGR "[Manager] Start kasjera: fork() %.2f ms, od fork() do main() kasjera %.2f ms, zasoby IPC %.2f ms, "
+        "gotowość po %.2f ms\n" CLR_RESET,
+        (forkNs - startNs) / 1e6, (note.startedNs - startNs) / 1e6,
+        (note.atNs - note.startedNs) / 1e6, (readyNs - startNs) / 1e6);
+    for (int s = 0; s < shards; s++) {
+        fcntl(readyFds[s], F_SETFL, O_NONBLOCK);  // pierwszą grupę przy stoliku sprawdzamy w pętli
     }
+    long long firstSeatNs = 0;
 
-    // Pętla oczekiwania na zasoby (semafor, shm)
     key_t keySem = ftok(".", SEMAPHORE_GEN_CHAR);
     if (keySem == -1) {
         perror(CLR_MGR "[Manager] Błąd ftok() dla semafora" CLR_RESET);
@@ -132,34 +367,12 @@ int main(int argc, char* argv[]) {
         exit(1);
     }
 
-    // 1) Czekamy, aż semafor zostanie utworzony przez kasjera
-    int semId = -1;
-    while (1) {
-        semId = semget(keySem, 0, 0);  // próba dołączenia do istniejącego semafora
-        if (semId != -1) {
-            break; // semafor istnieje
-        }
-        if (errno != ENOENT) {
-            perror(CLR_MGR "[Manager] Błąd semget() podczas czekania na kasjera" CLR_RESET);
-            exit(1);
-        }
-        // aby uniknąć 100% CPU, oddajemy kwant czasu innym procesom
-        sched_yield();
-    }
-    
-    // 2) Czekamy, aż pamięć współdzielona zostanie utworzona
-    int shmId = -1;
-    while (1) {
-        shmId = shmget(keyShm, 0, 0);
-        if (shmId != -1) {
-            break; // pamięć istnieje
-        }
-        if (errno != ENOENT) {
-            perror(CLR_MGR "[Manager] Błąd shmget() podczas czekania na kasjera" CLR_RESET);
-            exit(1);
-        }
-        sched_yield();
-    }
+    // Po meldunku semafor i pamięć współdzielona już istnieją
+    int semId = accessSemaphore(keySem);
+    int shmId = accessSharedMemory(keyShm);
+
+    // Grupa procesów klientów - strażak ewakuuje ją jednym sygnałem
+    pid_t clientGroup = startClientGroup();
 
     // Uruchamiamy strażaka (fireman_app)
     pid_t firemanPid = fork();
@@ -168,12 +381,13 @@ int main(int argc, char* argv[]) {
         exit(1);
     }
     if (firemanPid == 0) {
-        char bufCashier[30], bufManager[30], bufTables[30];
+        char bufCashier[30], bufManager[30], bufTables[30], bufGroup[30];
         snprintf(bufCashier,  sizeof(bufCashier), "%d", cashierPid);
         snprintf(bufManager,  sizeof(bufManager), "%d", managerPid);
         snprintf(bufTables,   sizeof(bufTables), "%d", totalTables);
+        snprintf(bufGroup,    sizeof(bufGroup), "%d", clientGroup);
 
-        execl("./fireman_app", "fireman_app", bufCashier, bufManager, bufTables, NULL);
+        execl("./fireman_app", "fireman_app", bufCashier, bufManager, bufTables, bufGroup, NULL);
         perror(CLR_MGR "[Manager] Nie udało się uruchomić strażaka" CLR_RESET);
         exit(1);
     }
@@ -185,49 +399,94 @@ int main(int argc, char* argv[]) {
         exit(1);
     }
 
-    unsigned long closeTime = time(NULL) + RUNTIME_LIMIT;
+    // Sposób uruchamiania klientów (PIZZERIA_LAUNCH); pula startuje przed otwarciem
+    ClientLauncher launcher;
+    if (launcherInit(&launcher, clientGroup) == -1) {
+        perror(CLR_MGR "[Manager] Błąd przygotowania uruchamiania klientów" CLR_RESET);
+        exit(1);
+    }
+
+    long long openNs  = monotonicNs();
+    long long closeNs = openNs + RUNTIME_LIMIT * 1000000000LL;
+    long long warnNs  = closeNs - TIME_BEFORE_CLOSE * 1000000000LL;
     int totalActive = 0;
     int notifiedClose = 0;
+    long arrived = 0, overLimit = 0;
+    Arrival next;
+    int moreArrivals = arrivalsNext(&arrivals, &next);
+    LOG(LVL_INFO, CLR_MGR "[Manager] Model przybyć: %s, uruchamianie klientów: %s\n" CLR_RESET,
+        arrivals.spec, launcher.spec);
 
     // Pętla generowania klientów
-    while (!fireEvent && (!notifiedClose || time(NULL) < closeTime)) {
-        // Tworzymy 1-3 osobową grupę
-        int groupSize = rand() % 3 + 1;
+    while (!fireEvent && monotonicNs() < closeNs) {
+        // Śpimy do najbliższego przybycia albo ostrzeżenia / zamknięcia
+        long long wakeNs = notifiedClose ? closeNs : warnNs;
+        if (moreArrivals && openNs + next.atUs * 1000 < wakeNs) {
+            wakeNs = openNs + next.atUs * 1000;
+        }
+        sleepUntil(wakeNs);
 
-        if (totalActive < MAX_CUSTOMERS && !fireEvent) {
-            totalActive++;
-            pid_t childPid = fork();
-            if (childPid == -1) {
-                perror(CLR_MGR "[Manager] Błąd fork() przy tworzeniu klienta" CLR_RESET);
-                exit(1);
+        // Wszystkie grupy, których czas już nadszedł (przy dużej intensywności kilka naraz)
+        long long nowNs = monotonicNs();
+        while (moreArrivals && !fireEvent && openNs + next.atUs * 1000 <= nowNs && nowNs < closeNs) {
+            int groupSize = next.size;
+            arrived++;
+            moreArrivals = arrivalsNext(&arrivals, &next);
+            if (totalActive >= MAX_CUSTOMERS) {
+                overLimit++;  // lokal pełen procesów klientów - grupa odchodzi, jak dotąd
+                continue;
             }
-            if (childPid == 0) {
-                // Proces klienta
-                char sizeBuf[10];
-                snprintf(sizeBuf, sizeof(sizeBuf), "%d", groupSize);
-                execl("./client_app", "client_app", sizeBuf, NULL);
-                perror(CLR_MGR "[Manager] Nie udało się uruchomić klienta" CLR_RESET);
+            totalActive++;
+            if (launchClient(&launcher, groupSize) == -1) {
+                perror(CLR_MGR "[Manager] Błąd uruchomienia klienta" CLR_RESET);
                 exit(1);
             }
         }
 
-        // Odstęp między kolejnymi grupami (0.5 - 1.5 s)
-        int pauseMicroSec = (rand() % 1001 + 500) * 1000;
-        usleep(pauseMicroSec);
-
         // Ostrzegamy kasjera o zbliżającym się zamknięciu
-        if (!notifiedClose && (closeTime - TIME_BEFORE_CLOSE <= time(NULL))) {
+        if (!notifiedClose && warnNs <= monotonicNs()) {
             notifiedClose = 1;
-            printf(CLR_MGR "[Manager] Ostrzegam kasjera: niedługo zamykamy!\n" CLR_RESET);
+            LOG(LVL_INFO, CLR_MGR "[Manager] Ostrzegam kasjera: niedługo zamykamy!\n" CLR_RESET);
             kill(cashierPid, SIGUSR2);
         }
 
-        // Zbieramy procesy-zombie
-        while (waitpid(-1, NULL, WNOHANG) > 0) {
-            totalActive--;
+        if (firstSeatNs == 0 && (firstSeatNs = pollFirstSeat(readyFds, shards)) != 0) {
+            LOG(LVL_INFO, CLR_MGR "[Manager] Pierwsza grupa przy stoliku po %.1f ms od startu (%.1f ms od gotowości kasjera)\n" CLR_RESET,
+                (firstSeatNs - startNs) / 1e6, (firstSeatNs - note.atNs) / 1e6);
+        }
+
+        // Zwolnieni pracownicy puli i zombie klientów
+        totalActive -= launcherPoll(&launcher);
+        pid_t done;
+        while ((done = waitpid(-clientGroup, NULL, WNOHANG)) > 0) {
+            totalActive -= launcherReaped(&launcher, done);
+        }
+    }
+
+    LOG(LVL_INFO, CLR_MGR "[Manager] Przybyło %ld grup (%.2f grupy/s), %ld odeszło przez limit %d procesów klientów.\n" CLR_RESET,
+        arrived, arrived / ((monotonicNs() - openNs) / 1e9), overLimit, MAX_CUSTOMERS);
+    arrivalsDestroy(&arrivals);
+    launcherPoll(&launcher);
+
+    // Pożar: klienci (i lider ich grupy) dostali jeden SIGUSR1 - czekamy na ostatniego
+    int evacuated = 0;
+    struct timespec lastClient, cashierDone, managerDone;
+    if (fireEvent) {
+        pid_t pid;
+        while ((pid = waitpid(-clientGroup, NULL, 0)) > 0 || errno == EINTR) {
+            launcherPoll(&launcher);
+            if (pid > 0) {
+                evacuated += launcherReaped(&launcher, pid);  // wolni pracownicy puli to nie grupy
+            }
         }
+        clock_gettime(CLOCK_MONOTONIC, &lastClient);
+        LOG(LVL_INFO, CLR_MGR "[Manager] Wszyscy klienci wyszli (%d grup) po %.1f ms od pożaru.\n" CLR_RESET,
+            evacuated, msBetween(&fireTime, &lastClient));
     }
 
+    // Pracownicy puli dostają koniec przydziałów (zajęci kończą po swojej grupie)
+    launcherClose(&launcher);
+
     // Czekamy aż kasjer się zakończy
     while (waitpid(cashierPid, NULL, 0) == -1) {
         if (errno == EINTR)  continue;
@@ -235,12 +494,19 @@ int main(int argc, char* argv[]) {
         perror(CLR_MGR "[Manager] Błąd waitpid() dla kasjera" CLR_RESET);
         break;
     }
+    clock_gettime(CLOCK_MONOTONIC, &cashierDone);
+    for (int s = 0; s < shards; s++) {
+        close(readyFds[s]);
+    }
 
     // Jeśli nie było pożaru, a kasjer już nie żyje, to strażak jest już niepotrzebny
     if (!fireEvent && kill(cashierPid, 0) != 0) {
         kill(firemanPid, SIGTERM);
     }
 
+    // Lider grupy klientów nie jest już potrzebny (po pożarze zginął razem z nią)
+    kill(clientGroup, SIGTERM);
+
     // Zbieramy resztę dzieci
     while (wait(NULL) > 0);
 
@@ -248,8 +514,20 @@ int main(int argc, char* argv[]) {
     deleteSharedMemory(shmId, tables);
     removeSemaphore(semId);
 
+    if (fireEvent) {
+        clock_gettime(CLOCK_MONOTONIC, &managerDone);
+        appendEvacuationReport(evacuated, &lastClient, &cashierDone, &managerDone);
+    }
+    int reportFd = open("daily_report.txt", O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (reportFd != -1) {
+        launcherPoll(&launcher);
+        launcherReport(&launcher, reportFd);
+        close(reportFd);
+    }
+    launcherDestroy(&launcher);
+
     // Wyświetlamy końcowy raport
-    printf(CLR_MGR "[Manager] Końcowy raport z dnia:\n" CLR_RESET);
+    LOG(LVL_INFO, CLR_MGR "[Manager] Końcowy raport z dnia:\n" CLR_RESET);
     displayReport();
 
     return 0;
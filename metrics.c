@@ -0,0 +1,73 @@
+#include "metrics.h"
+#include <string.h>
+
+static key_t metricsKey(void) {
+    key_t key = ftok(".", METRICS_GEN_CHAR);
+    if (key == -1) {
+        perror("[metrics.c] Błąd ftok()");
+        exit(1);
+    }
+    return key;
+}
+
+/**
+ * Kasjer prowadzący: tworzy i zeruje segment metryk (pozostałość po przerwanym
+ * dniu też zostaje wyzerowana - pozostali kasjerowie jeszcze nie działają).
+ *
+ * @param shards Liczba kasjerów.
+ * @param shmId Id segmentu (do usunięcia na koniec dnia).
+ */
+
+PizzeriaMetrics* metricsCreate(int shards, int* shmId) {
+    *shmId = createSharedMemory(metricsKey(), sizeof(PizzeriaMetrics));
+    PizzeriaMetrics* m = (PizzeriaMetrics*)shmat(*shmId, NULL, 0);
+    if (m == (void*)-1) {
+        perror(CLR_CASHIER "[metrics.c] Błąd shmat() metryk" CLR_RESET);
+        exit(1);
+    }
+    memset(m, 0, sizeof(*m));
+    m->shards    = shards;
+    m->startedNs = monotonicNs();
+    m->magic     = METRICS_MAGIC;
+    return m;
+}
+
+/**
+ * Dołącza do istniejącego segmentu metryk.
+ *
+ * @param readOnly 1 - tylko do odczytu (SHM_RDONLY, pizzeria_top).
+ * @return Metryki lub NULL (errno: ENOENT - segmentu jeszcze / już nie ma).
+ */
+
+PizzeriaMetrics* metricsAttach(int readOnly, int* shmId) {
+    int id = shmget(metricsKey(), 0, 0);
+    if (id == -1) {
+        return NULL;
+    }
+    PizzeriaMetrics* m = (PizzeriaMetrics*)shmat(id, NULL, readOnly ? SHM_RDONLY : 0);
+    if (m == (void*)-1) {
+        return NULL;
+    }
+    if (shmId != NULL) {
+        *shmId = id;
+    }
+    return m;
+}
+
+void metricsDetach(PizzeriaMetrics* m) {
+    if (shmdt(m) == -1) {
+        perror("[metrics.c] Błąd shmdt() metryk");
+    }
+}
+
+/**
+ * Kasjer zajmuje swoją linię metryk: miejsca wg pojemności stolików i PID.
+ */
+
+void metricsJoin(ShardMetrics* live, const int perCapacity[MAX_TABLE_CAPACITY]) {
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        live->seats[c] = perCapacity[c] * (c + 1);
+    }
+    atomic_store_explicit(&live->state, METRICS_RUNNING, memory_order_relaxed);
+    atomic_store_explicit(&live->pid, getpid(), memory_order_release);
+}
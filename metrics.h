@@ -0,0 +1,68 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "pizzeria.h"
+#include "shard.h"
+
+// --------------------- Bieżące metryki zmiany ---------------------
+//
+// Segment pamięci współdzielonej (ftok 'E'), w którym kasjerzy na bieżąco publikują
+// liczniki (zapytania, usadzenia, kolejka, odmowy, suma czasów oczekiwania) i wskaźniki
+// (długość kolejki, zajęte miejsca wg pojemności stolików). Każdy kasjer pisze tylko
+// do swojej linii pamięci podręcznej, więc zapis to zwykły atomowy store (relaxed)
+// bez blokad i bez instrukcji z prefiksem lock. pizzeria_top dołącza tylko do odczytu
+// i nie dotyka semafora (MUTEX_INDEX) ani kolejek komunikatów.
+//
+// Segment tworzy kasjer prowadzący (jedyny lub shard 0) przed uruchomieniem
+// pozostałych i usuwa go na koniec dnia, po ustawieniu finished.
+
+#define METRICS_GEN_CHAR    'E'
+#define METRICS_MAGIC       0x4d5a4950u   // "PIZM"
+
+#define METRICS_STARTING    0
+#define METRICS_RUNNING     1
+#define METRICS_CLOSING     2   // po SIGUSR2 / SIGUSR1 - obsługa ostatnich wyjść
+#define METRICS_DONE        3
+
+typedef struct ShardMetrics {
+    _Alignas(64) atomic_int pid;
+    atomic_int   state;
+    atomic_long  requests;                      // zapytania o stolik
+    atomic_long  seated;                        // grupy usadzone
+    atomic_long  queued;                        // grupy wstawione do kolejki
+    atomic_long  rejected;                      // odmowy (NO_TABLE_FOUND i NEAR_CLOSING)
+    atomic_long  waitUsSum;                     // suma czasów oczekiwania usadzonych grup
+    atomic_int   queueDepth;
+    atomic_int   occupied[MAX_TABLE_CAPACITY];  // zajęte miejsca przy stolikach danej pojemności
+    int          seats[MAX_TABLE_CAPACITY];     // wszystkie miejsca danej pojemności
+} ShardMetrics;
+
+typedef struct {
+    uint32_t     magic;
+    int          shards;
+    long long    startedNs;                     // CLOCK_MONOTONIC
+    atomic_int   finished;                      // koniec dnia - segment zaraz zniknie
+    ShardMetrics shard[MAX_SHARDS];
+} PizzeriaMetrics;
+
+PizzeriaMetrics* metricsCreate(int shards, int* shmId);
+PizzeriaMetrics* metricsAttach(int readOnly, int* shmId);
+void             metricsDetach(PizzeriaMetrics* m);
+void             metricsJoin(ShardMetrics* live, const int perCapacity[MAX_TABLE_CAPACITY]);
+
+// Każdy licznik ma jednego piszącego (swojego kasjera) - wystarczy load + store
+static inline void metricsAdd(atomic_long* counter, long delta) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + delta,
+                          memory_order_relaxed);
+}
+
+static inline void metricsAddInt(atomic_int* gauge, int delta) {
+    atomic_store_explicit(gauge, atomic_load_explicit(gauge, memory_order_relaxed) + delta,
+                          memory_order_relaxed);
+}
+
+static inline void metricsSet(atomic_int* gauge, int value) {
+    atomic_store_explicit(gauge, value, memory_order_relaxed);
+}
+
+#endif // METRICS_H
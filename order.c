@@ -0,0 +1,247 @@
+#include "order.h"
+#include "logger.h"
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+/**
+ * Wagi pozycji karty "w1,w2,..." (NULL lub pusty napis - równe). Brakujące wagi = 0.
+ * @return 0 lub -1 (błędne wagi).
+ */
+
+int menuPreferenceParse(MenuPreference* m, const char* weights) {
+    double w[MENU_SIZE];
+    memset(m, 0, sizeof(*m));
+    m->uniform = (weights == NULL || *weights == '\0');
+    for (int i = 0; i < MENU_SIZE; i++) {
+        w[i] = m->uniform ? 1.0 : 0.0;
+    }
+    const char* p = m->uniform ? NULL : weights;
+    for (int i = 0; p != NULL && *p != '\0'; i++) {
+        char* end;
+        double v = strtod(p, &end);
+        if (i >= MENU_SIZE || end == p || v < 0) {
+            fprintf(stderr, "[order.c] Błędne wagi karty (do %d liczb): %s\n", MENU_SIZE, weights);
+            return -1;
+        }
+        w[i] = v;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    double total = 0;
+    for (int i = 0; i < MENU_SIZE; i++) {
+        total += w[i];
+    }
+    if (total <= 0) {
+        fprintf(stderr, "[order.c] Wagi karty sumują się do zera: %s\n", weights);
+        return -1;
+    }
+    double acc = 0;
+    for (int i = 0; i < MENU_SIZE; i++) {
+        acc += w[i];
+        m->bound[i] = (uint64_t)(acc / total * 4294967296.0);
+    }
+    m->bound[MENU_SIZE - 1] = 4294967296ULL;
+    return 0;
+}
+
+/**
+ * Rozkład z PIZZERIA_MENU_WEIGHTS, wczytany raz (błędne wagi - równe).
+ */
+
+const MenuPreference* menuPreferenceFromEnv(void) {
+    static MenuPreference pref;
+    static int loaded = 0;
+    if (!loaded) {
+        if (menuPreferenceParse(&pref, getenv("PIZZERIA_MENU_WEIGHTS")) == -1) {
+            menuPreferenceParse(&pref, NULL);
+        }
+        loaded = 1;
+    }
+    return &pref;
+}
+
+int orderModeFromEnv(void) {
+    const char* s = getenv("PIZZERIA_CLIENT_THREADS");
+    if (s != NULL && strcasecmp(s, "inline") == 0) {
+        return ORDER_INLINE;
+    }
+    if (s != NULL && strcasecmp(s, "pool") == 0) {
+        return ORDER_POOL;
+    }
+    return ORDER_SPAWN;
+}
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Przydziela każdej osobie jej miejsce w selection i własny generator.
+ *
+ * @param go Zamówienie grupy.
+ * @param selection Tablica zamówienia (count pozycji).
+ * @param count Liczba osób (1..MAX_GROUP_SIZE).
+ * @param menu Rozkład preferencji karty.
+ * @param seed Ziarno grupy.
+ */
+
+void prepareGroupOrder(GroupOrder* go, int* selection, int count, const MenuPreference* menu, uint64_t seed) {
+    go->selection = selection;
+    go->count     = count;
+    for (int i = 0; i < count; i++) {
+        selection[i] = -1;
+        go->person[i].menu = menu;
+        go->person[i].slot = &selection[i];
+        go->person[i].rng  = splitmix64(seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL);
+        if (go->person[i].rng == 0) {
+            go->person[i].rng = 0x9E3779B97F4A7C15ULL;
+        }
+    }
+}
+
+/**
+ * Jedna osoba z grupy (wątek albo zwykłe wywołanie):
+ * losuje pizzę z rozkładu preferencji i wpisuje ją do swojego miejsca.
+ *
+ * @param arg PersonOrder tej osoby.
+ * @return NULL.
+ */
+
+void* singlePersonOrder(void* arg) {
+    PersonOrder* po = (PersonOrder*)arg;
+    int choice = menuPick(po->menu, orderRandom(&po->rng));
+    *po->slot = choice;
+    LOG(LVL_INFO, CLR_CLIENT "[Grupa PID(%d), wątek %lu] Wybiera: %s (%.2lf zł)\n" CLR_RESET,
+        getpid(), (unsigned long)pthread_self(), pizzaMenu[choice].name, pizzaMenu[choice].cost);
+    return NULL;
+}
+
+// --------------------- Pula wątków ---------------------
+
+struct OrderPool {
+    pthread_mutex_t lock;
+    pthread_cond_t  work;
+    pthread_cond_t  done;
+    PersonOrder*    jobs;       // osoby bieżącej grupy
+    int             jobCount;
+    int             next;       // następna osoba do wzięcia
+    int             pending;    // osoby jeszcze bez wyboru
+    int             stop;
+    int             workers;
+    pthread_t*      threads;
+};
+
+static void* poolWorker(void* arg) {
+    OrderPool* p = (OrderPool*)arg;
+    pthread_mutex_lock(&p->lock);
+    while (1) {
+        while (!p->stop && p->next >= p->jobCount) {
+            pthread_cond_wait(&p->work, &p->lock);
+        }
+        if (p->stop) {
+            break;
+        }
+        PersonOrder* job = &p->jobs[p->next++];
+        pthread_mutex_unlock(&p->lock);
+        singlePersonOrder(job);
+        pthread_mutex_lock(&p->lock);
+        if (--p->pending == 0) {
+            pthread_cond_signal(&p->done);
+        }
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/**
+ * Pula "workers" wątków wybierających za osoby kolejnych grup
+ * (grupy zgłasza jeden wątek, po jednej naraz).
+ * @return Pula lub NULL (errno z pthread_create / malloc).
+ */
+
+OrderPool* orderPoolCreate(int workers) {
+    OrderPool* p = (OrderPool*)calloc(1, sizeof(OrderPool));
+    if (p == NULL) {
+        return NULL;
+    }
+    p->threads = (pthread_t*)calloc(workers, sizeof(pthread_t));
+    if (p->threads == NULL) {
+        free(p);
+        return NULL;
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->work, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&p->threads[i], NULL, poolWorker, p) != 0) {
+            p->workers = i;
+            orderPoolDestroy(p);
+            return NULL;
+        }
+        p->workers = i + 1;
+    }
+    return p;
+}
+
+void orderPoolDestroy(OrderPool* p) {
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->work);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 0; i < p->workers; i++) {
+        pthread_join(p->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->work);
+    pthread_cond_destroy(&p->done);
+    free(p->threads);
+    free(p);
+}
+
+/**
+ * Zbiera zamówienie grupy w wybrany sposób (ORDER_SPAWN, ORDER_INLINE, ORDER_POOL).
+ * Po powrocie go->selection ma wybór każdej osoby.
+ *
+ * @return 0 lub -1 (błąd pthread_create / pthread_join).
+ */
+
+int orderGroup(GroupOrder* go, int mode, OrderPool* pool) {
+    if (mode == ORDER_POOL && pool != NULL) {
+        pthread_mutex_lock(&pool->lock);
+        pool->jobs     = go->person;
+        pool->jobCount = go->count;
+        pool->next     = 0;
+        pool->pending  = go->count;
+        pthread_cond_broadcast(&pool->work);
+        while (pool->pending > 0) {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pool->jobCount = 0;
+        pthread_mutex_unlock(&pool->lock);
+        return 0;
+    }
+    if (mode == ORDER_SPAWN) {
+        pthread_t threads[MAX_GROUP_SIZE];
+        for (int i = 0; i < go->count; i++) {
+            if (pthread_create(&threads[i], NULL, singlePersonOrder, &go->person[i]) != 0) {
+                while (--i >= 0) {
+                    pthread_join(threads[i], NULL);
+                }
+                return -1;
+            }
+        }
+        for (int i = 0; i < go->count; i++) {
+            if (pthread_join(threads[i], NULL) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    for (int i = 0; i < go->count; i++) {
+        singlePersonOrder(&go->person[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef ORDER_H
+#define ORDER_H
+
+#include "pizzeria.h"
+#include <stdint.h>
+
+// --------------------- Zamówienie grupy ---------------------
+//
+// Każda osoba wpisuje swoją pizzę do własnego, z góry przydzielonego miejsca
+// w zamówieniu grupy, więc nie potrzeba żadnej blokady. Osoba ma też własny
+// generator (xorshift64*, ziarno wyprowadzone z ziarna grupy przez splitmix64)
+// zamiast wspólnego, niebezpiecznego w wątkach rand().
+//
+// Wybór idzie z rozkładu preferencji karty: PIZZERIA_MENU_WEIGHTS="w1,w2,..."
+// (wagi kolejnych pozycji pizzaMenu, brakujące = 0; bez zmiennej - równe).
+// Tej samej funkcji (menuPick) używa symulacja zdarzeń (des.c).
+//
+// Osoby mogą wybierać w osobnych wątkach (jak dotąd), po kolei w wątku grupy
+// albo na puli wątków używanej przez kolejne grupy:
+// PIZZERIA_CLIENT_THREADS=spawn|inline|pool (domyślnie spawn).
+
+#define ORDER_SPAWN     0   // wątek na osobę
+#define ORDER_INLINE    1   // bez wątków
+#define ORDER_POOL      2   // pula wątków (OrderPool)
+
+typedef struct {
+    int      uniform;                   // równe wagi - wybór jak u % MENU_SIZE
+    uint64_t bound[MENU_SIZE];          // skumulowane wagi przeskalowane do 2^32 (ostatnia = 2^32)
+} MenuPreference;
+
+typedef struct {
+    const MenuPreference* menu;
+    uint64_t              rng;          // stan generatora tej osoby
+    int*                  slot;         // jej miejsce w zamówieniu grupy
+} PersonOrder;
+
+typedef struct {
+    int*        selection;              // zamówienie grupy (count pozycji)
+    int         count;
+    PersonOrder person[MAX_GROUP_SIZE];
+} GroupOrder;
+
+typedef struct OrderPool OrderPool;
+
+int                   menuPreferenceParse(MenuPreference* m, const char* weights);
+const MenuPreference* menuPreferenceFromEnv(void);
+int                   orderModeFromEnv(void);
+
+void  prepareGroupOrder(GroupOrder* go, int* selection, int count, const MenuPreference* menu, uint64_t seed);
+void* singlePersonOrder(void* arg);
+int   orderGroup(GroupOrder* go, int mode, OrderPool* pool);
+
+OrderPool* orderPoolCreate(int workers);
+void       orderPoolDestroy(OrderPool* p);
+
+/**
+ * Pozycja karty dla liczby losowej u (32 bity). Przy równych wagach - u % MENU_SIZE.
+ */
+
+static inline int menuPick(const MenuPreference* m, uint32_t u) {
+    if (m->uniform) {
+        return (int)(u % MENU_SIZE);
+    }
+    int i = 0;
+    while (i < MENU_SIZE - 1 && u >= m->bound[i]) {
+        i++;
+    }
+    return i;
+}
+
+// xorshift64* - stan nie może być zerem (prepareGroupOrder o to dba)
+static inline uint32_t orderRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (uint32_t)((*state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+#endif // ORDER_H
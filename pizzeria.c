@@ -1,20 +1,101 @@
 #include "pizzeria.h"
+#include "logger.h"
 #include <string.h>
+#include <sched.h>
 
 // --------------------- Definicja menu ---------------------
 MenuItem pizzaMenu[10] = {
-    {"Pizza Simple",       33.99},
-    {"Pizza Caprese",      42.99},
-    {"Pizza Napoli",       44.99},
-    {"Pizza Pepperoni",    37.99},
-    {"Pizza Spicy Salami", 42.99},
-    {"Pizza Hawaii",       44.99},
-    {"Pizza Diablo",       46.99},
-    {"Pizza Mare e Monti", 49.99},
-    {"Pizza Rustica",      44.99},
-    {"Pizza Veggie",       44.99}
+    {"Pizza Simple",       33.99, 1500},
+    {"Pizza Caprese",      42.99, 2000},
+    {"Pizza Napoli",       44.99, 2000},
+    {"Pizza Pepperoni",    37.99, 2000},
+    {"Pizza Spicy Salami", 42.99, 2000},
+    {"Pizza Hawaii",       44.99, 2500},
+    {"Pizza Diablo",       46.99, 2500},
+    {"Pizza Mare e Monti", 49.99, 3000},
+    {"Pizza Rustica",      44.99, 2500},
+    {"Pizza Veggie",       44.99, 2000}
 };
 
+// --------------------- Układ lokalu ---------------------
+
+/**
+ * Liczby stolików 1-, 2-, ..., count-osobowych z argumentów (pozostałe pojemności = 0).
+ * Wersja specjalizowana wymaga wszystkich MAX_TABLE_CAPACITY liczb, wersja ogólna
+ * (PIZZERIA_LAYOUT_GENERIC) - od 1 do MAX_TABLE_CAPACITY; ustawia też domyślne
+ * PIZZERIA_MAX_GROUP na największy stolik, które dziedziczą procesy potomne.
+ *
+ * @param count Liczba argumentów z liczbami stolików.
+ * @param argv Pierwszy z tych argumentów.
+ * @param perCapacity Wynik.
+ * @return Łączna liczba stolików lub -1 (błędne argumenty).
+ */
+
+int parseTableCounts(int count, char* argv[], int perCapacity[MAX_TABLE_CAPACITY]) {
+#ifdef PIZZERIA_LAYOUT_GENERIC
+    if (count < 1 || count > MAX_TABLE_CAPACITY) {
+        return -1;
+    }
+#else
+    if (count != MAX_TABLE_CAPACITY) {
+        return -1;
+    }
+#endif
+    int total = 0;
+    int largest = 0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        perCapacity[c] = (c < count) ? atoi(argv[c]) : 0;
+        if (perCapacity[c] < 0) {
+            return -1;
+        }
+        if (perCapacity[c] > 0) {
+            largest = c + 1;
+        }
+        total += perCapacity[c];
+    }
+    if (total == 0) {
+        return -1;
+    }
+#ifdef PIZZERIA_LAYOUT_GENERIC
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%d", (largest < MAX_GROUP_SIZE) ? largest : MAX_GROUP_SIZE);
+    setenv("PIZZERIA_MAX_GROUP", buf, 0);
+#else
+    (void)largest;
+#endif
+    return total;
+}
+
+/**
+ * Argumenty z liczbami stolików dla cashier_app - zawsze wszystkie MAX_TABLE_CAPACITY.
+ */
+
+void tableCountArgs(const int perCapacity[MAX_TABLE_CAPACITY], char text[MAX_TABLE_CAPACITY][12],
+                    char* args[MAX_TABLE_CAPACITY]) {
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        snprintf(text[c], sizeof(text[c]), "%d", perCapacity[c]);
+        args[c] = text[c];
+    }
+}
+
+/**
+ * Największa grupa w tym przebiegu: MAX_GROUP_SIZE albo (wersja ogólna)
+ * PIZZERIA_MAX_GROUP ograniczone do 1..MAX_GROUP_SIZE.
+ */
+
+int layoutGroupLimit(void) {
+    static int limit = 0;
+    if (limit == 0) {
+        const char* env = getenv("PIZZERIA_MAX_GROUP");
+        int value = env ? atoi(env) : MAX_GROUP_SIZE;
+#ifndef PIZZERIA_LAYOUT_GENERIC
+        value = MAX_GROUP_SIZE;  // układ ustalony przy kompilacji
+#endif
+        limit = (value < 1) ? 1 : (value > MAX_GROUP_SIZE ? MAX_GROUP_SIZE : value);
+    }
+    return limit;
+}
+
 // --------------------- Semafory ---------------------
 int createSemaphore(key_t key) {
     int semId = semget(key, 1, IPC_CREAT | 0600);
@@ -121,6 +202,68 @@ void semaphoreV(int semId, int semNum) {
     }
 }
 
+// --------------------- Seqlock stolików ---------------------
+
+#define TABLE_SPIN_LIMIT 64  // po tylu próbach oddajemy procesor (pisarz mógł zostać wywłaszczony)
+
+/**
+ * Zajmuje stolik do zapisu: zmienia parzyste seq na nieparzyste (CAS).
+ * Czytelnicy widzący nieparzyste seq czekają, a ci, którzy zaczęli wcześniej,
+ * po porównaniu seq powtórzą odczyt.
+ */
+
+void tableLock(DiningTable* t) {
+    unsigned int seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    int spins = 0;
+    while ((seq & 1u)
+           || !atomic_compare_exchange_weak_explicit(&t->seq, &seq, seq + 1,
+                                                     memory_order_acq_rel, memory_order_relaxed)) {
+        if (++spins >= TABLE_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+        seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_release);
+}
+
+void tableUnlock(DiningTable* t) {
+    unsigned int seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    atomic_store_explicit(&t->seq, seq + 1, memory_order_release);
+}
+
+/**
+ * Spójna kopia stolika bez blokowania pisarza: czytamy pola między dwoma
+ * odczytami seq i powtarzamy, jeśli w międzyczasie ktoś go zmienił.
+ *
+ * @param t Stolik (np. w pamięci współdzielonej).
+ * @param out Kopia; out->seq to wersja, z której pochodzi.
+ */
+
+void tableSnapshot(const DiningTable* t, DiningTable* out) {
+    int spins = 0;
+    while (1) {
+        unsigned int before = atomic_load_explicit(&t->seq, memory_order_acquire);
+        if ((before & 1u) == 0) {
+            out->capacity     = t->capacity;
+            out->group_size   = t->group_size;
+            out->total_seated = t->total_seated;
+            for (int j = 0; j < TABLE_SLOTS; j++) {
+                out->occupant_pids[j] = t->occupant_pids[j];
+            }
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&t->seq, memory_order_relaxed) == before) {
+                atomic_store_explicit(&out->seq, before, memory_order_relaxed);
+                return;
+            }
+        }
+        if (++spins >= TABLE_SPIN_LIMIT) {
+            sched_yield();
+            spins = 0;
+        }
+    }
+}
+
 /**
  * Wypisuje na ekran informację o wybranej pizzy (nazwa + cena),
  * używając indeksu w globalnej tablicy pizzaMenu.
@@ -129,20 +272,133 @@ void semaphoreV(int semId, int semNum) {
 
 // --------------------- Funkcja wypisująca zamówienie jednej osoby ---------------------
 void showChosenPizza(int id) {
-    printf(CLR_CLIENT "Wybiera: %s (%.2lf zł)\n" CLR_RESET, pizzaMenu[id].name, pizzaMenu[id].cost);
+    LOG(LVL_INFO, CLR_CLIENT "Wybiera: %s (%.2lf zł)\n" CLR_RESET, pizzaMenu[id].name, pizzaMenu[id].cost);
+}
+
+// --------------------- Gotowość kasjera ---------------------
+long long monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * Kasjer: melduje managerowi etap startu (zapis do PIPE_BUF jest atomowy).
+ * Po READY_FIRST_SEAT zamyka potok. Bez PIZZERIA_READY_FD nic nie robi.
+ *
+ * @param stage READY_DIRECTORY / READY_SERVING / READY_FIRST_SEAT.
+ * @param startedNs Chwila wejścia do main() kasjera.
+ */
+
+void readyNotify(int stage, long long startedNs) {
+    static int fd = -2;  // -2: jeszcze nie sprawdzono zmiennej, -1: brak potoku
+    if (fd == -2) {
+        const char* s = getenv(READY_FD_ENV);
+        fd = (s != NULL) ? atoi(s) : -1;
+    }
+    if (fd < 0) {
+        return;
+    }
+    ReadyNote note = { stage, startedNs, monotonicNs() };
+    while (write(fd, &note, sizeof(note)) == -1) {
+        if (errno != EINTR) {
+            // manager już nie czyta (EPIPE) - dalsze meldunki nie mają sensu
+            close(fd);
+            fd = -1;
+            return;
+        }
+    }
+    if (stage == READY_FIRST_SEAT) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * Manager: czeka na kolejny meldunek kasjera.
+ *
+ * @param fd Koniec potoku do odczytu.
+ * @param note Odczytany meldunek.
+ * @return 1 - meldunek, 0 - potok zamknięty bez meldunku, -1 - błąd
+ *         (EAGAIN przy potoku nieblokującym i braku meldunku).
+ */
+
+int readyAwait(int fd, ReadyNote* note) {
+    while (1) {
+        ssize_t n = read(fd, note, sizeof(*note));
+        if (n == (ssize_t)sizeof(*note)) {
+            return 1;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n > 0) {
+            errno = EIO;  // urwany meldunek - nie powinien się zdarzyć (zapis < PIPE_BUF)
+        }
+        return -1;
+    }
 }
 
 /**
- * Inicjuje pustą kolejkę oczekujących.
+ * Inicjuje pustą kolejkę oczekujących i rezerwuje pulę węzłów.
  * @param q Wskaźnik na strukturę kolejki.
- * @param limit Maksymalny rozmiar kolejki (maxSize).
+ * @param limit Maksymalny rozmiar kolejki (maxSize) = rozmiar puli.
  */
 
 // --------------------- Kolejka oczekujących (implementacja) ---------------------
 void initQueue(ClientsQueue* q, int limit) {
-    q->head         = NULL;
-    q->maxSize      = limit;
-    q->currentSize  = 0;
+    q->pool = (QueueNode*)calloc(limit > 0 ? limit : 1, sizeof(QueueNode));
+    if (q->pool == NULL) {
+        perror(CLR_CASHIER "[pizzeria.c] Błąd calloc() puli kolejki" CLR_RESET);
+        exit(1);
+    }
+    q->byPidMask = 1;
+    while (q->byPidMask + 1 < 2u * (unsigned int)(limit > 0 ? limit : 1)) {
+        q->byPidMask = (q->byPidMask << 1) | 1u;
+    }
+    q->byPid = (QueueNode**)calloc(q->byPidMask + 1, sizeof(QueueNode*));
+    if (q->byPid == NULL) {
+        perror(CLR_CASHIER "[pizzeria.c] Błąd calloc() indeksu kolejki" CLR_RESET);
+        exit(1);
+    }
+    q->maxSize = limit;
+    clearQueue(q);
+}
+
+static unsigned int pidSlot(const ClientsQueue* q, pid_t pid) {
+    return ((unsigned int)pid * 2654435761u) & q->byPidMask;
+}
+
+// Indeks jest co najwyżej w połowie pełny, więc sondowanie zawsze trafi na pustą pozycję
+static void indexInsert(ClientsQueue* q, QueueNode* node) {
+    unsigned int i = pidSlot(q, node->data.groupPID);
+    while (q->byPid[i] != NULL) {
+        i = (i + 1) & q->byPidMask;
+    }
+    q->byPid[i] = node;
+}
+
+/**
+ * Usuwa węzeł z indeksu bez znaczników usunięcia: wpisy dalej w tym samym ciągu
+ * sond cofają się na zwolnioną pozycję, jeśli nie leży ona przed ich pozycją domową.
+ */
+
+static void indexRemove(ClientsQueue* q, const QueueNode* node) {
+    unsigned int hole = pidSlot(q, node->data.groupPID);
+    while (q->byPid[hole] != node) {
+        hole = (hole + 1) & q->byPidMask;
+    }
+    for (unsigned int j = (hole + 1) & q->byPidMask; q->byPid[j] != NULL; j = (j + 1) & q->byPidMask) {
+        unsigned int home = pidSlot(q, q->byPid[j]->data.groupPID);
+        if (((j - home) & q->byPidMask) >= ((j - hole) & q->byPidMask)) {
+            q->byPid[hole] = q->byPid[j];
+            hole = j;
+        }
+    }
+    q->byPid[hole] = NULL;
 }
 
 /**
@@ -156,114 +412,193 @@ int queueSize(const ClientsQueue* q) {
 }
 
 /**
- * Dodaje nową grupę do końca kolejki, jeśli jest miejsce.
+ * Dodaje nową grupę na koniec kolejki i na koniec kubełka jej wielkości. O(1).
  * @param q Wskaźnik na strukturę kolejki.
  * @param g Grupa (pid, size) do wstawienia.
- * @note Nie sprawdza limitu, zakładamy że wywołujący zrobi to wcześniej.
+ * @return 0 przy sukcesie, -1 gdy pula jest wyczerpana lub wielkość grupy spoza 1..MAX_GROUP_SIZE.
  */
 
-void enqueueGroup(ClientsQueue* q, const GroupOfClients* g) {
-    QueueNode* node = (QueueNode*)calloc(1, sizeof(QueueNode));
-    node->data = *g; // kopia struktury GroupOfClients
-    node->next = NULL;
+int enqueueGroup(ClientsQueue* q, const GroupOfClients* g) {
+    if (q->freeNodes == NULL || g->size < 1 || g->size > MAX_GROUP_SIZE) {
+        return -1;
+    }
+    QueueNode* node = q->freeNodes;
+    q->freeNodes = node->next;
 
-    if (q->head == NULL) {
+    node->data     = *g; // kopia struktury GroupOfClients
+    node->seq      = q->nextSeq++;
+    node->next     = NULL;
+    node->prev     = q->tail;
+    node->nextSame = NULL;
+    node->prevSame = q->sizeTail[g->size];
+
+    if (q->tail == NULL) {
         q->head = node;
     } else {
-        QueueNode* temp = q->head;
-        while (temp->next != NULL) {
-            temp = temp->next;
-        }
-        temp->next = node;
+        q->tail->next = node;
     }
+    q->tail = node;
+
+    if (q->sizeTail[g->size] == NULL) {
+        q->sizeHead[g->size] = node;
+    } else {
+        q->sizeTail[g->size]->nextSame = node;
+    }
+    q->sizeTail[g->size] = node;
+    indexInsert(q, node);
+
     q->currentSize++;
+    return 0;
 }
 
 /**
- * Wyszukuje i usuwa z kolejki pierwszą grupę, która pasuje do wymagań:
- * - Jeśli neededSize == 0, to każda grupa o size <= freeSeats może wejść.
- * - Jeśli neededSize != 0, to tylko grupa z size == neededSize i size <= freeSeats.
- * Usuwa ją z listy i zwraca kopię zaalokowaną dynamicznie.
- * Jeśli nie znajdzie, zwraca NULL.
+ * Wypina węzeł z obu list i z indeksu PID-ów, po czym oddaje go do puli.
+ */
+
+static void unlinkNode(ClientsQueue* q, QueueNode* node) {
+    int size = node->data.size;
+    if (node->prev) node->prev->next = node->next; else q->head = node->next;
+    if (node->next) node->next->prev = node->prev; else q->tail = node->prev;
+    if (node->prevSame) node->prevSame->nextSame = node->nextSame; else q->sizeHead[size] = node->nextSame;
+    if (node->nextSame) node->nextSame->prevSame = node->prevSame; else q->sizeTail[size] = node->prevSame;
+    indexRemove(q, node);
+
+    node->next   = q->freeNodes;
+    q->freeNodes = node;
+    q->currentSize--;
+}
+
+/**
+ * Wyszukuje i usuwa z kolejki pierwszą (najdawniej przybyłą) grupę, która pasuje do wymagań:
+ * - Jeśli neededSize == 0, to każda grupa o size <= freeSeats może wejść
+ *   (wybieramy najmniejszy seq spośród głów kubełków 1..freeSeats).
+ * - Jeśli neededSize != 0, to tylko grupa z size == neededSize i size <= freeSeats
+ *   (głowa kubełka neededSize).
+ * Koszt O(MAX_GROUP_SIZE), niezależny od długości kolejki.
  *
  * @param q Wskaźnik na kolejkę.
  * @param neededSize Rozmiar grupy "dominującej" w stoliku (0 oznacza pusty stolik).
  * @param freeSeats Liczba wolnych miejsc w stoliku.
- * @return Wskaźnik na strukturę GroupOfClients lub NULL (jeśli brak odpowiedniej grupy).
+ * @param out Tu trafia kopia wyjętej grupy.
+ * @return 1 jeśli wyjęto grupę, 0 jeśli brak odpowiedniej grupy.
  */
 
-GroupOfClients* dequeueSuitable(ClientsQueue* q, int neededSize, int freeSeats) {
-    if (q->head == NULL) {
-        return NULL;
-    }
-
-    QueueNode* prev = NULL;
-    QueueNode* curr = q->head;
-
-    while (curr != NULL) {
-        GroupOfClients* gr = &curr->data;
+int dequeueSuitable(ClientsQueue* q, int neededSize, int freeSeats, GroupOfClients* out) {
+    QueueNode* found = NULL;
 
-        int canEnter = 0;
-
-        if (neededSize == 0) {
-            // Jeżeli stolik nie ma przypisanego group_size, wpuścimy każdą grupę, jeśli się zmieści
-            if (gr->size <= freeSeats) {
-                canEnter = 1;
-            }
-        } else {
-            // Tylko taką samą liczbę osób, co aktualnie przypisana stolikowi
-            if (gr->size == neededSize && gr->size <= freeSeats) {
-                canEnter = 1;
+    if (neededSize == 0) {
+        // Pusty stolik - wpuścimy najstarszą grupę, która się zmieści
+        int maxSize = freeSeats < MAX_GROUP_SIZE ? freeSeats : MAX_GROUP_SIZE;
+        for (int s = 1; s <= maxSize; s++) {
+            QueueNode* cand = q->sizeHead[s];
+            if (cand != NULL && (found == NULL || cand->seq < found->seq)) {
+                found = cand;
             }
         }
+    } else if (neededSize <= MAX_GROUP_SIZE && neededSize <= freeSeats) {
+        // Tylko taką samą liczbę osób, co aktualnie przypisana stolikowi
+        found = q->sizeHead[neededSize];
+    }
 
-        if (canEnter) {
-            // Wyciągamy z kolejki
-            if (prev == NULL) {
-                q->head = curr->next;
-            } else {
-                prev->next = curr->next;
-            }
-            q->currentSize--;
+    if (found == NULL) {
+        return 0;
+    }
+    *out = found->data;
+    unlinkNode(q, found);
+    return 1;
+}
 
-            GroupOfClients* ret = (GroupOfClients*)malloc(sizeof(GroupOfClients));
-            *ret = *gr; 
-            free(curr);
-            return ret;
+// Węzeł grupy o podanym PID-zie (indeks kolejki, sondowanie liniowe) albo NULL
+static QueueNode* findByPid(const ClientsQueue* q, pid_t pid) {
+    for (unsigned int i = pidSlot(q, pid); q->byPid[i] != NULL; i = (i + 1) & q->byPidMask) {
+        if (q->byPid[i]->data.groupPID == pid) {
+            return q->byPid[i];
         }
-
-        // Nie pasuje? Przechodzimy do kolejnego węzła
-        prev = curr;
-        curr = curr->next;
     }
-    // Jeśli przejdziemy całą pętlę i nic nie znajdziemy, zwracamy NULL
     return NULL;
 }
 
+/**
+ * Zdejmuje z kolejki grupę o podanym PID-zie (przez indeks, bez przeglądania kolejki). O(1).
+ *
+ * @param q Wskaźnik na kolejkę.
+ * @param pid PID grupy.
+ * @param out Tu trafia kopia zdjętej grupy.
+ * @return 1 jeśli grupa czekała w kolejce, 0 w przeciwnym razie.
+ */
+
+int removeGroup(ClientsQueue* q, pid_t pid, GroupOfClients* out) {
+    QueueNode* node = findByPid(q, pid);
+    if (node == NULL) {
+        return 0;
+    }
+    *out = node->data;
+    unlinkNode(q, node);
+    return 1;
+}
+
+// Czy grupa o podanym PID-zie czeka w kolejce. O(1).
+int isQueued(const ClientsQueue* q, pid_t pid) {
+    return findByPid(q, pid) != NULL;
+}
+
+/**
+ * Wypisuje zawartość kolejki (poziom LVL_DEBUG) w kolejności przybycia.
+ */
+
 void printQueue(const ClientsQueue* q) {
-    printf(CLR_CASHIER "--- Kolejka przed pizzerią ---\n" CLR_RESET);
+    if (!logEnabled(LVL_DEBUG)) {
+        return;
+    }
+    logWrite(LVL_DEBUG, CLR_CASHIER "--- Kolejka przed pizzerią ---\n" CLR_RESET);
     QueueNode* tmp = q->head;
     if (!tmp) {
-        printf(CLR_CASHIER "[Kolejka] Pusto!\n" CLR_RESET);
+        logWrite(LVL_DEBUG, CLR_CASHIER "[Kolejka] Pusto!\n" CLR_RESET);
         return;
     }
     int idx = 1;
     while (tmp) {
-        printf(CLR_CASHIER "%d) Grupa PID(%d) | Osób: %d\n" CLR_RESET,
-               idx, (int)tmp->data.groupPID, tmp->data.size);
+        logWrite(LVL_DEBUG, CLR_CASHIER "%d) Grupa PID(%d) | Osób: %d\n" CLR_RESET,
+                 idx, (int)tmp->data.groupPID, tmp->data.size);
         idx++;
         tmp = tmp->next;
     }
-    printf(CLR_CASHIER "--------------------------------\n" CLR_RESET);
+    logWrite(LVL_DEBUG, CLR_CASHIER "--------------------------------\n" CLR_RESET);
 }
 
+/**
+ * Opróżnia kolejkę - wszystkie węzły wracają do puli.
+ */
+
 void clearQueue(ClientsQueue* q) {
-    QueueNode* tmp = q->head;
-    while (tmp) {
-        QueueNode* toDelete = tmp;
-        tmp = tmp->next;
-        free(toDelete);
+    q->freeNodes = NULL;
+    for (int i = q->maxSize - 1; i >= 0; i--) {
+        q->pool[i].next = q->freeNodes;
+        q->freeNodes    = &q->pool[i];
+    }
+    for (int s = 0; s <= MAX_GROUP_SIZE; s++) {
+        q->sizeHead[s] = NULL;
+        q->sizeTail[s] = NULL;
     }
-    q->head = NULL;
+    memset(q->byPid, 0, (q->byPidMask + 1) * sizeof(QueueNode*));
+    q->head        = NULL;
+    q->tail        = NULL;
+    q->nextSeq     = 0;
+    q->currentSize = 0;
+}
+
+/**
+ * Zwalnia pulę węzłów kolejki.
+ */
+
+void destroyQueue(ClientsQueue* q) {
+    free(q->pool);
+    free(q->byPid);
+    q->pool        = NULL;
+    q->byPid       = NULL;
+    q->freeNodes   = NULL;
+    q->head        = NULL;
+    q->tail        = NULL;
+    q->maxSize     = 0;
     q->currentSize = 0;
 }
@@ -15,6 +15,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdatomic.h>
 
 // --------------------- Makra kolorów terminala ---------------------
 #define CLR_MGR     "\033[1;31m"  // intensywny czerwony
@@ -29,14 +30,25 @@
 #define SHM_GEN_CHAR        'B'
 #define MSG_GEN_CHAR        'C'
 
-// Typy wiadomości do kolejki
-#define REQUEST_TABLE        1
+// Typy wiadomości do kolejki. Kasjer odbiera z kolejki SysV najniższy typ
+// <= REQUEST_TABLE, więc kolejność to priorytet: wyjścia i zamówienia (bez
+// odpowiedzi) mają pierwszeństwo przed zapytaniami o stolik. Odwrotnie zalew
+// zapytań głodził wyjścia, a zamówienia zapełniały kolejkę aż do zakleszczenia.
+// Rezygnacja z kolejki zwalnia w niej miejsce, więc też idzie przed zapytaniami.
+#define LEAVE_TABLE          1
 #define SEND_ORDER           2
-#define LEAVE_TABLE          3
+#define SEAT_AVAILABLE       3  // między kasjerami: u nadawcy zwolniło się miejsce (PIZZERIA_SHARDS)
+#define CANCEL_REQUEST       4  // grupie skończyła się cierpliwość (PIZZERIA_PATIENCE)
+#define REQUEST_TABLE        5
 
 // Specjalne kody (brak stolika / zamykamy lokal)
 #define NO_TABLE_FOUND      -1
 #define NEAR_CLOSING        -2
+#define GROUP_QUEUED        -3  // grupa czeka w kolejce, stolik przyjdzie w kolejnej odpowiedzi
+#define PIZZA_READY         -4  // kuchnia: zamówienie grupy gotowe (odpowiedź po SEND_ORDER)
+#define GROUP_CANCELLED     -5  // CANCEL_REQUEST: grupa zdjęta z kolejki
+#define ORDER_SERVED        -6  // potwierdzenie SEND_ORDER: bez kuchni, grupa je od razu
+#define ORDER_COOKING       -7  // potwierdzenie SEND_ORDER: zamówienie w kuchni, potem przyjdzie PIZZA_READY
 
 // Rozmiary i czasy (można dostosować do wymagań)
 #define TIME_BEFORE_CLOSE    5
@@ -45,6 +57,46 @@
 #define MAX_CUSTOMERS      400
 #define QUEUE_LIMIT         30
 
+// --------------------- Układ lokalu (parametry kompilacji) ---------------------
+//
+// Rozmiary tablic w stolikach, komunikatach i statystykach są stałymi kompilacji,
+// więc pętle po slotach stolika, pozycjach zamówienia i karcie mają stałe granice
+// i kompilator je rozwija. Inny układ to osobna kompilacja wszystkich programów, np. bankiet:
+//   CFLAGS="-DMAX_TABLE_CAPACITY=12 -DMAX_GROUP_SIZE=10" ./kompilacja.sh
+// Wersja ogólna (-DPIZZERIA_LAYOUT_GENERIC) ma tablice na zapas, a układ bierze przy
+// starcie: manager przyjmuje liczby stolików tylko dla potrzebnych pojemności,
+// a największą grupę z PIZZERIA_MAX_GROUP (domyślnie - największy stolik).
+#ifdef PIZZERIA_LAYOUT_GENERIC
+#ifndef MAX_TABLE_CAPACITY
+#define MAX_TABLE_CAPACITY  16
+#endif
+#ifndef MAX_GROUP_SIZE
+#define MAX_GROUP_SIZE      12
+#endif
+#endif
+
+#ifndef MAX_GROUP_SIZE
+#define MAX_GROUP_SIZE       3  // największa grupa klientów
+#endif
+#ifndef MAX_TABLE_CAPACITY
+#define MAX_TABLE_CAPACITY   4  // największy stolik (liczba krzeseł)
+#endif
+#ifndef MENU_SIZE
+#define MENU_SIZE           10  // pozycje karty (pizzaMenu)
+#endif
+#define TABLE_SLOTS         MAX_TABLE_CAPACITY  // grup przy stoliku (każda ma co najmniej 1 osobę)
+
+_Static_assert(MAX_TABLE_CAPACITY >= 1 && MAX_TABLE_CAPACITY <= 16, "MAX_TABLE_CAPACITY: 1..16");
+_Static_assert(MAX_GROUP_SIZE >= 1 && MAX_GROUP_SIZE <= MAX_TABLE_CAPACITY,
+               "MAX_GROUP_SIZE: 1..MAX_TABLE_CAPACITY (grupa siada przy jednym stoliku)");
+_Static_assert(MENU_SIZE >= 1 && MENU_SIZE <= 10, "MENU_SIZE: 1..10 (tyle pozycji ma karta w pizzeria.c)");
+
+#ifdef PIZZERIA_LAYOUT_GENERIC
+#define GROUP_LIMIT         layoutGroupLimit()
+#else
+#define GROUP_LIMIT         MAX_GROUP_SIZE      // największa grupa w tym przebiegu
+#endif
+
 
 // --------------------- Struktury ---------------------
 
@@ -52,12 +104,15 @@
 typedef struct {
     const char* name;
     double      cost;
+    int         bakeMs;     // czas pieczenia (kuchnia, kitchen.h)
 } MenuItem;
 
 // Informacje o stoliku:
+// seq to jednocześnie blokada pisarza i licznik seqlocka: nieparzysty = trwa zmiana.
 typedef struct {
+    atomic_uint seq;
     int   capacity;         // liczba krzeseł
-    pid_t occupant_pids[4]; // do 4 grup na jednym stoliku
+    pid_t occupant_pids[TABLE_SLOTS]; // grupy przy stoliku
     int   group_size;       // wielkość głównej grupy
     int   total_seated;     // ile osób faktycznie przy nim siedzi
 } DiningTable;
@@ -66,6 +121,7 @@ typedef struct {
 typedef struct {
     int   size;     
     pid_t groupPID; 
+    int   ticket;   // numer zapytania o stolik - CANCEL_REQUEST dotyczy tylko zapytania z tym numerem
 } GroupOfClients;
 
 // Komunikat przesyłany przez kolejkę (klient <-> kasjer)
@@ -73,17 +129,20 @@ typedef struct {
     long  mtype;
     GroupOfClients group;
     int   tableIndex;
-    int   orderedItems[3];
+    int   orderedItems[MAX_GROUP_SIZE];
+    int   originShard;      // kasjer, u którego grupa czeka na odpowiedź (PIZZERIA_SHARDS)
+    int   hops;             // ile razy zapytanie przekazano innemu kasjerowi
+    int   waitMs;           // odpowiedź kasjera: szacowane czekanie na stolik [ms], -1 - bez szacunku
 } CommunicationMessage;
 
-// Pomocnicza struktura do zamówień wewnątrz procesu klienta
-typedef struct {
-    int* selection;
-    int  count;
-} GroupOrder;
-
 // --------------------- Deklaracja menu i funkcji ---------------------
-extern MenuItem pizzaMenu[10];
+extern MenuItem pizzaMenu[];  // karta (10 pozycji), w użyciu pierwsze MENU_SIZE
+
+// Układ lokalu podany przy starcie
+int  parseTableCounts(int count, char* argv[], int perCapacity[MAX_TABLE_CAPACITY]);
+void tableCountArgs(const int perCapacity[MAX_TABLE_CAPACITY], char text[MAX_TABLE_CAPACITY][12],
+                    char* args[MAX_TABLE_CAPACITY]);
+int  layoutGroupLimit(void);
 
 // Funkcje do semaforów, shm i msg
 int  createSemaphore(key_t key);
@@ -101,28 +160,76 @@ void deleteMessageQueue(int msgId);
 void semaphoreP(int semId, int semNum);
 void semaphoreV(int semId, int semNum);
 
+// Synchronizacja pojedynczego stolika w pamięci współdzielonej (bez wywołań systemowych,
+// dopóki nikt inny nie zmienia tego samego stolika)
+void tableLock(DiningTable* t);
+void tableUnlock(DiningTable* t);
+void tableSnapshot(const DiningTable* t, DiningTable* out);
+
 // Wypis informacji o wybranej pizzy
 void showChosenPizza(int id);
 
+// --------------------- Gotowość kasjera ---------------------
+//
+// Manager daje kasjerowi koniec potoku do zapisu (numer deskryptora w PIZZERIA_READY_FD).
+// Kasjer melduje nim kolejne etapy startu (ReadyNote ze znacznikami CLOCK_MONOTONIC,
+// wspólnego dla wszystkich procesów), a manager blokuje się w read() zamiast kręcić
+// się na semget()/shmget(). Koniec pliku bez meldunku = kasjer zginął przy starcie.
+// Kasjer uruchomiony ręcznie (bez zmiennej) nic nie wysyła.
+#define READY_FD_ENV        "PIZZERIA_READY_FD"
+#define READY_DIRECTORY      1  // prowadzący: katalog kasjerów gotowy, można uruchomić pozostałych
+#define READY_SERVING        2  // zasoby IPC utworzone, kasjer przyjmuje komunikaty
+#define READY_FIRST_SEAT     3  // pierwsza grupa przy stoliku (ostatni meldunek, potok zamknięty)
+
+typedef struct {
+    int       stage;
+    long long startedNs;   // wejście do main() kasjera
+    long long atNs;        // chwila meldunku
+} ReadyNote;
+
+long long monotonicNs(void);
+void readyNotify(int stage, long long startedNs);
+int  readyAwait(int fd, ReadyNote* note);
+
 // --------------------- Definicje kolejki oczekujących ---------------------
 
+// Węzły pochodzą ze stałej puli (maxSize elementów). Każdy węzeł jest jednocześnie
+// na liście w kolejności przybycia (next/prev) i w kubełku FIFO swojej wielkości
+// (nextSame/prevSame). Numer seq pozwala porównać kolejność między kubełkami.
+// Indeks PID -> węzeł (adresowanie otwarte, 2 x maxSize pozycji) pozwala zdjąć
+// z kolejki dowolną grupę w O(1) - rezygnacja albo proces, który już nie żyje.
 typedef struct _QueueNode {
     GroupOfClients       data;
-    struct _QueueNode*   next;
+    unsigned long        seq;       // numer kolejny przybycia
+    struct _QueueNode*   next;      // następny w kolejności przybycia
+    struct _QueueNode*   prev;
+    struct _QueueNode*   nextSame;  // następny w kubełku tej samej wielkości
+    struct _QueueNode*   prevSame;
 } QueueNode;
 
 typedef struct {
-    QueueNode* head;
-    int        maxSize;
-    int        currentSize;
+    QueueNode*    pool;                          // pula węzłów (maxSize)
+    QueueNode*    freeNodes;                     // wolne węzły puli
+    QueueNode*    head;                          // najdłużej czekająca grupa
+    QueueNode*    tail;
+    QueueNode*    sizeHead[MAX_GROUP_SIZE + 1];  // kubełki FIFO wg wielkości grupy
+    QueueNode*    sizeTail[MAX_GROUP_SIZE + 1];
+    QueueNode**   byPid;                         // indeks PID -> węzeł
+    unsigned int  byPidMask;                     // rozmiar indeksu - 1 (potęga dwójki)
+    unsigned long nextSeq;
+    int           maxSize;
+    int           currentSize;
 } ClientsQueue;
 
 // Funkcje obsługi kolejki
 void initQueue(ClientsQueue* q, int limit);
-void enqueueGroup(ClientsQueue* q, const GroupOfClients* g);
-GroupOfClients* dequeueSuitable(ClientsQueue* q, int neededSize, int freeSeats);
+int  enqueueGroup(ClientsQueue* q, const GroupOfClients* g);
+int  dequeueSuitable(ClientsQueue* q, int neededSize, int freeSeats, GroupOfClients* out);
+int  removeGroup(ClientsQueue* q, pid_t pid, GroupOfClients* out);
+int  isQueued(const ClientsQueue* q, pid_t pid);
 int  queueSize(const ClientsQueue* q);
 void clearQueue(ClientsQueue* q);
+void destroyQueue(ClientsQueue* q);
 void printQueue(const ClientsQueue* q);
 
 #endif // PIZZERIA_H
@@ -0,0 +1,171 @@
+#include "pizzeria.h"
+#include "metrics.h"
+#include <string.h>
+#include <getopt.h>
+
+// --------------------- pizzeria_top ---------------------
+//
+// Podgląd bieżącej zmiany z segmentu metryk (metrics.h). Dołącza tylko do odczytu
+// (SHM_RDONLY) i niczego nie blokuje: nie dotyka semafora MUTEX_INDEX, kolejek
+// komunikatów ani stolików, więc kasjer nie zwalnia, gdy ktoś go obserwuje.
+// Kończy się po zamknięciu dnia (finished) albo po -n odświeżeniach.
+
+static volatile sig_atomic_t stopTop = 0;
+
+static const char* stateNames[] = { "start", "praca", "zamykanie", "koniec" };
+
+typedef struct {
+    long requests;
+    long seated;
+    long queued;
+    long rejected;
+    long waitUsSum;
+    int  queueDepth;
+    int  occupied[MAX_TABLE_CAPACITY];
+} Sample;
+
+static void handleStop(int sig) {
+    (void)sig;
+    stopTop = 1;
+}
+
+// Kopia liczników jednego kasjera (każde pole czytane atomowo, bez blokad)
+static void takeSample(const ShardMetrics* live, Sample* out) {
+    out->requests   = atomic_load_explicit(&live->requests, memory_order_relaxed);
+    out->seated     = atomic_load_explicit(&live->seated, memory_order_relaxed);
+    out->queued     = atomic_load_explicit(&live->queued, memory_order_relaxed);
+    out->rejected   = atomic_load_explicit(&live->rejected, memory_order_relaxed);
+    out->waitUsSum  = atomic_load_explicit(&live->waitUsSum, memory_order_relaxed);
+    out->queueDepth = atomic_load_explicit(&live->queueDepth, memory_order_relaxed);
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        out->occupied[c] = atomic_load_explicit(&live->occupied[c], memory_order_relaxed);
+    }
+}
+
+static void addSample(Sample* into, const Sample* s) {
+    into->requests   += s->requests;
+    into->seated     += s->seated;
+    into->queued     += s->queued;
+    into->rejected   += s->rejected;
+    into->waitUsSum  += s->waitUsSum;
+    into->queueDepth += s->queueDepth;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        into->occupied[c] += s->occupied[c];
+    }
+}
+
+/**
+ * Jeden wiersz tabeli: tempo zapytań z różnicy względem poprzedniej próbki,
+ * średnie oczekiwanie od początku zmiany i w ostatnim odstępie.
+ */
+
+static void printRow(const char* label, const char* pid, const char* state, const Sample* now,
+                     const Sample* prev, double seconds, const int seats[MAX_TABLE_CAPACITY]) {
+    double rate     = (seconds > 0.0) ? (now->requests - prev->requests) / seconds : 0.0;
+    double waitAll  = now->seated ? now->waitUsSum / 1000.0 / now->seated : 0.0;
+    long   seatedIn = now->seated - prev->seated;
+    double waitLast = (seatedIn > 0) ? (now->waitUsSum - prev->waitUsSum) / 1000.0 / seatedIn : 0.0;
+    printf("%-7s %7s %-10s %8.1f %8ld %8ld %8ld %10.1f %10.1f %7d  ",
+           label, pid, state, rate, now->seated, now->queued, now->rejected, waitAll, waitLast, now->queueDepth);
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        printf(" %3d/%-3d", now->occupied[c], seats[c]);
+    }
+    printf("\n");
+}
+
+static void usage(void) {
+    fprintf(stderr, "Użycie: ./pizzeria_top [-i odstęp_ms] [-n odświeżeń]\n");
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    long intervalMs = 1000;
+    long frames = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opt) {
+        case 'i': intervalMs = atol(optarg); break;
+        case 'n': frames     = atol(optarg); break;
+        default:  usage();
+        }
+    }
+    if (intervalMs < 10) {
+        intervalMs = 10;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handleStop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    struct timespec pause = { intervalMs / 1000, (intervalMs % 1000) * 1000000L };
+    PizzeriaMetrics* m = NULL;
+    for (int waited = 0; !stopTop && (m = metricsAttach(1, NULL)) == NULL; waited++) {
+        if (waited == 0) {
+            fprintf(stderr, "[pizzeria_top] Czekam na segment metryk (kasjer jeszcze nie wystartował)...\n");
+        }
+        nanosleep(&pause, NULL);
+    }
+    if (m == NULL) {
+        return 0;
+    }
+    if (m->magic != METRICS_MAGIC) {
+        fprintf(stderr, "[pizzeria_top] Segment metryk ma nieznany format\n");
+        metricsDetach(m);
+        return 1;
+    }
+
+    int clear = isatty(STDOUT_FILENO);
+    static Sample prev[MAX_SHARDS];
+    long long prevNs = monotonicNs();
+    for (long frame = 1; !stopTop; frame++) {
+        nanosleep(&pause, NULL);
+        int finished = atomic_load_explicit(&m->finished, memory_order_acquire);
+        long long now = monotonicNs();
+        double seconds = (now - prevNs) / 1e9;
+        prevNs = now;
+
+        if (clear) {
+            printf("\033[H\033[2J");
+        }
+        printf("pizzeria_top - zmiana trwa %.1f s, kasjerów %d, odświeżanie co %ld ms%s\n",
+               (now - m->startedNs) / 1e9, m->shards, intervalMs, finished ? " - dzień zakończony" : "");
+        printf("%-7s %7s %-10s %8s %8s %8s %8s %10s %10s %7s   zajęte/wszystkie miejsca wg pojemności stolików\n",
+               "Kasjer", "PID", "stan", "zapyt/s", "usadz.", "kolejka", "odmowy", "czek[ms]", "ost.[ms]", "czeka");
+
+        Sample total = {0}, totalPrev = {0};
+        int seatsTotal[MAX_TABLE_CAPACITY] = {0};
+        for (int s = 0; s < m->shards && s < MAX_SHARDS; s++) {
+            const ShardMetrics* live = &m->shard[s];
+            Sample cur;
+            takeSample(live, &cur);
+            int state = atomic_load_explicit(&live->state, memory_order_relaxed);
+            char label[16], pid[16];
+            snprintf(label, sizeof(label), "%d", s);
+            snprintf(pid, sizeof(pid), "%d", atomic_load_explicit(&live->pid, memory_order_relaxed));
+            printRow(label, pid, stateNames[(state >= 0 && state <= METRICS_DONE) ? state : 0],
+                     &cur, &prev[s], seconds, live->seats);
+            addSample(&total, &cur);
+            addSample(&totalPrev, &prev[s]);
+            for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+                seatsTotal[c] += live->seats[c];
+            }
+            prev[s] = cur;
+        }
+        if (m->shards > 1) {
+            printRow("Razem", "", "", &total, &totalPrev, seconds, seatsTotal);
+        }
+        fflush(stdout);
+
+        if (finished || (frames > 0 && frame >= frames)) {
+            break;
+        }
+        if (!clear) {
+            printf("\n");
+        }
+    }
+    metricsDetach(m);
+    return 0;
+}
@@ -0,0 +1,355 @@
+#include "pizzeria.h"
+#include "restaurant.h"
+#include "journal.h"
+#include "logger.h"
+#include <string.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// --------------------- Odtwarzanie dziennika zmiany ---------------------
+//
+// Rekordy wejściowe dziennika kasjera (przybycia, zamówienia, wyjścia, ostrzeżenie,
+// pożar, przekazania z kolejki) trafiają jeszcze raz do logiki sali (restaurant.c)
+// na świeżych stolikach. Każda odpowiedź sali i każde wstawienie do kolejki jest
+// porównywane z rekordem decyzji zapisanym w oryginalnym przebiegu (SEAT / QUEUE /
+// REJECT) - zgodność oznacza, że obecna logika sadzania podejmuje te same decyzje.
+// Z -n przebieg powtarza się wielokrotnie, co daje benchmark na prawdziwym ruchu.
+
+#define REPLAY_MAX_MISMATCHES  5   // tyle niezgodności wypisujemy w szczegółach
+
+typedef struct {
+    int type;
+    int pid;
+    int table;
+} Decision;
+
+typedef struct {
+    Decision*     pending;          // decyzje sali czekające na porównanie (FIFO)
+    int           head;
+    int           count;
+    int           capacity;
+    long          matched;
+    long          mismatched;
+    long          missing;          // rekord decyzji bez odpowiadającej decyzji sali
+    int           verbose;
+} ReplayCheck;
+
+static void pushDecision(ReplayCheck* c, int type, int pid, int table) {
+    if (c->count == c->capacity) {
+        // Decyzji "w locie" jest najwyżej tyle, ile grup może usiąść po jednym zdarzeniu
+        int grown = c->capacity ? c->capacity * 2 : 64;
+        Decision* d = (Decision*)malloc(sizeof(Decision) * grown);
+        if (d == NULL) {
+            perror("[Replay] Błąd malloc() decyzji");
+            exit(1);
+        }
+        for (int i = 0; i < c->count; i++) {
+            d[i] = c->pending[(c->head + i) % c->capacity];
+        }
+        free(c->pending);
+        c->pending  = d;
+        c->head     = 0;
+        c->capacity = grown;
+    }
+    Decision* d = &c->pending[(c->head + c->count) % c->capacity];
+    d->type  = type;
+    d->pid   = pid;
+    d->table = table;
+    c->count++;
+}
+
+static void replyToCheck(void* ctx, const GroupOfClients* g, int tableIndex, int waitMs) {
+    (void)waitMs;
+    if (tableIndex == GROUP_QUEUED || tableIndex == GROUP_CANCELLED) {
+        return; // JOURNAL_QUEUE dopisuje replayOnce po handleTableRequest, rezygnacja nie jest decyzją
+    }
+    pushDecision((ReplayCheck*)ctx, (tableIndex >= 0) ? JOURNAL_SEAT : JOURNAL_REJECT, (int)g->groupPID, tableIndex);
+}
+
+static void compareDecision(ReplayCheck* c, const JournalRecord* rec) {
+    if (c->count == 0) {
+        c->missing++;
+        if (c->verbose || c->missing + c->mismatched <= REPLAY_MAX_MISMATCHES) {
+            printf("  #%u: w dzienniku %s PID(%d) stolik %d, sala nie podjęła decyzji\n",
+                   rec->seq, journalTypeName(rec->type), rec->pid, rec->table);
+        }
+        return;
+    }
+    Decision d = c->pending[c->head];
+    c->head = (c->head + 1) % c->capacity;
+    c->count--;
+    if (d.type == rec->type && d.pid == rec->pid && d.table == rec->table) {
+        c->matched++;
+        return;
+    }
+    c->mismatched++;
+    if (c->verbose || c->missing + c->mismatched <= REPLAY_MAX_MISMATCHES) {
+        printf("  #%u: w dzienniku %s PID(%d) stolik %d, teraz %s PID(%d) stolik %d\n",
+               rec->seq, journalTypeName(rec->type), rec->pid, rec->table,
+               journalTypeName(d.type), d.pid, d.table);
+    }
+}
+
+/**
+ * Jeden przebieg dziennika przez świeżą salę.
+ *
+ * @param h Nagłówek dziennika.
+ * @param recs Rekordy.
+ * @param count Liczba rekordów.
+ * @param check Porównanie decyzji (NULL - bez porównania, sam benchmark).
+ * @param hall Sala (po powrocie - stan końcowy, do zniszczenia przez wołającego).
+ * @param tables Stoliki sali.
+ */
+
+static void replayOnce(const JournalHeader* h, const JournalRecord* recs, uint64_t count,
+                       ReplayCheck* check, Restaurant* hall, DiningTable* tables) {
+    static ReplayCheck discard;
+    ReplayCheck* sink = check ? check : &discard;
+    initRestaurant(hall, tables, h->perCapacity, h->queueLimit, replyToCheck, sink);
+    hall->policy = &seatPolicies[h->seatPolicy];
+
+    // Przyjmowanie wg SLO szacuje czekanie w czasie z rekordów dziennika
+    static Admission admission;
+    static long long clockNs;
+    if (h->sloMs > 0) {
+        if (admissionInit(&admission, h->perCapacity, h->queueLimit, h->sloMs, 1) == -1) {
+            perror("[Replay] Błąd przygotowania szacowania czekania");
+            exit(1);
+        }
+        admissionUseClock(&admission, &clockNs);
+        hall->admission = &admission;
+    }
+
+    static CommunicationMessage leaves[65536];
+    for (uint64_t i = 0; i < count; i++) {
+        const JournalRecord* rec = &recs[i];
+        clockNs = rec->atNs;
+        GroupOfClients g = { rec->size, rec->pid, 0 };
+        switch (rec->type) {
+        case JOURNAL_ARRIVAL:
+            g.ticket = (int)(uint32_t)rec->items;
+            if (handleTableRequest(hall, &g) == GROUP_QUEUED) {
+                pushDecision(sink, JOURNAL_QUEUE, rec->pid, -1);
+            }
+            break;
+
+        case JOURNAL_ORDER: {
+            CommunicationMessage msg;
+            msg.mtype      = SEND_ORDER;
+            msg.group      = g;
+            msg.tableIndex = rec->table;
+            journalUnpackItems(rec->items, msg.orderedItems);
+            handleOrder(hall, &msg);
+            break;
+        }
+
+        case JOURNAL_LEAVE:
+            if (rec->batch <= 1) {
+                handleLeave(hall, rec->table, &g);
+                break;
+            }
+            // Wyjścia obsłużone razem (handleLeaveBatch) leżą w dzienniku jedno po drugim
+            int n = 0;
+            while (n < rec->batch && i + n < count && recs[i + n].type == JOURNAL_LEAVE
+                   && n < (int)(sizeof(leaves) / sizeof(leaves[0]))) {
+                leaves[n].group.size     = recs[i + n].size;
+                leaves[n].group.groupPID = recs[i + n].pid;
+                leaves[n].tableIndex     = recs[i + n].table;
+                n++;
+            }
+            handleLeaveBatch(hall, leaves, n);
+            i += n - 1;
+            break;
+
+        case JOURNAL_CLOSE_WARNING:
+            hall->closing = 1;
+            if (queueSize(&hall->waitingLine) > 0) {
+                announceClosing(hall);
+            }
+            break;
+
+        case JOURNAL_FIRE:
+            hall->closing = 1;
+            clearQueue(&hall->waitingLine);
+            break;
+
+        case JOURNAL_HANDOFF_QUEUED: {
+            GroupOfClients out;
+            if (!dequeueSuitable(&hall->waitingLine, rec->size, rec->size, &out) || out.groupPID != rec->pid) {
+                if (check) {
+                    check->mismatched++;
+                    printf("  #%u: grupy PID(%d) nie ma na czele kolejki %d-osobowych\n", rec->seq, rec->pid, rec->size);
+                }
+                break;
+            }
+            if (rec->table == -1) {
+                enqueueGroup(&hall->waitingLine, &out);
+            }
+            break;
+        }
+
+        case JOURNAL_CANCEL:
+            g.ticket = (int)(uint32_t)rec->items;
+            handleCancel(hall, &g);
+            break;
+
+        case JOURNAL_RECLAIM:
+            reclaimGroup(hall, &g, rec->table);
+            break;
+
+        case JOURNAL_QUEUE:
+        case JOURNAL_SEAT:
+        case JOURNAL_REJECT:
+            if (check) {
+                compareDecision(check, rec);
+            } else {
+                sink->count = 0;
+            }
+            break;
+
+        default:  // JOURNAL_HANDOFF - grupa nie weszła do sali
+            break;
+        }
+    }
+    if (hall->admission != NULL) {
+        admissionDestroy(hall->admission);
+        hall->admission = NULL;
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "Użycie: ./replay_app [-n powtórzeń] [-v] dziennik\n");
+    exit(1);
+}
+
+/**
+ * Odtwarza dziennik kasjera:
+ * 1) Odwzorowuje plik (tylko do odczytu) i sprawdza nagłówek.
+ * 2) Wypisuje liczbę rekordów każdego typu i czas trwania zmiany.
+ * 3) Przepuszcza rekordy przez logikę sali i porównuje decyzje oraz końcowy utarg.
+ * 4) Z -n powtarza przebieg (bez porównywania) i podaje czas na rekord.
+ */
+
+int main(int argc, char* argv[]) {
+    long repeat = 0;
+    int verbose = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:v")) != -1) {
+        switch (opt) {
+        case 'n': repeat  = atol(optarg); break;
+        case 'v': verbose = 1; break;
+        default:  usage();
+        }
+    }
+    if (argc - optind != 1) {
+        usage();
+    }
+    setenv("PIZZERIA_LOG", "error", 0);
+    logInit(0);
+
+    int fd = open(argv[optind], O_RDONLY);
+    if (fd == -1) {
+        perror("[Replay] Błąd open() dziennika");
+        exit(1);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(JournalHeader)) {
+        fprintf(stderr, "[Replay] Plik za krótki na dziennik\n");
+        exit(1);
+    }
+    const char* map = (const char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("[Replay] Błąd mmap() dziennika");
+        exit(1);
+    }
+    close(fd);
+
+    const JournalHeader* h = (const JournalHeader*)map;
+    if (memcmp(h->magic, JOURNAL_MAGIC, sizeof(h->magic)) != 0 || h->version != JOURNAL_VERSION
+        || h->recordSize != sizeof(JournalRecord)) {
+        fprintf(stderr, "[Replay] Nieznany format dziennika\n");
+        exit(1);
+    }
+    if (h->maxCapacity != MAX_TABLE_CAPACITY || h->maxGroup != MAX_GROUP_SIZE || h->menuSize != MENU_SIZE) {
+        fprintf(stderr, "[Replay] Dziennik z innego układu lokalu (stoliki do %d, grupy do %d, menu %d) - "
+                        "zbuduj replay_app z tymi samymi -D\n", h->maxCapacity, h->maxGroup, h->menuSize);
+        exit(1);
+    }
+    if (h->seatPolicy < 0 || h->seatPolicy >= SEAT_POLICIES) {
+        fprintf(stderr, "[Replay] Nieznana polityka sadzania w dzienniku: %d\n", h->seatPolicy);
+        exit(1);
+    }
+    const JournalRecord* recs = (const JournalRecord*)(map + sizeof(JournalHeader));
+    uint64_t count = (st.st_size - sizeof(JournalHeader)) / sizeof(JournalRecord);
+    if (h->count > 0 && h->count < count) {
+        count = h->count;
+    }
+    // Dziennik niedomknięty (awaria kasjera): rekordy kończą się na zerowym typie
+    uint64_t valid = 0;
+    long perType[JOURNAL_TYPES] = { 0 };
+    while (valid < count && recs[valid].type > 0 && recs[valid].type < JOURNAL_TYPES) {
+        perType[recs[valid].type]++;
+        valid++;
+    }
+    count = valid;
+
+    printf("----- Dziennik kasjera %d/%d -----\n", h->shard, h->shards);
+    printf("Stoliki:");
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        printf(" %d", h->perCapacity[c]);
+    }
+    if (h->sloMs > 0) {
+        printf(" | SLO czekania: %d ms", h->sloMs);
+    }
+    printf(" | limit kolejki: %d | sadzanie: %s | rekordów: %llu | zmiana: %.3f s\n",
+           h->queueLimit, seatPolicies[h->seatPolicy].name, (unsigned long long)count, count ? recs[count - 1].atNs / 1e9 : 0.0);
+    for (int t = 1; t < JOURNAL_TYPES; t++) {
+        if (perType[t] > 0) {
+            printf("  %-22s %ld\n", journalTypeName(t), perType[t]);
+        }
+    }
+
+    // Porównanie decyzji
+    DiningTable* tables = (DiningTable*)calloc(tableCountFor(h->perCapacity) + 1, sizeof(DiningTable));
+    ReplayCheck check;
+    memset(&check, 0, sizeof(check));
+    check.verbose = verbose;
+    Restaurant hall;
+    replayOnce(h, recs, count, &check, &hall, tables);
+    printf("Decyzje: zgodne %ld, różne %ld, brakujące %ld, nadmiarowe %d\n",
+           check.matched, check.mismatched, check.missing, check.count);
+
+    double revenue = 0;
+    long   clients = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        if (recs[i].type == JOURNAL_ORDER) {
+            int items[MAX_GROUP_SIZE];
+            journalUnpackItems(recs[i].items, items);
+            for (int k = 0; k < recs[i].size; k++) {
+                revenue += pizzaMenu[items[k]].cost;
+            }
+            clients += recs[i].size;
+        }
+    }
+    printf("Utarg: %.2lf zł (z dziennika %.2lf zł), obsłużone osoby: %d\n", hall.totalRevenue, revenue, hall.totalClients);
+    destroyRestaurant(&hall);
+    int ok = (check.mismatched == 0 && check.missing == 0 && check.count == 0 && hall.totalClients == clients);
+
+    // Benchmark: ta sama zmiana wielokrotnie, bez porównywania
+    if (repeat > 0) {
+        long long start = monotonicNs();
+        for (long r = 0; r < repeat; r++) {
+            replayOnce(h, recs, count, NULL, &hall, tables);
+            destroyRestaurant(&hall);
+        }
+        double elapsed = (monotonicNs() - start) / 1e9;
+        printf("Powtórzenia: %ld | czas: %.3f s | %.1f ns/rekord | %.0f rekordów/s\n",
+               repeat, elapsed, elapsed * 1e9 / ((double)count * repeat), count * repeat / elapsed);
+    }
+
+    free(tables);
+    munmap((void*)map, st.st_size);
+    printf("%s\n", ok ? "Przebieg zgodny z dziennikiem." : "PRZEBIEG NIEZGODNY Z DZIENNIKIEM!");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,474 @@
+#include "report.h"
+#include <stdarg.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#define REPORT_TABLES  (MAX_SHARDS * STATS_TABLE_DETAIL)
+
+typedef struct {
+    char*  data;
+    size_t len;
+    size_t cap;
+} ReportText;
+
+typedef struct {
+    int    number;              // globalny numer stolika
+    int    capacity;
+    double percent;
+} TableUse;
+
+static const double waitPercentiles[] = { 50.0, 90.0, 99.0 };
+
+// Dopisuje sformatowany tekst, w razie potrzeby powiększając bufor
+static void put(ReportText* t, const char* fmt, ...) {
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        size_t room = t->cap - t->len;
+        int n = vsnprintf(t->data ? t->data + t->len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            perror("[report.c] Błąd vsnprintf()");
+            exit(1);
+        }
+        if ((size_t)n < room) {
+            t->len += (size_t)n;
+            return;
+        }
+        size_t cap = t->cap ? t->cap * 2 : 4096;
+        while (cap - t->len <= (size_t)n) {
+            cap *= 2;
+        }
+        char* data = realloc(t->data, cap);
+        if (data == NULL) {
+            perror("[report.c] Błąd realloc() raportu");
+            exit(1);
+        }
+        t->data = data;
+        t->cap  = cap;
+    }
+}
+
+static double percentOf(double seatNs, int seats, long long ns) {
+    return (seats > 0 && ns > 0) ? 100.0 * seatNs / ((double)seats * ns) : 0.0;
+}
+
+static double meanOccupancy(const ShiftSummary* s) {
+    double seatNs = 0.0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        seatNs += s->capacitySeatNs[c];
+    }
+    return percentOf(seatNs, s->seats, s->shiftNs);
+}
+
+// Liczba przedziałów wykresu zajętości, które obejmują zmianę
+static int timelineSlots(const ShiftSummary* s) {
+    if (s->slotNs <= 0) {
+        return 0;
+    }
+    long long slots = (s->shiftNs + s->slotNs - 1) / s->slotNs;
+    return (slots < STATS_SLOTS) ? (int)slots : STATS_SLOTS;
+}
+
+static double slotPercent(const ShiftSummary* s, int slot) {
+    long long len = s->slotNs;
+    if ((long long)(slot + 1) * s->slotNs > s->shiftNs) {
+        len = s->shiftNs - (long long)slot * s->slotNs;   // ostatni, niepełny przedział
+    }
+    return percentOf(s->slotSeatNs[slot], s->seats, len);
+}
+
+/**
+ * Zbiera zajętość opisywanych osobno stolików: z podsumowania jedynego kasjera
+ * albo z podsumowań wszystkich kasjerów w katalogu.
+ */
+
+static int collectTables(const DayReport* day, const ShardDirectory* dir, TableUse* out) {
+    int n = 0;
+    int sources = (dir == NULL) ? 1 : dir->shards;
+    for (int k = 0; k < sources; k++) {
+        const ShiftSummary* s = (dir == NULL) ? &day->stats : &dir->shard[k].stats;
+        for (int i = 0; i < s->detailTables && n < REPORT_TABLES; i++, n++) {
+            out[n].number   = s->tableBase + i;
+            out[n].capacity = s->tableCapacity[i];
+            out[n].percent  = percentOf(s->tableSeatNs[i], s->tableCapacity[i], s->shiftNs);
+        }
+    }
+    return n;
+}
+
+static double ovenUtilization(const KitchenSummary* k) {
+    return (k->ovenTimeNs > 0) ? 100.0 * k->ovenBusyNs / k->ovenTimeNs : 0.0;
+}
+
+static double kitchenThroughput(const KitchenSummary* k) {
+    return (k->spanNs > 0) ? k->pizzas / (k->spanNs / 1e9) : 0.0;
+}
+
+static void bar(ReportText* t, double percent) {
+    int width = (int)(percent / 5.0 + 0.5);
+    for (int i = 0; i < width && i < 20; i++) {
+        put(t, "#");
+    }
+}
+
+// --------------------- daily_report.txt ---------------------
+
+static void textSummary(ReportText* t, const DayReport* day, const ShardDirectory* dir) {
+    put(t, "----- Dzienny raport pizzerii -----\n");
+    put(t, "Liczba obsłużonych osób: %d\n", day->clients);
+    put(t, "Całkowity utarg: %.2lf zł\n", day->revenue);
+    put(t, "Sprzedane produkty:\n");
+    for (int i = 0; i < MENU_SIZE; i++) {
+        put(t, "  %s: %d\n", pizzaMenu[i].name, day->soldItems[i]);
+    }
+    if (dir != NULL) {
+        put(t, "Kasjerzy: %d\n", dir->shards);
+        for (int s = 0; s < dir->shards; s++) {
+            const ShardInfo* info = &dir->shard[s];
+            put(t, "  Kasjer %d: stoliki %d-%d, osoby %d, utarg %.2lf zł, oddane grupy %ld, przekazane wyjścia %ld,"
+                   " najdłuższa kolejka %d\n",
+                s, info->base, info->base + info->count - 1, info->totalClients, info->totalRevenue,
+                info->handedOff, info->forwardedLeaves, info->stats.peakQueue);
+        }
+    }
+}
+
+static void textAnalytics(ReportText* t, const DayReport* day, const ShardDirectory* dir,
+                          const TableUse* tables, int tableCount) {
+    const ShiftSummary* s = &day->stats;
+    put(t, "----- Analityka zmiany -----\n");
+    put(t, "Czas zmiany: %.1f s, stoliki %d, miejsca %d\n", s->shiftNs / 1e9, s->tables, s->seats);
+    put(t, "Grupy: przybyło %ld, usadzone od razu %ld, weszły do kolejki %ld, usadzone z kolejki %ld\n",
+        s->arrivals, s->seatedAtOnce, s->queued, s->seatedFromQueue);
+    put(t, "Odmowy: kolejka pełna (NO_TABLE_FOUND) %ld, przed zamknięciem (NEAR_CLOSING) %ld,"
+           " odprawione z kolejki (NEAR_CLOSING) %ld\n",
+        s->rejects[STATS_REJECT_NO_TABLE], s->rejects[STATS_REJECT_NEAR_CLOSING],
+        s->rejects[STATS_REJECT_DISMISSED]);
+    put(t, "Rezygnacje z kolejki (CANCEL_REQUEST): %ld; martwe procesy grup: zwolnione miejsca w kolejce %ld,"
+           " przy stolikach %ld grup / %ld miejsc\n",
+        s->cancelled, s->reclaimedQueued, s->reclaimedGroups, s->reclaimedSeats);
+    put(t, "Najdłuższa kolejka: %d grup%s\n", s->peakQueue, dir ? " (największa u jednego kasjera)" : "");
+
+    put(t, "Czas oczekiwania na stolik [ms]:   liczba    średnia        p50        p90        p99       max\n");
+    for (int g = 0; g <= MAX_GROUP_SIZE; g++) {
+        const Histogram* h = &s->wait[g];
+        char label[32];
+        if (g == 0) {
+            snprintf(label, sizeof(label), "wszystkie grupy");
+        } else {
+            snprintf(label, sizeof(label), "grupy %d-osobowe", g);
+        }
+        put(t, "  %-30s %8llu %10.3f", label, (unsigned long long)h->count, histMean(h) / 1000.0);
+        for (int p = 0; p < 3; p++) {
+            put(t, " %10.3f", histPercentile(h, waitPercentiles[p]) / 1000.0);
+        }
+        put(t, " %9.3f\n", h->count ? h->max / 1000.0 : 0.0);
+    }
+
+    put(t, "Zajętość sali: średnio %.1f%%, p50 %.0f%%, p90 %.0f%%, p99 %.0f%%, szczyt %d z %d miejsc%s\n",
+        meanOccupancy(s), summaryOccupancyPercentile(s, 50.0), summaryOccupancyPercentile(s, 90.0),
+        summaryOccupancyPercentile(s, 99.0), s->peakSeated, s->seats,
+        dir ? " (percentyle z czasu kasjerów, szczyt - suma szczytów)" : "");
+    put(t, "Zajętość wg pojemności stolików:\n");
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        if (s->perCapacity[c] > 0) {
+            put(t, "  %d-osobowe (%d szt.): %5.1f%%\n", c + 1, s->perCapacity[c],
+                percentOf(s->capacitySeatNs[c], s->perCapacity[c] * (c + 1), s->shiftNs));
+        }
+    }
+    put(t, "Zajętość stolików%s:\n", (tableCount < s->tables) ? " (pierwsze stoliki każdego kasjera)" : "");
+    for (int i = 0; i < tableCount; i++) {
+        put(t, "  Stolik %3d (%d os.): %5.1f%% ", tables[i].number, tables[i].capacity, tables[i].percent);
+        bar(t, tables[i].percent);
+        put(t, "\n");
+    }
+    put(t, "Zajętość sali w czasie (przedziały %.1f s):\n", s->slotNs / 1e9);
+    for (int i = 0; i < timelineSlots(s); i++) {
+        double pct = slotPercent(s, i);
+        put(t, "  %7.1f s %5.1f%% ", i * (s->slotNs / 1e9), pct);
+        bar(t, pct);
+        put(t, "\n");
+    }
+}
+
+static void textKitchen(ReportText* t, const KitchenSummary* k) {
+    put(t, "----- Kuchnia -----\n");
+    put(t, "Piece: %d (wsad do %d pizz), kolejka przygotowania: %d pizz\n", k->ovens, k->ovenLoad, k->queueLimit);
+    put(t, "Zamówienia: %ld, upieczone pizze: %ld (%.2f pizzy/s), wsady: %ld (średnio %.2f pizzy)\n",
+        k->orders, k->pizzas, kitchenThroughput(k), k->loads, k->loads ? (double)k->pizzas / k->loads : 0.0);
+    put(t, "Zajętość pieców: %.1f%%\n", ovenUtilization(k));
+    put(t, "Najdłuższa kolejka przygotowania: %d pizz, pełna kolejka: %ld razy (kasjer czekał łącznie %.1f ms)\n",
+        k->peakQueue, k->stalls, k->stallNs / 1e6);
+    const Histogram* h = &k->latency;
+    put(t, "Od zamówienia do podania [ms]: liczba %llu, średnio %.1f",
+        (unsigned long long)h->count, histMean(h) / 1000.0);
+    for (int p = 0; p < 3; p++) {
+        put(t, ", p%.0f %.1f", waitPercentiles[p], histPercentile(h, waitPercentiles[p]) / 1000.0);
+    }
+    put(t, ", max %.1f\n", h->count ? h->max / 1000.0 : 0.0);
+}
+
+static void textAdmission(ReportText* t, const ShiftSummary* s) {
+    const AdmissionSummary* a = &s->admission;
+    put(t, "----- Przyjmowanie grup -----\n");
+    put(t, "SLO czekania na stolik: %d ms (%s)\n", a->sloMs,
+        a->enforce ? "odmowa, gdy szacunek je przekracza" : "tylko pomiar, decyduje limit kolejki");
+    put(t, "Przyjęte grupy: %ld (%.1f na minutę), odmowy ponad SLO: %ld, odmowy przy pełnej kolejce: %ld\n",
+        a->admitted, s->shiftNs ? a->admitted * 60e9 / s->shiftNs : 0.0, a->sloRejects,
+        s->rejects[STATS_REJECT_NO_TABLE]);
+    put(t, "Przekroczenia SLO: %ld z %ld grup w kolejce (%.1f%%)\n", a->violations, s->queued,
+        s->queued ? 100.0 * a->violations / s->queued : 0.0);
+    put(t, "Szacunek czekania: średni błąd %.0f ms (%ld grup), średni czas przy stoliku %.1f s\n",
+        a->estimates ? (double)a->absErrorMs / a->estimates : 0.0, a->estimates, a->holdNs / 1e9);
+}
+
+// --------------------- daily_report.csv ---------------------
+
+static void csvReport(ReportText* t, const DayReport* day, const TableUse* tables, int tableCount) {
+    const ShiftSummary* s = &day->stats;
+    put(t, "kategoria,klucz,wartosc\n");
+    put(t, "dzien,osoby,%d\n", day->clients);
+    put(t, "dzien,utarg,%.2f\n", day->revenue);
+    put(t, "dzien,czas_zmiany_s,%.3f\n", s->shiftNs / 1e9);
+    for (int i = 0; i < MENU_SIZE; i++) {
+        put(t, "sprzedaz,\"%s\",%d\n", pizzaMenu[i].name, day->soldItems[i]);
+    }
+    put(t, "grupy,przybyly,%ld\n", s->arrivals);
+    put(t, "grupy,usadzone_od_razu,%ld\n", s->seatedAtOnce);
+    put(t, "grupy,w_kolejce,%ld\n", s->queued);
+    put(t, "grupy,usadzone_z_kolejki,%ld\n", s->seatedFromQueue);
+    put(t, "odmowy,NO_TABLE_FOUND,%ld\n", s->rejects[STATS_REJECT_NO_TABLE]);
+    put(t, "odmowy,NEAR_CLOSING,%ld\n", s->rejects[STATS_REJECT_NEAR_CLOSING]);
+    put(t, "odmowy,NEAR_CLOSING_z_kolejki,%ld\n", s->rejects[STATS_REJECT_DISMISSED]);
+    put(t, "kolejka,rezygnacje,%ld\n", s->cancelled);
+    put(t, "odzyskane,miejsca_w_kolejce,%ld\n", s->reclaimedQueued);
+    put(t, "odzyskane,grupy_przy_stolikach,%ld\n", s->reclaimedGroups);
+    put(t, "odzyskane,miejsca_przy_stolikach,%ld\n", s->reclaimedSeats);
+    put(t, "kolejka,najdluzsza,%d\n", s->peakQueue);
+    for (int g = 0; g <= MAX_GROUP_SIZE; g++) {
+        const Histogram* h = &s->wait[g];
+        char who[16];
+        if (g == 0) {
+            snprintf(who, sizeof(who), "wszystkie");
+        } else {
+            snprintf(who, sizeof(who), "%d_os", g);
+        }
+        put(t, "czekanie_us,%s_liczba,%llu\n", who, (unsigned long long)h->count);
+        put(t, "czekanie_us,%s_srednia,%.1f\n", who, histMean(h));
+        for (int p = 0; p < 3; p++) {
+            put(t, "czekanie_us,%s_p%.0f,%llu\n", who, waitPercentiles[p],
+                (unsigned long long)histPercentile(h, waitPercentiles[p]));
+        }
+        put(t, "czekanie_us,%s_max,%llu\n", who, (unsigned long long)(h->count ? h->max : 0));
+    }
+    put(t, "zajetosc,srednia,%.2f\n", meanOccupancy(s));
+    put(t, "zajetosc,p50,%.0f\n", summaryOccupancyPercentile(s, 50.0));
+    put(t, "zajetosc,p90,%.0f\n", summaryOccupancyPercentile(s, 90.0));
+    put(t, "zajetosc,p99,%.0f\n", summaryOccupancyPercentile(s, 99.0));
+    put(t, "zajetosc,szczyt_osob,%d\n", s->peakSeated);
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        put(t, "zajetosc_pojemnosc,%d,%.2f\n", c + 1,
+            percentOf(s->capacitySeatNs[c], s->perCapacity[c] * (c + 1), s->shiftNs));
+    }
+    for (int i = 0; i < tableCount; i++) {
+        put(t, "zajetosc_stolika,%d,%.2f\n", tables[i].number, tables[i].percent);
+    }
+    for (int i = 0; i < timelineSlots(s); i++) {
+        put(t, "zajetosc_w_czasie,%.1f,%.2f\n", i * (s->slotNs / 1e9), slotPercent(s, i));
+    }
+    const KitchenSummary* k = &s->kitchen;
+    if (k->ovens > 0) {
+        put(t, "kuchnia,piece,%d\n", k->ovens);
+        put(t, "kuchnia,wsad,%d\n", k->ovenLoad);
+        put(t, "kuchnia,kolejka,%d\n", k->queueLimit);
+        put(t, "kuchnia,zamowienia,%ld\n", k->orders);
+        put(t, "kuchnia,pizze,%ld\n", k->pizzas);
+        put(t, "kuchnia,pizze_na_s,%.3f\n", kitchenThroughput(k));
+        put(t, "kuchnia,wsady,%ld\n", k->loads);
+        put(t, "kuchnia,zajetosc_piecow,%.2f\n", ovenUtilization(k));
+        put(t, "kuchnia,najdluzsza_kolejka,%d\n", k->peakQueue);
+        put(t, "kuchnia,pelna_kolejka,%ld\n", k->stalls);
+        put(t, "kuchnia,czekanie_kasjera_us,%lld\n", k->stallNs / 1000);
+        put(t, "podanie_us,liczba,%llu\n", (unsigned long long)k->latency.count);
+        put(t, "podanie_us,srednia,%.1f\n", histMean(&k->latency));
+        for (int p = 0; p < 3; p++) {
+            put(t, "podanie_us,p%.0f,%llu\n", waitPercentiles[p],
+                (unsigned long long)histPercentile(&k->latency, waitPercentiles[p]));
+        }
+        put(t, "podanie_us,max,%llu\n", (unsigned long long)(k->latency.count ? k->latency.max : 0));
+    }
+    const AdmissionSummary* a = &s->admission;
+    if (a->sloMs > 0) {
+        put(t, "przyjmowanie,slo_ms,%d\n", a->sloMs);
+        put(t, "przyjmowanie,egzekwowane,%d\n", a->enforce);
+        put(t, "przyjmowanie,przyjete,%ld\n", a->admitted);
+        put(t, "przyjmowanie,odmowy_slo,%ld\n", a->sloRejects);
+        put(t, "przyjmowanie,przekroczenia_slo,%ld\n", a->violations);
+        put(t, "przyjmowanie,szacunki,%ld\n", a->estimates);
+        put(t, "przyjmowanie,sredni_blad_ms,%.1f\n", a->estimates ? (double)a->absErrorMs / a->estimates : 0.0);
+        put(t, "przyjmowanie,czas_przy_stoliku_ms,%.1f\n", a->holdNs / 1e6);
+    }
+}
+
+// --------------------- daily_report.json ---------------------
+
+static void jsonReport(ReportText* t, const DayReport* day, const ShardDirectory* dir,
+                       const TableUse* tables, int tableCount) {
+    const ShiftSummary* s = &day->stats;
+    put(t, "{\n  \"osoby\": %d,\n  \"utarg\": %.2f,\n  \"czas_zmiany_s\": %.3f,\n",
+        day->clients, day->revenue, s->shiftNs / 1e9);
+    put(t, "  \"kasjerzy\": %d,\n", dir ? dir->shards : 1);
+    put(t, "  \"sprzedaz\": {");
+    for (int i = 0; i < MENU_SIZE; i++) {
+        put(t, "%s\"%s\": %d", i ? ", " : "", pizzaMenu[i].name, day->soldItems[i]);
+    }
+    put(t, "},\n");
+    put(t, "  \"grupy\": {\"przybyly\": %ld, \"usadzone_od_razu\": %ld, \"w_kolejce\": %ld, "
+           "\"usadzone_z_kolejki\": %ld},\n",
+        s->arrivals, s->seatedAtOnce, s->queued, s->seatedFromQueue);
+    put(t, "  \"odmowy\": {\"NO_TABLE_FOUND\": %ld, \"NEAR_CLOSING\": %ld, \"NEAR_CLOSING_z_kolejki\": %ld},\n",
+        s->rejects[STATS_REJECT_NO_TABLE], s->rejects[STATS_REJECT_NEAR_CLOSING],
+        s->rejects[STATS_REJECT_DISMISSED]);
+    put(t, "  \"rezygnacje\": %ld,\n", s->cancelled);
+    put(t, "  \"odzyskane\": {\"miejsca_w_kolejce\": %ld, \"grupy_przy_stolikach\": %ld, \"miejsca_przy_stolikach\": %ld},\n",
+        s->reclaimedQueued, s->reclaimedGroups, s->reclaimedSeats);
+    put(t, "  \"najdluzsza_kolejka\": %d,\n", s->peakQueue);
+    put(t, "  \"czekanie_us\": {\n");
+    for (int g = 0; g <= MAX_GROUP_SIZE; g++) {
+        const Histogram* h = &s->wait[g];
+        if (g == 0) {
+            put(t, "    \"wszystkie\": ");
+        } else {
+            put(t, "    \"%d\": ", g);
+        }
+        put(t, "{\"liczba\": %llu, \"srednia\": %.1f", (unsigned long long)h->count, histMean(h));
+        for (int p = 0; p < 3; p++) {
+            put(t, ", \"p%.0f\": %llu", waitPercentiles[p],
+                (unsigned long long)histPercentile(h, waitPercentiles[p]));
+        }
+        put(t, ", \"max\": %llu}%s\n", (unsigned long long)(h->count ? h->max : 0),
+            (g < MAX_GROUP_SIZE) ? "," : "");
+    }
+    put(t, "  },\n");
+    put(t, "  \"zajetosc\": {\"srednia\": %.2f, \"p50\": %.0f, \"p90\": %.0f, \"p99\": %.0f, "
+           "\"szczyt_osob\": %d, \"miejsca\": %d},\n",
+        meanOccupancy(s), summaryOccupancyPercentile(s, 50.0), summaryOccupancyPercentile(s, 90.0),
+        summaryOccupancyPercentile(s, 99.0), s->peakSeated, s->seats);
+    put(t, "  \"zajetosc_pojemnosc\": [");
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        put(t, "%s%.2f", c ? ", " : "",
+            percentOf(s->capacitySeatNs[c], s->perCapacity[c] * (c + 1), s->shiftNs));
+    }
+    put(t, "],\n");
+    put(t, "  \"stoliki\": [");
+    for (int i = 0; i < tableCount; i++) {
+        put(t, "%s\n    {\"nr\": %d, \"pojemnosc\": %d, \"zajetosc\": %.2f}", i ? "," : "",
+            tables[i].number, tables[i].capacity, tables[i].percent);
+    }
+    put(t, "%s],\n", tableCount ? "\n  " : "");
+    put(t, "  \"zajetosc_w_czasie\": {\"przedzial_s\": %.3f, \"wartosci\": [", s->slotNs / 1e9);
+    for (int i = 0; i < timelineSlots(s); i++) {
+        put(t, "%s%.2f", i ? ", " : "", slotPercent(s, i));
+    }
+    put(t, "]}");
+    const KitchenSummary* k = &s->kitchen;
+    if (k->ovens > 0) {
+        put(t, ",\n  \"kuchnia\": {\"piece\": %d, \"wsad\": %d, \"kolejka\": %d, \"zamowienia\": %ld, "
+               "\"pizze\": %ld, \"pizze_na_s\": %.3f, \"wsady\": %ld, \"zajetosc_piecow\": %.2f, "
+               "\"najdluzsza_kolejka\": %d, \"pelna_kolejka\": %ld, \"czekanie_kasjera_us\": %lld,\n",
+            k->ovens, k->ovenLoad, k->queueLimit, k->orders, k->pizzas, kitchenThroughput(k), k->loads,
+            ovenUtilization(k), k->peakQueue, k->stalls, k->stallNs / 1000);
+        put(t, "    \"podanie_us\": {\"liczba\": %llu, \"srednia\": %.1f",
+            (unsigned long long)k->latency.count, histMean(&k->latency));
+        for (int p = 0; p < 3; p++) {
+            put(t, ", \"p%.0f\": %llu", waitPercentiles[p],
+                (unsigned long long)histPercentile(&k->latency, waitPercentiles[p]));
+        }
+        put(t, ", \"max\": %llu}}", (unsigned long long)(k->latency.count ? k->latency.max : 0));
+    }
+    const AdmissionSummary* a = &s->admission;
+    if (a->sloMs > 0) {
+        put(t, ",\n  \"przyjmowanie\": {\"slo_ms\": %d, \"egzekwowane\": %s, \"przyjete\": %ld, \"odmowy_slo\": %ld, "
+               "\"przekroczenia_slo\": %ld, \"szacunki\": %ld, \"sredni_blad_ms\": %.1f, \"czas_przy_stoliku_ms\": %.1f}",
+            a->sloMs, a->enforce ? "true" : "false", a->admitted, a->sloRejects, a->violations, a->estimates,
+            a->estimates ? (double)a->absErrorMs / a->estimates : 0.0, a->holdNs / 1e6);
+    }
+    put(t, "\n}\n");
+}
+
+/**
+ * Zapisuje plik jednym writev() (w pętli tylko na wypadek częściowego zapisu).
+ */
+
+static void writeFile(const char* path, ReportText* parts, int count) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) {
+        perror(CLR_CASHIER "[Kasjer] Błąd przy otwarciu pliku raportu" CLR_RESET);
+        exit(1);
+    }
+    struct iovec iov[4];
+    for (int i = 0; i < count; i++) {
+        iov[i].iov_base = parts[i].data;
+        iov[i].iov_len  = parts[i].len;
+    }
+    struct iovec* next = iov;
+    while (count > 0) {
+        ssize_t n = writev(fd, next, count);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror(CLR_CASHIER "[Kasjer] Błąd writev() raportu" CLR_RESET);
+            break;
+        }
+        while (count > 0 && (size_t)n >= next->iov_len) {
+            n -= (ssize_t)next->iov_len;
+            next++;
+            count--;
+        }
+        if (count > 0) {
+            next->iov_base = (char*)next->iov_base + n;
+            next->iov_len -= (size_t)n;
+        }
+    }
+    close(fd);
+}
+
+/**
+ * Zapisuje daily_report.txt, daily_report.csv i daily_report.json.
+ *
+ * @param day Sumy dnia i analityka zmiany.
+ * @param dir Katalog kasjerów (linia i stoliki każdego kasjera) lub NULL (jeden kasjer).
+ */
+
+void writeDailyReports(const DayReport* day, const ShardDirectory* dir) {
+    static TableUse tables[REPORT_TABLES];
+    int tableCount = collectTables(day, dir, tables);
+
+    ReportText text[4] = {{0}};
+    int parts = 0;
+    textSummary(&text[parts++], day, dir);
+    textAnalytics(&text[parts++], day, dir, tables, tableCount);
+    if (day->stats.kitchen.ovens > 0) {
+        textKitchen(&text[parts++], &day->stats.kitchen);
+    }
+    if (day->stats.admission.sloMs > 0) {
+        textAdmission(&text[parts++], &day->stats);
+    }
+    writeFile("daily_report.txt", text, parts);
+
+    ReportText csv = {0};
+    csvReport(&csv, day, tables, tableCount);
+    writeFile("daily_report.csv", &csv, 1);
+
+    ReportText json = {0};
+    jsonReport(&json, day, dir, tables, tableCount);
+    writeFile("daily_report.json", &json, 1);
+
+    for (int i = 0; i < parts; i++) {
+        free(text[i].data);
+    }
+    free(csv.data);
+    free(json.data);
+}
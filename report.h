@@ -0,0 +1,24 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "pizzeria.h"
+#include "stats.h"
+#include "shard.h"
+
+// --------------------- Raport dzienny ---------------------
+//
+// Kasjer (przy kilku kasjerach - prowadzący, z sumami z katalogu) zapisuje na koniec
+// dnia trzy pliki: daily_report.txt (dotychczasowy raport, analityka zmiany, kuchnia i przyjmowanie grup),
+// daily_report.csv (kategoria,klucz,wartosc) i daily_report.json. Każdy plik jest
+// składany w pamięci i zapisywany jednym writev().
+
+typedef struct {
+    int          soldItems[MENU_SIZE];
+    double       revenue;
+    int          clients;
+    ShiftSummary stats;          // przy kilku kasjerach - suma (summaryMerge)
+} DayReport;
+
+void writeDailyReports(const DayReport* day, const ShardDirectory* dir);
+
+#endif // REPORT_H
@@ -0,0 +1,505 @@
+#include "restaurant.h"
+#include "logger.h"
+#include <string.h>
+
+/**
+ * Inicjuje fragment tablicy stolików w zakresie [start..end-1].
+ * Ustawia seq = 0, capacity = cap, group_size = 0, total_seated = 0,
+ * occupant_pids[j] = 0.
+ *
+ * @param t Tablica DiningTable.
+ * @param start Indeks początkowy.
+ * @param end Indeks końcowy (niewłączny).
+ * @param cap Pojemność (1..MAX_TABLE_CAPACITY).
+ */
+
+// -------------------------------------
+static void setupTables(DiningTable* t, int start, int end, int cap) {
+    for (int i = start; i < end; i++) {
+        atomic_init(&t[i].seq, 0);
+        for (int j = 0; j < TABLE_SLOTS; j++) {
+            t[i].occupant_pids[j] = 0;
+        }
+        t[i].capacity = cap;
+        t[i].group_size = 0;
+        t[i].total_seated = 0;
+    }
+}
+
+// Rekord w dzienniku zdarzeń sali (jeśli jest włączony)
+static inline void journalHall(Restaurant* r, int type, const GroupOfClients* g, int table, uint64_t items, int batch) {
+    if (r->journal != NULL) {
+        journalAppend(r->journal, type, g, table, items, batch);
+    }
+}
+
+/**
+ * Zwraca łączną liczbę stolików dla podanych liczności (1..MAX_TABLE_CAPACITY osobowych).
+ */
+
+int tableCountFor(const int perCapacity[MAX_TABLE_CAPACITY]) {
+    int total = 0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        total += perCapacity[c];
+    }
+    return total;
+}
+
+/**
+ * Przygotowuje salę: stoliki kolejno od 1- do MAX_TABLE_CAPACITY-osobowych, katalog wolnych
+ * miejsc, pustą kolejkę oczekujących i wyzerowane statystyki.
+ *
+ * @param r Stan sali.
+ * @param tables Tablica stolików (np. w pamięci współdzielonej) o rozmiarze tableCountFor(perCapacity).
+ * @param perCapacity Liczba stolików każdej pojemności.
+ * @param queueLimit Maksymalna długość kolejki oczekujących.
+ * @param reply Funkcja wysyłająca odpowiedź do grupy.
+ * @param replyCtx Kontekst przekazywany do reply.
+ */
+
+void initRestaurant(Restaurant* r, DiningTable* tables, const int perCapacity[MAX_TABLE_CAPACITY],
+                    int queueLimit, ReplyFn reply, void* replyCtx) {
+    memset(r, 0, sizeof(*r));
+    r->tables   = tables;
+    r->count    = tableCountFor(perCapacity);
+    r->reply    = reply;
+    r->replyCtx = replyCtx;
+
+    int start = 0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        setupTables(tables, start, start + perCapacity[c], c + 1);
+        start += perCapacity[c];
+    }
+    initSeatDirectory(&r->dir, tables, r->count);
+    r->policy = seatPolicyFromEnv();
+    initQueue(&r->waitingLine, queueLimit);
+}
+
+void destroyRestaurant(Restaurant* r) {
+    freeSeatDirectory(&r->dir);
+    destroyQueue(&r->waitingLine);
+}
+
+/**
+ * Szuka wolnego stolika (lub pasującego do danej wielkości grupy)
+ * w katalogu wolnych miejsc. Jeśli zaraz zamykamy, zwraca NEAR_CLOSING.
+ * W przeciwnym razie zwraca stolik wybrany przez politykę sadzania spośród tych, które:
+ *   - są puste lub mają group_size równy rozmiarowi grupy,
+ *   - mają dość miejsca (capacity - total_seated >= groupSize).
+ * Gdy nie znajdzie, zwraca NO_TABLE_FOUND.
+ *
+ * @param r Stan sali.
+ * @param groupSize Wielkość grupy.
+ * @return Indeks stolika >= 0, NEAR_CLOSING lub NO_TABLE_FOUND.
+ */
+
+// -------------------------------------
+static int findFreeTable(const Restaurant* r, int groupSize) {
+    if (r->closing) {
+        return NEAR_CLOSING;
+    }
+    return r->policy->pickTable(&r->dir, groupSize);
+}
+
+/**
+ * Usadza daną grupę (groupPID, size) przy stoliku o indeksie tableIdx:
+ * 1) Ustawia, jeśli total_seated == 0, group_size = group->size.
+ * 2) Zwiększa total_seated o group->size.
+ * 3) Szuka pustego slotu occupant_pids[] i wpisuje tam PID grupy.
+ * 4) Wysyła do klienta odpowiedź z numerem stolika.
+ *
+ * @param r Stan sali.
+ * @param tableIdx Indeks stolika w tablicy.
+ * @param grp Informacje o grupie (pid, size).
+ * @param fromQueue 1 - grupa czekała w kolejce.
+ */
+
+static void seatGroupAtTable(Restaurant* r, int tableIdx, const GroupOfClients* grp, int fromQueue) {
+    occupyTable(r->tables, &r->dir, tableIdx, grp);
+    r->seated += grp->size;
+    journalHall(r, JOURNAL_SEAT, grp, tableIdx, 0, 0);
+    if (r->stats != NULL) {
+        statsSeat(r->stats, grp, tableIdx);
+    }
+    if (r->admission != NULL) {
+        admissionSeated(r->admission, r->tables, tableIdx, grp, fromQueue);
+    }
+
+    LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Przydzielam stolik %d grupie PID(%d), liczba osób: %d\n" CLR_RESET,
+            tableIdx, (int)grp->groupPID, grp->size);
+
+    r->reply(r->replyCtx, grp, tableIdx, 0);
+}
+
+/**
+ * Próbujemy usadzić grupy z kolejki przy stoliku "idx", który właśnie się zwolnił.
+ * Po każdym REQUEST_TABLE i LEAVE_TABLE żadna grupa z kolejki nie pasuje do
+ * żadnego stolika (inaczej zostałaby usadzona), więc po wyjściu grupy jedynym
+ * stolikiem, który może kogoś przyjąć, jest ten zwolniony. Dopóki przy nim
+ * jest miejsce:
+ *   - obliczamy wolne miejsce (freeSpace) i bierzemy group_size (grpSize),
+ *   - polityka sadzania wybiera i zdejmuje z kolejki pasującą grupę,
+ *   - jeśli znajdzie grupę, przydzielamy ją seatGroupAtTable(...).
+ *
+ * @param r Stan sali.
+ * @param idx Indeks zwolnionego stolika.
+ */
+
+static void trySeatQueue(Restaurant* r, int idx) {  //Staramy się rozładować kolejkę w razie możliwości
+    DiningTable* t = r->tables;
+    while (queueSize(&r->waitingLine) > 0) {
+        int freeSpace = t[idx].capacity - t[idx].total_seated;
+        int grpSize = t[idx].group_size;
+        if (freeSpace <= 0 || (freeSpace < grpSize && grpSize != 0)) {  //stolik nie przyjmie już nikogo
+            return;
+        }
+        GroupOfClients newG;
+        if (!r->policy->pickGroup(&r->waitingLine, grpSize, freeSpace, &newG)) {  //wyszukuje pasującą grupę
+            return;
+        }
+        seatGroupAtTable(r, idx, &newG, 1);
+    }
+}
+
+// Wpis rezygnacji z zapytania g (numer PID-u i zapytania) albo -1
+static int findCancelNote(const Restaurant* r, const GroupOfClients* g) {
+    for (int i = 0; r->cancelNoted > 0 && i < CANCEL_NOTES; i++) {
+        if (r->cancelNotes[i].pid == g->groupPID && r->cancelNotes[i].ticket == g->ticket) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Czy zapytanie g zostało już odwołane (CANCEL_REQUEST dotarł przed nim)
+int cancelNoted(const Restaurant* r, const GroupOfClients* g) {
+    return findCancelNote(r, g) != -1;
+}
+
+/**
+ * REQUEST_TABLE: sadza grupę, wstawia ją do kolejki albo odmawia.
+ * Odpowiedź jest od razu wysyłana przez r->reply. Z przyjmowaniem wg SLO (r->admission)
+ * grupa bez stolika dostaje szacunek czekania: odmowę, gdy przekracza SLO,
+ * albo GROUP_QUEUED z szacunkiem; bez niego o wejściu do kolejki decyduje tylko jej limit.
+ * Zapytanie odwołane wcześniej przez CANCEL_REQUEST dostaje od razu GROUP_CANCELLED.
+ *
+ * @param r Stan sali.
+ * @param g Grupa proszące o stolik.
+ * @return Indeks stolika, GROUP_QUEUED, NO_TABLE_FOUND (kolejka pełna lub ponad SLO), NEAR_CLOSING
+ *         lub GROUP_CANCELLED.
+ */
+
+int handleTableRequest(Restaurant* r, const GroupOfClients* g) {
+    journalHall(r, JOURNAL_ARRIVAL, g, -1, (uint64_t)(unsigned int)g->ticket, 0);
+    if (r->stats != NULL) {
+        statsArrival(r->stats);
+    }
+    int note = findCancelNote(r, g);
+    if (note != -1) {
+        LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d) zrezygnowała, zanim dotarło jej zapytanie.\n" CLR_RESET,
+                (int)g->groupPID);
+        r->cancelNotes[note].pid = 0;
+        r->cancelNoted--;
+        if (r->stats != NULL) {
+            statsCancel(r->stats, g);
+        }
+        r->reply(r->replyCtx, g, GROUP_CANCELLED, -1);
+        return GROUP_CANCELLED;
+    }
+    int tIdx = findFreeTable(r, g->size);
+    if (tIdx == NEAR_CLOSING) {
+        LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d), zamykamy wkrótce, nie wpuszczam.\n" CLR_RESET,
+                (int)g->groupPID);
+        journalHall(r, JOURNAL_REJECT, g, NEAR_CLOSING, 0, 0);
+        if (r->stats != NULL) {
+            statsReject(r->stats, g, STATS_REJECT_NEAR_CLOSING);
+        }
+        r->reply(r->replyCtx, g, NEAR_CLOSING, -1);
+        return NEAR_CLOSING;
+    }
+    if (tIdx == NO_TABLE_FOUND) {
+        int waitMs  = (r->admission != NULL) ? admissionEstimate(r->admission, g->size) : -1;
+        int overSlo = (r->admission != NULL) && admissionOverSlo(r->admission, waitMs);
+        if (overSlo || queueSize(&r->waitingLine) >= r->waitingLine.maxSize || enqueueGroup(&r->waitingLine, g) == -1) {
+            if (overSlo) {
+                LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d), szacowane czekanie %d ms ponad SLO %d ms.\n" CLR_RESET,
+                        (int)g->groupPID, waitMs, r->admission->sloMs);
+            } else {
+                LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d), kolejka jest przepełniona.\n" CLR_RESET,
+                        (int)g->groupPID);
+            }
+            journalHall(r, JOURNAL_REJECT, g, NO_TABLE_FOUND, 0, 0);
+            if (r->stats != NULL) {
+                statsReject(r->stats, g, overSlo ? STATS_REJECT_SLO : STATS_REJECT_NO_TABLE);
+            }
+            r->reply(r->replyCtx, g, NO_TABLE_FOUND, overSlo ? waitMs : -1);
+            return NO_TABLE_FOUND;
+        }
+        journalHall(r, JOURNAL_QUEUE, g, -1, 0, 0);
+        if (r->stats != NULL) {
+            statsQueued(r->stats, g, queueSize(&r->waitingLine));
+        }
+        if (r->admission != NULL) {
+            admissionQueued(r->admission, g, waitMs);
+            r->reply(r->replyCtx, g, GROUP_QUEUED, waitMs);
+        }
+        if (LOG_HOT_ENABLED(LVL_DEBUG)) {
+            printQueue(&r->waitingLine);
+        }
+        return GROUP_QUEUED;
+    }
+    seatGroupAtTable(r, tIdx, g, 0);
+    return tIdx;
+}
+
+/**
+ * SEND_ORDER: zlicza sprzedane pizze, przychód i obsłużone osoby.
+ */
+
+void handleOrder(Restaurant* r, const CommunicationMessage* msg) {
+    journalHall(r, JOURNAL_ORDER, &msg->group, msg->tableIndex, journalPackItems(msg->orderedItems), 0);
+    for (int i = 0; i < msg->group.size; i++) {
+        r->soldItems[msg->orderedItems[i]]++;
+        r->totalRevenue += pizzaMenu[msg->orderedItems[i]].cost;
+    }
+    r->totalClients += msg->group.size;
+}
+
+/**
+ * Czy grupa siedzi przy stoliku. Wyjście grupy, której miejsce zwolnił już
+ * reclaimGroup (proces zakończył się zaraz po wysłaniu LEAVE_TABLE), jest pomijane.
+ */
+
+static int seatedAt(const Restaurant* r, int tableIdx, pid_t pid) {
+    if (tableIdx < 0 || tableIdx >= r->count) {
+        return 0;
+    }
+    for (int j = 0; j < TABLE_SLOTS; j++) {
+        if (r->tables[tableIdx].occupant_pids[j] == pid) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * LEAVE_TABLE: zwalnia miejsca grupy i próbuje wpuścić przy tym stoliku kogoś z kolejki.
+ */
+
+void handleLeave(Restaurant* r, int tableIdx, const GroupOfClients* g) {
+    journalHall(r, JOURNAL_LEAVE, g, tableIdx, 0, 1);
+    if (!seatedAt(r, tableIdx, g->groupPID)) {
+        return;
+    }
+    if (r->admission != NULL) {
+        admissionLeft(r->admission, r->tables, tableIdx, g);
+    }
+    vacateTable(r->tables, &r->dir, tableIdx, g->groupPID, g->size);
+    r->seated -= g->size;
+    if (r->stats != NULL) {
+        statsLeave(r->stats, g, tableIdx);
+    }
+    trySeatQueue(r, tableIdx);
+}
+
+/**
+ * Kilka LEAVE_TABLE naraz: najpierw zwalnia wszystkie stoliki, a dopiero potem
+ * jednym przejściem próbuje usadzić kolejkę przy zwolnionych stolikach.
+ * Niezmiennik z trySeatQueue zostaje zachowany - grupy z kolejki mogą pasować
+ * tylko do stolików zwolnionych w tej partii.
+ *
+ * @param r Stan sali.
+ * @param leaves Komunikaty LEAVE_TABLE.
+ * @param count Liczba komunikatów.
+ */
+
+void handleLeaveBatch(Restaurant* r, const CommunicationMessage* leaves, int count) {
+    for (int i = 0; i < count; i++) {
+        journalHall(r, JOURNAL_LEAVE, &leaves[i].group, leaves[i].tableIndex, 0, count);
+        if (!seatedAt(r, leaves[i].tableIndex, leaves[i].group.groupPID)) {
+            continue;
+        }
+        if (r->admission != NULL) {
+            admissionLeft(r->admission, r->tables, leaves[i].tableIndex, &leaves[i].group);
+        }
+        vacateTable(r->tables, &r->dir, leaves[i].tableIndex, leaves[i].group.groupPID, leaves[i].group.size);
+        r->seated -= leaves[i].group.size;
+        if (r->stats != NULL) {
+            statsLeave(r->stats, &leaves[i].group, leaves[i].tableIndex);
+        }
+    }
+    if (queueSize(&r->waitingLine) == 0) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        trySeatQueue(r, leaves[i].tableIndex);
+    }
+}
+
+/**
+ * Informuje wszystkie grupy w kolejce, że pizzeria
+ * "zaraz się zamyka" (NEAR_CLOSING). Wysyła do każdej
+ * w kolejce odpowiedź z tableIndex = NEAR_CLOSING.
+ * Następnie opróżnia kolejkę (clearQueue), aby nikt nie czekał.
+ *
+ * @param r Stan sali.
+ */
+
+void announceClosing(Restaurant* r) {
+    QueueNode* iter = r->waitingLine.head;
+    while (iter) {
+        GroupOfClients* g = &iter->data;
+        LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Informuję grupę PID(%d), że zaraz zamykamy.\n" CLR_RESET,
+                (int)g->groupPID);
+        journalHall(r, JOURNAL_REJECT, g, NEAR_CLOSING, 0, 0);
+        if (r->stats != NULL) {
+            statsReject(r->stats, g, STATS_REJECT_DISMISSED);
+        }
+        if (r->admission != NULL) {
+            admissionDismissed(r->admission, g);
+        }
+        r->reply(r->replyCtx, g, NEAR_CLOSING, -1);
+        iter = iter->next;
+    }
+    clearQueue(&r->waitingLine);
+}
+
+/**
+ * CANCEL_REQUEST: grupa nie chce dłużej czekać. Jeśli jest jeszcze w kolejce,
+ * zdejmujemy ją (O(1), indeks PID-ów kolejki) i odpowiadamy GROUP_CANCELLED.
+ * W przeciwnym razie odpowiedź (stolik lub odmowa) już poszła albo pójdzie od
+ * innego kasjera - grupa czeka na nią zamiast na GROUP_CANCELLED - albo rezygnacja
+ * wyprzedziła zapytanie. Zapamiętujemy ją więc (cancelNotes): zapytanie z tym samym
+ * numerem dostanie GROUP_CANCELLED, a wpis po odpowiedzi już wysłanej nikomu nie zaszkodzi.
+ *
+ * @param r Stan sali.
+ * @param g Grupa rezygnująca z czekania.
+ * @return 1, gdy grupa została zdjęta z kolejki.
+ */
+
+int handleCancel(Restaurant* r, const GroupOfClients* g) {
+    journalHall(r, JOURNAL_CANCEL, g, -1, (uint64_t)(unsigned int)g->ticket, 0);
+    GroupOfClients out;
+    if (!removeGroup(&r->waitingLine, g->groupPID, &out)) {
+        if (findCancelNote(r, g) == -1) {
+            CancelNote* n = &r->cancelNotes[r->cancelNext];
+            r->cancelNoted += (n->pid == 0);
+            n->pid    = g->groupPID;
+            n->ticket = g->ticket;
+            r->cancelNext = (r->cancelNext + 1) % CANCEL_NOTES;
+        }
+        return 0;
+    }
+    LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d) rezygnuje z czekania, zdejmuję ją z kolejki.\n" CLR_RESET,
+            (int)out.groupPID);
+    if (r->stats != NULL) {
+        statsCancel(r->stats, &out);
+    }
+    if (r->admission != NULL) {
+        admissionForget(r->admission, &out);
+    }
+    r->reply(r->replyCtx, &out, GROUP_CANCELLED, -1);
+    return 1;
+}
+
+/**
+ * Zwalnia miejsce grupy, której proces już nie żyje: przy stoliku tableIdx
+ * (jak LEAVE_TABLE, razem z próbą usadzenia kolejki) albo w kolejce (tableIdx = -1).
+ * Nikt nie czeka na odpowiedź, więc żadna nie jest wysyłana.
+ *
+ * @param r Stan sali.
+ * @param g Grupa (przy stoliku - wielkość to group_size stolika).
+ * @param tableIdx Lokalny indeks stolika albo -1.
+ */
+
+void reclaimGroup(Restaurant* r, const GroupOfClients* g, int tableIdx) {
+    journalHall(r, JOURNAL_RECLAIM, g, tableIdx, 0, 0);
+    if (tableIdx < 0) {
+        GroupOfClients out;
+        if (removeGroup(&r->waitingLine, g->groupPID, &out)) {
+            if (r->stats != NULL) {
+                statsReclaim(r->stats, &out, -1);
+            }
+            if (r->admission != NULL) {
+                admissionForget(r->admission, &out);
+            }
+        }
+        return;
+    }
+    if (r->admission != NULL) {
+        admissionLeft(r->admission, r->tables, tableIdx, g);
+    }
+    vacateTable(r->tables, &r->dir, tableIdx, g->groupPID, g->size);
+    r->seated -= g->size;
+    if (r->stats != NULL) {
+        statsReclaim(r->stats, g, tableIdx);
+    }
+    trySeatQueue(r, tableIdx);
+}
+
+/**
+ * Sprawdza procesy wszystkich grup w kolejce i przy stolikach i zwalnia miejsca
+ * tych, które już nie żyją (klient zabity, zginął przy starcie itp.). Inaczej
+ * martwa grupa zajmowałaby miejsce w kolejce, a potem stolik, przy którym nikt nie je.
+ *
+ * @param r Stan sali.
+ * @param alive Test życia procesu.
+ * @return Liczba zwolnionych grup.
+ */
+
+int reclaimDeadGroups(Restaurant* r, AliveFn alive) {
+    int reclaimed = 0;
+    QueueNode* iter = r->waitingLine.head;
+    while (iter) {
+        QueueNode* next = iter->next;
+        if (!alive(iter->data.groupPID)) {
+            GroupOfClients g = iter->data;
+            LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d) nie żyje, zwalniam jej miejsce w kolejce.\n" CLR_RESET,
+                    (int)g.groupPID);
+            reclaimGroup(r, &g, -1);
+            reclaimed++;
+        }
+        iter = next;
+    }
+    for (int i = 0; i < r->count; i++) {
+        for (int j = 0; j < TABLE_SLOTS; j++) {
+            pid_t pid = r->tables[i].occupant_pids[j];
+            if (pid == 0 || alive(pid)) {
+                continue;
+            }
+            GroupOfClients g = { r->tables[i].group_size, pid, 0 };
+            LOG_HOT(LVL_INFO, CLR_CASHIER "[Kasjer] Grupa PID(%d) nie żyje, zwalniam stolik %d.\n" CLR_RESET,
+                    (int)pid, i);
+            reclaimGroup(r, &g, i);
+            reclaimed++;
+        }
+    }
+    return reclaimed;
+}
+
+/**
+ * Wyświetla status wszystkich stolików (capacity, total_seated,
+ * group_size, occupant_pids) na poziomie LVL_DEBUG - jedna linia logu na stolik.
+ * Każdy stolik jest czytany jako spójna kopia (tableSnapshot), bez blokowania.
+ *
+ * @param r Stan sali.
+ */
+
+void showCurrentTables(const Restaurant* r) {
+    logWrite(LVL_DEBUG, CLR_CASHIER "\n--- Stoliki w lokalu ---\n" CLR_RESET);
+    for (int i = 0; i < r->count; i++) {
+        DiningTable t;
+        tableSnapshot(&r->tables[i], &t);
+        char pids[12 * TABLE_SLOTS];
+        int  used = 0;
+        pids[0] = '\0';
+        for (int j = 0; j < TABLE_SLOTS; j++) {
+            if (t.occupant_pids[j] != 0) {
+                used += snprintf(pids + used, sizeof(pids) - used, " %d ", (int)t.occupant_pids[j]);
+            }
+        }
+        logWrite(LVL_DEBUG, CLR_CASHIER "[Stol %2d] Kap: %d | Zaj: %d | GrupaSz: %d | PIDy: (%s)\n" CLR_RESET,
+                 i, t.capacity, t.total_seated, t.group_size, pids);
+    }
+    logWrite(LVL_DEBUG, CLR_CASHIER "************************\n\n" CLR_RESET);
+}
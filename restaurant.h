@@ -0,0 +1,74 @@
+#ifndef RESTAURANT_H
+#define RESTAURANT_H
+
+#include "pizzeria.h"
+#include "seating.h"
+#include "journal.h"
+#include "stats.h"
+#include "admission.h"
+
+// --------------------- Logika sali (bez IPC) ---------------------
+//
+// Stan obsługiwany przez kasjera: stoliki, katalog wolnych miejsc, kolejka
+// oczekujących i statystyki dnia. Odpowiedzi do grup wychodzą przez funkcję
+// zwrotną, więc ta sama logika działa nad kolejką komunikatów (cashier_app)
+// i nad kolejkami w pamięci (engine_app).
+
+// Odpowiedź do grupy: tableIndex >= 0, NO_TABLE_FOUND lub NEAR_CLOSING; z przyjmowaniem
+// wg SLO także GROUP_QUEUED przy wejściu do kolejki, a po rezygnacji GROUP_CANCELLED.
+// waitMs - szacowane czekanie (-1 - brak).
+typedef void (*ReplyFn)(void* ctx, const GroupOfClients* g, int tableIndex, int waitMs);
+
+// Czy proces grupy jeszcze żyje (kasjer sprawdza to przez pidfd / kill)
+typedef int (*AliveFn)(pid_t pid);
+
+// Rezygnacje, które nikogo nie zastały w kolejce. Z kolejki SysV CANCEL_REQUEST (niższy typ)
+// bywa odebrany przed REQUEST_TABLE tej samej grupy - zapytanie z tym samym numerem
+// dostaje wtedy od razu GROUP_CANCELLED. Najstarsze wpisy są nadpisywane.
+#define CANCEL_NOTES 32
+
+typedef struct {
+    pid_t pid;              // 0 - wolny wpis
+    int   ticket;
+} CancelNote;
+
+typedef struct {
+    DiningTable*  tables;
+    int           count;
+    SeatDirectory dir;
+    const SeatPolicy* policy;    // wybór stolika i grupy z kolejki (PIZZERIA_SEATING)
+    ClientsQueue  waitingLine;
+    ReplyFn       reply;
+    void*         replyCtx;
+    int           closing;       // nowe grupy dostają NEAR_CLOSING
+    int           seated;        // osoby przy stolikach
+    Journal*      journal;       // NULL - bez dziennika zdarzeń
+    ShiftStats*   stats;         // NULL - bez statystyk do raportu dziennego
+    Admission*    admission;     // NULL - tylko stały limit kolejki (PIZZERIA_ADMISSION)
+    CancelNote    cancelNotes[CANCEL_NOTES];
+    int           cancelNoted;   // zajęte wpisy cancelNotes
+    int           cancelNext;    // następny wpis do nadpisania
+
+    // Statystyki dzienne
+    int           soldItems[MENU_SIZE];
+    double        totalRevenue;
+    int           totalClients;
+} Restaurant;
+
+void initRestaurant(Restaurant* r, DiningTable* tables, const int perCapacity[MAX_TABLE_CAPACITY],
+                    int queueLimit, ReplyFn reply, void* replyCtx);
+void destroyRestaurant(Restaurant* r);
+int  tableCountFor(const int perCapacity[MAX_TABLE_CAPACITY]);
+
+int  handleTableRequest(Restaurant* r, const GroupOfClients* g);
+void handleOrder(Restaurant* r, const CommunicationMessage* msg);
+void handleLeave(Restaurant* r, int tableIdx, const GroupOfClients* g);
+void handleLeaveBatch(Restaurant* r, const CommunicationMessage* leaves, int count);
+void announceClosing(Restaurant* r);
+int  handleCancel(Restaurant* r, const GroupOfClients* g);
+int  cancelNoted(const Restaurant* r, const GroupOfClients* g);
+void reclaimGroup(Restaurant* r, const GroupOfClients* g, int tableIdx);
+int  reclaimDeadGroups(Restaurant* r, AliveFn alive);
+void showCurrentTables(const Restaurant* r);
+
+#endif // RESTAURANT_H
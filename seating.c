@@ -0,0 +1,549 @@
+#include "seating.h"
+#include <string.h>
+#include <strings.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEAT_X86 1
+#endif
+
+// --------------------- Hierarchiczna mapa bitowa ---------------------
+
+static void initIndexSet(TableIndexSet* s, int count) {
+    int words = (count + 63) / 64;
+    if (words == 0) {
+        words = 1;
+    }
+    s->levels = 0;
+    while (1) {
+        if (s->levels == SEAT_INDEX_MAX_LEVELS) {
+            fprintf(stderr, "[seating.c] Zbyt wiele stolików: %d\n", count);
+            exit(1);
+        }
+        s->words[s->levels] = (uint64_t*)calloc(words, sizeof(uint64_t));
+        if (s->words[s->levels] == NULL) {
+            perror("[seating.c] Błąd calloc() katalogu stolików");
+            exit(1);
+        }
+        s->levels++;
+        if (words == 1) {
+            break; // najwyższy poziom ma jedno słowo
+        }
+        words = (words + 63) / 64;
+    }
+}
+
+static void freeIndexSet(TableIndexSet* s) {
+    for (int l = 0; l < s->levels; l++) {
+        free(s->words[l]);
+        s->words[l] = NULL;
+    }
+    s->levels = 0;
+}
+
+static void setIndex(TableIndexSet* s, int idx) {
+    for (int l = 0; l < s->levels; l++) {
+        uint64_t* w = &s->words[l][idx >> 6];
+        int wasEmpty = (*w == 0);
+        *w |= 1ULL << (idx & 63);
+        if (!wasEmpty) {
+            return; // wyższe poziomy już wskazują na to słowo
+        }
+        idx >>= 6;
+    }
+}
+
+static void clearIndex(TableIndexSet* s, int idx) {
+    for (int l = 0; l < s->levels; l++) {
+        uint64_t* w = &s->words[l][idx >> 6];
+        *w &= ~(1ULL << (idx & 63));
+        if (*w != 0) {
+            return; // w słowie zostały inne stoliki
+        }
+        idx >>= 6;
+    }
+}
+
+static int firstIndex(const TableIndexSet* s) {
+    int top = s->levels - 1;
+    if (s->words[top][0] == 0) {
+        return -1;
+    }
+    int idx = 0;
+    for (int l = top; l >= 0; l--) {
+        idx = (idx << 6) + __builtin_ctzll(s->words[l][idx]);
+    }
+    return idx;
+}
+
+// --------------------- Kolumny stolików i skan wektorowy ---------------------
+
+static uint8_t* allocColumn(int blocks) {
+    uint8_t* col = (uint8_t*)aligned_alloc(64, (size_t)blocks * 64);
+    if (col == NULL) {
+        perror("[seating.c] Błąd aligned_alloc() kolumn stolików");
+        exit(1);
+    }
+    memset(col, 0, (size_t)blocks * 64);
+    return col;
+}
+
+static void initColumns(TableColumns* c, const DiningTable* t, int count) {
+    c->blocks    = (count > 0) ? (count + 63) / 64 : 1;
+    c->capacity  = allocColumn(c->blocks);
+    c->groupSize = allocColumn(c->blocks);
+    c->freeSeats = allocColumn(c->blocks);   // dopełnienie: 0 wolnych - nigdy nie pasuje
+    c->open      = (uint64_t*)calloc(c->blocks, sizeof(uint64_t));
+    if (c->open == NULL) {
+        perror("[seating.c] Błąd calloc() kolumn stolików");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        c->capacity[i] = (uint8_t)t[i].capacity;
+    }
+}
+
+static void freeColumns(TableColumns* c) {
+    free(c->capacity);
+    free(c->groupSize);
+    free(c->freeSeats);
+    free(c->open);
+    memset(c, 0, sizeof(*c));
+}
+
+static void updateColumns(TableColumns* c, const DiningTable* t, int idx, int isOpen) {
+    c->groupSize[idx] = (uint8_t)t->group_size;
+    c->freeSeats[idx] = (uint8_t)(c->capacity[idx] - t->total_seated);
+    if (isOpen) {
+        c->open[idx >> 6] |= 1ULL << (idx & 63);
+    } else {
+        c->open[idx >> 6] &= ~(1ULL << (idx & 63));
+    }
+}
+
+/**
+ * Skan kolumn: pierwszy stolik z (group_size == 0 || group_size == k) && wolne >= k.
+ * Bloki 64 stolików bez żadnego otwartego stolika są pomijane po mapie bitowej,
+ * w pozostałych warunek liczy się dla całego bloku naraz (maska 64 bitów).
+ */
+
+static int scanScalar(const TableColumns* c, int k) {
+    for (int b = 0; b < c->blocks; b++) {
+        if (c->open[b] == 0) {
+            continue;
+        }
+        const uint8_t* gs = &c->groupSize[b * 64];
+        const uint8_t* fr = &c->freeSeats[b * 64];
+        for (int i = 0; i < 64; i++) {
+            if ((gs[i] == 0 || gs[i] == k) && fr[i] >= k) {
+                return b * 64 + i;
+            }
+        }
+    }
+    return NO_TABLE_FOUND;
+}
+
+#ifdef SEAT_X86
+static int scanSse2(const TableColumns* c, int k) {
+    const __m128i kv   = _mm_set1_epi8((char)k);
+    const __m128i zero = _mm_setzero_si128();
+    for (int b = 0; b < c->blocks; b++) {
+        if (c->open[b] == 0) {
+            continue;
+        }
+        uint64_t mask = 0;
+        for (int j = 0; j < 4; j++) {
+            __m128i gs  = _mm_load_si128((const __m128i*)&c->groupSize[b * 64 + j * 16]);
+            __m128i fr  = _mm_load_si128((const __m128i*)&c->freeSeats[b * 64 + j * 16]);
+            __m128i ok  = _mm_or_si128(_mm_cmpeq_epi8(gs, zero), _mm_cmpeq_epi8(gs, kv));
+            __m128i fit = _mm_cmpeq_epi8(_mm_max_epu8(fr, kv), fr);    // fr >= k (bez znaku)
+            mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_and_si128(ok, fit)) << (j * 16);
+        }
+        if (mask != 0) {
+            return b * 64 + __builtin_ctzll(mask);
+        }
+    }
+    return NO_TABLE_FOUND;
+}
+
+__attribute__((target("avx2")))
+static int scanAvx2(const TableColumns* c, int k) {
+    const __m256i kv   = _mm256_set1_epi8((char)k);
+    const __m256i zero = _mm256_setzero_si256();
+    for (int b = 0; b < c->blocks; b++) {
+        if (c->open[b] == 0) {
+            continue;
+        }
+        uint64_t mask = 0;
+        for (int j = 0; j < 2; j++) {
+            __m256i gs  = _mm256_load_si256((const __m256i*)&c->groupSize[b * 64 + j * 32]);
+            __m256i fr  = _mm256_load_si256((const __m256i*)&c->freeSeats[b * 64 + j * 32]);
+            __m256i ok  = _mm256_or_si256(_mm256_cmpeq_epi8(gs, zero), _mm256_cmpeq_epi8(gs, kv));
+            __m256i fit = _mm256_cmpeq_epi8(_mm256_max_epu8(fr, kv), fr);
+            mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(ok, fit)) << (j * 32);
+        }
+        if (mask != 0) {
+            return b * 64 + __builtin_ctzll(mask);
+        }
+    }
+    return NO_TABLE_FOUND;
+}
+
+static int hasAvx2(void) {
+    static int cached = -1;
+    if (cached == -1) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return cached;
+}
+#endif
+
+/**
+ * Najniższy indeks stolika dla grupy groupSize według kolumn.
+ * @param search SEAT_SEARCH_SIMD (AVX2, gdy procesor ma, inaczej SSE2) lub SEAT_SEARCH_SCALAR.
+ * @return Indeks stolika lub NO_TABLE_FOUND.
+ */
+
+int scanTableColumns(const TableColumns* c, int groupSize, int search) {
+    if (groupSize < 1 || groupSize > MAX_GROUP_SIZE) {
+        return NO_TABLE_FOUND;
+    }
+#ifdef SEAT_X86
+    if (search == SEAT_SEARCH_SIMD) {
+        return hasAvx2() ? scanAvx2(c, groupSize) : scanSse2(c, groupSize);
+    }
+#endif
+    (void)search;
+    return scanScalar(c, groupSize);
+}
+
+const char* seatSearchKernel(int search) {
+    if (search == SEAT_SEARCH_INDEX) {
+        return "kubełki";
+    }
+#ifdef SEAT_X86
+    if (search == SEAT_SEARCH_SIMD) {
+        return hasAvx2() ? "avx2" : "sse2";
+    }
+#endif
+    return "skalarny";
+}
+
+static int seatSearchFromEnv(int count) {
+    const char* s = getenv("PIZZERIA_SEAT_SEARCH");
+    if (s != NULL && strcasecmp(s, "index") == 0) {
+        return SEAT_SEARCH_INDEX;
+    }
+    if (s != NULL && strcasecmp(s, "simd") == 0) {
+        return SEAT_SEARCH_SIMD;
+    }
+    if (s != NULL && strcasecmp(s, "scalar") == 0) {
+        return SEAT_SEARCH_SCALAR;
+    }
+    return (count <= SEAT_SCAN_MAX_TABLES) ? SEAT_SEARCH_SIMD : SEAT_SEARCH_INDEX;
+}
+
+// --------------------- Katalog wolnych miejsc ---------------------
+
+static int bucketKey(int groupSize, int freeSeats) {
+    return groupSize * (MAX_TABLE_CAPACITY + 1) + freeSeats;
+}
+
+/**
+ * Wyznacza kubełek stolika na podstawie jego stanu.
+ * @return Numer kubełka lub -1, jeśli nikt nowy nie usiądzie przy stoliku.
+ */
+
+static int bucketForTable(const DiningTable* t) {
+    int freeSeats = t->capacity - t->total_seated;
+    if (freeSeats <= 0 || (t->group_size != 0 && freeSeats < t->group_size)) {
+        return -1;
+    }
+    return bucketKey(t->group_size, freeSeats);
+}
+
+/**
+ * Buduje katalog dla tablicy stolików (stoliki mogą być już zajęte).
+ * @param d Katalog do zainicjowania.
+ * @param t Tablica stolików.
+ * @param count Liczba stolików.
+ */
+
+void initSeatDirectory(SeatDirectory* d, const DiningTable* t, int count) {
+    d->count    = count;
+    d->search   = seatSearchFromEnv(count);
+    d->bucketOf = (int*)malloc(sizeof(int) * (count > 0 ? count : 1));
+    if (d->bucketOf == NULL) {
+        perror("[seating.c] Błąd malloc() katalogu stolików");
+        exit(1);
+    }
+    for (int b = 0; b < SEAT_BUCKET_COUNT; b++) {
+        initIndexSet(&d->buckets[b], count);
+    }
+    initColumns(&d->cols, t, count);
+    for (int i = 0; i < count; i++) {
+        d->bucketOf[i] = bucketForTable(&t[i]);
+        if (d->bucketOf[i] != -1) {
+            setIndex(&d->buckets[d->bucketOf[i]], i);
+        }
+        updateColumns(&d->cols, &t[i], i, d->bucketOf[i] != -1);
+    }
+}
+
+void freeSeatDirectory(SeatDirectory* d) {
+    for (int b = 0; b < SEAT_BUCKET_COUNT; b++) {
+        freeIndexSet(&d->buckets[b]);
+    }
+    freeColumns(&d->cols);
+    free(d->bucketOf);
+    d->bucketOf = NULL;
+    d->count    = 0;
+}
+
+/**
+ * Przenosi stolik idx do kubełka odpowiadającego jego obecnemu stanowi.
+ * Trzeba wywołać po każdej zmianie group_size / total_seated stolika.
+ */
+
+void updateSeatDirectory(SeatDirectory* d, const DiningTable* t, int idx) {
+    int newBucket = bucketForTable(&t[idx]);
+    int oldBucket = d->bucketOf[idx];
+    updateColumns(&d->cols, &t[idx], idx, newBucket != -1);
+    if (newBucket == oldBucket) {
+        return;
+    }
+    if (oldBucket != -1) {
+        clearIndex(&d->buckets[oldBucket], idx);
+    }
+    if (newBucket != -1) {
+        setIndex(&d->buckets[newBucket], idx);
+    }
+    d->bucketOf[idx] = newBucket;
+}
+
+/**
+ * Zwraca najniższy indeks stolika, przy którym zmieści się grupa:
+ * pusty stolik o pojemności >= groupSize lub stolik z group_size == groupSize
+ * i co najmniej groupSize wolnymi miejscami (ta sama reguła co pełny skan).
+ *
+ * @param d Katalog stolików.
+ * @param groupSize Wielkość grupy.
+ * @return Indeks stolika lub NO_TABLE_FOUND.
+ */
+
+int findTableForGroup(const SeatDirectory* d, int groupSize) {
+    if (d->search != SEAT_SEARCH_INDEX) {
+        return scanTableColumns(&d->cols, groupSize, d->search);
+    }
+    int best = NO_TABLE_FOUND;
+    if (groupSize < 1 || groupSize > MAX_GROUP_SIZE) {
+        return NO_TABLE_FOUND;
+    }
+    for (int f = groupSize; f <= MAX_TABLE_CAPACITY; f++) {
+        int empty  = firstIndex(&d->buckets[bucketKey(0, f)]);
+        int shared = firstIndex(&d->buckets[bucketKey(groupSize, f)]);
+        if (empty != -1 && (best == NO_TABLE_FOUND || empty < best)) {
+            best = empty;
+        }
+        if (shared != -1 && (best == NO_TABLE_FOUND || shared < best)) {
+            best = shared;
+        }
+    }
+    return best;
+}
+
+/**
+ * Sadza grupę przy stoliku idx (group_size, total_seated, occupant_pids)
+ * pod blokadą tego stolika i aktualizuje katalog. Nie wysyła żadnych komunikatów.
+ */
+
+void occupyTable(DiningTable* t, SeatDirectory* d, int idx, const GroupOfClients* g) {
+    tableLock(&t[idx]);
+    if (t[idx].total_seated == 0) {
+        t[idx].group_size = g->size;
+    }
+    t[idx].total_seated += g->size;
+
+    int slot = 0;
+    while (slot < TABLE_SLOTS && t[idx].occupant_pids[slot] != 0) {
+        slot++;
+    }
+    t[idx].occupant_pids[slot] = g->groupPID;
+    tableUnlock(&t[idx]);
+    updateSeatDirectory(d, t, idx);
+}
+
+/**
+ * Usuwa grupę gPID ze stolika idx (pod blokadą stolika) i aktualizuje katalog.
+ * Grupy, której już nie ma przy stoliku (stoliki wyczyścił strażak), nie odejmuje.
+ */
+
+void vacateTable(DiningTable* t, SeatDirectory* d, int idx, pid_t gPID, int size) {
+    tableLock(&t[idx]);
+    for (int j = 0; j < TABLE_SLOTS; j++) {
+        if (t[idx].occupant_pids[j] == gPID) {
+            t[idx].occupant_pids[j] = 0;
+            t[idx].total_seated -= size;
+            break;
+        }
+    }
+    if (t[idx].total_seated == 0) {
+        t[idx].group_size = 0;
+    }
+    tableUnlock(&t[idx]);
+    updateSeatDirectory(d, t, idx);
+}
+
+// --------------------- Polityki sadzania ---------------------
+
+static int firstFitTable(const SeatDirectory* d, int groupSize) {
+    return findTableForGroup(d, groupSize);
+}
+
+// Najniższy indeks w kubełku (groupSize, f) albo NO_TABLE_FOUND
+static int firstInBucket(const SeatDirectory* d, int groupSize, int freeSeats) {
+    int idx = firstIndex(&d->buckets[bucketKey(groupSize, freeSeats)]);
+    return (idx == -1) ? NO_TABLE_FOUND : idx;
+}
+
+static int validGroup(int groupSize) {
+    return groupSize >= 1 && groupSize <= MAX_GROUP_SIZE;
+}
+
+static int bestFitTable(const SeatDirectory* d, int groupSize) {
+    if (!validGroup(groupSize)) {
+        return NO_TABLE_FOUND;
+    }
+    for (int f = groupSize; f <= MAX_TABLE_CAPACITY; f++) {
+        int empty  = firstInBucket(d, 0, f);
+        int shared = firstInBucket(d, groupSize, f);
+        if (empty != NO_TABLE_FOUND && (shared == NO_TABLE_FOUND || empty < shared)) {
+            return empty;
+        }
+        if (shared != NO_TABLE_FOUND) {
+            return shared;
+        }
+    }
+    return NO_TABLE_FOUND;
+}
+
+// Dosiadka do grupy tej samej wielkości przy stoliku z najmniejszą liczbą wolnych miejsc
+static int sharedTable(const SeatDirectory* d, int groupSize) {
+    for (int f = groupSize; f <= MAX_TABLE_CAPACITY; f++) {
+        int idx = firstInBucket(d, groupSize, f);
+        if (idx != NO_TABLE_FOUND) {
+            return idx;
+        }
+    }
+    return NO_TABLE_FOUND;
+}
+
+static int sizeMatchTable(const SeatDirectory* d, int groupSize) {
+    if (!validGroup(groupSize)) {
+        return NO_TABLE_FOUND;
+    }
+    int idx = sharedTable(d, groupSize);
+    for (int f = groupSize; idx == NO_TABLE_FOUND && f <= MAX_TABLE_CAPACITY; f++) {
+        idx = firstInBucket(d, 0, f);
+    }
+    return idx;
+}
+
+static int lookaheadTable(const SeatDirectory* d, int groupSize) {
+    if (!validGroup(groupSize)) {
+        return NO_TABLE_FOUND;
+    }
+    int idx = sharedTable(d, groupSize);
+    // Najpierw stoliki, które kolejne grupy tej wielkości zapełnią bez reszty
+    for (int pass = 0; pass < 2 && idx == NO_TABLE_FOUND; pass++) {
+        for (int f = groupSize; idx == NO_TABLE_FOUND && f <= MAX_TABLE_CAPACITY; f++) {
+            if ((f % groupSize == 0) == (pass == 0)) {
+                idx = firstInBucket(d, 0, f);
+            }
+        }
+    }
+    return idx;
+}
+
+static int firstFitGroup(ClientsQueue* q, int groupSize, int freeSeats, GroupOfClients* out) {
+    return dequeueSuitable(q, groupSize, freeSeats, out);
+}
+
+static int bestFitGroup(ClientsQueue* q, int groupSize, int freeSeats, GroupOfClients* out) {
+    if (groupSize != 0) {
+        return dequeueSuitable(q, groupSize, freeSeats, out);
+    }
+    for (int s = (freeSeats < MAX_GROUP_SIZE) ? freeSeats : MAX_GROUP_SIZE; s >= 1; s--) {
+        if (q->sizeHead[s] != NULL) {
+            return dequeueSuitable(q, s, s, out);
+        }
+    }
+    return 0;
+}
+
+static int sizeMatchGroup(ClientsQueue* q, int groupSize, int freeSeats, GroupOfClients* out) {
+    if (groupSize == 0 && freeSeats <= MAX_GROUP_SIZE && q->sizeHead[freeSeats] != NULL) {
+        return dequeueSuitable(q, freeSeats, freeSeats, out);
+    }
+    return dequeueSuitable(q, groupSize, freeSeats, out);
+}
+
+/**
+ * Pusty stolik: dla każdej wielkości s liczy, ile miejsc zajmą czekające grupy
+ * s-osobowe (najwyżej freeSeats / s grup), i sadza najstarszą grupę wielkości
+ * z największym wynikiem (przy remisie - tę, której pierwsza grupa czeka dłużej).
+ */
+
+static int lookaheadGroup(ClientsQueue* q, int groupSize, int freeSeats, GroupOfClients* out) {
+    if (groupSize != 0) {
+        return dequeueSuitable(q, groupSize, freeSeats, out);
+    }
+    int best = 0, bestFilled = 0;
+    int maxSize = (freeSeats < MAX_GROUP_SIZE) ? freeSeats : MAX_GROUP_SIZE;
+    for (int s = 1; s <= maxSize; s++) {
+        int groups = 0;
+        for (const QueueNode* n = q->sizeHead[s]; n != NULL && groups < freeSeats / s; n = n->nextSame) {
+            groups++;
+        }
+        int filled = groups * s;
+        if (filled > bestFilled || (filled == bestFilled && filled > 0 && q->sizeHead[s]->seq < q->sizeHead[best]->seq)) {
+            best       = s;
+            bestFilled = filled;
+        }
+    }
+    return best ? dequeueSuitable(q, best, best, out) : 0;
+}
+
+const SeatPolicy seatPolicies[SEAT_POLICIES] = {
+    { SEAT_POLICY_FIRST_FIT,  "first",     firstFitTable,  firstFitGroup  },
+    { SEAT_POLICY_BEST_FIT,   "best",      bestFitTable,   bestFitGroup   },
+    { SEAT_POLICY_SIZE_MATCH, "match",     sizeMatchTable, sizeMatchGroup },
+    { SEAT_POLICY_LOOKAHEAD,  "lookahead", lookaheadTable, lookaheadGroup },
+};
+
+/**
+ * Polityka o podanej nazwie (first, best, match, lookahead).
+ * @return Polityka lub NULL (nieznana nazwa).
+ */
+
+const SeatPolicy* seatPolicyByName(const char* name) {
+    for (int p = 0; p < SEAT_POLICIES; p++) {
+        if (strcasecmp(name, seatPolicies[p].name) == 0) {
+            return &seatPolicies[p];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Polityka z PIZZERIA_SEATING; brak zmiennej lub nieznana nazwa - first.
+ */
+
+const SeatPolicy* seatPolicyFromEnv(void) {
+    const char* s = getenv("PIZZERIA_SEATING");
+    const SeatPolicy* p = (s != NULL && *s != '\0') ? seatPolicyByName(s) : NULL;
+    if (s != NULL && *s != '\0' && p == NULL) {
+        fprintf(stderr, "[seating.c] Nieznana polityka sadzania: %s (first, best, match, lookahead)\n", s);
+    }
+    return p ? p : &seatPolicies[SEAT_POLICY_FIRST_FIT];
+}
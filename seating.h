@@ -0,0 +1,101 @@
+#ifndef SEATING_H
+#define SEATING_H
+
+#include "pizzeria.h"
+#include <stdint.h>
+
+// --------------------- Katalog wolnych miejsc ---------------------
+//
+// Każdy stolik należy do dokładnie jednego kubełka (group_size, wolne miejsca).
+// Pusty stolik ma group_size = 0 i wolne = capacity, więc kubełki (0, f)
+// odpowiadają pojemności stolika. Stoliki pełne (lub takie, w których nie
+// zmieści się już grupa o danym group_size) nie należą do żadnego kubełka.
+// Kubełek to hierarchiczna mapa bitowa (64-arne drzewo słów), więc wstawienie,
+// usunięcie i znalezienie najniższego indeksu kosztują O(log64 n).
+//
+// Obok kubełków katalog trzyma kolumny stolików (struct-of-arrays): gęste tablice
+// bajtów capacity / group_size / wolne miejsca i mapę bitową stolików, przy których
+// ktoś jeszcze usiądzie. Po nich idzie wyszukiwanie wektorowe (AVX2 / SSE2, z wersją
+// skalarną): 64 stoliki naraz, bez dotykania occupant_pids ze wspólnej tablicy.
+// PIZZERIA_SEAT_SEARCH=auto|index|simd|scalar wybiera sposób szukania; wszystkie
+// zwracają ten sam, najniższy pasujący indeks. auto (domyślnie) skanuje kolumny na
+// małych salach, a na większych korzysta z kubełków, których koszt nie rośnie
+// z liczbą stolików (bench_seating_app, druga tabela).
+
+#define SEAT_INDEX_MAX_LEVELS 4  // 64^4 = 16M stolików
+#define SEAT_BUCKET_COUNT     ((MAX_GROUP_SIZE + 1) * (MAX_TABLE_CAPACITY + 1))
+
+#define SEAT_SEARCH_INDEX     0  // kubełki (hierarchiczne mapy bitowe)
+#define SEAT_SEARCH_SIMD      1  // skan kolumn, najszerszy dostępny wariant wektorowy
+#define SEAT_SEARCH_SCALAR    2  // skan kolumn, wersja skalarna
+#define SEAT_SCAN_MAX_TABLES  512  // auto: do tylu stolików skan kolumn
+
+typedef struct {
+    int       levels;
+    uint64_t* words[SEAT_INDEX_MAX_LEVELS]; // words[0] - bity stolików, wyżej - podsumowania
+} TableIndexSet;
+
+typedef struct {
+    int       blocks;       // bloki po 64 stoliki (kolumny dopełnione zerami)
+    uint8_t*  capacity;
+    uint8_t*  groupSize;
+    uint8_t*  freeSeats;
+    uint64_t* open;         // bit = stolik należy do jakiegoś kubełka
+} TableColumns;
+
+typedef struct {
+    int           count;                      // liczba stolików
+    int           search;                     // SEAT_SEARCH_*
+    int*          bucketOf;                   // aktualny kubełek stolika (-1 = żaden)
+    TableIndexSet buckets[SEAT_BUCKET_COUNT];
+    TableColumns  cols;
+} SeatDirectory;
+
+void initSeatDirectory(SeatDirectory* d, const DiningTable* t, int count);
+void freeSeatDirectory(SeatDirectory* d);
+void updateSeatDirectory(SeatDirectory* d, const DiningTable* t, int idx);
+int  findTableForGroup(const SeatDirectory* d, int groupSize);
+int  scanTableColumns(const TableColumns* c, int groupSize, int search);
+const char* seatSearchKernel(int search);
+
+// Operacje na stoliku utrzymujące katalog w zgodzie z tablicą stolików
+void occupyTable(DiningTable* t, SeatDirectory* d, int idx, const GroupOfClients* g);
+void vacateTable(DiningTable* t, SeatDirectory* d, int idx, pid_t gPID, int size);
+
+// --------------------- Polityki sadzania ---------------------
+//
+// Polityka decyduje, który stolik dostaje nowa grupa (pickTable) i którą grupę
+// z kolejki sadzamy przy zwolnionym stoliku (pickGroup). Każda sadza, gdy tylko
+// cokolwiek pasuje, więc niezmiennik sali (po obsłużeniu zdarzenia żadna grupa
+// z kolejki nie pasuje do żadnego stolika) zostaje zachowany. Wybór:
+// PIZZERIA_SEATING=first|best|match|lookahead (domyślnie first - jak dotąd).
+//
+//   first     - najniższy pasujący indeks, najdłużej czekająca pasująca grupa;
+//   best      - stolik z najmniejszą liczbą wolnych miejsc, która wystarczy;
+//               przy zwolnionym stoliku - największa grupa, która się zmieści;
+//   match     - najpierw dosiadka do grupy tej samej wielkości, potem najmniejszy
+//               pusty stolik; przy zwolnionym - grupa zajmująca dokładnie wolne miejsca;
+//   lookahead - jak match, ale pusty stolik o pojemności będącej wielokrotnością
+//               grupy ma pierwszeństwo (dosiądą się następne takie same); przy
+//               zwolnionym stoliku przegląda całą kolejkę i wybiera wielkość grupy,
+//               która razem z czekającymi tej samej wielkości zajmie najwięcej miejsc.
+
+#define SEAT_POLICY_FIRST_FIT   0
+#define SEAT_POLICY_BEST_FIT    1
+#define SEAT_POLICY_SIZE_MATCH  2
+#define SEAT_POLICY_LOOKAHEAD   3
+#define SEAT_POLICIES           4
+
+typedef struct {
+    int         id;             // SEAT_POLICY_* (zapisywany w dzienniku)
+    const char* name;
+    int         (*pickTable)(const SeatDirectory* d, int groupSize);
+    int         (*pickGroup)(ClientsQueue* q, int groupSize, int freeSeats, GroupOfClients* out);
+} SeatPolicy;
+
+extern const SeatPolicy seatPolicies[SEAT_POLICIES];
+
+const SeatPolicy* seatPolicyByName(const char* name);
+const SeatPolicy* seatPolicyFromEnv(void);
+
+#endif // SEATING_H
@@ -0,0 +1,217 @@
+#include "shard.h"
+#include <string.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * Liczba kasjerów z PIZZERIA_SHARDS (domyślnie 1, najwyżej MAX_SHARDS).
+ */
+
+int shardCountFromEnv(void) {
+    const char* s = getenv("PIZZERIA_SHARDS");
+    if (s == NULL) {
+        return 1;
+    }
+    int n = atoi(s);
+    if (n < 1) {
+        return 1;
+    }
+    return (n > MAX_SHARDS) ? MAX_SHARDS : n;
+}
+
+/**
+ * Dzieli stoliki między kasjerów: każdy dostaje równą część stolików każdej
+ * pojemności, a reszty z dzielenia rozdajemy po kolei dalej od miejsca,
+ * w którym skończyła się reszta poprzedniej pojemności (przy 1 1 1 1
+ * i czterech kasjerach każdy dostaje jeden stolik, a nie kasjer 0 wszystkie).
+ * Stoliki kasjera s leżą w tablicy jednym blokiem od indeksu *base,
+ * wewnątrz bloku - kolejno od 1- do MAX_TABLE_CAPACITY-osobowych (jak przy jednym kasjerze).
+ *
+ * @param perCapacity Liczba stolików każdej pojemności w całym lokalu.
+ * @param shards Liczba kasjerów.
+ * @param s Numer kasjera.
+ * @param out Liczba stolików każdej pojemności kasjera s.
+ * @param base Indeks pierwszego stolika kasjera s.
+ */
+
+void shardSplit(const int perCapacity[MAX_TABLE_CAPACITY], int shards, int s,
+                int out[MAX_TABLE_CAPACITY], int* base) {
+    *base = 0;
+    for (int i = 0; i <= s; i++) {
+        int offset = 0;  // od którego kasjera zaczyna się reszta tej pojemności
+        for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+            int rest  = perCapacity[c] % shards;
+            int share = perCapacity[c] / shards + (((i - offset + shards) % shards) < rest ? 1 : 0);
+            offset = (offset + rest) % shards;
+            if (i < s) {
+                *base += share;
+            } else {
+                out[c] = share;
+            }
+        }
+    }
+}
+
+static key_t directoryKey(void) {
+    key_t key = ftok(".", SHARD_GEN_CHAR);
+    if (key == -1) {
+        perror("[shard.c] Błąd ftok()");
+        exit(1);
+    }
+    return key;
+}
+
+/**
+ * Kasjer prowadzący: tworzy katalog kasjerów z podziałem stolików.
+ * leadPid jest wpisywany na końcu - manager czeka właśnie na niego,
+ * więc pozostałość po przerwanym dniu nie zostanie wzięta za nowy katalog.
+ *
+ * @param shmId Id segmentu (do usunięcia na koniec dnia).
+ */
+
+ShardDirectory* shardCreateDirectory(const int perCapacity[MAX_TABLE_CAPACITY], int shards, int* shmId) {
+    *shmId = createSharedMemory(directoryKey(), sizeof(ShardDirectory));
+    ShardDirectory* d = (ShardDirectory*)shmat(*shmId, NULL, 0);
+    if (d == (void*)-1) {
+        perror(CLR_CASHIER "[shard.c] Błąd shmat() katalogu kasjerów" CLR_RESET);
+        exit(1);
+    }
+    memset(d, 0, sizeof(*d));
+    d->shards = shards;
+    for (int s = 0; s < shards; s++) {
+        ShardInfo* info = &d->shard[s];
+        shardSplit(perCapacity, shards, s, info->perCapacity, &info->base);
+        for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+            info->count += info->perCapacity[c];
+            info->seats += info->perCapacity[c] * (c + 1);
+        }
+        d->totalTables += info->count;
+    }
+    atomic_store_explicit(&d->leadPid, getpid(), memory_order_release);
+    return d;
+}
+
+/**
+ * Dołącza do istniejącego katalogu kasjerów.
+ * @return Katalog lub NULL (errno: ENOENT - jeszcze / już go nie ma).
+ */
+
+ShardDirectory* shardAttachDirectory(int* shmId) {
+    int id = shmget(directoryKey(), 0, 0);
+    if (id == -1) {
+        return NULL;
+    }
+    ShardDirectory* d = (ShardDirectory*)shmat(id, NULL, 0);
+    if (d == (void*)-1) {
+        return NULL;
+    }
+    if (shmId != NULL) {
+        *shmId = id;
+    }
+    return d;
+}
+
+void shardDetachDirectory(ShardDirectory* d) {
+    if (shmdt(d) == -1) {
+        perror("[shard.c] Błąd shmdt() katalogu kasjerów");
+    }
+}
+
+/**
+ * Kasjer zgłasza gotowość w katalogu i budzi czekającego na nią prowadzącego.
+ * Słowo ready leży w shm między procesami - futex bez FUTEX_PRIVATE_FLAG.
+ */
+
+void shardMarkReady(ShardInfo* info) {
+    atomic_store_explicit(&info->ready, 1, memory_order_release);
+    syscall(SYS_futex, &info->ready, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * Prowadzący: śpi (futex), aż kasjer s zgłosi gotowość.
+ */
+
+void shardAwaitReady(ShardDirectory* d, int s) {
+    ShardInfo* info = &d->shard[s];
+    while (!atomic_load_explicit(&info->ready, memory_order_acquire)) {
+        syscall(SYS_futex, &info->ready, FUTEX_WAIT, 0, NULL, NULL, 0);
+    }
+}
+
+/**
+ * Kasjer, do którego należy stolik o globalnym indeksie tableIdx (-1 - żaden).
+ */
+
+int shardOwner(const ShardDirectory* d, int tableIdx) {
+    for (int s = 0; s < d->shards; s++) {
+        if (tableIdx >= d->shard[s].base && tableIdx < d->shard[s].base + d->shard[s].count) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Obciążenie kasjera: zajęte miejsca (ułamek w jednostkach SHARD_LOAD_SCALE)
+ * plus pełna jednostka za każdą grupę w kolejce.
+ */
+
+int shardLoad(const ShardInfo* info) {
+    int seated = atomic_load_explicit(&info->seated, memory_order_relaxed);
+    int queued = atomic_load_explicit(&info->queued, memory_order_relaxed);
+    int load   = queued * SHARD_LOAD_SCALE;
+    if (info->seats > 0) {
+        load += (int)((long)seated * SHARD_LOAD_SCALE / info->seats);
+    }
+    return load;
+}
+
+/**
+ * Router przybyć: wybiera kasjera, który ma teraz stolik dla grupy tej
+ * wielkości, a spośród nich najmniej obciążonego. Gdy nikt nie ma miejsca -
+ * najmniej obciążonego w ogóle (najkrótsza kolejka). Przeglądanie zaczyna się
+ * od salt % shards, więc remisy rozkładają się po kasjerach.
+ *
+ * @param d Katalog kasjerów.
+ * @param groupSize Wielkość grupy.
+ * @param salt Dowolna liczba różna dla grup (np. PID).
+ * @return Numer kasjera.
+ */
+
+int shardRoute(const ShardDirectory* d, int groupSize, unsigned int salt) {
+    int best = 0, bestFits = 0, bestLoad = INT_MAX;
+    for (int i = 0; i < d->shards; i++) {
+        int s = (int)((salt + (unsigned int)i) % (unsigned int)d->shards);
+        const ShardInfo* info = &d->shard[s];
+        if (info->count == 0) {
+            continue;
+        }
+        unsigned int mask = atomic_load_explicit(&info->fitMask, memory_order_relaxed);
+        int fits = (mask >> groupSize) & 1u;
+        int load = shardLoad(info);
+        if (fits > bestFits || (fits == bestFits && load < bestLoad)) {
+            best     = s;
+            bestFits = fits;
+            bestLoad = load;
+        }
+    }
+    return best;
+}
+
+/**
+ * Klient: numer kasjera, do którego ma się zgłosić grupa (0 przy jednym kasjerze).
+ */
+
+int shardForClient(int groupSize, pid_t pid) {
+    if (shardCountFromEnv() <= 1) {
+        return 0;
+    }
+    ShardDirectory* d = shardAttachDirectory(NULL);
+    if (d == NULL) {
+        return 0;
+    }
+    int s = shardRoute(d, groupSize, (unsigned int)pid);
+    shardDetachDirectory(d);
+    return s;
+}
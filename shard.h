@@ -0,0 +1,65 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "pizzeria.h"
+#include "stats.h"
+
+// --------------------- Kilku kasjerów (shardy) ---------------------
+//
+// Przy PIZZERIA_SHARDS = N > 1 manager uruchamia N kasjerów. Kasjer s obsługuje
+// ciągły zakres tablicy stolików w shm (po części stolików każdej pojemności),
+// ma własną kolejkę oczekujących i własny transport. Wspólny stan leży
+// w katalogu w pamięci współdzielonej (ftok 'D'): zakresy stolików, bieżące
+// obciążenie i wolne miejsca każdego kasjera oraz jego statystyki z końca dnia.
+// Klient wybiera kasjera przez shardRoute(), a kasjerzy przekazują sobie grupy
+// i wyjścia (cashier_shard.c). Katalog tworzy i usuwa kasjer prowadzący (shard 0).
+
+#define SHARD_GEN_CHAR      'D'
+#define MAX_SHARDS          16
+#define SHARD_LOAD_SCALE    1024
+
+typedef struct {
+    _Alignas(64) atomic_int pid;
+    atomic_int   ready;                         // kasjer przygotował swoje stoliki i transport
+    int          base;                          // pierwszy stolik kasjera
+    int          count;
+    int          seats;
+    int          perCapacity[MAX_TABLE_CAPACITY];
+    atomic_uint  fitMask;                       // bit g: jest stolik dla grupy g-osobowej
+    atomic_int   seated;                        // osoby przy stolikach
+    atomic_int   queued;                        // grupy w kolejce
+
+    // Statystyki dnia, wpisywane raz na koniec (potem done = 1)
+    atomic_int   done;
+    int          soldItems[MENU_SIZE];
+    double       totalRevenue;
+    int          totalClients;
+    long         handedOff;                     // grupy oddane innym kasjerom
+    long         forwardedLeaves;               // wyjścia przekazane właścicielom stolików
+    ShiftSummary stats;                         // analityka zmiany do raportu dziennego
+} ShardInfo;
+
+typedef struct {
+    atomic_int   leadPid;                       // ustawiany na końcu - katalog gotowy
+    int          shards;
+    int          totalTables;
+    ShardInfo    shard[MAX_SHARDS];
+} ShardDirectory;
+
+int  shardCountFromEnv(void);
+void shardSplit(const int perCapacity[MAX_TABLE_CAPACITY], int shards, int s,
+                int out[MAX_TABLE_CAPACITY], int* base);
+
+ShardDirectory* shardCreateDirectory(const int perCapacity[MAX_TABLE_CAPACITY], int shards, int* shmId);
+ShardDirectory* shardAttachDirectory(int* shmId);
+void shardDetachDirectory(ShardDirectory* d);
+
+void shardMarkReady(ShardInfo* info);
+void shardAwaitReady(ShardDirectory* d, int s);
+
+int  shardOwner(const ShardDirectory* d, int tableIdx);
+int  shardLoad(const ShardInfo* info);
+int  shardRoute(const ShardDirectory* d, int groupSize, unsigned int salt);
+int  shardForClient(int groupSize, pid_t pid);
+
+#endif // SHARD_H
@@ -0,0 +1,431 @@
+#include "stats.h"
+#include "metrics.h"
+#include <string.h>
+
+/**
+ * Przygotowuje statystyki zmiany dla sali o podanym układzie stolików
+ * (kolejno od 1- do MAX_TABLE_CAPACITY-osobowych, jak w initRestaurant).
+ *
+ * @param s Statystyki.
+ * @param perCapacity Liczba stolików każdej pojemności.
+ * @param queueLimit Limit kolejki - tyle grup naraz może czekać na pomiar czasu.
+ * @param shard Numer kasjera.
+ * @param tableBase Globalny numer pierwszego stolika tego kasjera.
+ * @return 0 lub -1 (brak pamięci).
+ */
+
+int statsInit(ShiftStats* s, const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit,
+              int shard, int tableBase) {
+    memset(s, 0, sizeof(*s));
+    ShiftSummary* sum = &s->summary;
+    sum->shard     = shard;
+    sum->tableBase = tableBase;
+    sum->slotNs    = STATS_SLOT_NS;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        sum->perCapacity[c] = perCapacity[c];
+        sum->tables += perCapacity[c];
+        sum->seats  += perCapacity[c] * (c + 1);
+    }
+    for (int i = 0; i <= MAX_GROUP_SIZE; i++) {
+        histInit(&sum->wait[i]);
+    }
+
+    int n = sum->tables;
+    s->pendingCap    = (queueLimit > 0) ? queueLimit : 1;
+    s->tableSeated   = calloc(n ? n : 1, sizeof(int));
+    s->tableCapacity = calloc(n ? n : 1, sizeof(int));
+    s->tableLastNs   = calloc(n ? n : 1, sizeof(long long));
+    s->tableSeatNs   = calloc(n ? n : 1, sizeof(double));
+    s->pending       = calloc(s->pendingCap, sizeof(StatsPending));
+    if (!s->tableSeated || !s->tableCapacity || !s->tableLastNs || !s->tableSeatNs || !s->pending) {
+        perror("[stats.c] Błąd calloc() statystyk");
+        statsDestroy(s);
+        return -1;
+    }
+
+    s->startNs    = monotonicNs();
+    s->hallLastNs = s->startNs;
+    int idx = 0;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        for (int k = 0; k < perCapacity[c]; k++, idx++) {
+            s->tableCapacity[idx] = c + 1;
+            s->tableLastNs[idx]   = s->startNs;
+        }
+    }
+    return 0;
+}
+
+void statsDestroy(ShiftStats* s) {
+    free(s->tableSeated);
+    free(s->tableCapacity);
+    free(s->tableLastNs);
+    free(s->tableSeatNs);
+    free(s->pending);
+    s->tableSeated   = NULL;
+    s->tableCapacity = NULL;
+    s->tableLastNs   = NULL;
+    s->tableSeatNs   = NULL;
+    s->pending       = NULL;
+}
+
+// Chwila zdarzenia: zegar monotoniczny albo czas wirtualny symulacji
+static inline long long statsNow(const ShiftStats* s) {
+    return s->clockNs ? *s->clockNs : monotonicNs();
+}
+
+/**
+ * Mierzy zmianę w czasie wirtualnym (*clockNs, od tej chwili), a nie monotonicznym.
+ */
+
+void statsUseClock(ShiftStats* s, const long long* clockNs) {
+    s->clockNs    = clockNs;
+    s->startNs    = *clockNs;
+    s->hallLastNs = s->startNs;
+    for (int i = 0; i < s->summary.tables; i++) {
+        s->tableLastNs[i] = s->startNs;
+    }
+}
+
+void statsAttachLive(ShiftStats* s, ShardMetrics* live) {
+    s->live = live;
+}
+
+// Łączy sąsiednie przedziały wykresu w pary - szerokość przedziału rośnie dwukrotnie
+static void foldSlots(ShiftSummary* sum) {
+    for (int i = 0; i < STATS_SLOTS / 2; i++) {
+        sum->slotSeatNs[i] = sum->slotSeatNs[2 * i] + sum->slotSeatNs[2 * i + 1];
+    }
+    for (int i = STATS_SLOTS / 2; i < STATS_SLOTS; i++) {
+        sum->slotSeatNs[i] = 0.0;
+    }
+    sum->slotNs *= 2;
+}
+
+/**
+ * Dolicza okres [s->hallLastNs, now), w którym przy stolikach siedziało
+ * s->hallSeated osób: czas w danym procencie zajętości i osobo-ns w przedziałach wykresu.
+ */
+
+static void advanceHall(ShiftStats* s, long long now) {
+    ShiftSummary* sum = &s->summary;
+    long long from = s->hallLastNs - s->startNs;
+    long long to   = now - s->startNs;
+    s->hallLastNs  = now;
+    if (to <= from) {
+        return;
+    }
+    int pct = sum->seats ? (s->hallSeated * 100 + sum->seats / 2) / sum->seats : 0;
+    if (pct < 0) {
+        pct = 0;
+    } else if (pct > 100) {
+        pct = 100;
+    }
+    sum->occupancyNs[pct] += to - from;
+    if (s->hallSeated <= 0) {
+        return;
+    }
+    while (to > sum->slotNs * STATS_SLOTS) {
+        foldSlots(sum);
+    }
+    while (from < to) {
+        int       slot = (int)(from / sum->slotNs);
+        long long end  = (long long)(slot + 1) * sum->slotNs;
+        if (end > to) {
+            end = to;
+        }
+        sum->slotSeatNs[slot] += (double)s->hallSeated * (end - from);
+        from = end;
+    }
+}
+
+// Zmiana liczby osób przy stoliku tableIdx (i na sali) o delta
+static void seatsChanged(ShiftStats* s, int tableIdx, int delta, long long now) {
+    advanceHall(s, now);
+    s->hallSeated += delta;
+    if (s->hallSeated > s->summary.peakSeated) {
+        s->summary.peakSeated = s->hallSeated;
+    }
+    if (tableIdx < 0 || tableIdx >= s->summary.tables) {
+        return;
+    }
+    if (s->live != NULL) {
+        metricsAddInt(&s->live->occupied[s->tableCapacity[tableIdx] - 1], delta);
+    }
+    s->tableSeatNs[tableIdx] += (double)s->tableSeated[tableIdx] * (now - s->tableLastNs[tableIdx]);
+    s->tableLastNs[tableIdx]  = now;
+    s->tableSeated[tableIdx] += delta;
+    if (s->tableSeated[tableIdx] < 0) {         // stolik wyzerowany przez strażaka
+        s->tableSeated[tableIdx] = 0;
+    }
+}
+
+// Usuwa grupę z listy czekających; zwraca chwilę wejścia do kolejki lub -1
+static long long takePending(ShiftStats* s, pid_t pid) {
+    for (int i = 0; i < s->pendingCount; i++) {
+        if (s->pending[i].pid == pid) {
+            long long since = s->pending[i].sinceNs;
+            s->pending[i] = s->pending[--s->pendingCount];
+            return since;
+        }
+    }
+    return -1;
+}
+
+void statsArrival(ShiftStats* s) {
+    s->summary.arrivals++;
+    if (s->live != NULL) {
+        metricsAdd(&s->live->requests, 1);
+    }
+}
+
+/**
+ * Grupa weszła do kolejki o długości queueDepth (razem z nią).
+ * Gdy lista czekających jest pełna (grupy przekazane między kasjerami),
+ * najstarszy wpis ustępuje nowemu.
+ */
+
+void statsQueued(ShiftStats* s, const GroupOfClients* g, int queueDepth) {
+    s->summary.queued++;
+    if (queueDepth > s->summary.peakQueue) {
+        s->summary.peakQueue = queueDepth;
+    }
+    if (s->live != NULL) {
+        metricsAdd(&s->live->queued, 1);
+        metricsSet(&s->live->queueDepth, queueDepth);
+    }
+    int slot = s->pendingCount;
+    if (slot == s->pendingCap) {
+        slot = 0;
+        for (int i = 1; i < s->pendingCount; i++) {
+            if (s->pending[i].sinceNs < s->pending[slot].sinceNs) {
+                slot = i;
+            }
+        }
+    } else {
+        s->pendingCount++;
+    }
+    s->pending[slot].pid     = g->groupPID;
+    s->pending[slot].sinceNs = statsNow(s);
+}
+
+/**
+ * Grupa usiadła przy stoliku: czas oczekiwania (0 dla usadzonych od razu)
+ * trafia do histogramu jej wielkości i do zbiorczego.
+ */
+
+void statsSeat(ShiftStats* s, const GroupOfClients* g, int tableIdx) {
+    long long now   = statsNow(s);
+    long long since = takePending(s, g->groupPID);
+    uint64_t  waitUs = 0;
+    if (since >= 0) {
+        s->summary.seatedFromQueue++;
+        waitUs = (uint64_t)(now - since) / 1000;
+    } else {
+        s->summary.seatedAtOnce++;
+    }
+    histRecord(&s->summary.wait[0], waitUs);
+    if (g->size >= 1 && g->size <= MAX_GROUP_SIZE) {
+        histRecord(&s->summary.wait[g->size], waitUs);
+    }
+    if (s->live != NULL) {
+        metricsAdd(&s->live->seated, 1);
+        metricsAdd(&s->live->waitUsSum, (long)waitUs);
+    }
+    seatsChanged(s, tableIdx, g->size, now);
+}
+
+void statsLeave(ShiftStats* s, const GroupOfClients* g, int tableIdx) {
+    seatsChanged(s, tableIdx, -g->size, statsNow(s));
+}
+
+/**
+ * Odmowa: reason to STATS_REJECT_*. Grupa odprawiona z kolejki przestaje czekać.
+ */
+
+void statsReject(ShiftStats* s, const GroupOfClients* g, int reason) {
+    if (reason >= 0 && reason < STATS_REJECTS) {
+        s->summary.rejects[reason]++;
+    }
+    if (s->live != NULL) {
+        metricsAdd(&s->live->rejected, 1);
+    }
+    if (reason == STATS_REJECT_DISMISSED) {
+        takePending(s, g->groupPID);
+    }
+}
+
+// Grupa opuściła kolejkę bez stolika u tego kasjera (przekazana innemu)
+void statsForget(ShiftStats* s, pid_t pid) {
+    takePending(s, pid);
+}
+
+// Grupa zrezygnowała z czekania (CANCEL_REQUEST) - jej miejsce w kolejce jest wolne
+void statsCancel(ShiftStats* s, const GroupOfClients* g) {
+    s->summary.cancelled++;
+    takePending(s, g->groupPID);
+}
+
+/**
+ * Proces grupy już nie żyje: tableIdx >= 0 - zwolnione miejsca przy stoliku,
+ * -1 - zwolnione miejsce w kolejce.
+ */
+
+void statsReclaim(ShiftStats* s, const GroupOfClients* g, int tableIdx) {
+    if (tableIdx < 0) {
+        s->summary.reclaimedQueued++;
+        takePending(s, g->groupPID);
+        return;
+    }
+    s->summary.reclaimedGroups++;
+    s->summary.reclaimedSeats += g->size;
+    seatsChanged(s, tableIdx, -g->size, statsNow(s));
+}
+
+/**
+ * Zamyka pomiary na koniec zmiany i przepisuje zajętość stolików do podsumowania.
+ */
+
+void statsFinish(ShiftStats* s) {
+    long long now = statsNow(s);
+    ShiftSummary* sum = &s->summary;
+    advanceHall(s, now);
+    sum->shiftNs = now - s->startNs;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        sum->capacitySeatNs[c] = 0.0;
+    }
+    sum->detailTables = (sum->tables < STATS_TABLE_DETAIL) ? sum->tables : STATS_TABLE_DETAIL;
+    for (int i = 0; i < sum->tables; i++) {
+        s->tableSeatNs[i] += (double)s->tableSeated[i] * (now - s->tableLastNs[i]);
+        s->tableLastNs[i]  = now;
+        sum->capacitySeatNs[s->tableCapacity[i] - 1] += s->tableSeatNs[i];
+        if (i < sum->detailTables) {
+            sum->tableSeatNs[i]   = s->tableSeatNs[i];
+            sum->tableCapacity[i] = s->tableCapacity[i];
+        }
+    }
+}
+
+/**
+ * Dodaje podsumowanie innego kasjera. Liczniki i histogramy sumują się wprost,
+ * wykres zajętości - po wyrównaniu szerokości przedziałów; czas w danym procencie
+ * zajętości jest od tej chwili czasem sumarycznym po kasjerach. Szczegóły stolików
+ * zostają przy kasjerach (ShardInfo), tutaj zostaje tylko ich podział na pojemności.
+ */
+
+void summaryMerge(ShiftSummary* into, const ShiftSummary* from) {
+    into->tables += from->tables;
+    into->seats  += from->seats;
+    for (int c = 0; c < MAX_TABLE_CAPACITY; c++) {
+        into->perCapacity[c]    += from->perCapacity[c];
+        into->capacitySeatNs[c] += from->capacitySeatNs[c];
+    }
+    if (from->shiftNs > into->shiftNs) {
+        into->shiftNs = from->shiftNs;
+    }
+    into->arrivals        += from->arrivals;
+    into->seatedAtOnce    += from->seatedAtOnce;
+    into->queued          += from->queued;
+    into->seatedFromQueue += from->seatedFromQueue;
+    for (int i = 0; i < STATS_REJECTS; i++) {
+        into->rejects[i] += from->rejects[i];
+    }
+    if (from->peakQueue > into->peakQueue) {
+        into->peakQueue = from->peakQueue;
+    }
+    into->peakSeated += from->peakSeated;       // górne oszacowanie - szczyty mogą się nie pokrywać
+    into->cancelled       += from->cancelled;
+    into->reclaimedQueued += from->reclaimedQueued;
+    into->reclaimedGroups += from->reclaimedGroups;
+    into->reclaimedSeats  += from->reclaimedSeats;
+    for (int i = 0; i <= MAX_GROUP_SIZE; i++) {
+        histMerge(&into->wait[i], &from->wait[i]);
+    }
+    for (int p = 0; p < STATS_OCCUPANCY; p++) {
+        into->occupancyNs[p] += from->occupancyNs[p];
+    }
+    while (into->slotNs < from->slotNs) {
+        foldSlots(into);
+    }
+    int ratio = (int)(into->slotNs / from->slotNs);
+    for (int i = 0; i < STATS_SLOTS; i++) {
+        into->slotSeatNs[i / ratio] += from->slotSeatNs[i];
+    }
+    into->detailTables = 0;
+    kitchenSummaryMerge(&into->kitchen, &from->kitchen);
+    admissionSummaryMerge(&into->admission, &from->admission);
+}
+
+/**
+ * Sumuje kuchnie kilku kasjerów (albo kilku dni symulacji): piece, wsady i czasy się dodają,
+ * najdłuższa kolejka i czas pracy to maksimum.
+ */
+
+void kitchenSummaryMerge(KitchenSummary* into, const KitchenSummary* from) {
+    if (from->ovens == 0) {
+        return;
+    }
+    if (into->ovens == 0) {
+        into->ovenLoad = from->ovenLoad;
+        histInit(&into->latency);
+    }
+    into->ovens      += from->ovens;
+    into->queueLimit += from->queueLimit;
+    into->orders     += from->orders;
+    into->pizzas     += from->pizzas;
+    into->loads      += from->loads;
+    into->ovenBusyNs += from->ovenBusyNs;
+    into->ovenTimeNs += from->ovenTimeNs;
+    into->stalls     += from->stalls;
+    into->stallNs    += from->stallNs;
+    if (from->spanNs > into->spanNs) {
+        into->spanNs = from->spanNs;
+    }
+    if (from->peakQueue > into->peakQueue) {
+        into->peakQueue = from->peakQueue;
+    }
+    histMerge(&into->latency, &from->latency);
+}
+
+/**
+ * Sumuje przyjmowanie grup kilku kasjerów (albo dni): liczniki się dodają,
+ * czas przy stoliku to maksimum.
+ */
+
+void admissionSummaryMerge(AdmissionSummary* into, const AdmissionSummary* from) {
+    if (from->sloMs == 0) {
+        return;
+    }
+    into->sloMs       = from->sloMs;
+    into->enforce     = from->enforce;
+    into->admitted   += from->admitted;
+    into->sloRejects += from->sloRejects;
+    into->violations += from->violations;
+    into->estimates  += from->estimates;
+    into->absErrorMs += from->absErrorMs;
+    if (from->holdNs > into->holdNs) {
+        into->holdNs = from->holdNs;
+    }
+}
+
+/**
+ * Zajętość sali (w %), której nie przekraczano przez percentile % czasu zmiany.
+ */
+
+double summaryOccupancyPercentile(const ShiftSummary* s, double percentile) {
+    long long total = 0;
+    for (int p = 0; p < STATS_OCCUPANCY; p++) {
+        total += s->occupancyNs[p];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    long long rank = (long long)(percentile / 100.0 * total);
+    long long seen = 0;
+    for (int p = 0; p < STATS_OCCUPANCY; p++) {
+        seen += s->occupancyNs[p];
+        if (seen > rank) {
+            return p;
+        }
+    }
+    return 100.0;
+}
@@ -0,0 +1,138 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "pizzeria.h"
+#include "histogram.h"
+
+// --------------------- Statystyki zmiany do raportu dziennego ---------------------
+//
+// Kasjer zbiera je w tych samych miejscach co dziennik zdarzeń: czas oczekiwania
+// w kolejce (histogram wg wielkości grupy), odmowy wg powodu, najdłuższą kolejkę,
+// zajętość sali w czasie i zajętość każdego stolika. Wszystkie bufory mają stały
+// rozmiar lub są przydzielane w statsInit() - obsługa zdarzenia niczego nie alokuje.
+//
+// Przy podłączonych metrykach (statsAttachLive) te same zdarzenia trafiają też
+// do segmentu metryk czytanego na bieżąco przez pizzeria_top (metrics.h).
+//
+// ShiftSummary nie ma wskaźników, więc przy kilku kasjerach jest kopiowana do
+// katalogu w pamięci współdzielonej (ShardInfo) i sumowana przez kasjera 0.
+
+#define STATS_SLOTS          120        // przedziały wykresu zajętości w czasie
+#define STATS_SLOT_NS        1000000000LL // początkowa szerokość przedziału (podwajana)
+#define STATS_TABLE_DETAIL   128        // stoliki opisywane osobno w raporcie
+#define STATS_OCCUPANCY      101        // zajętość sali 0..100%
+
+#define STATS_REJECT_NO_TABLE       0   // NO_TABLE_FOUND - kolejka pełna
+#define STATS_REJECT_NEAR_CLOSING   1   // NEAR_CLOSING - nowe grupy przed zamknięciem
+#define STATS_REJECT_DISMISSED      2   // NEAR_CLOSING - grupa odprawiona z kolejki
+#define STATS_REJECT_SLO            3   // NO_TABLE_FOUND - szacowane czekanie ponad SLO (admission.h)
+#define STATS_REJECTS               4
+
+// Kuchnia (kitchen.c) - liczona osobno, wpisywana do podsumowania na koniec zmiany
+typedef struct {
+    int       ovens;                    // 0 - dzień bez kuchni
+    int       ovenLoad;                 // pizz w jednym wsadzie
+    int       queueLimit;               // pizz w kolejce przygotowania
+    long      orders;
+    long      pizzas;                   // upieczone
+    long      loads;                    // wsady pieców
+    long long ovenBusyNs;               // suma czasu pieczenia wszystkich pieców
+    long long ovenTimeNs;               // piece x czas pracy kuchni (mianownik zajętości)
+    long long spanNs;                   // czas pracy kuchni
+    long      stalls;                   // zamówienia, które czekały na miejsce w kolejce
+    long long stallNs;
+    int       peakQueue;                // najdłuższa kolejka przygotowania (pizze)
+    Histogram latency;                  // od zamówienia do PIZZA_READY (us)
+} KitchenSummary;
+
+// Przyjmowanie grup wg szacowanego czekania (admission.c) - jak kuchnia, wpisywane na koniec zmiany
+typedef struct {
+    int       sloMs;                    // 0 - dzień ze stałym limitem kolejki
+    int       enforce;                  // 0 - SLO tylko mierzone
+    long      admitted;                 // usadzone od razu albo przyjęte do kolejki
+    long      sloRejects;               // odmowy, bo szacunek > SLO
+    long      violations;               // przyjęte, a czekały dłużej niż SLO
+    long      estimates;                // szacunki porównane z faktycznym czekaniem
+    long long absErrorMs;               // suma |szacunek - czekanie|
+    long long holdNs;                   // średni czas przy stoliku na koniec zmiany (EWMA)
+} AdmissionSummary;
+
+typedef struct {
+    int       shard;
+    int       tableBase;                // globalny numer pierwszego stolika tego kasjera
+    int       tables;
+    int       seats;
+    int       perCapacity[MAX_TABLE_CAPACITY];
+    long long shiftNs;
+
+    long      arrivals;
+    long      seatedAtOnce;             // usadzone bez czekania
+    long      queued;
+    long      seatedFromQueue;
+    long      rejects[STATS_REJECTS];
+    int       peakQueue;
+    int       peakSeated;
+    long      cancelled;                // grupy, które zrezygnowały z kolejki (CANCEL_REQUEST)
+    long      reclaimedQueued;          // miejsca w kolejce po grupach, których proces już nie żyje
+    long      reclaimedGroups;          // martwe grupy zdjęte ze stolików
+    long      reclaimedSeats;           // zwolnione przez nie miejsca
+
+    Histogram wait[MAX_GROUP_SIZE + 1]; // czas w kolejce (us), [0] - wszystkie grupy
+
+    long long occupancyNs[STATS_OCCUPANCY];       // ile ns sala była zajęta w p%
+    long long slotNs;                             // szerokość przedziału wykresu
+    double    slotSeatNs[STATS_SLOTS];            // osobo-ns w przedziale
+    double    capacitySeatNs[MAX_TABLE_CAPACITY]; // osobo-ns przy stolikach danej pojemności
+    int       detailTables;                       // min(tables, STATS_TABLE_DETAIL)
+    double    tableSeatNs[STATS_TABLE_DETAIL];
+    int       tableCapacity[STATS_TABLE_DETAIL];
+
+    KitchenSummary   kitchen;
+    AdmissionSummary admission;
+} ShiftSummary;
+
+struct ShardMetrics;
+
+typedef struct {
+    pid_t     pid;
+    long long sinceNs;
+} StatsPending;
+
+typedef struct {
+    ShiftSummary summary;
+    long long    startNs;
+    long long    hallLastNs;
+    int          hallSeated;
+    int*         tableSeated;           // osoby przy stoliku od tableLastNs
+    int*         tableCapacity;
+    long long*   tableLastNs;
+    double*      tableSeatNs;
+    StatsPending* pending;              // grupy w kolejce i chwila wejścia do niej
+    int          pendingCap;
+    int          pendingCount;
+    struct ShardMetrics* live;          // NULL - bez metryk bieżących
+    const long long* clockNs;           // NULL - CLOCK_MONOTONIC, inaczej czas wirtualny (des.c)
+} ShiftStats;
+
+int  statsInit(ShiftStats* s, const int perCapacity[MAX_TABLE_CAPACITY], int queueLimit,
+               int shard, int tableBase);
+void statsDestroy(ShiftStats* s);
+void statsUseClock(ShiftStats* s, const long long* clockNs);
+void statsAttachLive(ShiftStats* s, struct ShardMetrics* live);
+
+void statsArrival(ShiftStats* s);
+void statsQueued(ShiftStats* s, const GroupOfClients* g, int queueDepth);
+void statsSeat(ShiftStats* s, const GroupOfClients* g, int tableIdx);
+void statsLeave(ShiftStats* s, const GroupOfClients* g, int tableIdx);
+void statsReject(ShiftStats* s, const GroupOfClients* g, int reason);
+void statsForget(ShiftStats* s, pid_t pid);
+void statsCancel(ShiftStats* s, const GroupOfClients* g);
+void statsReclaim(ShiftStats* s, const GroupOfClients* g, int tableIdx);
+void statsFinish(ShiftStats* s);
+
+void   summaryMerge(ShiftSummary* into, const ShiftSummary* from);
+void   kitchenSummaryMerge(KitchenSummary* into, const KitchenSummary* from);
+void   admissionSummaryMerge(AdmissionSummary* into, const AdmissionSummary* from);
+double summaryOccupancyPercentile(const ShiftSummary* s, double percentile);
+
+#endif // STATS_H
@@ -0,0 +1,519 @@
+#include "transport.h"
+#include <string.h>
+#include <strings.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define REPLY_MAX_PROBE 64
+#define REPLY_RING      8  // odpowiedzi czekające na klienta (GROUP_QUEUED przy każdym kasjerze + stolik), potęga dwójki
+
+// Slot pierścienia zapytań - ten sam schemat co pierścień logów (logger.c):
+// producent rezerwuje pozycję przez CAS na tail i publikuje komunikat przez seq.
+typedef struct {
+    atomic_ulong         seq;
+    CommunicationMessage msg;
+} RequestSlot;
+
+// Slot odpowiedzi klienta: mały pierścień, więc kolejna odpowiedź (np. stolik po GROUP_QUEUED)
+// nie nadpisze tej, której klient jeszcze nie przeczytał. Nadawców może być kilku (kasjerzy-shardy,
+// wątek kuchni) - wpis chroni krótka blokada nadawców; klient czyta bez blokady.
+typedef struct {
+    atomic_int           owner;     // PID klienta, 0 = wolny
+    atomic_int           lock;      // blokada nadawców
+    atomic_uint          written;   // odpowiedzi wpisane (nadawcy)
+    atomic_uint          read;      // odpowiedzi odebrane (klient)
+    atomic_int           wake;      // słowo futexa klienta
+    atomic_int           waiting;   // klient śpi - nadawca musi go obudzić
+    atomic_int           closed;    // kasjer zamknął transport (odpowiednik EIDRM)
+    CommunicationMessage reply[REPLY_RING];
+} ReplySlot;
+
+struct TransportArea {
+    atomic_int                ready;             // segment zainicjowany przez kasjera
+    atomic_int                closed;
+    _Alignas(64) atomic_ulong tail;              // producenci (klienci)
+    _Alignas(64) atomic_ulong head;              // konsument (kasjer)
+    atomic_int                consumerSleeping;
+    atomic_int                consumerWake;      // słowo futexa kasjera
+    _Alignas(64) RequestSlot  ring[TRANSPORT_RING_SLOTS];
+    ReplySlot                 replies[TRANSPORT_REPLY_SLOTS];
+};
+
+// Segment jest dzielony między procesy, więc futex nie może być FUTEX_PRIVATE
+static long futexWait(atomic_int* addr, int expected) {
+    return syscall(SYS_futex, addr, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+static void futexWake(atomic_int* addr, int count) {
+    syscall(SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+int transportKindFromEnv(void) {
+    const char* s = getenv("PIZZERIA_TRANSPORT");
+    if (s != NULL && strcasecmp(s, "shm") == 0) {
+        return TRANSPORT_SHM;
+    }
+    return TRANSPORT_MSG;
+}
+
+static key_t transportKey(int shard) {
+    key_t key = ftok(".", (shard == 0) ? MSG_GEN_CHAR : TRANSPORT_SHARD_GEN_CHAR + shard - 1);
+    if (key == -1) {
+        perror("[transport.c] Błąd ftok()");
+        exit(1);
+    }
+    return key;
+}
+
+static void init(Transport* t, pid_t pid, int shard) {
+    memset(t, 0, sizeof(*t));
+    t->kind      = transportKindFromEnv();
+    t->shard     = shard;
+    t->pid       = pid;
+    t->replySlot = -1;
+    t->msgId     = -1;
+    // Nazwa z klucza ftok() - tak jak zasoby SysV, osobna dla każdego katalogu
+    if (shard == 0) {
+        snprintf(t->name, sizeof(t->name), "/pizzeria_%x", (unsigned int)transportKey(0));
+    } else {
+        snprintf(t->name, sizeof(t->name), "/pizzeria_%x_%d", (unsigned int)transportKey(0), shard);
+    }
+}
+
+static unsigned int slotHash(pid_t pid) {
+    return ((unsigned int)pid * 2654435761u) & (TRANSPORT_REPLY_SLOTS - 1);
+}
+
+static int findReplySlot(struct TransportArea* a, pid_t pid) {
+    unsigned int h = slotHash(pid);
+    for (int i = 0; i < REPLY_MAX_PROBE; i++) {
+        int idx = (int)((h + i) & (TRANSPORT_REPLY_SLOTS - 1));
+        if (atomic_load_explicit(&a->replies[idx].owner, memory_order_acquire) == pid) {
+            return idx;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Zajmuje slot odpowiedzi dla PID-u (adresowanie otwarte, najwyżej REPLY_MAX_PROBE prób).
+ * Slot po procesie, który zginął (np. w pożarze) z tym samym PID-em, jest używany ponownie.
+ */
+
+// Odpowiedzi pozostawione przez poprzedniego właściciela slotu przepadają
+static void resetReplySlot(ReplySlot* slot) {
+    atomic_store(&slot->read, atomic_load(&slot->written));
+    atomic_store(&slot->waiting, 0);
+}
+
+static int claimReplySlot(struct TransportArea* a, pid_t pid) {
+    int idx = findReplySlot(a, pid);
+    if (idx >= 0) {
+        resetReplySlot(&a->replies[idx]);
+        return idx;
+    }
+    unsigned int h = slotHash(pid);
+    for (int i = 0; i < REPLY_MAX_PROBE; i++) {
+        idx = (int)((h + i) & (TRANSPORT_REPLY_SLOTS - 1));
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&a->replies[idx].owner, &expected, pid)) {
+            resetReplySlot(&a->replies[idx]);
+            return idx;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Kasjer: tworzy transport wybrany przez PIZZERIA_TRANSPORT.
+ * Przy shm pozostałość po przerwanym dniu jest usuwana, a segment zgłasza
+ * gotowość (ready) dopiero po zainicjowaniu pierścienia.
+ */
+
+void transportCreate(Transport* t, int shard) {
+    init(t, getpid(), shard);
+    if (t->kind == TRANSPORT_MSG) {
+        t->msgId = createMessageQueue(transportKey(shard));
+        return;
+    }
+
+    shm_unlink(t->name);
+    int fd = shm_open(t->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        perror(CLR_CASHIER "[transport.c] Błąd shm_open() przy tworzeniu transportu" CLR_RESET);
+        exit(1);
+    }
+    if (ftruncate(fd, sizeof(struct TransportArea)) == -1) {
+        perror(CLR_CASHIER "[transport.c] Błąd ftruncate()" CLR_RESET);
+        exit(1);
+    }
+    t->area = (struct TransportArea*)mmap(NULL, sizeof(struct TransportArea), PROT_READ | PROT_WRITE,
+                                          MAP_SHARED, fd, 0);
+    close(fd);
+    if (t->area == MAP_FAILED) {
+        perror(CLR_CASHIER "[transport.c] Błąd mmap()" CLR_RESET);
+        exit(1);
+    }
+    for (unsigned long i = 0; i < TRANSPORT_RING_SLOTS; i++) {
+        atomic_store(&t->area->ring[i].seq, i);
+    }
+    atomic_store_explicit(&t->area->ready, 1, memory_order_release);
+}
+
+/**
+ * Klient: dołącza do transportu kasjera i (przy shm) zajmuje slot odpowiedzi.
+ * Kasjer-shard dołącza tak do transportów pozostałych kasjerów z pid = 0:
+ * tylko wysyła (przekazane komunikaty) i odpowiada ich klientom, bez własnego slotu.
+ *
+ * @param t Transport klienta.
+ * @param pid Adres odpowiedzi: PID grupy (lub TID wątku w bench_app), 0 - bez odpowiedzi.
+ * @param shard Numer kasjera (0, gdy jest tylko jeden).
+ * @return 0 lub -1 (errno: ENOENT - kasjer jeszcze nie gotowy, ENOSPC - brak slotu).
+ */
+
+int transportOpen(Transport* t, pid_t pid, int shard) {
+    init(t, pid, shard);
+    if (t->kind == TRANSPORT_MSG) {
+        t->msgId = msgget(transportKey(shard), 0);
+        return (t->msgId == -1) ? -1 : 0;
+    }
+
+    int fd = shm_open(t->name, O_RDWR, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct TransportArea)) {
+        close(fd);
+        errno = ENOENT;
+        return -1;
+    }
+    t->area = (struct TransportArea*)mmap(NULL, sizeof(struct TransportArea), PROT_READ | PROT_WRITE,
+                                          MAP_SHARED, fd, 0);
+    close(fd);
+    if (t->area == MAP_FAILED) {
+        t->area = NULL;
+        return -1;
+    }
+    if (!atomic_load_explicit(&t->area->ready, memory_order_acquire)) {
+        transportClose(t);
+        errno = ENOENT;
+        return -1;
+    }
+    if (pid == 0) {
+        return 0;
+    }
+    t->replySlot = claimReplySlot(t->area, pid);
+    if (t->replySlot == -1) {
+        transportClose(t);
+        errno = ENOSPC;
+        return -1;
+    }
+    return 0;
+}
+
+void transportClose(Transport* t) {
+    if (t->kind == TRANSPORT_MSG || t->area == NULL) {
+        return;
+    }
+    if (t->replySlot >= 0) {
+        ReplySlot* slot = &t->area->replies[t->replySlot];
+        resetReplySlot(slot);
+        atomic_store(&slot->owner, 0);
+        t->replySlot = -1;
+    }
+    munmap(t->area, sizeof(struct TransportArea));
+    t->area = NULL;
+}
+
+/**
+ * Kasjer: usuwa transport. Klienci czekający na odpowiedź w shm dostają
+ * closed (jak EIDRM przy usuniętej kolejce komunikatów) - po odebraniu odpowiedzi już wpisanych.
+ */
+
+void transportDestroy(Transport* t) {
+    if (t->kind == TRANSPORT_MSG) {
+        deleteMessageQueue(t->msgId);
+        return;
+    }
+    atomic_store(&t->area->closed, 1);
+    for (int i = 0; i < TRANSPORT_REPLY_SLOTS; i++) {
+        ReplySlot* slot = &t->area->replies[i];
+        if (atomic_load(&slot->owner) != 0) {
+            atomic_store(&slot->closed, 1);
+            atomic_fetch_add(&slot->wake, 1);
+            futexWake(&slot->wake, INT_MAX);
+        }
+    }
+    munmap(t->area, sizeof(struct TransportArea));
+    t->area = NULL;
+    if (shm_unlink(t->name) == -1) {
+        perror(CLR_CASHIER "[transport.c] Błąd shm_unlink()" CLR_RESET);
+    }
+}
+
+static CommunicationMessage* acquire(Transport* t, int wait) {
+    if (t->kind == TRANSPORT_MSG) {
+        t->buffer.originShard = t->shard;
+        t->buffer.hops        = 0;
+        return &t->buffer;
+    }
+    struct TransportArea* a = t->area;
+    unsigned long pos = atomic_load_explicit(&a->tail, memory_order_relaxed);
+    RequestSlot* slot;
+    while (1) {
+        if (atomic_load_explicit(&a->closed, memory_order_relaxed)) {
+            errno = EIDRM;
+            return NULL;
+        }
+        slot = &a->ring[pos & (TRANSPORT_RING_SLOTS - 1)];
+        unsigned long seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        long diff = (long)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&a->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            if (!wait) {
+                errno = EAGAIN;  // pierścień pełny
+                return NULL;
+            }
+            sched_yield();  // pierścień pełny
+            pos = atomic_load_explicit(&a->tail, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&a->tail, memory_order_relaxed);
+        }
+    }
+    t->pending = pos;
+    slot->msg.originShard = t->shard;
+    slot->msg.hops        = 0;
+    return &slot->msg;
+}
+
+/**
+ * Rezerwuje miejsce na komunikat do kasjera. Przy shm to slot pierścienia
+ * (pełny pierścień = czekamy, aż kasjer go zwolni), przy msg - bufor lokalny.
+ * Pola trasy są już ustawione: originShard = ten kasjer, hops = 0.
+ * @return Wskaźnik do wypełnienia lub NULL (errno = EIDRM - transport zamknięty).
+ */
+
+CommunicationMessage* transportAcquire(Transport* t) {
+    return acquire(t, 1);
+}
+
+/**
+ * Jak transportAcquire, ale przy pełnym pierścieniu nie czeka. Dla kasjerów,
+ * którzy wysyłają do siebie nawzajem - dwóch czekających na miejsce u drugiego
+ * nigdy by go nie zwolniło.
+ * @return Wskaźnik do wypełnienia lub NULL (errno = EAGAIN - pierścień pełny, EIDRM).
+ */
+
+CommunicationMessage* transportTryAcquire(Transport* t) {
+    return acquire(t, 0);
+}
+
+static int commit(Transport* t, int flags) {
+    if (t->kind == TRANSPORT_MSG) {
+        return msgsnd(t->msgId, &t->buffer, sizeof(t->buffer) - sizeof(long), flags);
+    }
+    struct TransportArea* a = t->area;
+    RequestSlot* slot = &a->ring[t->pending & (TRANSPORT_RING_SLOTS - 1)];
+    atomic_store_explicit(&slot->seq, t->pending + 1, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&a->consumerSleeping, memory_order_relaxed)) {
+        atomic_fetch_add(&a->consumerWake, 1);
+        futexWake(&a->consumerWake, 1);
+    }
+    return 0;
+}
+
+/**
+ * Publikuje komunikat przygotowany po transportAcquire() i budzi kasjera, jeśli śpi.
+ * @return 0 lub -1 (błąd msgsnd()).
+ */
+
+int transportCommit(Transport* t) {
+    return commit(t, 0);
+}
+
+/**
+ * Publikuje komunikat po transportTryAcquire(). Przy msg pełna kolejka
+ * nie blokuje (IPC_NOWAIT); przy shm slot jest już zarezerwowany.
+ * @return 0 lub -1 (errno = EAGAIN - kolejka pełna, inny błąd msgsnd()).
+ */
+
+int transportTryCommit(Transport* t) {
+    return commit(t, IPC_NOWAIT);
+}
+
+/**
+ * Odbiór z kolejki SysV. Ujemny mtype zabiera najniższy typ <= REQUEST_TABLE
+ * (odpowiedzi z mtype = PID zostają w kolejce), patrz priorytety w pizzeria.h.
+ */
+
+static int msgReceive(Transport* t, int flags) {
+    size_t size = sizeof(t->buffer) - sizeof(long);
+    return (msgrcv(t->msgId, &t->buffer, size, -REQUEST_TABLE, flags) == -1) ? -1 : 0;
+}
+
+/**
+ * Kasjer: czeka na następny komunikat (REQUEST_TABLE, CANCEL_REQUEST, SEND_ORDER, LEAVE_TABLE,
+ * SEAT_AVAILABLE).
+ * Sygnał przerywa czekanie (handlery bez SA_RESTART), tak jak msgrcv().
+ * @return Wskaźnik do komunikatu (ważny do transportRelease) lub NULL z errno.
+ */
+
+CommunicationMessage* transportReceive(Transport* t) {
+    if (t->kind == TRANSPORT_MSG) {
+        return (msgReceive(t, 0) == -1) ? NULL : &t->buffer;
+    }
+    struct TransportArea* a = t->area;
+    unsigned long head = atomic_load_explicit(&a->head, memory_order_relaxed);
+    RequestSlot* slot = &a->ring[head & (TRANSPORT_RING_SLOTS - 1)];
+    while (1) {
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) == head + 1) {
+            return &slot->msg;
+        }
+        int seen = atomic_load(&a->consumerWake);
+        atomic_store(&a->consumerSleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != head + 1) {
+            long rc = futexWait(&a->consumerWake, seen);
+            int  err = errno;
+            atomic_store(&a->consumerSleeping, 0);
+            if (rc == -1 && err == EINTR) {
+                errno = EINTR;
+                return NULL;
+            }
+        } else {
+            atomic_store(&a->consumerSleeping, 0);
+        }
+    }
+}
+
+/**
+ * Kasjer: jak transportReceive, ale bez czekania.
+ * @return Wskaźnik do komunikatu lub NULL, gdy nic nie czeka (errno = ENOMSG).
+ */
+
+CommunicationMessage* transportPoll(Transport* t) {
+    if (t->kind == TRANSPORT_MSG) {
+        return (msgReceive(t, IPC_NOWAIT) == -1) ? NULL : &t->buffer;
+    }
+    struct TransportArea* a = t->area;
+    unsigned long head = atomic_load_explicit(&a->head, memory_order_relaxed);
+    RequestSlot* slot = &a->ring[head & (TRANSPORT_RING_SLOTS - 1)];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != head + 1) {
+        errno = ENOMSG;
+        return NULL;
+    }
+    return &slot->msg;
+}
+
+void transportRelease(Transport* t) {
+    if (t->kind == TRANSPORT_MSG) {
+        return;
+    }
+    struct TransportArea* a = t->area;
+    unsigned long head = atomic_load_explicit(&a->head, memory_order_relaxed);
+    atomic_store_explicit(&a->ring[head & (TRANSPORT_RING_SLOTS - 1)].seq,
+                          head + TRANSPORT_RING_SLOTS, memory_order_release);
+    atomic_store_explicit(&a->head, head + 1, memory_order_relaxed);
+}
+
+/**
+ * Kasjer: odpowiedź do grupy (numer stolika, NO_TABLE_FOUND, NEAR_CLOSING, GROUP_QUEUED,
+ * GROUP_CANCELLED, ORDER_SERVED, ORDER_COOKING lub PIZZA_READY) z szacowanym czekaniem waitMs. Przy shm nie czeka na klienta -
+ * dopisuje odpowiedź do pierścienia jego slotu i robi FUTEX_WAKE tylko wtedy, gdy klient już na nią czeka.
+ * @return 0 lub -1 (errno = ESRCH - klient nie ma slotu, np. już nie żyje; ENOBUFS - klient nie odbiera).
+ */
+
+int transportReply(Transport* t, const GroupOfClients* g, int tableIndex, int waitMs) {
+    if (t->kind == TRANSPORT_MSG) {
+        CommunicationMessage msg;  // nie t->buffer - tam może leżeć obsługiwane właśnie zapytanie
+        memset(&msg, 0, sizeof(msg));
+        msg.mtype      = g->groupPID;
+        msg.group      = *g;
+        msg.tableIndex = tableIndex;
+        msg.waitMs     = waitMs;
+        return msgsnd(t->msgId, &msg, sizeof(msg) - sizeof(long), 0);
+    }
+    int idx = findReplySlot(t->area, g->groupPID);
+    if (idx == -1) {
+        errno = ESRCH;
+        return -1;
+    }
+    ReplySlot* slot = &t->area->replies[idx];
+    int unlocked = 0;
+    while (!atomic_compare_exchange_weak_explicit(&slot->lock, &unlocked, 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+        unlocked = 0;
+        sched_yield();
+    }
+    unsigned int w = atomic_load_explicit(&slot->written, memory_order_relaxed);
+    if (w - atomic_load_explicit(&slot->read, memory_order_acquire) >= REPLY_RING) {
+        atomic_store_explicit(&slot->lock, 0, memory_order_release);
+        errno = ENOBUFS;    // klient nie odbiera odpowiedzi
+        return -1;
+    }
+    CommunicationMessage* reply = &slot->reply[w & (REPLY_RING - 1)];
+    reply->mtype      = g->groupPID;
+    reply->group      = *g;
+    reply->tableIndex = tableIndex;
+    reply->waitMs     = waitMs;
+    for (int i = 0; i < MAX_GROUP_SIZE; i++) {
+        reply->orderedItems[i] = -1;
+    }
+    atomic_store_explicit(&slot->written, w + 1, memory_order_release);
+    atomic_store_explicit(&slot->lock, 0, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&slot->waiting, memory_order_relaxed)) {
+        atomic_fetch_add(&slot->wake, 1);
+        futexWake(&slot->wake, 1);
+    }
+    return 0;
+}
+
+/**
+ * Klient: czeka na odpowiedź kasjera adresowaną do t->pid. Przy shm odpowiedzi
+ * przychodzą w kolejności wpisania; zamknięty transport zgłasza się dopiero po ostatniej.
+ * @return 0 lub -1 (errno = EIDRM - kasjer zamknął transport, EINTR - sygnał).
+ */
+
+int transportAwaitReply(Transport* t, CommunicationMessage* out) {
+    if (t->kind == TRANSPORT_MSG) {
+        return (msgrcv(t->msgId, out, sizeof(*out) - sizeof(long), t->pid, 0) == -1) ? -1 : 0;
+    }
+    ReplySlot* slot = &t->area->replies[t->replySlot];
+    while (1) {
+        int seen = atomic_load(&slot->wake);
+        unsigned int r = atomic_load_explicit(&slot->read, memory_order_relaxed);
+        if (atomic_load_explicit(&slot->written, memory_order_acquire) != r) {
+            *out = slot->reply[r & (REPLY_RING - 1)];
+            atomic_store_explicit(&slot->read, r + 1, memory_order_release);
+            return 0;
+        }
+        if (atomic_load(&slot->closed)) {
+            errno = EIDRM;
+            return -1;
+        }
+        // Nadawca sprawdza waiting po wpisaniu odpowiedzi, my - written po ustawieniu waiting
+        atomic_store(&slot->waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&slot->written, memory_order_acquire) == r && !atomic_load(&slot->closed)) {
+            long rc = futexWait(&slot->wake, seen);
+            int  err = errno;
+            atomic_store(&slot->waiting, 0);
+            if (rc == -1 && err == EINTR) {
+                errno = EINTR;
+                return -1;
+            }
+        } else {
+            atomic_store(&slot->waiting, 0);
+        }
+    }
+}
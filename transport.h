@@ -0,0 +1,64 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "pizzeria.h"
+
+// --------------------- Transport klient <-> kasjer ---------------------
+//
+// Dwa wymienne mechanizmy, wybierane zmienną środowiskową PIZZERIA_TRANSPORT:
+//   msg (domyślnie) - kolejka komunikatów SysV, odpowiedzi z mtype = PID grupy,
+//   shm             - pamięć współdzielona POSIX: pierścień MPSC zapytań do kasjera
+//                     i po jednym pierścieniu odpowiedzi na klienta (PID -> slot przez
+//                     tablicę mieszającą), budzenie przez futex.
+// Komunikat budujemy w miejscu docelowym: transportAcquire() zwraca wskaźnik
+// do slotu pierścienia (przy msg - do bufora), transportCommit() go publikuje.
+// Kasjer czyta komunikat wprost z pierścienia i oddaje slot transportRelease().
+// Przy kilku kasjerach (PIZZERIA_SHARDS) każdy ma własny transport: shard 0
+// używa dotychczasowego klucza / nazwy, shard s > 0 - klucza ftok(".", 'a' + s - 1)
+// i nazwy z przyrostkiem _s.
+
+#define TRANSPORT_MSG           0
+#define TRANSPORT_SHM           1
+
+#define TRANSPORT_RING_SLOTS    4096  // potęga dwójki
+#define TRANSPORT_REPLY_SLOTS   4096  // potęga dwójki
+#define TRANSPORT_SHARD_GEN_CHAR 'a'  // klucze kolejek shardów 1, 2, ...
+
+struct TransportArea;
+
+typedef struct {
+    int                   kind;
+    int                   shard;         // numer kasjera
+    int                   msgId;         // msg: id kolejki
+    struct TransportArea* area;          // shm: odwzorowany segment
+    char                  name[32];      // shm: nazwa segmentu
+    pid_t                 pid;           // klient: adres odpowiedzi (PID grupy / TID)
+    int                   replySlot;     // shm: slot odpowiedzi klienta
+    unsigned long         pending;       // shm: pozycja zarezerwowana przez transportAcquire
+    CommunicationMessage  buffer;        // msg: bufor wysyłki / odbioru
+} Transport;
+
+int  transportKindFromEnv(void);
+void transportCreate(Transport* t, int shard);
+int  transportOpen(Transport* t, pid_t pid, int shard);
+void transportClose(Transport* t);
+void transportDestroy(Transport* t);
+
+// Klient -> kasjer
+CommunicationMessage* transportAcquire(Transport* t);
+int  transportCommit(Transport* t);
+
+// Kasjer -> inny kasjer: bez czekania na miejsce (EAGAIN)
+CommunicationMessage* transportTryAcquire(Transport* t);
+int  transportTryCommit(Transport* t);
+
+// Kasjer
+CommunicationMessage* transportReceive(Transport* t);
+CommunicationMessage* transportPoll(Transport* t);
+void transportRelease(Transport* t);
+int  transportReply(Transport* t, const GroupOfClients* g, int tableIndex, int waitMs);
+
+// Kasjer -> klient
+int  transportAwaitReply(Transport* t, CommunicationMessage* out);
+
+#endif // TRANSPORT_H